@@ -36,6 +36,9 @@
 #include <Core/Algorithms/DataIO/WriteMatrix.h>
 #include <Core/Algorithms/DataIO/ReadMatrix.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Persistent/PersistentSTL.h>
+#include <Core/GeometryPrimitives/Point.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
 
 using namespace SCIRun::TestUtils;
@@ -220,3 +223,124 @@ TEST(WriteMatrixAlgorithmTest, RoundTripRealBinaryFileDense)
   ASSERT_TRUE(dense5.get() != nullptr);
   EXPECT_EQ(*dense4, *dense5);
 }
+
+TEST(WriteMatrixAlgorithmTest, MappedBinaryReadMatchesStdioRead)
+{
+  DenseMatrixHandle dense(new DenseMatrix(DenseMatrix::Random(200, 300)));
+  auto sparse = toSparseHandle(DenseMatrix(DenseMatrix::Identity(500, 400) * 3.5));
+  auto denseFile = TestResources::rootDir() / "TransientOutput" / "mappedDense.mat";
+  auto sparseFile = TestResources::rootDir() / "TransientOutput" / "mappedSparse.mat";
+  writeMatrixToFile(dense, denseFile);
+  writeMatrixToFile(sparse, sparseFile);
+
+  for (const auto& file : { denseFile, sparseFile })
+  {
+    MatrixHandle mapped, buffered;
+    {
+      SCIRun::MappedBinaryPiostream stream(file.string());
+      ASSERT_FALSE(stream.error());
+#ifndef _WIN32
+      EXPECT_TRUE(stream.mapped());
+#endif
+      Pio(stream, mapped);
+      EXPECT_FALSE(stream.error());
+    }
+    {
+      SCIRun::BinaryPiostream stream(file.string(), SCIRun::Piostream::Direction::Read);
+      Pio(stream, buffered);
+    }
+    ASSERT_TRUE(mapped != nullptr);
+    ASSERT_TRUE(buffered != nullptr);
+    EXPECT_EQ(*convertMatrix::toDense(buffered), *convertMatrix::toDense(mapped));
+  }
+
+  EXPECT_EQ(*dense, *castMatrix::toDense(readDenseMatrixFile(denseFile)));
+  EXPECT_EQ(*sparse, *castMatrix::toSparse(readSparseMatrixFile(sparseFile)));
+}
+
+TEST(WriteMatrixAlgorithmTest, PackedPointArrayMatchesElementwiseFormat)
+{
+  using SCIRun::Core::Geometry::Point;
+  std::vector<Point> points;
+  for (int i = 0; i < 1000; ++i)
+    points.emplace_back(i, 0.5 * i, -2.0 * i);
+  auto file = TestResources::rootDir() / "TransientOutput" / "packedPoints.bin";
+  {
+    SCIRun::BinaryPiostream stream(file.string(), SCIRun::Piostream::Direction::Write);
+    SCIRun::Pio<Point>(stream, points);
+    ASSERT_FALSE(stream.error());
+  }
+  std::vector<Point> mapped, elementwise;
+  {
+    SCIRun::MappedBinaryPiostream stream(file.string());
+    SCIRun::Pio(stream, mapped);
+    EXPECT_FALSE(stream.error());
+  }
+  {
+    SCIRun::BinaryPiostream stream(file.string(), SCIRun::Piostream::Direction::Read);
+    SCIRun::Pio<Point>(stream, elementwise);
+    EXPECT_FALSE(stream.error());
+  }
+  EXPECT_EQ(points, mapped);
+  EXPECT_EQ(points, elementwise);
+}
+
+TEST(WriteMatrixAlgorithmTest, ChunkedCompressedRoundTripAndRowAccess)
+{
+  using SCIRun::ChunkedBinaryPiostream;
+  using SCIRun::Piostream;
+  DenseMatrixHandle dense(new DenseMatrix(DenseMatrix::Random(300, 200)));
+  DenseMatrix banded(DenseMatrix::Zero(1000, 800));
+  for (int i = 0; i < banded.rows(); ++i)
+  {
+    banded(i, i % 800) = i + 1;
+    banded(i, (7 * i + 3) % 800) = -0.5 * i;
+  }
+  auto sparse = toSparseHandle(banded);
+  auto denseFile = TestResources::rootDir() / "TransientOutput" / "chunkedDense.mat";
+  auto sparseFile = TestResources::rootDir() / "TransientOutput" / "chunkedSparse.mat";
+
+  const std::vector<std::pair<MatrixHandle, boost::filesystem::path>> files { { dense, denseFile }, { sparse, sparseFile } };
+  for (const auto& file : files)
+  {
+    ChunkedBinaryPiostream stream(file.second.string(), Piostream::Direction::Write, 16384);
+    MatrixHandle matrix = file.first;
+    Pio(stream, matrix);
+    EXPECT_TRUE(stream.finish());
+  }
+
+  EXPECT_EQ(*dense, *castMatrix::toDense(readDenseMatrixFile(denseFile)));
+  EXPECT_EQ(*sparse, *castMatrix::toSparse(readSparseMatrixFile(sparseFile)));
+
+  {
+    ChunkedBinaryPiostream stream(denseFile.string(), Piostream::Direction::Read);
+    ASSERT_FALSE(stream.error());
+    EXPECT_EQ(16384u, stream.chunk_size());
+    EXPECT_GT(stream.num_chunks(), 20u);
+    std::vector<double> rows;
+    size_t ncols = 0;
+    ASSERT_TRUE(stream.read_dense_matrix_rows(100, 20, rows, ncols));
+    ASSERT_EQ(200u, ncols);
+    for (int r = 0; r < 20; ++r)
+      for (int c = 0; c < 200; ++c)
+        EXPECT_EQ((*dense)(100 + r, c), rows[r * ncols + c]);
+    EXPECT_LT(stream.num_inflated_chunks(), stream.num_chunks() / 2);
+    EXPECT_FALSE(stream.read_dense_matrix_rows(290, 20, rows, ncols));
+  }
+
+  {
+    ChunkedBinaryPiostream stream(sparseFile.string(), Piostream::Direction::Read);
+    ASSERT_FALSE(stream.error());
+    std::vector<SCIRun::index_type> rowPtr, columns;
+    std::vector<double> values;
+    ASSERT_TRUE(stream.read_sparse_matrix_rows(500, 10, rowPtr, columns, values));
+    ASSERT_EQ(11u, rowPtr.size());
+    for (int r = 0; r < 10; ++r)
+    {
+      EXPECT_EQ(sparse->outerIndexPtr()[501 + r] - sparse->outerIndexPtr()[500 + r], rowPtr[r + 1] - rowPtr[r]);
+      for (auto k = rowPtr[r]; k < rowPtr[r + 1]; ++k)
+        EXPECT_EQ(sparse->coeff(500 + r, columns[k]), values[k]);
+    }
+    EXPECT_LT(stream.num_inflated_chunks(), stream.num_chunks());
+  }
+}
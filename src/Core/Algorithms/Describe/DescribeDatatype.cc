@@ -31,6 +31,9 @@
 #include <Core/Algorithms/Math/ReportMatrixInfo.h>
 #include <Core/Datatypes/String.h>
 #include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Geometry.h>
 #include <Core/Datatypes/ColorMap.h>
@@ -112,3 +115,68 @@ std::string DescribeDatatype::describe(const DatatypeHandle& data) const
 
   return "[Unknown Datatype]";
 }
+
+namespace
+{
+  size_t fieldValueBytes(VField* vfield)
+  {
+    if (vfield->is_vector())
+      return sizeof(Vector);
+    if (vfield->is_tensor())
+      return sizeof(Tensor);
+    if (vfield->is_char() || vfield->is_unsigned_char())
+      return 1;
+    if (vfield->is_short() || vfield->is_unsigned_short())
+      return 2;
+    if (vfield->is_int() || vfield->is_unsigned_int() || vfield->is_float())
+      return 4;
+    if (vfield->is_complex_double())
+      return 16;
+    return 8;
+  }
+}
+
+size_t DescribeDatatype::estimateBytes(const DatatypeHandle& data) const
+{
+  if (!data)
+    return 0;
+
+  auto str = std::dynamic_pointer_cast<String>(data);
+  if (str)
+    return str->value().size();
+
+  auto sparse = std::dynamic_pointer_cast<SparseRowMatrix>(data);
+  if (sparse)
+    return sparse->nonZeros() * (sizeof(double) + sizeof(index_type)) + (sparse->rows() + 1) * sizeof(index_type);
+
+  auto mat = std::dynamic_pointer_cast<Matrix>(data);
+  if (mat)
+    return mat->nrows() * mat->ncols() * sizeof(double);
+
+  auto field = std::dynamic_pointer_cast<Field>(data);
+  if (field)
+  {
+    auto vmesh = field->vmesh();
+    auto vfield = field->vfield();
+    size_t bytes = 0;
+    if (vmesh && !vmesh->is_regularmesh())
+    {
+      bytes += vmesh->num_nodes() * sizeof(Point);
+      bytes += vmesh->num_elems() * vmesh->num_nodes_per_elem() * sizeof(VMesh::index_type);
+    }
+    if (vfield)
+      bytes += (vfield->num_values() + vfield->num_evalues()) * fieldValueBytes(vfield);
+    return bytes;
+  }
+
+  auto bundle = std::dynamic_pointer_cast<Bundle>(data);
+  if (bundle)
+  {
+    size_t bytes = 0;
+    for (const auto& item : *bundle)
+      bytes += estimateBytes(item.second);
+    return bytes;
+  }
+
+  return 0;
+}
@@ -41,6 +41,8 @@ namespace General {
   {
   public:
     std::string describe(const Datatypes::DatatypeHandle& data) const;
+    /// Approximate in-memory size of the data payload, used for execution tracing.
+    size_t estimateBytes(const Datatypes::DatatypeHandle& data) const;
     AlgorithmOutput run(const AlgorithmInput&) const override { return AlgorithmOutput(); }
   };
 
@@ -30,6 +30,7 @@
 
 
 #include <gtest/gtest.h>
+#include <cmath>
 
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
@@ -39,6 +40,7 @@
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
 #include <Core/Datatypes/DenseMatrix.h>
 
 using namespace SCIRun;
@@ -118,3 +120,105 @@ TEST(ClipVolumeByIsovalueAlgoTest, DISABLED_ClipVolumeByIsovalue_LatVol_DataOnNo
   EXPECT_EQ(output->vmesh()->num_elems(),1);
   EXPECT_EQ(output->vfield()->num_values(),8);
 }
+
+namespace
+{
+  // Block of tets or hexes, or a single layer of triangles, with a smoothly
+  // varying node value.
+  FieldHandle clipGrid(mesh_info_type type, int n)
+  {
+    FieldHandle field;
+    if (type != mesh_info_type::TRISURFMESH_E)
+    {
+      field = CreateCubeBlock(type, n, databasis_info_type::LINEARDATA_E, ShearedGridPoint);
+    }
+    else
+    {
+      FieldInformation fi(mesh_info_type::TRISURFMESH_E, databasis_info_type::LINEARDATA_E, data_info_type::DOUBLE_E);
+      field = CreateField(fi);
+      auto vmesh = field->vmesh();
+      for (int j = 0; j <= n; j++)
+        for (int i = 0; i <= n; i++)
+          vmesh->add_point(ShearedGridPoint(i, j, 0));
+
+      auto node = [n](int i, int j) { return i + (n+1)*j; };
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          VMesh::Node::array_type nodes(3);
+          nodes[0] = node(i, j); nodes[1] = node(i+1, j); nodes[2] = node(i+1, j+1);
+          vmesh->add_elem(nodes);
+          nodes[1] = node(i+1, j+1); nodes[2] = node(i, j+1);
+          vmesh->add_elem(nodes);
+        }
+    }
+
+    auto vmesh = field->vmesh();
+    auto vfield = field->vfield();
+    vfield->resize_values();
+    for (VMesh::Node::index_type i = 0; i < vmesh->num_nodes(); i++)
+    {
+      Point p;
+      vmesh->get_center(p, i);
+      vfield->set_value(std::sin(0.7*p.x()) + std::cos(0.5*p.y()) + 0.3*p.z(), i);
+    }
+    return field;
+  }
+
+  void expectIdenticalClip(FieldHandle input, double isoval, bool lessThan)
+  {
+    ClipMeshByIsovalueAlgo algo;
+    algo.set(Parameters::ScalarIsoValue, isoval);
+    algo.set(Parameters::LessThanIsoValue, lessThan);
+    FieldHandle serial, parallel;
+    algo.set(Parameters::MultithreadedClip, false);
+    ASSERT_TRUE(algo.run(input, serial));
+    algo.set(Parameters::MultithreadedClip, true);
+    ASSERT_TRUE(algo.run(input, parallel));
+
+    auto smesh = serial->vmesh();
+    auto pmesh = parallel->vmesh();
+    ASSERT_GT(smesh->num_elems(), 0);
+    ASSERT_EQ(smesh->num_nodes(), pmesh->num_nodes());
+    ASSERT_EQ(smesh->num_elems(), pmesh->num_elems());
+    ASSERT_EQ(serial->vfield()->num_values(), parallel->vfield()->num_values());
+
+    for (VMesh::Node::index_type i = 0; i < smesh->num_nodes(); i++)
+    {
+      EXPECT_EQ(smesh->get_point(i), pmesh->get_point(i));
+      double sval, pval;
+      serial->vfield()->get_value(sval, i);
+      parallel->vfield()->get_value(pval, i);
+      EXPECT_EQ(sval, pval);
+    }
+
+    VMesh::Node::array_type snodes, pnodes;
+    for (VMesh::Elem::index_type e = 0; e < smesh->num_elems(); e++)
+    {
+      smesh->get_nodes(snodes, e);
+      pmesh->get_nodes(pnodes, e);
+      EXPECT_EQ(snodes, pnodes);
+    }
+  }
+}
+
+TEST(ClipVolumeByIsovalueAlgoTest, MultithreadedClipMatchesSerialTets)
+{
+  auto input = clipGrid(mesh_info_type::TETVOLMESH_E, 12);
+  expectIdenticalClip(input, 1.0, false);
+  expectIdenticalClip(input, 1.0, true);
+}
+
+TEST(ClipVolumeByIsovalueAlgoTest, MultithreadedClipMatchesSerialTriangles)
+{
+  auto input = clipGrid(mesh_info_type::TRISURFMESH_E, 80);
+  expectIdenticalClip(input, 0.5, false);
+  expectIdenticalClip(input, 0.5, true);
+}
+
+TEST(ClipVolumeByIsovalueAlgoTest, MultithreadedClipMatchesSerialHexes)
+{
+  auto input = clipGrid(mesh_info_type::HEXVOLMESH_E, 10);
+  expectIdenticalClip(input, 1.0, false);
+  expectIdenticalClip(input, 1.0, true);
+}
@@ -0,0 +1,365 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Algorithms/Legacy/Fields/SmoothMesh/FairMesh.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace SCIRun;
+using namespace Core::Datatypes;
+using namespace Core::Geometry;
+using namespace Core::Algorithms;
+using namespace Fields;
+
+namespace
+{
+  // Latitude/longitude sphere with a deterministic radial perturbation
+  FieldHandle noisySphere(int nlat, int nlon)
+  {
+    FieldInformation fi("TriSurfMesh", static_cast<int>(databasis_info_type::LINEARDATA_E), "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    const double pi = 3.14159265358979323846;
+    mesh->add_point(Point(0.0, 0.0, 1.0));
+    for (int i = 1; i < nlat; ++i)
+    {
+      for (int j = 0; j < nlon; ++j)
+      {
+        double theta = pi * i / nlat;
+        double phi = 2.0 * pi * j / nlon;
+        double r = 1.0 + 0.05 * (((i * 7919 + j * 104729) % 13) - 6) / 6.0;
+        mesh->add_point(Point(r * sin(theta) * cos(phi), r * sin(theta) * sin(phi), r * cos(theta)));
+      }
+    }
+    const VMesh::index_type south = mesh->num_nodes();
+    mesh->add_point(Point(0.0, 0.0, -1.0));
+
+    auto ring = [nlon](int i, int j) { return static_cast<VMesh::index_type>(1 + (i - 1) * nlon + (j % nlon)); };
+    VMesh::Node::array_type tri(3);
+    for (int j = 0; j < nlon; ++j)
+    {
+      tri[0] = 0; tri[1] = ring(1, j); tri[2] = ring(1, j + 1);
+      mesh->add_elem(tri);
+      tri[0] = south; tri[1] = ring(nlat - 1, j + 1); tri[2] = ring(nlat - 1, j);
+      mesh->add_elem(tri);
+    }
+    for (int i = 1; i < nlat - 1; ++i)
+    {
+      for (int j = 0; j < nlon; ++j)
+      {
+        tri[0] = ring(i, j); tri[1] = ring(i + 1, j); tri[2] = ring(i + 1, j + 1);
+        mesh->add_elem(tri);
+        tri[0] = ring(i, j); tri[1] = ring(i + 1, j + 1); tri[2] = ring(i, j + 1);
+        mesh->add_elem(tri);
+      }
+    }
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  // Standard deviation of the distance of the nodes to the origin
+  double radialDeviation(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    double sum = 0.0, sum2 = 0.0;
+    for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); ++idx)
+    {
+      Point p;
+      mesh->get_center(p, idx);
+      double r = Vector(p).length();
+      sum += r;
+      sum2 += r * r;
+    }
+    double mean = sum / mesh->num_nodes();
+    return sqrt(std::max(0.0, sum2 / mesh->num_nodes() - mean * mean));
+  }
+
+  double meanRadius(FieldHandle field)
+  {
+    VMesh* mesh = field->vmesh();
+    double total = 0.0;
+    for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); ++idx)
+    {
+      Point p;
+      mesh->get_center(p, idx);
+      total += Vector(p).length();
+    }
+    return total / mesh->num_nodes();
+  }
+
+  // The serial lambda/mu loops FairMesh used before the sweeps were
+  // parallelized, kept as a reference for the node positions
+  std::vector<Point> serialFairMesh(FieldHandle input, bool desbrun, int num_iter, double lambda, double mu)
+  {
+    FieldHandle field(input->deep_clone());
+    VMesh* mesh = field->vmesh();
+    const VMesh::size_type num_nodes = mesh->num_nodes();
+    mesh->synchronize(Mesh::NODE_NEIGHBORS_E | Mesh::EPSILON_E);
+    const double epsilon = mesh->get_epsilon();
+
+    std::vector<VMesh::Node::array_type> neighbors(num_nodes);
+    std::vector<std::vector<std::pair<VMesh::index_type, VMesh::index_type>>> edges(num_nodes);
+    VMesh::Elem::array_type elems;
+    VMesh::Node::array_type nodes;
+    for (VMesh::Node::index_type idx = 0; idx < num_nodes; ++idx)
+    {
+      mesh->get_neighbors(neighbors[idx], idx);
+      mesh->get_elems(elems, idx);
+      for (size_t j = 0; j < elems.size(); ++j)
+      {
+        mesh->get_nodes(nodes, elems[j]);
+        nodes.push_back(nodes[0]);
+        for (size_t k = 1; k < nodes.size(); ++k)
+        {
+          if (nodes[k - 1] != idx && nodes[k] != idx)
+            edges[idx].push_back(std::make_pair(nodes[k - 1], nodes[k]));
+        }
+      }
+    }
+
+    std::vector<Point> point(num_nodes);
+    for (VMesh::Node::index_type idx = 0; idx < num_nodes; ++idx)
+      mesh->get_center(point[idx], idx);
+
+    std::vector<Vector> disp(num_nodes);
+    for (int it = 0; it < 2 * num_iter; ++it)
+    {
+      for (VMesh::index_type idx = 0; idx < num_nodes; ++idx)
+      {
+        const Point p0 = point[idx];
+        Vector d(0.0, 0.0, 0.0);
+        if (!desbrun)
+        {
+          double w = 1.0 / neighbors[idx].size();
+          for (size_t j = 0; j < neighbors[idx].size(); ++j)
+            d += w * (point[neighbors[idx][j]] - p0);
+          disp[idx] = d;
+          continue;
+        }
+
+        double totw = 0.0;
+        for (size_t j = 0; j < edges[idx].size(); ++j)
+        {
+          Point p1 = point[edges[idx][j].first];
+          Point p2 = point[edges[idx][j].second];
+          Vector p12 = p1 - p2;
+          double e = Dot(p12, p12);
+          if (e > 0.0)
+          {
+            double dot = Dot(p1 - p0, p12) / e;
+            Point p3 = p1 - dot * p12;
+            double A = (p1 - p3).length();
+            double B = (p0 - p3).length();
+            double C = (p2 - p3).length();
+            if (B >= 10 * epsilon)
+            {
+              if (dot < 0.0) A = -A;
+              if (dot > 1.0) C = -C;
+              totw += (A + C) / B;
+              d += (A / B) * (p2 - p0) + (C / B) * (p1 - p0);
+            }
+          }
+        }
+        if (totw != 0.0) disp[idx] = d * (1.0 / totw);
+      }
+
+      const double factor = (it % 2 == 0) ? lambda : mu;
+      for (VMesh::index_type idx = 0; idx < num_nodes; ++idx)
+        point[idx] = point[idx] + factor * disp[idx];
+    }
+    return point;
+  }
+}
+
+class FairMeshAlgoTests : public testing::TestWithParam<std::string>
+{
+};
+
+TEST_P(FairMeshAlgoTests, SmoothsNoisySphere)
+{
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, GetParam());
+  algo.set(Parameters::NumIterations, 30);
+
+  FieldHandle input = noisySphere(40, 80);
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+  ASSERT_TRUE(output != nullptr);
+  ASSERT_EQ(input->vmesh()->num_nodes(), output->vmesh()->num_nodes());
+
+  EXPECT_LT(radialDeviation(output), 0.5 * radialDeviation(input));
+  // low pass filters should not shrink the surface noticeably
+  EXPECT_NEAR(1.0, meanRadius(output), 0.05);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  FairMeshAlgoTestsParameterized,
+  FairMeshAlgoTests,
+  testing::Values("fast", "chebyshev")
+);
+
+TEST(FairMeshAlgoChebyshevTests, PreservesTranslation)
+{
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, "chebyshev");
+  algo.set(Parameters::NumIterations, 10);
+
+  FieldInformation fi("TriSurfMesh", static_cast<int>(databasis_info_type::LINEARDATA_E), "double");
+  FieldHandle input = CreateField(fi);
+  VMesh* mesh = input->vmesh();
+  mesh->add_point(Point(5.0, 5.0, 5.0));
+  mesh->add_point(Point(6.0, 5.0, 5.0));
+  mesh->add_point(Point(5.0, 6.0, 5.0));
+  mesh->add_point(Point(5.0, 5.0, 6.0));
+  VMesh::Node::array_type tri(3);
+  tri[0] = 0; tri[1] = 2; tri[2] = 1; mesh->add_elem(tri);
+  tri[0] = 0; tri[1] = 1; tri[2] = 3; mesh->add_elem(tri);
+  tri[0] = 0; tri[1] = 3; tri[2] = 2; mesh->add_elem(tri);
+  tri[0] = 1; tri[1] = 2; tri[2] = 3; mesh->add_elem(tri);
+  input->vfield()->resize_values();
+
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+
+  Point centroid(0.0, 0.0, 0.0);
+  for (VMesh::Node::index_type idx = 0; idx < 4; ++idx)
+  {
+    Point p;
+    output->vmesh()->get_center(p, idx);
+    centroid += Vector(p) / 4.0;
+  }
+  EXPECT_NEAR(5.25, centroid.x(), 1e-10);
+  EXPECT_NEAR(5.25, centroid.y(), 1e-10);
+  EXPECT_NEAR(5.25, centroid.z(), 1e-10);
+}
+
+class FairMeshSweepTests : public testing::TestWithParam<std::string>
+{
+};
+
+TEST_P(FairMeshSweepTests, MatchesSerialSweeps)
+{
+  const std::string method = GetParam();
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, method);
+  algo.set(Parameters::NumIterations, 10);
+  const double lambda = algo.get(Parameters::Lambda).toDouble();
+  const double mu = 1.0 / (algo.get(Parameters::FilterCutoff).toDouble() - 1.0 / lambda);
+
+  FieldHandle input = noisySphere(20, 40);
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+
+  auto expected = serialFairMesh(input, method == "desbrun", 10, lambda, mu);
+  ASSERT_EQ(expected.size(), static_cast<size_t>(output->vmesh()->num_nodes()));
+  for (VMesh::Node::index_type idx = 0; idx < output->vmesh()->num_nodes(); ++idx)
+  {
+    Point p;
+    output->vmesh()->get_center(p, idx);
+    EXPECT_NEAR(expected[idx].x(), p.x(), 1e-12);
+    EXPECT_NEAR(expected[idx].y(), p.y(), 1e-12);
+    EXPECT_NEAR(expected[idx].z(), p.z(), 1e-12);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+  FairMeshSweepTestsParameterized,
+  FairMeshSweepTests,
+  testing::Values("fast", "desbrun")
+);
+
+TEST(FairMeshAlgoDesbrunTests, ReducesNoise)
+{
+  // The curvature flow only moves nodes along the normal, so on the
+  // stretched triangles near the poles it reduces the noise less than the
+  // equal weight filters do.
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, "desbrun");
+  algo.set(Parameters::NumIterations, 30);
+
+  FieldHandle input = noisySphere(40, 80);
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+
+  EXPECT_LT(radialDeviation(output), 0.8 * radialDeviation(input));
+  EXPECT_NEAR(1.0, meanRadius(output), 0.05);
+}
+
+TEST(FairMeshAlgoChebyshevTests, SingleIterationIsFirstDegreeFilter)
+{
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, "chebyshev");
+  algo.set(Parameters::NumIterations, 1);
+
+  FieldHandle input = noisySphere(20, 40);
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+  EXPECT_LT(radialDeviation(output), radialDeviation(input));
+}
+
+TEST(FairMeshAlgoDesbrunTests, NodesWithVanishingWeightsStayInPlace)
+{
+  // With lambda = 1 the first sweep moves every node of a right triangle
+  // onto the foot of its altitude, which collapses the two acute corners
+  // onto the right angle corner. All weights of the second (mu) sweep
+  // vanish, so no node may move again.
+  FairMeshAlgo algo;
+  algo.setOption(Parameters::FairMeshMethod, "desbrun");
+  algo.set(Parameters::NumIterations, 1);
+  algo.set(Parameters::Lambda, 1.0);
+
+  FieldInformation fi("TriSurfMesh", static_cast<int>(databasis_info_type::LINEARDATA_E), "double");
+  FieldHandle input = CreateField(fi);
+  VMesh* mesh = input->vmesh();
+  mesh->add_point(Point(0.0, 0.0, 0.0));
+  mesh->add_point(Point(1.0, 0.0, 0.0));
+  mesh->add_point(Point(0.0, 1.0, 0.0));
+  VMesh::Node::array_type tri(3);
+  tri[0] = 0; tri[1] = 1; tri[2] = 2; mesh->add_elem(tri);
+  input->vfield()->resize_values();
+
+  FieldHandle output;
+  ASSERT_TRUE(algo.runImpl(input, output));
+
+  const Point expected[3] = { Point(0.5, 0.5, 0.0), Point(0.0, 0.0, 0.0), Point(0.0, 0.0, 0.0) };
+  for (VMesh::Node::index_type idx = 0; idx < 3; ++idx)
+  {
+    Point p;
+    output->vmesh()->get_center(p, idx);
+    EXPECT_NEAR(expected[idx].x(), p.x(), 1e-12);
+    EXPECT_NEAR(expected[idx].y(), p.y(), 1e-12);
+    EXPECT_NEAR(expected[idx].z(), p.z(), 1e-12);
+  }
+}
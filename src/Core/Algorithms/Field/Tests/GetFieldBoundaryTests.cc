@@ -29,6 +29,7 @@
 #include <gtest/gtest.h>
 
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Matrix.h>
 #include <Core/Datatypes/MatrixIO.h>
@@ -36,10 +37,12 @@
 #include <Core/Algorithms/Legacy/Fields/MeshDerivatives/GetFieldBoundaryAlgo.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::TestUtils;
 
@@ -145,6 +148,122 @@ TEST(GetFieldBoundaryTest, LatVolBoundary)
   EXPECT_EQ("None (nodata basis)", info.dataLocation);*/
 }
 
+namespace
+{
+// 3x3x3 block of cells with the center and one corner cell left out, so the
+// boundary has an interior cavity as well as an outer skin. With
+// repeatedNodes every cube of a tet block also gets a flat tet with a
+// repeated node, added after the other tets, on the face that the first two
+// tets of the cube share.
+FieldHandle makeBlock(mesh_info_type meshType, databasis_info_type basis, bool repeatedNodes = false)
+{
+  const int n = 3;
+  auto skipCell = [](int i, int j, int k) { return (i == 1 && j == 1 && k == 1) || (i == 0 && j == 0 && k == 0); };
+  FieldHandle field = CreateCubeBlock(meshType, n, basis, {}, skipCell);
+  if (repeatedNodes)
+  {
+    auto node = [n](int i, int j, int k) { return static_cast<VMesh::index_type>(i + (n+1)*(j + (n+1)*k)); };
+    VMesh* mesh = field->vmesh();
+    VMesh::Node::array_type nodes(4);
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          if (skipCell(i, j, k))
+            continue;
+          nodes[0] = node(i,j,k);
+          nodes[1] = node(i+1,j,k);
+          nodes[2] = nodes[3] = node(i+1,j+1,k+1);
+          mesh->add_elem(nodes);
+        }
+    field->vfield()->resize_values();
+  }
+  for (VMesh::index_type i = 0; i < field->vfield()->num_values(); i++)
+    field->vfield()->set_value(static_cast<double>(i), i);
+  return field;
+}
+
+FieldHandle fieldBoundary(FieldHandle input, const std::string& method, MatrixHandle& mapping)
+{
+  GetFieldBoundaryAlgo algo;
+  algo.setOption(Parameters::BoundaryMethod, method);
+  FieldHandle boundary;
+  EXPECT_TRUE(algo.run(input, boundary, mapping));
+  EXPECT_TRUE(boundary != nullptr);
+  EXPECT_TRUE(mapping != nullptr);
+  return boundary;
+}
+
+void expectSameField(FieldHandle expectedField, FieldHandle actualField)
+{
+  ASSERT_TRUE(expectedField && actualField);
+  VMesh* expected = expectedField->vmesh();
+  VMesh* actual = actualField->vmesh();
+  ASSERT_EQ(expected->num_nodes(), actual->num_nodes());
+  ASSERT_EQ(expected->num_elems(), actual->num_elems());
+  for (VMesh::index_type i = 0; i < expected->num_nodes(); i++)
+  {
+    Point p, q;
+    expected->get_center(p, VMesh::Node::index_type(i));
+    actual->get_center(q, VMesh::Node::index_type(i));
+    EXPECT_EQ(p, q);
+  }
+  for (VMesh::index_type i = 0; i < expected->num_elems(); i++)
+  {
+    VMesh::Node::array_type a, b;
+    expected->get_nodes(a, VMesh::Elem::index_type(i));
+    actual->get_nodes(b, VMesh::Elem::index_type(i));
+    EXPECT_EQ(a, b);
+  }
+  ASSERT_EQ(expectedField->vfield()->num_values(), actualField->vfield()->num_values());
+  for (VMesh::index_type i = 0; i < expectedField->vfield()->num_values(); i++)
+  {
+    double a, b;
+    expectedField->vfield()->get_value(a, i);
+    actualField->vfield()->get_value(b, i);
+    EXPECT_EQ(a, b);
+  }
+}
+
+void expectSameBoundary(mesh_info_type meshType, databasis_info_type basis)
+{
+  FieldHandle input = makeBlock(meshType, basis);
+  MatrixHandle neighborsMapping, sortMapping;
+  FieldHandle neighbors = fieldBoundary(input, "neighbors", neighborsMapping);
+  FieldHandle sorted = fieldBoundary(input, "sort", sortMapping);
+  expectSameField(neighbors, sorted);
+  ASSERT_TRUE(neighborsMapping && sortMapping);
+  EXPECT_EQ(matrix_to_string(*convertMatrix::toDense(neighborsMapping)),
+    matrix_to_string(*convertMatrix::toDense(sortMapping)));
+}
+}
+
+TEST(GetFieldBoundaryTest, SortedFacesMatchNeighborSearchOnTetVol)
+{
+  expectSameBoundary(mesh_info_type::TETVOLMESH_E, databasis_info_type::CONSTANTDATA_E);
+  expectSameBoundary(mesh_info_type::TETVOLMESH_E, databasis_info_type::LINEARDATA_E);
+}
+
+TEST(GetFieldBoundaryTest, SortedFacesMatchNeighborSearchOnHexVol)
+{
+  expectSameBoundary(mesh_info_type::HEXVOLMESH_E, databasis_info_type::CONSTANTDATA_E);
+  expectSameBoundary(mesh_info_type::HEXVOLMESH_E, databasis_info_type::LINEARDATA_E);
+}
+
+// The neighbor search cannot look up the faces of tets with repeated nodes.
+// The sort path leaves out their faces that are lines, their other faces are
+// interior here, so the boundary is the one of the block without them.
+TEST(GetFieldBoundaryTest, SortedFacesSkipLinesOfTetsWithRepeatedNodes)
+{
+  for (auto basis : { databasis_info_type::CONSTANTDATA_E, databasis_info_type::LINEARDATA_E })
+  {
+    MatrixHandle mapping;
+    FieldHandle expected = fieldBoundary(makeBlock(mesh_info_type::TETVOLMESH_E, basis), "neighbors", mapping);
+    FieldHandle actual = fieldBoundary(makeBlock(mesh_info_type::TETVOLMESH_E, basis, true), "sort", mapping);
+    expectSameField(expected, actual);
+  }
+}
+
 TEST(GetFieldBoundaryTest, CanLogErrorMessage)
 {
   GetFieldBoundaryAlgo algo;
@@ -0,0 +1,193 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/MarchingCubes.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  // Distance to the origin at the nodes, or at the cell centers for cell data
+  void setDistanceToOrigin(FieldHandle field)
+  {
+    auto vmesh = field->vmesh();
+    auto vfield = field->vfield();
+    vfield->resize_values();
+    Point p;
+    if (vfield->basis_order() == 0)
+    {
+      for (VMesh::Elem::index_type idx = 0; idx < vmesh->num_elems(); ++idx)
+      {
+        vmesh->get_center(p, idx);
+        vfield->set_value((p - Point(0, 0, 0)).length(), idx);
+      }
+    }
+    else
+    {
+      for (VMesh::Node::index_type idx = 0; idx < vmesh->num_nodes(); ++idx)
+      {
+        vmesh->get_center(p, idx);
+        vfield->set_value((p - Point(0, 0, 0)).length(), idx);
+      }
+    }
+  }
+
+  FieldHandle SphereLatVol(size_type size, databasis_info_type basis)
+  {
+    FieldInformation fi(mesh_info_type::LATVOLMESH_E, basis, data_info_type::DOUBLE_E);
+    auto field = CreateField(fi, CreateMesh(fi, size, size, size, Point(-1, -1, -1), Point(1, 1, 1)));
+    setDistanceToOrigin(field);
+    return field;
+  }
+
+  // Block of n^3 cubes over [-1,1]^3
+  FieldHandle SphereBlock(mesh_info_type mesh, int n, databasis_info_type basis)
+  {
+    auto position = [n](int i, int j, int k) { return Point(2.0*i/n - 1, 2.0*j/n - 1, 2.0*k/n - 1); };
+    auto field = CreateCubeBlock(mesh, n, basis, position);
+    setDistanceToOrigin(field);
+    return field;
+  }
+
+  void runMarchingCubes(FieldHandle input, int threads, FieldHandle& output, MatrixHandle& nodeInterp, MatrixHandle& elemInterp)
+  {
+    MarchingCubesAlgo algo;
+    algo.set(Parameters::build_field, true);
+    algo.set(Parameters::build_node_interpolant, true);
+    algo.set(Parameters::build_elem_interpolant, true);
+    algo.set(Parameters::num_threads, threads);
+    std::vector<double> isovalues { 0.5, 0.8 };
+    ASSERT_TRUE(algo.run(input, isovalues, output, nodeInterp, elemInterp));
+  }
+
+  void expectSameMatrix(MatrixHandle expected, MatrixHandle actual)
+  {
+    ASSERT_EQ(expected->nrows(), actual->nrows());
+    ASSERT_EQ(expected->ncols(), actual->ncols());
+    if (expected->nrows() > 0)
+      EXPECT_TRUE(castMatrix::toSparse(expected)->isApprox(*castMatrix::toSparse(actual)));
+  }
+
+  // The inputs have at least 4*4096 elements, so four threads are used
+  // whatever the number of cores and the stitching is exercised.
+  void expectThreadedExtractionMatchesSerial(FieldHandle input)
+  {
+    ASSERT_GE(input->vmesh()->num_elems(), 4*4096);
+
+    FieldHandle serial, threaded;
+    MatrixHandle serialNodes, serialElems, threadedNodes, threadedElems;
+    runMarchingCubes(input, 1, serial, serialNodes, serialElems);
+    runMarchingCubes(input, 4, threaded, threadedNodes, threadedElems);
+
+    auto smesh = serial->vmesh();
+    auto tmesh = threaded->vmesh();
+    ASSERT_GT(smesh->num_elems(), 0);
+    ASSERT_EQ(smesh->num_nodes(), tmesh->num_nodes());
+    ASSERT_EQ(smesh->num_elems(), tmesh->num_elems());
+
+    Point ps, pt;
+    for (VMesh::Node::index_type idx = 0; idx < smesh->num_nodes(); ++idx)
+    {
+      smesh->get_point(ps, idx);
+      tmesh->get_point(pt, idx);
+      EXPECT_EQ(ps, pt);
+    }
+
+    VMesh::Node::array_type ns, nt;
+    for (VMesh::Elem::index_type idx = 0; idx < smesh->num_elems(); ++idx)
+    {
+      smesh->get_nodes(ns, idx);
+      tmesh->get_nodes(nt, idx);
+      EXPECT_EQ(ns, nt);
+    }
+
+    ASSERT_TRUE(serialNodes != nullptr);
+    ASSERT_TRUE(threadedNodes != nullptr);
+    ASSERT_TRUE(serialElems != nullptr);
+    ASSERT_TRUE(threadedElems != nullptr);
+    if (input->vfield()->basis_order() == 0)
+    {
+      // Cell data: every face interpolates the two cells it separates, and
+      // no parent cells are recorded
+      EXPECT_EQ(smesh->num_elems(), threadedNodes->nrows());
+      EXPECT_EQ(input->vmesh()->num_elems(), threadedNodes->ncols());
+      EXPECT_EQ(0, threadedElems->nrows());
+    }
+    else
+    {
+      EXPECT_EQ(smesh->num_nodes(), threadedNodes->nrows());
+      EXPECT_EQ(input->vmesh()->num_nodes(), threadedNodes->ncols());
+      EXPECT_EQ(smesh->num_elems(), threadedElems->nrows());
+    }
+    expectSameMatrix(serialNodes, threadedNodes);
+    expectSameMatrix(serialElems, threadedElems);
+  }
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerial)
+{
+  expectThreadedExtractionMatchesSerial(SphereLatVol(40, databasis_info_type::LINEARDATA_E));
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerialForCellData)
+{
+  expectThreadedExtractionMatchesSerial(SphereLatVol(40, databasis_info_type::CONSTANTDATA_E));
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerialOnTetVol)
+{
+  expectThreadedExtractionMatchesSerial(SphereBlock(mesh_info_type::TETVOLMESH_E, 16, databasis_info_type::LINEARDATA_E));
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerialOnTetVolCellData)
+{
+  expectThreadedExtractionMatchesSerial(SphereBlock(mesh_info_type::TETVOLMESH_E, 16, databasis_info_type::CONSTANTDATA_E));
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerialOnHexVol)
+{
+  expectThreadedExtractionMatchesSerial(SphereBlock(mesh_info_type::HEXVOLMESH_E, 26, databasis_info_type::LINEARDATA_E));
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedExtractionMatchesSerialOnHexVolCellData)
+{
+  expectThreadedExtractionMatchesSerial(SphereBlock(mesh_info_type::HEXVOLMESH_E, 26, databasis_info_type::CONSTANTDATA_E));
+}
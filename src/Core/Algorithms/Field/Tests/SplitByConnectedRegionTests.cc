@@ -421,3 +421,51 @@ TEST(SplitByConnectedRegionTest, DISABLED_SplitFieldByConnectedRegionAlgoTriTest
   EXPECT_EQ(result8->vmesh()->num_nodes(), 895);
 
 }
+
+TEST(SplitByConnectedRegionTest, SplitsTriangleIslandsInElementOrder)
+{
+  SplitFieldByConnectedRegionAlgo algo;
+  algo.set(Parameters::SortDomainBySize, false);
+
+  FieldInformation fi("TriSurfMesh", static_cast<int>(databasis_info_type::LINEARDATA_E), "double");
+  FieldHandle input = CreateField(fi);
+  VMesh* mesh = input->vmesh();
+  for (int i = 0; i < 10; ++i)
+    mesh->add_point(Point(i, i % 3, 0.0));
+
+  // node 9 is not used, the elements on nodes 0-2 form the second region
+  VMesh::Node::array_type tri(3);
+  tri[0] = 5; tri[1] = 6; tri[2] = 4; mesh->add_elem(tri);
+  tri[0] = 0; tri[1] = 1; tri[2] = 2; mesh->add_elem(tri);
+  tri[0] = 7; tri[1] = 8; tri[2] = 3; mesh->add_elem(tri);
+  tri[0] = 4; tri[1] = 3; tri[2] = 7; mesh->add_elem(tri);
+  tri[0] = 1; tri[1] = 2; tri[2] = 0; mesh->add_elem(tri);
+
+  input->vfield()->resize_values();
+  for (VMesh::index_type i = 0; i < 10; ++i)
+    input->vfield()->set_value(static_cast<double>(10 * i), i);
+
+  std::vector<FieldHandle> result = algo.run(input);
+
+  ASSERT_EQ(2, result.size());
+
+  // the first region is the one containing element 0, its nodes keep their order
+  VMesh* first = result[0]->vmesh();
+  EXPECT_EQ(6, first->num_nodes());
+  EXPECT_EQ(3, first->num_elems());
+  double value;
+  result[0]->vfield()->get_value(value, VMesh::index_type(0));
+  EXPECT_EQ(30.0, value);
+  result[0]->vfield()->get_value(value, VMesh::index_type(5));
+  EXPECT_EQ(80.0, value);
+
+  VMesh::Node::array_type nodes;
+  first->get_nodes(nodes, VMesh::Elem::index_type(0));
+  ASSERT_EQ(3, nodes.size());
+  EXPECT_EQ(2, nodes[0]);
+  EXPECT_EQ(3, nodes[1]);
+  EXPECT_EQ(1, nodes[2]);
+
+  EXPECT_EQ(3, result[1]->vmesh()->num_nodes());
+  EXPECT_EQ(2, result[1]->vmesh()->num_elems());
+}
@@ -36,6 +36,7 @@
 #include <Core/Algorithms/DataIO/ReadMatrix.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -73,6 +74,18 @@ namespace FEInputData
   {
     return nullptr;
   }
+
+  // Cube of n^3 hexes split into six tetrahedra each, with the data at the elements
+  FieldHandle tetCube(int n)
+  {
+    return CreateCubeBlock(mesh_info_type::TETVOLMESH_E, n, databasis_info_type::CONSTANTDATA_E, ShearedGridPoint);
+  }
+
+  SparseRowMatrixHandle buildMatrix(BuildFEMatrixAlgo& algo, FieldHandle field, DenseMatrixHandle ctable)
+  {
+    auto out = algo.run(withInputData((Variables::InputField, field)(BuildFEMatrixAlgo::Conductivity_Table, ctable)));
+    return out.get<SparseRowMatrix>(BuildFEMatrixAlgo::Stiffness_Matrix);
+  }
 }
 
 TEST(BuildFEMatrixAlgorithmTests, ThrowsForNullMesh)
@@ -214,3 +227,98 @@ TEST(BuildFEMatrixAlgorithmTests, DISABLED_TestMeshSize1e6)
 
   EXPECT_TRUE(compare_with_tolerance(*expectedOutput("1e6.mat"), *output));
 }
+
+TEST(BuildFEMatrixAlgorithmTests, GenerateBasisMatchesDirectAssemblyForNewConductivities)
+{
+  using namespace FEInputData;
+  auto field = tetCube(4);
+  auto vfield = field->vfield();
+  for (VMesh::Elem::index_type e = 0; e < field->vmesh()->num_elems(); e++)
+    vfield->set_value(1.0 + (e % 7)*0.5, e);
+
+  BuildFEMatrixAlgo planAlgo;
+  planAlgo.set(BuildFEMatrixAlgo::GenerateBasis, true);
+  BuildFEMatrixAlgo directAlgo;
+
+  auto expected = buildMatrix(directAlgo, field, nullptr);
+  auto actual = buildMatrix(planAlgo, field, nullptr);
+  ASSERT_THAT(expected, NotNull());
+  ASSERT_THAT(actual, NotNull());
+  EXPECT_EQ(expected->nonZeros(), actual->nonZeros());
+  EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+
+  // Same mesh, different conductivities: the assembly plan is reused
+  FieldInformation fi(field);
+  auto update = CreateField(fi, field->mesh());
+  update->vfield()->resize_values();
+  for (VMesh::Elem::index_type e = 0; e < field->vmesh()->num_elems(); e++)
+    update->vfield()->set_value(e % 3 == 0 ? 0.0 : 2.0 + (e % 5), e);
+
+  expected = buildMatrix(directAlgo, update, nullptr);
+  actual = buildMatrix(planAlgo, update, nullptr);
+  ASSERT_THAT(actual, NotNull());
+  EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+}
+
+TEST(BuildFEMatrixAlgorithmTests, GenerateBasisMatchesDirectAssemblyForConductivityTable)
+{
+  using namespace FEInputData;
+  auto field = tetCube(3);
+  auto vfield = field->vfield();
+  for (VMesh::Elem::index_type e = 0; e < field->vmesh()->num_elems(); e++)
+    vfield->set_value(static_cast<double>(e % 2), e);
+
+  DenseMatrixHandle table(new DenseMatrix(2, 6));
+  *table << 1.0, 0.1, 0.0, 2.0, 0.2, 3.0,
+            0.5, 0.0, 0.05, 0.5, 0.0, 1.5;
+
+  BuildFEMatrixAlgo planAlgo;
+  planAlgo.set(BuildFEMatrixAlgo::GenerateBasis, true);
+  planAlgo.set(BuildFEMatrixAlgo::ForceSymmetry, true);
+  BuildFEMatrixAlgo directAlgo;
+  directAlgo.set(BuildFEMatrixAlgo::ForceSymmetry, true);
+
+  for (int run = 0; run < 2; run++)
+  {
+    auto expected = buildMatrix(directAlgo, field, table);
+    auto actual = buildMatrix(planAlgo, field, table);
+    ASSERT_THAT(actual, NotNull());
+    EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+    (*table)(1, 0) = 4.0;
+  }
+
+  DenseMatrixHandle shortTable(new DenseMatrix(1, 1, 1.0));
+  EXPECT_THROW(buildMatrix(planAlgo, field, shortTable), AlgorithmProcessingException);
+}
+
+TEST(BuildFEMatrixAlgorithmTests, ElementColoringMatchesDirectAssembly)
+{
+  using namespace FEInputData;
+  FieldInformation lfi(mesh_info_type::LATVOLMESH_E, databasis_info_type::CONSTANTDATA_E, data_info_type::DOUBLE_E);
+  auto latvol = CreateField(lfi, CreateMesh(lfi, 6, 5, 4, Point(0, 0, 0), Point(2, 1, 1)));
+  latvol->vfield()->resize_values();
+
+  for (auto field : { tetCube(4), latvol })
+  {
+    for (VMesh::Elem::index_type e = 0; e < field->vmesh()->num_elems(); e++)
+      field->vfield()->set_value(e % 4 == 0 ? 0.0 : 1.0 + (e % 5), e);
+
+    BuildFEMatrixAlgo coloredAlgo;
+    coloredAlgo.set(BuildFEMatrixAlgo::ElementColoring, true);
+    BuildFEMatrixAlgo directAlgo;
+
+    auto expected = buildMatrix(directAlgo, field, nullptr);
+    auto actual = buildMatrix(coloredAlgo, field, nullptr);
+    ASSERT_THAT(actual, NotNull());
+    EXPECT_EQ(expected->nonZeros(), actual->nonZeros());
+    EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+
+    coloredAlgo.set(BuildFEMatrixAlgo::GenerateBasis, true);
+    for (int run = 0; run < 2; run++)
+    {
+      actual = buildMatrix(coloredAlgo, field, nullptr);
+      ASSERT_THAT(actual, NotNull());
+      EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+    }
+  }
+}
@@ -35,6 +35,7 @@
 #include <Core/Datatypes/Matrix.h>
 #include <Core/Datatypes/SparseRowMatrixFromMap.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Thread/Parallel.h>
 #include <unordered_map>
 
 #include <algorithm>
@@ -46,6 +47,7 @@ using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Thread;
 
 int tet_permute_table[15][4] = {
   { 0, 0, 0, 0 }, // 0x0
@@ -134,139 +136,215 @@ namespace detail
 
   typedef std::unordered_map<facetriple_t, VMesh::Node::index_type, facetriplehash> face_hash_type;
 
-}
-
-ALGORITHM_PARAMETER_DEF(Fields, LessThanIsoValue);
-ALGORITHM_PARAMETER_DEF(Fields, ScalarIsoValue);
+  edgepair_t make_edgepair(VField::index_type u0, VField::index_type u1, double d0)
+  {
+    edgepair_t np;
+    if (u0 < u1)  { np.first = u0; np.second = u1; np.dfirst = d0; }
+    else { np.first = u1; np.second = u0; np.dfirst = 1.0 - d0; }
+    return np;
+  }
 
-ClipMeshByIsovalueAlgo::ClipMeshByIsovalueAlgo()
-{
-  addParameter(Parameters::LessThanIsoValue, 1);
-  addParameter(Parameters::ScalarIsoValue, 0.0);
-}
+  facetriple_t make_facetriple(VField::index_type u0, VField::index_type u1, VField::index_type u2, double d1, double d2)
+  {
+    facetriple_t nt;
+    if (u0 < u1)
+    {
+      if (u2 < u0)
+      {
+        nt.first = u2; nt.second = u0; nt.third = u1;
+        nt.dsecond = 1.0 - d1 - d2; nt.dthird = d1;
+      }
+      else if (u2 < u1)
+      {
+        nt.first = u0; nt.second = u2; nt.third = u1;
+        nt.dsecond = d2; nt.dthird = d1;
+      }
+      else
+      {
+        nt.first = u0; nt.second = u1; nt.third = u2;
+        nt.dsecond = d1; nt.dthird = d2;
+      }
+    }
+    else
+    {
+      if (u2 > u0)
+      {
+        nt.first = u1; nt.second = u0; nt.third = u2;
+        nt.dsecond = 1.0 - d1 - d2; nt.dthird = d2;
+      }
+      else if (u2 > u1)
+      {
+        nt.first = u1; nt.second = u2; nt.third = u0;
+        nt.dsecond = d2; nt.dthird = 1.0 - d1 - d2;
+      }
+      else
+      {
+        nt.first = u2; nt.second = u1; nt.third = u0;
+        nt.dsecond = d1; nt.dthird = 1.0 - d1 - d2;
+      }
+    }
+    return nt;
+  }
 
-class ClipMeshByIsovalueAlgoTet {
+  // Creates the nodes of the clipped mesh as soon as they are looked up.
+  class serial_sink
+  {
+    public:
+      explicit serial_sink(VMesh* clipped) : clipped_(clipped) {}
 
-  public:
-    bool run(const AlgorithmBase* algo,FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const;
+      VMesh::Node::index_type node(VField::index_type n, const Point &p)
+      {
+        const node_hash_type::iterator loc = nodemap.find(n);
+        if (loc == nodemap.end())
+        {
+          const VMesh::Node::index_type nodeindex = clipped_->add_point(p);
+          nodemap[n] = nodeindex;
+          return nodeindex;
+        }
+        return loc->second;
+      }
 
-  private:
-    VMesh::Node::index_type
-    edge_lookup(VField::index_type u0, VField::index_type u1, double d0,
-          const Point &p, detail::edge_hash_type &edgemap,
-          VMesh *clipped) const;
+      VMesh::Node::index_type edge(VField::index_type u0, VField::index_type u1, double d0, const Point &p)
+      {
+        const edgepair_t np = make_edgepair(u0, u1, d0);
+        const edge_hash_type::iterator loc = edgemap.find(np);
+        if (loc == edgemap.end())
+        {
+          const VMesh::Node::index_type nodeindex = clipped_->add_point(p);
+          edgemap[np] = nodeindex;
+          return nodeindex;
+        }
+        return loc->second;
+      }
 
-    VMesh::Node::index_type
-    face_lookup(VField::index_type u0, VField::index_type u1, VField::index_type u2,
-          double d1, double d2,
-          const Point &p, detail::face_hash_type &facemap,
-          VMesh *clipped) const;
+      VMesh::Node::index_type face(VField::index_type u0, VField::index_type u1, VField::index_type u2,
+                                   double d1, double d2, const Point &p)
+      {
+        const facetriple_t nt = make_facetriple(u0, u1, u2, d1, d2);
+        const face_hash_type::iterator loc = facemap.find(nt);
+        if (loc == facemap.end())
+        {
+          const VMesh::Node::index_type nodeindex = clipped_->add_point(p);
+          facemap[nt] = nodeindex;
+          return nodeindex;
+        }
+        return loc->second;
+      }
 
- };
+      void elem(const VMesh::Node::array_type &nodes)
+      {
+        clipped_->add_elem(nodes);
+      }
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTet::edge_lookup(VField::index_type u0, VField::index_type u1, double d0, const Point &p, detail::edge_hash_type &edgemap, VMesh *clipped) const
-{
-  using namespace detail;
-  edgepair_t np;
-  if (u0 < u1)  { np.first = u0; np.second = u1; np.dfirst = d0; }
-  else { np.first = u1; np.second = u0; np.dfirst = 1.0 - d0; }
+      node_hash_type nodemap;
+      edge_hash_type edgemap;
+      face_hash_type facemap;
 
-  auto loc = edgemap.find(np);
+    private:
+      VMesh* clipped_;
+  };
 
-  if (loc == edgemap.end())
-  {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    edgemap[np] = nodeindex;
-    return nodeindex;
-  }
-  else
+  // A node of the clipped mesh before it is numbered: an original node, a
+  // point on an edge or a point inside a face of the input mesh.
+  struct clipref_t
   {
-   return loc->second;
-  }
-}
+    enum { NODE, EDGE, FACE };
+    int kind;
+    VField::index_type first, second, third;
+    Point point;
+  };
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTet::face_lookup(VField::index_type u0, VField::index_type u1, VField::index_type u2, double d1, double d2, const Point &p, detail::face_hash_type &facemap, VMesh *clipped) const
-{
-  using namespace detail;
-  facetriple_t nt;
-  if (u0 < u1)
+  bool operator==(const clipref_t &a, const clipref_t &b)
   {
-    if (u2 < u0)
-    {
-      nt.first = u2; nt.second = u0; nt.third = u1;
-      nt.dsecond = 1.0 - d1 - d2; nt.dthird = d1;
-    }
-    else if (u2 < u1)
-    {
-      nt.first = u0; nt.second = u2; nt.third = u1;
-      nt.dsecond = d2; nt.dthird = d1;
-    }
-    else
-    {
-      nt.first = u0; nt.second = u1; nt.third = u2;
-      nt.dsecond = d1; nt.dthird = d2;
-    }
+    return a.kind == b.kind && a.first == b.first && a.second == b.second && a.third == b.third;
   }
-  else
+
+  struct cliprefhash
   {
-    if (u2 > u0)
-    {
-      nt.first = u1; nt.second = u0; nt.third = u2;
-      nt.dsecond = 1.0 - d1 - d2; nt.dthird = d2;
-    }
-    else if (u2 > u1)
-    {
-      nt.first = u1; nt.second = u2; nt.third = u0;
-      nt.dsecond = d2; nt.dthird = 1.0 - d1 - d2;
-    }
-    else
+    size_t operator()(const clipref_t &a) const
     {
-      nt.first = u2; nt.second = u1; nt.third = u0;
-      nt.dsecond = d1; nt.dthird = 1.0 - d1 - d2;
+      size_t h = static_cast<size_t>(a.first);
+      h = h * 1000003 ^ static_cast<size_t>(a.second);
+      h = h * 1000003 ^ static_cast<size_t>(a.third);
+      return h * 31 + a.kind;
     }
-  }
-  const face_hash_type::iterator loc = facemap.find(nt);
-  if (loc == facemap.end())
+  };
+
+  typedef std::unordered_map<clipref_t, VMesh::index_type, cliprefhash> ref_hash_type;
+
+  // Clipped elements of one consecutive range of input elements. The nodes
+  // are unique within the range and stored in the order in which the serial
+  // algorithm looks them up first. They are sorted into shards for the
+  // deduplication across ranges.
+  struct clipchunk_t
   {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    facemap[nt] = nodeindex;
-    return nodeindex;
-  }
-  else
+    std::vector<clipref_t> refs;
+    std::vector<VMesh::index_type> elems;
+    std::vector<std::vector<VMesh::index_type> > shards;
+  };
+
+  // Collects the nodes of one range of elements without touching the
+  // output mesh, so the ranges can be clipped concurrently.
+  class chunk_sink
   {
-    return (*loc).second;
-  }
-}
+    public:
+      chunk_sink(clipchunk_t& chunk, size_t num_shards) : chunk_(chunk)
+      {
+        chunk_.shards.resize(num_shards);
+      }
 
-bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle &/*mapping*/) const
-{
-  VField* field = input->vfield();
-  VMesh*  mesh  = input->vmesh();
-  VMesh*  clipped = output->vmesh();
+      VMesh::Node::index_type node(VField::index_type n, const Point &p)
+      {
+        return add(clipref_t::NODE, n, 0, 0, p);
+      }
 
-  using namespace detail;
-  node_hash_type nodemap;
-  edge_hash_type edgemap;
-  face_hash_type facemap;
+      VMesh::Node::index_type edge(VField::index_type u0, VField::index_type u1, double d0, const Point &p)
+      {
+        const edgepair_t np = make_edgepair(u0, u1, d0);
+        return add(clipref_t::EDGE, np.first, np.second, 0, p);
+      }
 
-  VMesh::Node::array_type onodes(4);
-  std::vector<double> v(4);
-  std::vector<Point> p(4);
+      VMesh::Node::index_type face(VField::index_type u0, VField::index_type u1, VField::index_type u2,
+                                   double d1, double d2, const Point &p)
+      {
+        const facetriple_t nt = make_facetriple(u0, u1, u2, d1, d2);
+        return add(clipref_t::FACE, nt.first, nt.second, nt.third, p);
+      }
 
-  double isoval = algo->get(Parameters::ScalarIsoValue).toDouble();
+      void elem(const VMesh::Node::array_type &nodes)
+      {
+        for (size_t i = 0; i < nodes.size(); i++)
+          chunk_.elems.push_back(static_cast<VMesh::index_type>(nodes[i]));
+      }
 
-  bool lte = !algo->get(Parameters::LessThanIsoValue).toBool();
+    private:
+      VMesh::Node::index_type add(int kind, VField::index_type first, VField::index_type second,
+                                  VField::index_type third, const Point &p)
+      {
+        clipref_t ref;
+        ref.kind = kind;
+        ref.first = first; ref.second = second; ref.third = third;
+        ref.point = p;
+        const VMesh::index_type local = static_cast<VMesh::index_type>(chunk_.refs.size());
+        const std::pair<ref_hash_type::iterator, bool> loc = refmap_.emplace(ref, local);
+        if (!loc.second) return VMesh::Node::index_type(loc.first->second);
+
+        chunk_.shards[cliprefhash()(ref) % chunk_.shards.size()].push_back(local);
+        chunk_.refs.push_back(ref);
+        return VMesh::Node::index_type(local);
+      }
 
-  VMesh::size_type num_elems = mesh->num_elems();
+      clipchunk_t& chunk_;
+      ref_hash_type refmap_;
+  };
 
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  // Clips one tetrahedron, handing every new node and element to the sink.
+  template <class SINK>
+  void clip_tet(const VMesh::Node::array_type& onodes, const std::vector<double>& v,
+                const std::vector<Point>& p, double isoval, bool lte, SINK& sink)
   {
-    mesh->get_nodes(onodes, idx);
-
       // Get the values and compute an inside/outside mask.
     VField::index_type inside = 0;
-    mesh->get_centers(p, onodes);
-    field->get_values(v,onodes);
     for (size_t i = 0; i < onodes.size(); i++)
     {
       inside = inside << 1;
@@ -274,7 +352,6 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       {
         inside |= 1;
       }
-
     }
 
       // Invert the mask if we are doing less than.
@@ -290,19 +367,10 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       VMesh::Node::array_type nnodes(onodes.size());
       for (size_t i = 0; i<onodes.size(); i++)
       {
-        if (nodemap.find((VField::index_type)onodes[i]) == nodemap.end())
-        {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[i]);
-          nodemap[(VField::index_type)onodes[i]] = nodeindex;
-          nnodes[i] = nodeindex;
-        }
-        else
-        {
-          nnodes[i] = nodemap[(VField::index_type)onodes[i]];
-        }
+        nnodes[i] = sink.node((VField::index_type)onodes[i], p[i]);
       }
 
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
     }
     else if (inside == 0x8 || inside == 0x4 || inside == 0x2 || inside == 0x1)
     {
@@ -310,16 +378,7 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       const int *perm = tet_permute_table[inside];
       VMesh::Node::array_type nnodes(4);
 
-      if (nodemap.find((VField::index_type)onodes[perm[0]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[0]]);
-        nodemap[(VField::index_type)onodes[perm[0]]] = nodeindex;
-        nnodes[0] = nodeindex;
-      }
-      else
-      {
-        nnodes[0] = nodemap[(VField::index_type)onodes[perm[0]]];
-      }
+      nnodes[0] = sink.node((VField::index_type)onodes[perm[0]], p[perm[0]]);
 
       const double imv = isoval - v[perm[0]];
       const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
@@ -329,20 +388,14 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
       const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
 
+      nnodes[1] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (VField::index_type)onodes[perm[1]], dl1, l1);
+      nnodes[2] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (VField::index_type)onodes[perm[2]], dl2, l2);
+      nnodes[3] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (VField::index_type)onodes[perm[3]], dl3, l3);
 
-      nnodes[1] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[1]],
-                              dl1, l1, edgemap, clipped);
-
-      nnodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[2]],
-                              dl2, l2, edgemap, clipped);
-
-      nnodes[3] = edge_lookup((VField::index_type)onodes[perm[0]],
-                              (VField::index_type)onodes[perm[3]],
-                              dl3, l3, edgemap, clipped);
-
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
     }
     else if (inside == 0x7 || inside == 0xb || inside == 0xd || inside == 0xe)
     {
@@ -354,16 +407,7 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       VMesh::Node::index_type inodes[9];
       for (size_t i = 1; i < 4; i++)
       {
-        if (nodemap.find((VField::index_type)onodes[perm[i]]) == nodemap.end())
-        {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[i]]);
-          nodemap[(VField::index_type)onodes[perm[i]]] = nodeindex;
-          inodes[i-1] = nodeindex;
-        }
-        else
-        {
-          inodes[i-1] = nodemap[(VField::index_type)onodes[perm[i]]];
-        }
+        inodes[i-1] = sink.node((VField::index_type)onodes[perm[i]], p[perm[i]]);
       }
 
       const double imv = isoval - v[perm[0]];
@@ -374,80 +418,71 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       const double dl3 = imv / (v[perm[3]] - v[perm[0]]);
       const Point l3 = Interpolate(p[perm[0]], p[perm[3]], dl3);
 
-
-      inodes[3] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[1]],
-                              dl1, l1, edgemap, clipped);
-
-      inodes[4] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              dl2, l2, edgemap, clipped);
-
-      inodes[5] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              dl3, l3, edgemap, clipped);
+      inodes[3] = sink.edge((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[1]], dl1, l1);
+      inodes[4] = sink.edge((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[2]], dl2, l2);
+      inodes[5] = sink.edge((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[3]], dl3, l3);
 
       const Point c1 = Interpolate(l1, l2, 0.5);
       const Point c2 = Interpolate(l2, l3, 0.5);
       const Point c3 = Interpolate(l3, l1, 0.5);
 
-      inodes[6] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              dl1*0.5, dl2*0.5,
-                              c1, facemap, clipped);
-      inodes[7] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl2*0.5, dl3*0.5,
-                              c2, facemap, clipped);
-      inodes[8] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              (index_type)onodes[perm[1]],
-                              dl3*0.5, dl1*0.5,
-                              c3, facemap, clipped);
+      inodes[6] = sink.face((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[1]],
+                            (index_type)onodes[perm[2]],
+                            dl1*0.5, dl2*0.5, c1);
+      inodes[7] = sink.face((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[2]],
+                            (index_type)onodes[perm[3]],
+                            dl2*0.5, dl3*0.5, c2);
+      inodes[8] = sink.face((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[3]],
+                            (index_type)onodes[perm[1]],
+                            dl3*0.5, dl1*0.5, c3);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[3];
       nnodes[2] = inodes[8];
       nnodes[3] = inodes[6];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[1];
       nnodes[1] = inodes[4];
       nnodes[2] = inodes[6];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[2];
       nnodes[1] = inodes[5];
       nnodes[2] = inodes[7];
       nnodes[3] = inodes[8];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[6];
       nnodes[2] = inodes[8];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[8];
       nnodes[2] = inodes[2];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[6];
       nnodes[2] = inodes[7];
       nnodes[3] = inodes[1];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[1];
       nnodes[2] = inodes[7];
       nnodes[3] = inodes[2];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
     }
     else// if (inside == 0x3 || inside == 0x5 || inside == 0x6 ||
           //     inside == 0x9 || inside == 0xa || inside == 0xc)
@@ -460,16 +495,7 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       VMesh::Node::index_type inodes[8];
       for (size_t i = 2; i < 4; i++)
       {
-        if (nodemap.find((VField::index_type)onodes[perm[i]]) == nodemap.end())
-        {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[i]]);
-          nodemap[(VField::index_type)onodes[perm[i]]] = nodeindex;
-          inodes[i-2] = nodeindex;
-        }
-        else
-        {
-          inodes[i-2] = nodemap[(VField::index_type)onodes[perm[i]]];
-        }
+        inodes[i-2] = sink.node((VField::index_type)onodes[perm[i]], p[perm[i]]);
       }
       const double imv0 = isoval - v[perm[0]];
       const double dl02 = imv0 / (v[perm[2]] - v[perm[0]]);
@@ -483,68 +509,341 @@ bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input
       const double dl13 = imv1 / (v[perm[3]] - v[perm[1]]);
       const Point l13 = Interpolate(p[perm[1]], p[perm[3]], dl13);
 
-
-      inodes[2] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              dl02, l02, edgemap, clipped);
-      inodes[3] = edge_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[3]],
-                              dl03, l03, edgemap, clipped);
-      inodes[4] = edge_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              dl12, l12, edgemap, clipped);
-      inodes[5] = edge_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[3]],
-                              dl13, l13, edgemap, clipped);
+      inodes[2] = sink.edge((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[2]], dl02, l02);
+      inodes[3] = sink.edge((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[3]], dl03, l03);
+      inodes[4] = sink.edge((index_type)onodes[perm[1]],
+                            (index_type)onodes[perm[2]], dl12, l12);
+      inodes[5] = sink.edge((index_type)onodes[perm[1]],
+                            (index_type)onodes[perm[3]], dl13, l13);
 
       const Point c1 = Interpolate(l02, l03, 0.5);
       const Point c2 = Interpolate(l12, l13, 0.5);
 
-      inodes[6] = face_lookup((index_type)onodes[perm[0]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl02*0.5,
-                              dl03*0.5,
-                              c1, facemap, clipped);
-      inodes[7] = face_lookup((index_type)onodes[perm[1]],
-                              (index_type)onodes[perm[2]],
-                              (index_type)onodes[perm[3]],
-                              dl12*0.5,
-                              dl13*0.5,
-                              c2, facemap, clipped);
+      inodes[6] = sink.face((index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[2]],
+                            (index_type)onodes[perm[3]],
+                            dl02*0.5, dl03*0.5, c1);
+      inodes[7] = sink.face((index_type)onodes[perm[1]],
+                            (index_type)onodes[perm[2]],
+                            (index_type)onodes[perm[3]],
+                            dl12*0.5, dl13*0.5, c2);
 
       nnodes[0] = inodes[7];
       nnodes[1] = inodes[2];
       nnodes[2] = inodes[0];
       nnodes[3] = inodes[4];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[1];
       nnodes[1] = inodes[5];
       nnodes[2] = inodes[3];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[1];
       nnodes[1] = inodes[3];
       nnodes[2] = inodes[6];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[7];
       nnodes[2] = inodes[6];
       nnodes[3] = inodes[2];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
 
       nnodes[0] = inodes[0];
       nnodes[1] = inodes[1];
       nnodes[2] = inodes[6];
       nnodes[3] = inodes[7];
-      clipped->add_elem(nnodes);
+      sink.elem(nnodes);
+    }
+  }
+
+  // Clips one triangle, handing every new node and element to the sink.
+  template <class SINK>
+  void clip_tri(const VMesh::Node::array_type& onodes, const std::vector<double>& v,
+                const std::vector<Point>& p, double isoval, bool lte, SINK& sink)
+  {
+    // Get the values and compute an inside/outside mask.
+    VField::index_type inside = 0;
+    for (size_t i = 0; i < onodes.size(); i++)
+    {
+      inside = inside << 1;
+      if (v[i] > isoval)
+      {
+        inside |= 1;
+      }
+    }
+
+    // Invert the mask if we are doing less than.
+    if (lte) { inside = ~inside & 0x7; }
+
+    if (inside == 0)
+    {
+      // Discard outside elements.
+    }
+    else if (inside == 0x7)
+    {
+      // Add this element to the new mesh.
+      VMesh::Node::array_type nnodes(onodes.size());
+
+      for (size_t i = 0; i<onodes.size(); i++)
+      {
+        nnodes[i] = sink.node((VField::index_type)onodes[i], p[i]);
+      }
+
+      sink.elem(nnodes);
+    }
+    else if (inside == 0x1 || inside == 0x2 || inside == 0x4)
+    {
+      // Add the corner containing the inside point to the mesh.
+      const int *perm = tri_permute_table[inside];
+      VMesh::Node::array_type nnodes(onodes.size());
+      nnodes[0] = sink.node((VField::index_type)onodes[perm[0]], p[perm[0]]);
+
+      const double imv = isoval - v[perm[0]];
+
+      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+
+      nnodes[1] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[1]], dl1, l1);
+      nnodes[2] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (index_type)onodes[perm[2]], dl2, l2);
+
+      sink.elem(nnodes);
+    }
+    else
+    {
+      // Lop off the one point that is outside of the mesh, then add
+      // the remaining quad to the mesh by dicing it into two
+      // triangles.
+      const int *perm = tri_permute_table[inside];
+      VMesh::Node::array_type inodes(4);
+      inodes[0] = sink.node((VField::index_type)onodes[perm[1]], p[perm[1]]);
+      inodes[1] = sink.node((VField::index_type)onodes[perm[2]], p[perm[2]]);
+
+      const double imv = isoval - v[perm[0]];
+      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
+      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
+      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
+      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
+
+      inodes[2] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (VField::index_type)onodes[perm[1]], dl1, l1);
+      inodes[3] = sink.edge((VField::index_type)onodes[perm[0]],
+                            (VField::index_type)onodes[perm[2]], dl2, l2);
+
+      VMesh::Node::array_type nnodes(onodes.size());
+
+      nnodes[0] = inodes[0];
+      nnodes[1] = inodes[1];
+      nnodes[2] = inodes[3];
+      sink.elem(nnodes);
+
+      nnodes[0] = inodes[0];
+      nnodes[1] = inodes[3];
+      nnodes[2] = inodes[2];
+      sink.elem(nnodes);
     }
   }
 
+  // Multithreaded version of the element loop. The elements are clipped in
+  // independent ranges, then every output node is numbered by the position
+  // of its first lookup in the serial element order. Hence the nodes,
+  // elements and values come out identical to the ones of the serial loop.
+  template <class CLIPELEM>
+  void parallel_clip(VMesh* mesh, VField* field, VMesh* clipped, VField* ofield,
+                     double isoval, const CLIPELEM& clip_elem)
+  {
+    const size_t chunk_size = 4096;
+    const size_t num_shards = 64;
+
+    const size_t num_elems = static_cast<size_t>(mesh->num_elems());
+    const size_t num_chunks = (num_elems + chunk_size - 1) / chunk_size;
+    const size_t nodes_per_elem = static_cast<size_t>(mesh->num_nodes_per_elem());
+
+    // Clip each range of elements into its own list of node references.
+    std::vector<clipchunk_t> chunks(num_chunks);
+    Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+    {
+      VMesh::Node::array_type onodes(nodes_per_elem);
+      std::vector<double> v(nodes_per_elem);
+      std::vector<Point> p(nodes_per_elem);
+
+      for (size_t c = begin; c < end; c++)
+      {
+        chunk_sink sink(chunks[c], num_shards);
+        const size_t last = std::min(num_elems, (c+1)*chunk_size);
+        for (size_t idx = c*chunk_size; idx < last; idx++)
+        {
+          mesh->get_nodes(onodes, VMesh::Elem::index_type(idx));
+          mesh->get_centers(p, onodes);
+          field->get_values(v, onodes);
+          clip_elem(onodes, v, p, sink);
+        }
+      }
+    });
+
+    std::vector<VMesh::index_type> ref_offset(num_chunks+1, 0);
+    for (size_t c = 0; c < num_chunks; c++)
+      ref_offset[c+1] = ref_offset[c] + static_cast<VMesh::index_type>(chunks[c].refs.size());
+
+    // Find the first reference to every output node. Each shard walks the
+    // ranges in order, so the first hit is the lookup that creates the
+    // node in the serial loop.
+    std::vector<VMesh::index_type> first(ref_offset[num_chunks]);
+    Parallel::For(0, num_shards, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t s = begin; s < end; s++)
+      {
+        ref_hash_type firstmap;
+        for (size_t c = 0; c < num_chunks; c++)
+        {
+          const std::vector<VMesh::index_type>& shard = chunks[c].shards[s];
+          for (size_t k = 0; k < shard.size(); k++)
+          {
+            const VMesh::index_type seq = ref_offset[c] + shard[k];
+            first[seq] = firstmap.emplace(chunks[c].refs[shard[k]], seq).first->second;
+          }
+        }
+      }
+    });
+
+    // Number the output nodes in the order of their first reference.
+    std::vector<VMesh::index_type> node_offset(num_chunks+1, 0);
+    std::vector<VMesh::index_type> elem_offset(num_chunks+1, 0);
+    Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t c = begin; c < end; c++)
+      {
+        VMesh::index_type count = 0;
+        for (VMesh::index_type seq = ref_offset[c]; seq < ref_offset[c+1]; seq++)
+          if (first[seq] == seq) count++;
+        node_offset[c+1] = count;
+      }
+    });
+    for (size_t c = 0; c < num_chunks; c++)
+    {
+      node_offset[c+1] += node_offset[c];
+      elem_offset[c+1] = elem_offset[c] + static_cast<VMesh::index_type>(chunks[c].elems.size());
+    }
+
+    clipped->resize_nodes(node_offset[num_chunks]);
+    clipped->resize_elems(elem_offset[num_chunks] / nodes_per_elem);
+    ofield->resize_values();
+
+    Point* points = clipped->get_points_pointer();
+    VMesh::index_type* elems = clipped->get_elems_pointer();
+    std::vector<VMesh::index_type> nodeindex(ref_offset[num_chunks]);
+
+    // Put the new points in place, copy the data of the original nodes and
+    // put the isovalue at the edge and face break points.
+    Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t c = begin; c < end; c++)
+      {
+        VMesh::index_type n = node_offset[c];
+        for (size_t k = 0; k < chunks[c].refs.size(); k++)
+        {
+          const VMesh::index_type seq = ref_offset[c] + static_cast<VMesh::index_type>(k);
+          if (first[seq] != seq) continue;
+
+          const clipref_t& ref = chunks[c].refs[k];
+          nodeindex[seq] = n;
+          points[n] = ref.point;
+          if (ref.kind == clipref_t::NODE) ofield->copy_value(field, ref.first, n);
+          else ofield->set_value(isoval, n);
+          n++;
+        }
+      }
+    });
+
+    Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t c = begin; c < end; c++)
+      {
+        const std::vector<VMesh::index_type>& celems = chunks[c].elems;
+        VMesh::index_type* out = elems + elem_offset[c];
+        for (size_t k = 0; k < celems.size(); k++)
+          out[k] = nodeindex[first[ref_offset[c] + celems[k]]];
+      }
+    });
+  }
+
+}
+
+ALGORITHM_PARAMETER_DEF(Fields, LessThanIsoValue);
+ALGORITHM_PARAMETER_DEF(Fields, ScalarIsoValue);
+ALGORITHM_PARAMETER_DEF(Fields, MultithreadedClip);
+
+ClipMeshByIsovalueAlgo::ClipMeshByIsovalueAlgo()
+{
+  addParameter(Parameters::LessThanIsoValue, 1);
+  addParameter(Parameters::ScalarIsoValue, 0.0);
+  // Clip in parallel ranges of elements, the output is identical to the one
+  // of the serial loop. Tet and hex meshes stay serial on a single core,
+  // where the extra passes only cost time, so this is on by default.
+  addParameter(Parameters::MultithreadedClip, true);
+}
+
+class ClipMeshByIsovalueAlgoTet {
+
+  public:
+    bool run(const AlgorithmBase* algo,FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const;
+ };
+
+bool ClipMeshByIsovalueAlgoTet::run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle &/*mapping*/) const
+{
+  VField* field = input->vfield();
+  VMesh*  mesh  = input->vmesh();
+  VMesh*  clipped = output->vmesh();
+
+  using namespace detail;
+
+  double isoval = algo->get(Parameters::ScalarIsoValue).toDouble();
+
+  bool lte = !algo->get(Parameters::LessThanIsoValue).toBool();
+
+  if (algo->get(Parameters::MultithreadedClip).toBool() && Parallel::NumCores() > 1)
+  {
+    parallel_clip(mesh, field, clipped, output->vfield(), isoval,
+      [isoval, lte](const VMesh::Node::array_type& onodes, const std::vector<double>& v,
+                    const std::vector<Point>& p, chunk_sink& sink)
+      {
+        clip_tet(onodes, v, p, isoval, lte, sink);
+      });
+    CopyProperties(*input, *output);
+    return (true);
+  }
+
+  serial_sink sink(clipped);
+
+  VMesh::Node::array_type onodes(4);
+  std::vector<double> v(4);
+  std::vector<Point> p(4);
+
+  VMesh::size_type num_elems = mesh->num_elems();
+
+  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  {
+    mesh->get_nodes(onodes, idx);
+    mesh->get_centers(p, onodes);
+    field->get_values(v,onodes);
+
+    clip_tet(onodes, v, p, isoval, lte, sink);
+  }
+
+  node_hash_type& nodemap = sink.nodemap;
+  edge_hash_type& edgemap = sink.edgemap;
+  face_hash_type& facemap = sink.facemap;
+
+
   VField* ofield = output->vfield();
   ofield->resize_values();
   CopyProperties(*input, *output);
@@ -664,33 +963,8 @@ class ClipMeshByIsovalueAlgoTri
 {
   public:
     bool run(const AlgorithmBase* algo,FieldHandle input, FieldHandle& output, MatrixHandle& mapping) const;
-
-private:
-    VMesh::Node::index_type
-    edge_lookup(VField::index_type u0, VField::index_type u1, double d0,
-          const Point &p, detail::edge_hash_type &edgemap,
-          VMesh *clipped) const;
 };
 
-VMesh::Node::index_type ClipMeshByIsovalueAlgoTri::edge_lookup(VField::index_type u0, VField::index_type u1, double d0, const Point &p, detail::edge_hash_type &edgemap, VMesh *clipped) const
-{
-  using namespace detail;
-  edgepair_t np;
-  if (u0 < u1)  { np.first = u0; np.second = u1; np.dfirst = d0; }
-  else { np.first = u1; np.second = u0; np.dfirst = 1.0 - d0; }
-  const auto loc = edgemap.find(np);
-  if (loc == edgemap.end())
-  {
-    const VMesh::Node::index_type nodeindex = clipped->add_point(p);
-    edgemap[np] = nodeindex;
-    return nodeindex;
-  }
-  else
-  {
-    return loc->second;
-  }
-}
-
 bool ClipMeshByIsovalueAlgoTri::run(const AlgorithmBase* algo, FieldHandle input, FieldHandle& output, MatrixHandle &) const
 {
   VField* field = input->vfield();
@@ -699,155 +973,40 @@ bool ClipMeshByIsovalueAlgoTri::run(const AlgorithmBase* algo, FieldHandle input
 
   using namespace detail;
 
-  node_hash_type nodemap;
-  edge_hash_type edgemap;
+  double isoval = algo->get(Parameters::ScalarIsoValue).toDouble();
+
+  bool lte = !algo->get(Parameters::LessThanIsoValue).toBool();
+
+  if (algo->get(Parameters::MultithreadedClip).toBool())
+  {
+    parallel_clip(mesh, field, clipped, output->vfield(), isoval,
+      [isoval, lte](const VMesh::Node::array_type& onodes, const std::vector<double>& v,
+                    const std::vector<Point>& p, chunk_sink& sink)
+      {
+        clip_tri(onodes, v, p, isoval, lte, sink);
+      });
+    return (true);
+  }
+
+  serial_sink sink(clipped);
 
   VMesh::Node::array_type onodes(3);
   std::vector<double> v(3);
   std::vector<Point>  p(3);
 
-  double isoval = algo->get(Parameters::ScalarIsoValue).toDouble();
-
-  bool lte = !algo->get(Parameters::LessThanIsoValue).toBool();
-
   VMesh::size_type num_elems = mesh->num_elems();
   for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
   {
     mesh->get_nodes(onodes, idx);
-
-    // Get the values and compute an inside/outside mask.
-    VField::index_type inside = 0;
     mesh->get_centers(p, onodes);
     field->get_values(v, onodes);
 
-    for (size_t i = 0; i < onodes.size(); i++)
-    {
-      inside = inside << 1;
-      if (v[i] > isoval)
-      {
-        inside |= 1;
-      }
-    }
-
-    // Invert the mask if we are doing less than.
-    if (lte) { inside = ~inside & 0x7; }
-
-    if (inside == 0)
-    {
-      // Discard outside elements.
-    }
-    else if (inside == 0x7)
-    {
-      // Add this element to the new mesh.
-      VMesh::Node::array_type nnodes(onodes.size());
-
-      for (size_t i = 0; i<onodes.size(); i++)
-      {
-        if (nodemap.find((VField::index_type)onodes[i]) == nodemap.end())
-        {
-          const VMesh::Node::index_type nodeindex = clipped->add_point(p[i]);
-          nodemap[(VField::index_type)onodes[i]] = nodeindex;
-          nnodes[i] = nodeindex;
-        }
-        else
-        {
-          nnodes[i] = nodemap[(VField::index_type)onodes[i]];
-        }
-      }
-
-      clipped->add_elem(nnodes);
-    }
-    else if (inside == 0x1 || inside == 0x2 || inside == 0x4)
-    {
-      // Add the corner containing the inside point to the mesh.
-      const int *perm = tri_permute_table[inside];
-      VMesh::Node::array_type nnodes(onodes.size());
-      if (nodemap.find((VField::index_type)onodes[perm[0]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex =
-            clipped->add_point(p[perm[0]]);
-        nodemap[(VField::index_type)onodes[perm[0]]] = nodeindex;
-        nnodes[0] = nodeindex;
-      }
-      else
-      {
-        nnodes[0] = nodemap[(VField::index_type)onodes[perm[0]]];
-      }
-
-      const double imv = isoval - v[perm[0]];
-
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
-
-
-      nnodes[1] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (index_type)onodes[perm[1]],
-			      dl1, l1, edgemap, clipped);
-
-      nnodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (index_type)onodes[perm[2]],
-			      dl2, l2, edgemap, clipped);
-
-      clipped->add_elem(nnodes);
-    }
-    else
-    {
-      // Lop off the one point that is outside of the mesh, then add
-      // the remaining quad to the mesh by dicing it into two
-      // triangles.
-      const int *perm = tri_permute_table[inside];
-      VMesh::Node::array_type inodes(4);
-      if (nodemap.find((index_type)onodes[perm[1]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[1]]);
-        nodemap[(VField::index_type)onodes[perm[1]]] = nodeindex;
-        inodes[0] = nodeindex;
-      }
-      else
-      {
-        inodes[0] = nodemap[(VField::index_type)onodes[perm[1]]];
-      }
-
-      if (nodemap.find((VField::index_type)onodes[perm[2]]) == nodemap.end())
-      {
-        const VMesh::Node::index_type nodeindex = clipped->add_point(p[perm[2]]);
-        nodemap[(VField::index_type)onodes[perm[2]]] = nodeindex;
-        inodes[1] = nodeindex;
-      }
-      else
-      {
-        inodes[1] = nodemap[(VField::index_type)onodes[perm[2]]];
-      }
-
-      const double imv = isoval - v[perm[0]];
-      const double dl1 = imv / (v[perm[1]] - v[perm[0]]);
-      const Point l1 = Interpolate(p[perm[0]], p[perm[1]], dl1);
-      const double dl2 = imv / (v[perm[2]] - v[perm[0]]);
-      const Point l2 = Interpolate(p[perm[0]], p[perm[2]], dl2);
-
-      inodes[2] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (VField::index_type)onodes[perm[1]],
-			      dl1, l1, edgemap, clipped);
-
-      inodes[3] = edge_lookup((VField::index_type)onodes[perm[0]],
-			      (VField::index_type)onodes[perm[2]],
-			      dl2, l2, edgemap, clipped);
-
-      VMesh::Node::array_type nnodes(onodes.size());
+    clip_tri(onodes, v, p, isoval, lte, sink);
+  }
 
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[1];
-      nnodes[2] = inodes[3];
-      clipped->add_elem(nnodes);
+  node_hash_type& nodemap = sink.nodemap;
+  edge_hash_type& edgemap = sink.edgemap;
 
-      nnodes[0] = inodes[0];
-      nnodes[1] = inodes[3];
-      nnodes[2] = inodes[2];
-      clipped->add_elem(nnodes);
-    }
-  }
 
   VField* ofield = output->vfield();
   ofield->resize_values();
@@ -1009,15 +1168,16 @@ bool ClipMeshByIsovalueAlgoHex::run(const AlgorithmBase* algo, FieldHandle input
 
   std::vector<VMesh::Elem::index_type> elemmap;
 
-  // Find all of the hexes inside the isosurface and add them to the
-  // clipped mesh.
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
-  {
-    bool inside = false;
+  // The marching cubes and the face walks above and below need the shared
+  // mesh and hash maps, so only the per element test and the projection of
+  // the boundary nodes run in parallel. Numbering stays in serial order.
+  const bool multithreaded =
+    algo->get(Parameters::MultithreadedClip).toBool() && Parallel::NumCores() > 1;
 
+  auto is_inside = [mesh, field, isoval, lte](VMesh::Elem::index_type idx)
+  {
     VMesh::Node::array_type onodes;
     mesh->get_nodes(onodes, idx);
-    inside = true;
 
     for (size_t i = 0; i < onodes.size(); i++)
     {
@@ -1026,21 +1186,32 @@ bool ClipMeshByIsovalueAlgoHex::run(const AlgorithmBase* algo, FieldHandle input
 
       if( lte )
       {
-        if( v > isoval )
-        {
-          inside = false;
-          break;
-        }
+        if( v > isoval ) return (false);
       }
       else
       {
-        if( v < isoval )
-        {
-          inside = false;
-          break;
-        }
+        if( v < isoval ) return (false);
       }
     }
+    return (true);
+  };
+
+  std::vector<char> inside_flags;
+  if (multithreaded)
+  {
+    inside_flags.resize(num_elems);
+    Parallel::For(0, num_elems, 4096, [&](size_t begin, size_t end)
+    {
+      for (size_t idx = begin; idx < end; idx++)
+        inside_flags[idx] = is_inside(VMesh::Elem::index_type(idx));
+    });
+  }
+
+  // Find all of the hexes inside the isosurface and add them to the
+  // clipped mesh.
+  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  {
+    const bool inside = multithreaded ? (inside_flags[idx] != 0) : is_inside(idx);
 
     if (inside)
     {
@@ -1158,10 +1329,8 @@ bool ClipMeshByIsovalueAlgoHex::run(const AlgorithmBase* algo, FieldHandle input
     tri_mesh->synchronize( Mesh::FIND_CLOSEST_ELEM_E );
   std::map<VMesh::Node::index_type, VMesh::Node::index_type> new_map;
 
-  int cnt = 0;
-  for(size_t i = 0; i < node_list.size(); i++ )
+  auto project = [clipped, tri_mesh](VMesh::Node::index_type this_node)
   {
-    VMesh::Node::index_type this_node = node_list[i];
     Point n_p;
     clipped->get_center( n_p, this_node );
 
@@ -1170,9 +1339,28 @@ bool ClipMeshByIsovalueAlgoHex::run(const AlgorithmBase* algo, FieldHandle input
     double dist;
 
     tri_mesh->find_closest_elem(dist, new_result, face_id, n_p );
+    return (new_result);
+  };
+
+  // The closest point queries only read the synchronized isosurface.
+  std::vector<Point> projected;
+  if (multithreaded)
+  {
+    projected.resize(node_list.size());
+    Parallel::For(0, node_list.size(), 256, [&](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; i++)
+        projected[i] = project(node_list[i]);
+    });
+  }
+
+  int cnt = 0;
+  for(size_t i = 0; i < node_list.size(); i++ )
+  {
+    VMesh::Node::index_type this_node = node_list[i];
 
     // Add the new node to the clipped mesh.
-    Point new_point( new_result );
+    Point new_point( multithreaded ? projected[i] : project(this_node) );
     VMesh::Node::index_type this_index = clipped->add_point( new_point );
 
     // Create a map for the new node to a node on the boundary of the
@@ -39,6 +39,7 @@ namespace SCIRun {
 
      ALGORITHM_PARAMETER_DECL(LessThanIsoValue);
      ALGORITHM_PARAMETER_DECL(ScalarIsoValue);
+     ALGORITHM_PARAMETER_DECL(MultithreadedClip);
 
 class SCISHARE ClipMeshByIsovalueAlgo : public AlgorithmBase
 {
@@ -32,6 +32,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/ElemBVH.h>
 #include <Core/Logging/Log.h>
 #include <Core/Thread/Parallel.h>
 
@@ -62,281 +63,114 @@ CalculateDistanceFieldAlgo::CalculateDistanceFieldAlgo()
 namespace detail
 {
 
+/// Computes the distance for blocks of field locations on all cores. The
+/// closest elements of curve and surface objects are found with a bounding
+/// volume hierarchy, other object meshes use their own search grid.
 class CalculateDistanceFieldP : public Interruptible
 {
   public:
     CalculateDistanceFieldP(VMesh* imesh, VMesh* objmesh, VField*  ofield, const AlgorithmBase* algo) :
-      imesh(imesh), objmesh(objmesh), objfield(nullptr), ofield(ofield), vfield(nullptr), algo_(algo) {}
+      imesh(imesh), objmesh(objmesh), objfield(nullptr), ofield(ofield), vfield(nullptr), algo_(algo) { prepare(); }
 
     CalculateDistanceFieldP(VMesh* imesh, VMesh* objmesh, VField* objfield, VField*  ofield, VField* vfield, const AlgorithmBase* algo) :
-      imesh(imesh), objmesh(objmesh), objfield(objfield), ofield(ofield), vfield(vfield), algo_(algo)  {}
+      imesh(imesh), objmesh(objmesh), objfield(objfield), ofield(ofield), vfield(vfield), algo_(algo)  { prepare(); }
 
-    void parallel(int proc, int nproc)
+    /// A negative maxdist searches without limit, locations without an
+    /// element within maxdist are set to maxdist.
+    void run(double maxdist)
     {
-      VMesh::size_type num_values = ofield->num_values();
-      VMesh::size_type num_evalues = ofield->num_evalues();
+      const size_t num = (ofield->basis_order() > 1) ?
+        static_cast<size_t>(ofield->num_evalues()) : static_cast<size_t>(ofield->num_values());
 
-      double max = DBL_MAX;
-      if (algo_->get(Parameters::Truncate).toBool())
+      // Progress is reported between blocks, so only this thread calls
+      // back into the algorithm.
+      const size_t block = 65536;
+      for (size_t bbegin = 0; bbegin < num; bbegin += block)
       {
-        max = algo_->get(Parameters::TruncateDistance).toDouble();
+        const size_t bend = std::min(num, bbegin + block);
+        Parallel::For(bbegin, bend, 256, [&](size_t begin, size_t end) { compute(begin, end, maxdist); });
+        algo_->update_progress_max(bend, num);
       }
+    }
 
-      double val = 0.0;
-      int cnt = 0;
-
-      if (ofield->basis_order() == 0)
-      {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
-
-        for (VMesh::Elem::index_type idx=start; idx<end; idx++)
-        {
-
-          Point p, p2;
-          imesh->get_center(p,idx);
-          if(!(objmesh->find_closest_elem(val,p2,fidx,p,max))) val = max;
-          ofield->set_value(val,idx);
-
-          if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-        }
-      }
-      else if (ofield->basis_order() == 1)
-      {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
-
-        for (VMesh::Node::index_type idx=start; idx<end; idx++)
-        {
-
-          Point p, p2;
-          imesh->get_center(p,idx);
-          if(!(objmesh->find_closest_elem(val,p2,fidx,p,max))) val = max;
-          ofield->set_value(val,idx);
-
-          if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-        }
-      }
-      else if (ofield->basis_order() > 1)
-      {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_evalues);
+  private:
+    void prepare()
+    {
+      if (ElemBVH::supports(objmesh))
+        bvh_.reset(new ElemBVH(objmesh));
+      else
+        objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
+    }
 
-        for (VMesh::ENode::index_type idx=start; idx<end; idx++)
-        {
+    void location(Point& p, VMesh::index_type idx) const
+    {
+      if (ofield->basis_order() == 0) imesh->get_center(p, VMesh::Elem::index_type(idx));
+      else if (ofield->basis_order() == 1) imesh->get_center(p, VMesh::Node::index_type(idx));
+      else imesh->get_center(p, VMesh::ENode::index_type(idx));
+    }
 
-          Point p, p2;
-          imesh->get_center(p,idx);
-          if(!(objmesh->find_closest_elem(val,p2,fidx,p,max))) val = max;
-          ofield->set_value(val,idx);
+    template <class T>
+    void set_value(VField* field, const T& val, VMesh::index_type idx) const
+    {
+      if (field->basis_order() > 1) field->set_evalue(val, idx);
+      else field->set_value(val, idx);
+    }
 
-          if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-        }
-      }
+    template <class T>
+    void set_closest_value(const VMesh::coords_type& coords, VMesh::Elem::index_type elem, VMesh::index_type idx) const
+    {
+      T val;
+      objfield->interpolate(val, coords, elem);
+      set_value(vfield, val, idx);
     }
 
-    void parallel2(int proc, int nproc)
+    void compute(size_t begin, size_t end, double maxdist) const
     {
-      VMesh::size_type num_values = ofield->num_values();
-      VMesh::size_type num_evalues = ofield->num_evalues();
+      const size_t num = end - begin;
+      std::vector<Point> points(num);
+      std::vector<ElemBVH::Hit> hits(num);
+      for (size_t j = 0; j < num; j++) location(points[j], static_cast<VMesh::index_type>(begin + j));
 
-      if (algo_->get(Parameters::Truncate).toBool())
+      if (bvh_)
       {
-        // Cannot do both at the same time
-        if (proc == 0) algo_->warning("Closest value has been requested, disabling truncated distance map.");
+        bvh_->find_closest_elems(points.data(), num, hits.data(), maxdist);
       }
-
-      double val = 0.0;
-      int cnt = 0;
-
-      if (ofield->basis_order() == 0)
+      else
       {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        VMesh::coords_type coords;
-        Point p, p2;
-        range(proc,nproc,start,end,num_values);
-
-        if (objfield->is_scalar())
-        {
-          double scalar;
-
-          for (VMesh::Elem::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(scalar,coords,fidx);
-            vfield->set_value(scalar,idx);
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_vector())
-        {
-          Vector vec;
-
-          for (VMesh::Elem::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(vec,coords,fidx);
-            vfield->set_value(vec,idx);
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_tensor())
+        for (size_t j = 0; j < num; j++)
         {
-          Tensor tensor;
-
-          for (VMesh::Elem::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(tensor,coords,fidx);
-            vfield->set_value(tensor,idx);
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
+          ElemBVH::Hit& hit = hits[j];
+          const bool found = (maxdist < 0.0) ?
+            objmesh->find_closest_elem(hit.distance, hit.point, hit.elem, points[j]) :
+            objmesh->find_closest_elem(hit.distance, hit.point, hit.elem, points[j], maxdist);
+          if (!found) hit.elem = -1;
         }
       }
-      else if (ofield->basis_order() == 1)
-      {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        VMesh::coords_type coords;
-        range(proc,nproc,start,end,num_values);
-        Point p, p2;
-
-        if (objfield->is_scalar())
-        {
-          double scalar;
-
-          for (VMesh::Node::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(scalar,coords,fidx);
-            vfield->set_value(scalar,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_vector())
-        {
-          Vector vec;
-
-          for (VMesh::Node::index_type idx=start; idx<end; idx++)
-          {
 
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(vec,coords,fidx);
-            vfield->set_value(vec,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_tensor())
-        {
-          Tensor tensor;
-
-          for (VMesh::Node::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(tensor,coords,fidx);
-            vfield->set_value(tensor,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-      }
-      else if (ofield->basis_order() > 1)
+      VMesh::coords_type coords;
+      for (size_t j = 0; j < num; j++)
       {
-        VMesh::Elem::index_type fidx;
-        VMesh::index_type start, end;
-        VMesh::coords_type coords;
-        range(proc,nproc,start,end,num_evalues);
-        Point p, p2;
+        const ElemBVH::Hit& hit = hits[j];
+        const VMesh::index_type idx = static_cast<VMesh::index_type>(begin + j);
+        set_value(ofield, (hit.elem >= 0) ? hit.distance : maxdist, idx);
 
-        if (objfield->is_scalar())
+        if (vfield && hit.elem >= 0)
         {
-          double scalar;
-          for (VMesh::ENode::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(scalar,coords,fidx);
-            vfield->set_value(scalar,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_vector())
-        {
-          Vector vec;
-          for (VMesh::ENode::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(vec,coords,fidx);
-            vfield->set_value(vec,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
-        }
-        else if (objfield->is_tensor())
-        {
-          Tensor tensor;
-          for (VMesh::ENode::index_type idx=start; idx<end; idx++)
-          {
-
-            imesh->get_center(p,idx);
-            objmesh->find_closest_elem(val,p2,coords,fidx,p);
-            ofield->set_value(val,idx);
-            objfield->interpolate(tensor,coords,fidx);
-            vfield->set_value(tensor,idx);
-
-            if (proc == 0) { cnt++; if (cnt == 100) { algo_->update_progress_max(idx,end); cnt = 0; } }
-          }
+          objmesh->get_coords(coords, hit.point, hit.elem);
+          if (objfield->is_scalar()) set_closest_value<double>(coords, hit.elem, idx);
+          else if (objfield->is_vector()) set_closest_value<Vector>(coords, hit.elem, idx);
+          else if (objfield->is_tensor()) set_closest_value<Tensor>(coords, hit.elem, idx);
         }
       }
     }
 
-
-    void range(int proc, int nproc,
-               VMesh::index_type& start, VMesh::index_type& end,
-               VMesh::size_type size)
-    {
-      VMesh::size_type m = size/nproc;
-      start = proc*m;
-      end = (proc+1)*m;
-      if (proc == nproc-1) end = size;
-    }
-
-  private:
     VMesh*   imesh;
     VMesh*   objmesh;
     VField*  objfield;
     VField*  ofield;
     VField*  vfield;
     const AlgorithmBase* algo_;
+    std::unique_ptr<ElemBVH> bvh_;
 };
 }
 
@@ -396,17 +230,20 @@ CalculateDistanceFieldAlgo::runImpl(FieldHandle input, FieldHandle object, Field
     return (true);
   }
 
-  objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
-
   if (ofield->basis_order() > 2)
   {
     error("Cannot add distance data to field");
     return (false);
   }
 
+  double max = -1.0;
+  if (get(Parameters::Truncate).toBool())
+  {
+    max = get(Parameters::TruncateDistance).toDouble();
+  }
+
   detail::CalculateDistanceFieldP palgo(imesh,objmesh,ofield,this);
-  auto task_i = [&palgo](int i) { palgo.parallel(i, Parallel::NumCores()); };
-  Parallel::RunTasks(task_i, Parallel::NumCores());
+  palgo.run(max);
 
   return (true);
 }
@@ -481,17 +318,20 @@ CalculateDistanceFieldAlgo::runImpl(FieldHandle input, FieldHandle object, Field
     return (true);
   }
 
-  objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
-
   if (distance->basis_order() > 2)
   {
     error("Cannot add distance data to field");
     return (false);
   }
 
+  if (get(Parameters::Truncate).toBool())
+  {
+    // Cannot do both at the same time
+    warning("Closest value has been requested, disabling truncated distance map.");
+  }
+
   detail::CalculateDistanceFieldP palgo(imesh,objmesh,objfield,dfield,vfield,this);
-  auto task_i = [&palgo](int i) { palgo.parallel2(i, Parallel::NumCores()); };
-  Parallel::RunTasks(task_i, Parallel::NumCores());
+  palgo.run(-1.0);
 
   return (true);
 }
@@ -31,6 +31,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/ElemBVH.h>
 #include <Core/Thread/Parallel.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 
@@ -42,618 +43,180 @@ using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 
+/// Computes the signed distance for blocks of field locations on all cores.
+/// The closest elements of the surface are found with a bounding volume
+/// hierarchy, the sign follows from the normal of the closest element.
 class CalculateSignedDistanceFieldP : public Interruptible
 {
   public:
     CalculateSignedDistanceFieldP(VMesh* imesh, VMesh* objmesh, VField*  ofield, const ProgressReporter* pr) :
-      imesh(imesh), objmesh(objmesh), ofield(ofield), pr_(pr) {}
+      imesh(imesh), objmesh(objmesh), objfield(nullptr), ofield(ofield), vfield(nullptr), pr_(pr) { prepare(); }
 
     CalculateSignedDistanceFieldP(VMesh* imesh, VMesh* objmesh, VField* objfield,
             VField* ofield, VField* vfield, const ProgressReporter* pr) :
-      imesh(imesh), objmesh(objmesh), objfield(objfield), ofield(ofield), vfield(vfield), pr_(pr) {}
+      imesh(imesh), objmesh(objmesh), objfield(objfield), ofield(ofield), vfield(vfield), pr_(pr) { prepare(); }
 
-    void parallel(int proc, int nproc)
+    void run()
     {
-      VMesh::size_type num_values = ofield->num_values();
-      VMesh::size_type num_evalues = ofield->num_evalues();
+      const size_t num = (ofield->basis_order() > 1) ?
+        static_cast<size_t>(ofield->num_evalues()) : static_cast<size_t>(ofield->num_values());
 
-      double val = 0.0;
-      double epsilon = objmesh->get_epsilon();
-      int cnt = 0;
-
-      if (ofield->basis_order() == 0)
+      // Progress is reported between blocks, so only this thread calls
+      // back into the algorithm.
+      const size_t block = 65536;
+      for (size_t bbegin = 0; bbegin < num; bbegin += block)
       {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
-
-        for (VMesh::Elem::index_type idx = start; idx < end; idx++)
-        {
-
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
-
-          objmesh->find_closest_elem(val,p2,fidx,p);
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
-
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2); k.normalize();
-
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
-          {
-            val = -val;
-          }
-          else if (angle > epsilon)
-          {
-          }
-          else
-          {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0) val = -(val);
-            }
-          }
-
-          ofield->set_value(val,idx);
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
-        }
+        const size_t bend = std::min(num, bbegin + block);
+        Parallel::For(bbegin, bend, 256, [this](size_t begin, size_t end) { compute(begin, end); });
+        pr_->update_progress_max(bend, num);
       }
-      else if (ofield->basis_order() == 1)
-      {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
-
-        for (VMesh::Node::index_type idx =start; idx <end; idx++)
-        {
-
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
-          objmesh->find_closest_elem(val,p2,fidx,p);
-
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2);
-          k.normalize();
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
-          {
-            val = -val;
-          }
-          else if (angle > epsilon)
-          {
-          }
-          else
-          {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0.0) val = -(val);
-            }
-          }
+    }
 
-          ofield->set_value(val,idx);
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
-        }
+  private:
+    void prepare()
+    {
+      epsilon_ = objmesh->get_epsilon();
+      if (ElemBVH::supports(objmesh))
+      {
+        objmesh->synchronize(Mesh::EDGES_E);
+        bvh_.reset(new ElemBVH(objmesh));
       }
-      else if (ofield->basis_order() > 1)
+      else
       {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_evalues);
-
-        for (VMesh::ENode::index_type idx=start; idx < end; idx++)
-        {
-
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
-          objmesh->find_closest_elem(val,p2,fidx,p);
-
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2);
-          k.normalize();
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
-          {
-            val = -val;
-          }
-          else if (angle > epsilon)
-          {
-          }
-          else
-          {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0.0) val = -(val);
-            }
-          }
-
-          ofield->set_evalue(val,idx);
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
-        }
+        objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E|Mesh::EDGES_E);
       }
     }
 
-    void parallel2(int proc, int nproc)
+    void location(Point& p, VMesh::index_type idx) const
     {
-      VMesh::size_type num_values = ofield->num_values();
-      VMesh::size_type num_evalues = ofield->num_evalues();
+      if (ofield->basis_order() == 0) imesh->get_center(p, VMesh::Elem::index_type(idx));
+      else if (ofield->basis_order() == 1) imesh->get_center(p, VMesh::Node::index_type(idx));
+      else imesh->get_center(p, VMesh::ENode::index_type(idx));
+    }
 
-      double val = 0.0;
-      double epsilon = objmesh->get_epsilon();
-      int cnt = 0;
+    template <class T>
+    void set_value(VField* field, const T& val, VMesh::index_type idx) const
+    {
+      if (field->basis_order() > 1) field->set_evalue(val, idx);
+      else field->set_value(val, idx);
+    }
 
-      if (ofield->basis_order() == 0)
-      {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-        VMesh::coords_type coords;
+    template <class T>
+    void set_closest_value(const VMesh::coords_type& coords, VMesh::Elem::index_type elem, VMesh::index_type idx) const
+    {
+      T val;
+      objfield->interpolate(val, coords, elem);
+      set_value(vfield, val, idx);
+    }
 
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
+    /// Distance val from p to the point p2 on element fidx, negated when p
+    /// is on the back side of the element.
+    double sign_distance(const Point& p, double val, Point p2, VMesh::Elem::index_type fidx) const
+    {
+      VMesh::Elem::index_type fidx_n;
+      VMesh::Node::array_type nodes;
+      VMesh::DElem::array_type delems;
+      Point n0, n1, n2, p1;
 
-        for (VMesh::Elem::index_type idx = start; idx < end; idx++)
-        {
+      objmesh->get_nodes(nodes,fidx);
+      objmesh->get_center(n0,nodes[0]);
+      objmesh->get_center(n1,nodes[1]);
+      objmesh->get_center(n2,nodes[2]);
 
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
+      Vector n = Cross(Vector(n1-n0),Vector(n2-n1));
+      Vector k = Vector(p-p2); k.normalize();
 
-          objmesh->find_closest_elem(val,p2,coords,fidx,p);
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
+      double angle = Dot(n,k);
+      if (angle < -epsilon_) return (-val);
+      if (angle > epsilon_) return (val);
 
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2); k.normalize();
+      // trouble
+      if (val != 0.0)
+      {
+        objmesh->get_delems(delems,fidx);
+        double mindist = DBL_MAX;
+        double dist;
+        int edgeidx = 0;
+        for (size_t r=0; r<delems.size();r++)
+        {
+          objmesh->get_nodes(nodes,delems[r]);
+          objmesh->get_center(p1,nodes[0]);
+          objmesh->get_center(p2,nodes[1]);
 
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
+          if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
           {
-            val = -val;
+            Vector v = Vector(p-p2);
+            dist  = Dot(v,v);
           }
-          else if (angle > epsilon)
+          else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
           {
+            Vector v = Vector(p-p1);
+            dist = Dot(v,v);
           }
           else
           {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0) val = -(val);
-            }
+            Vector v1 = Vector(p1-p2);
+            Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
+            dist = Dot(v,v);
           }
 
-          ofield->set_value(val,idx);
-          if (objfield->is_scalar())
-          {
-            double val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_vector())
-          {
-            Vector val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_tensor())
-          {
-            Tensor val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
+          if (dist < mindist) { mindist = dist; edgeidx = r;}
         }
+        objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
+        objmesh->get_nodes(nodes,fidx);
+        objmesh->get_center(n0,nodes[0]);
+        objmesh->get_center(n1,nodes[1]);
+        objmesh->get_center(n2,nodes[2]);
+        n = Cross(Vector(n1-n0),Vector(n2-n1));
+        k = Vector(p-p2);
+        k.normalize();
+        angle = Dot(n,k);
+        if (angle < 0.0) val = -(val);
       }
-      else if (ofield->basis_order() == 1)
-      {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-        VMesh::coords_type coords;
-
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_values);
-
-        for (VMesh::Node::index_type idx =start; idx <end; idx++)
-        {
+      return (val);
+    }
 
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
-          objmesh->find_closest_elem(val,p2,coords,fidx,p);
-
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2);
-          k.normalize();
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
-          {
-            val = -val;
-          }
-          else if (angle > epsilon)
-          {
-          }
-          else
-          {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 Point p1, p2;
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0.0) val = -(val);
-            }
-          }
+    void compute(size_t begin, size_t end) const
+    {
+      const size_t num = end - begin;
+      std::vector<Point> points(num);
+      std::vector<ElemBVH::Hit> hits(num);
+      for (size_t j = 0; j < num; j++) location(points[j], static_cast<VMesh::index_type>(begin + j));
 
-          ofield->set_value(val,idx);
-          if (objfield->is_scalar())
-          {
-            double val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_vector())
-          {
-            Vector val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_tensor())
-          {
-            Tensor val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
-        }
+      if (bvh_)
+      {
+        bvh_->find_closest_elems(points.data(), num, hits.data());
       }
-      else if (ofield->basis_order() > 1)
+      else
       {
-        VMesh::Elem::index_type fidx, fidx_n;
-        VMesh::Node::array_type nodes;
-        VMesh::DElem::array_type delems;
-        VMesh::coords_type coords;
+        for (size_t j = 0; j < num; j++)
+          objmesh->find_closest_elem(hits[j].distance, hits[j].point, hits[j].elem, points[j]);
+      }
 
-        Vector n, k;
-        Point n0,n1,n2;
-        VMesh::index_type start, end;
-        range(proc,nproc,start,end,num_evalues);
+      VMesh::coords_type coords;
+      for (size_t j = 0; j < num; j++)
+      {
+        const ElemBVH::Hit& hit = hits[j];
+        const VMesh::index_type idx = static_cast<VMesh::index_type>(begin + j);
+        set_value(ofield, sign_distance(points[j], hit.distance, hit.point, hit.elem), idx);
 
-        for (VMesh::ENode::index_type idx=start; idx < end; idx++)
+        if (vfield)
         {
-
-          Point p, p1, p2;
-          imesh->get_center(p,idx);
-          objmesh->find_closest_elem(val,p2,coords,fidx,p);
-
-          objmesh->get_nodes(nodes,fidx);
-          objmesh->get_center(n0,nodes[0]);
-          objmesh->get_center(n1,nodes[1]);
-          objmesh->get_center(n2,nodes[2]);
-          n = Cross(Vector(n1-n0),Vector(n2-n1));
-          k = Vector(p-p2);
-          k.normalize();
-          double angle = Dot(n,k);
-          if (angle < -epsilon)
-          {
-            val = -val;
-          }
-          else if (angle > epsilon)
-          {
-          }
-          else
-          {
-            // trouble
-            if (val != 0.0)
-            {
-               objmesh->get_delems(delems,fidx);
-               double mindist = DBL_MAX;
-               double dist;
-               int edgeidx = 0;
-               for (size_t r=0; r<delems.size();r++)
-               {
-                 objmesh->get_nodes(nodes,delems[r]);
-                 objmesh->get_center(p1,nodes[0]);
-                 objmesh->get_center(p2,nodes[1]);
-
-                if (Dot(Vector(p-p2),Vector(p2-p1)) >= 0.0)
-                {
-                  Vector v = Vector(p-p2);
-                  dist  = Dot(v,v);
-                }
-                else if (Dot(Vector(p-p1),Vector(p1-p2)) >= 0.0)
-                {
-                  Vector v = Vector(p-p1);
-                  dist = Dot(v,v);
-                }
-                else
-                {
-                  Vector v1 = Vector(p1-p2);
-                  Vector v = Vector(p-p2)-v1*(Dot(Vector(p-p2),v1)/Dot(v1,v1));
-                  dist = Dot(v,v);
-                }
-
-                if (dist < mindist) { mindist = dist; edgeidx = r;}
-              }
-              objmesh->get_neighbor(fidx_n,fidx,delems[edgeidx]);
-              objmesh->get_nodes(nodes,fidx);
-              objmesh->get_center(n0,nodes[0]);
-              objmesh->get_center(n1,nodes[1]);
-              objmesh->get_center(n2,nodes[2]);
-              n = Cross(Vector(n1-n0),Vector(n2-n1));
-              k = Vector(p-p2);
-              k.normalize();
-              angle = Dot(n,k);
-              if (angle < 0.0) val = -(val);
-            }
-          }
-
-          ofield->set_evalue(val,idx);
-          if (objfield->is_scalar())
-          {
-            double val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_vector())
-          {
-            Vector val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          else if (objfield->is_tensor())
-          {
-            Tensor val;
-            objfield->interpolate(val,coords,fidx);
-            vfield->set_value(val,idx);
-          }
-          if (proc == 0) { cnt++; if (cnt == 100) { pr_->update_progress_max(idx,end); cnt = 0; } }
+          objmesh->get_coords(coords, hit.point, hit.elem);
+          if (objfield->is_scalar()) set_closest_value<double>(coords, hit.elem, idx);
+          else if (objfield->is_vector()) set_closest_value<Vector>(coords, hit.elem, idx);
+          else if (objfield->is_tensor()) set_closest_value<Tensor>(coords, hit.elem, idx);
         }
       }
     }
 
-
-    void range(int proc, int nproc,
-               VMesh::index_type& start, VMesh::index_type& end,
-               VMesh::size_type size)
-    {
-      VMesh::size_type m = size/nproc;
-      start = proc*m;
-      end = (proc+1)*m;
-      if (proc == nproc-1) end = size;
-    }
-
-  private:
     VMesh*   imesh;
     VMesh*   objmesh;
     VField*  objfield;
     VField*  ofield;
     VField*  vfield;
+    double   epsilon_;
+    std::unique_ptr<ElemBVH> bvh_;
 
     const ProgressReporter* pr_;
 };
@@ -718,11 +281,8 @@ CalculateSignedDistanceFieldAlgo::run(FieldHandle input, FieldHandle object, Fie
     return (true);
   }
 
-  objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E|Mesh::EDGES_E);
   CalculateSignedDistanceFieldP palgo(imesh, objmesh, ofield, this);
-  const int numThreads = Parallel::NumCores();
-  auto task_i = [&palgo,numThreads](int i) { palgo.parallel(i, numThreads); };
-  Parallel::RunTasks(task_i, numThreads);
+  palgo.run();
 
   return (true);
 }
@@ -800,8 +360,6 @@ CalculateSignedDistanceFieldAlgo::run(FieldHandle input, FieldHandle object, Fie
     return (true);
   }
 
-  objmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E|Mesh::EDGES_E);
-
   if (distance->basis_order() > 2)
   {
     error("Cannot add distance data to field");
@@ -809,9 +367,7 @@ CalculateSignedDistanceFieldAlgo::run(FieldHandle input, FieldHandle object, Fie
   }
 
   CalculateSignedDistanceFieldP palgo(imesh, objmesh, objfield, dfield, vfield, this);
-
-  auto task_i = [&palgo](int i) { palgo.parallel2(i, Parallel::NumCores()); };
-  Parallel::RunTasks(task_i, Parallel::NumCores());
+  palgo.run();
 
   return (true);
 }
@@ -33,91 +33,64 @@ using namespace SCIRun::Core::Datatypes;
 
 MatrixHandle BaseMC::get_interpolant()
 {
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   if( !build_field_ ) return (0);
-
-    // The columns represent the source nodes while the rows
-    // represent the destination nodes
-    const size_type nrows = static_cast<size_type>(edge_map_.size());
-    const size_type ncols = nnodes_;
-
-    //  Yale Sparse Row Matrix format.
-    SparseRowMatrix::Data sparseData(nrows+1, nrows*2);
-    const SparseRowMatrix::Rows& rr = sparseData.rows();
-    const SparseRowMatrix::Columns& cc = sparseData.columns();
-    const SparseRowMatrix::Storage& dd = sparseData.data();
-
-    edge_hash_type::iterator eiter = edge_map_.begin();
-    while (eiter != edge_map_.end())
-    {
-      const SCIRun::index_type ei = (*eiter).second;
-
-      cc[ei * 2 + 0] = (*eiter).first.first;
-      cc[ei * 2 + 1] = (*eiter).first.second;
-      dd[ei * 2 + 0] = 1.0 - (*eiter).first.dfirst;
-      dd[ei * 2 + 1] = (*eiter).first.dfirst;
-
-      ++eiter;
-    }
-
-    size_type nnz = 0;
-    index_type i;
-    for (i = 0; i < nrows; i++)
-    {
-      rr[i] = nnz;
-      if (cc[i * 2 + 0] >= 0)
-      {
-        cc[nnz] = cc[i * 2 + 0];
-        dd[nnz] = dd[i * 2 + 0];
-        nnz++;
-      }
-      if (cc[i * 2 + 1] >= 0)
-      {
-        cc[nnz] = cc[i * 2 + 1];
-        dd[nnz] = dd[i * 2 + 1];
-        nnz++;
-      }
-    }
-
-    rr[i] = nnz;
-
-    return new SparseRowMatrix(nrows, ncols, sparseData, nnz);
-   #endif
-    return MatrixHandle();
+  if (!build_field_) return MatrixHandle();
+
+  // When surfacing cell data the edge map holds pairs of cells
+  const size_type ncols = (basis_order_ == 0) ? ncells_ : nnodes_;
+  return build_interpolant(edge_map_, ncols);
 }
 
 
 MatrixHandle BaseMC::get_parent_cells()
 {
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   if( !build_field_ ) return (0);
-
-
-    // The columns represent the source cells while the rows
-    // represent the destination cells
-    const size_type nrows = cell_map_.size();
-    const size_type ncols = ncells_;
-
-    // Yale Sparse Row Matrix format.
-    SparseRowMatrix::Data sparseData(nrows+1, nrows);
-    const SparseRowMatrix::Rows& rr = sparseData.rows();
-    const SparseRowMatrix::Columns& cc = sparseData.columns();
-    const SparseRowMatrix::Storage& dd = sparseData.data();
+  if (!build_field_) return MatrixHandle();
 
-    size_type nnz = nrows;
-    index_type i;
+  return build_parent_cells(cell_map_, ncells_);
+}
 
-    for (i = 0; i < nrows; i++)
-    {
-      rr[i] = i;
 
-      cc[i] = cell_map_[i];
-      dd[i] = 1;
-    }
+MatrixHandle BaseMC::build_interpolant(const edge_hash_type& edge_map, size_type ncols)
+{
+  // The columns represent the source nodes while the rows
+  // represent the destination nodes
+  const size_type nrows = static_cast<size_type>(edge_map.size());
+
+  typedef SparseRowMatrix::Triplet T;
+  std::vector<T> tripletList;
+  tripletList.reserve(2*nrows);
+
+  for (const auto& edge : edge_map)
+  {
+    const index_type row = edge.second;
+    // A negative index marks an edge point that coincides with a node
+    if (edge.first.first >= 0)
+      tripletList.push_back(T(row, edge.first.first, 1.0 - edge.first.dfirst));
+    if (edge.first.second >= 0)
+      tripletList.push_back(T(row, edge.first.second, edge.first.dfirst));
+  }
+
+  SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
+  mat->setFromTriplets(tripletList.begin(), tripletList.end());
+  return mat;
+}
 
-    rr[i] = nrows;
 
-    return new SparseRowMatrix(nrows, ncols, sparseData, nnz);
-  #endif
-    return MatrixHandle();
+MatrixHandle BaseMC::build_parent_cells(const std::vector<index_type>& cell_map, size_type ncols)
+{
+  // The columns represent the source cells while the rows
+  // represent the destination cells
+  const size_type nrows = static_cast<size_type>(cell_map.size());
+
+  typedef SparseRowMatrix::Triplet T;
+  std::vector<T> tripletList;
+  tripletList.reserve(nrows);
+
+  for (index_type i = 0; i < nrows; i++)
+  {
+    tripletList.push_back(T(i, cell_map[i], 1.0));
+  }
+
+  SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
+  mat->setFromTriplets(tripletList.begin(), tripletList.end());
+  return mat;
 }
@@ -87,7 +87,7 @@ namespace SCIRun {
       SCIRun::index_type second;
       double dfirst;
     };
-  protected:
+
     struct edgepairhash
     {
       size_t operator()(const edgepair_t &a) const
@@ -99,6 +99,23 @@ namespace SCIRun {
 
     typedef std::unordered_map<edgepair_t, SCIRun::index_type, edgepairhash> edge_hash_type;
 
+    /// Read access to the tables built during extraction, used to stitch
+    /// together the outputs of tesselators that ran over disjoint cell ranges.
+    const edge_hash_type& edge_map() const { return edge_map_; }
+    const std::vector<SCIRun::index_type>& cell_map() const { return cell_map_; }
+    const std::vector<SCIRun::index_type>& node_map() const { return node_map_; }
+    SCIRun::size_type num_input_nodes() const { return nnodes_; }
+    SCIRun::size_type num_input_cells() const { return ncells_; }
+
+    /// Build the sparse matrices from (merged) tables. The interpolant has
+    /// one row per entry in the edge map, the parent matrix one row per
+    /// entry in the cell map.
+    static Core::Datatypes::MatrixHandle build_interpolant(const edge_hash_type& edge_map,
+      SCIRun::size_type ncols);
+    static Core::Datatypes::MatrixHandle build_parent_cells(const std::vector<SCIRun::index_type>& cell_map,
+      SCIRun::size_type ncols);
+
+  protected:
     std::vector<SCIRun::index_type> cell_map_;  // Unique cells when surfacing node data.
     std::vector<SCIRun::index_type> node_map_;  // Unique nodes when surfacing cell data.
 
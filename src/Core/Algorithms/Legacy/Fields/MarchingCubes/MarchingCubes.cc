@@ -57,6 +57,7 @@
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Algorithms::Math;
@@ -95,9 +96,8 @@ class MarchingCubesAlgoP {
 
     ~MarchingCubesAlgoP()
     {
-      #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-       delete_all_items(tesselator_);
-      #endif
+      for (auto tesselator : tesselator_)
+        delete tesselator;
     }
 
     FieldHandle    input_;
@@ -125,6 +125,8 @@ class MarchingCubesAlgoP {
     void parallel(int proc, int nproc, size_t iso);
 
   private:
+    void stitch(size_t iso);
+
     AppendFieldsAlgorithm append_fields_;
     AppendMatrixAlgorithm append_matrices_;
 
@@ -150,32 +152,31 @@ template <class TESSELATOR>
 bool
 MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
                         FieldHandle& output,
-                        MatrixHandle&,
-                        MatrixHandle&)
+                        MatrixHandle& node_interpolant,
+                        MatrixHandle& elem_interpolant)
 {
   algo_ = algo;
 
- #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  int np = algo->get_int("num_threads");
   /// By default (-1) choose number of processors
-  if (np < 1) np = Thread::numProcessors();
-  /// Cap the number of threads
-  if (np > 4*Thread::numProcessors()) np = 4*Thread::numProcessors();
-  */
-  /// @todo: FIX MULTI THREADING OF MARCHING CUBES FIELDS ARE NOT PROPORLY LINKED
- #endif
-  int np = Parallel::NumCores();
+  int np = algo->get(Parameters::num_threads).toInt();
+  if (np < 1) np = Parallel::NumCores();
+  /// Cap the number of threads; the tesselators run on dedicated threads,
+  /// so a few more than the number of cores is fine
+  np = std::min(np, 4*static_cast<int>(Parallel::NumCores()));
+  /// Do not split small meshes, the stitching would dominate
+  const size_type min_elems_per_thread = 4096;
+  const size_type num_elems = input_->vmesh()->num_elems();
+  np = std::max(1, std::min(np, static_cast<int>(num_elems / min_elems_per_thread)));
 
-  np = 1;
   size_t num_values = iso_values_.size();
 
   tesselator_.resize(np);
   for (size_t j=0; j<tesselator_.size(); j++)
     tesselator_[j] = new TESSELATOR(input_);
 
-  output_field_.resize(np*num_values);
-  output_interpolant_matrix_.resize(np*num_values);
-  output_parent_cell_matrix_.resize(np*num_values);
+  output_field_.resize(num_values);
+  output_interpolant_matrix_.resize(num_values);
+  output_parent_cell_matrix_.resize(num_values);
   //output_geometry_.resize(np*num_values);
 
   build_field_ = algo->get(Parameters::build_field).toBool();
@@ -184,12 +185,26 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
   build_elem_interpolant_ = algo->get(Parameters::build_elem_interpolant).toBool();
   transparency_ = algo->get(Parameters::transparency).toBool();
 
+  /// The interpolants are derived from the tables built alongside the field
+  if (build_node_interpolant_ || build_elem_interpolant_)
+    build_field_ = true;
+
  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   append_fields_.set_progress_reporter(algo->get_progress_reporter());
   append_matrices_.set_progress_reporter(algo->get_progress_reporter());
-  append_matrices_.setOption("method","append_rows");
  #endif
 
+  /// Cell data tesselators need the face and neighbor tables; build them
+  /// once up front instead of having every thread wait on the mesh lock.
+  if (np > 1 && input_->vfield()->basis_order() == 0)
+  {
+    FieldInformation fi(input_);
+    if (fi.is_crv_element() || fi.is_tri_element() || fi.is_quad_element())
+      input_->vmesh()->synchronize(Mesh::EDGES_E|Mesh::ELEM_NEIGHBORS_E);
+    else
+      input_->vmesh()->synchronize(Mesh::FACES_E|Mesh::ELEM_NEIGHBORS_E);
+  }
+
   for (size_t j=0; j<iso_values_.size(); j++)
   {
     if (np == 1)
@@ -198,10 +213,10 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
     }
     else
     {
-      #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-       Thread::parallel(this,&MarchingCubesAlgoP<TESSELATOR>::parallel,np,np,j);
-      #endif
+      auto task_i = [this,np,j](int i) { parallel(i,np,j); };
+      Parallel::RunTasks(task_i, np);
     }
+    stitch(j);
   }
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (output_geometry_.size() == 0)
@@ -227,19 +242,23 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
       return (false);
   }
 
- #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  if (build_node_interpolant_)
+  if (build_node_interpolant_ && !output_interpolant_matrix_.empty())
   {
-    if (!(append_matrices_.run(output_interpolant_matrix_,node_interpolant)))
+    std::vector<MatrixHandle> rest(output_interpolant_matrix_.begin() + 1, output_interpolant_matrix_.end());
+    node_interpolant = append_matrices_.concatenateMatrices(output_interpolant_matrix_[0], rest,
+      AppendMatrixAlgorithm::Option::ROWS);
+    if (!node_interpolant)
       return (false);
   }
 
-  if (build_elem_interpolant_)
+  if (build_elem_interpolant_ && !output_parent_cell_matrix_.empty())
   {
-    if (!(append_matrices_.run(output_parent_cell_matrix_,elem_interpolant)))
+    std::vector<MatrixHandle> rest(output_parent_cell_matrix_.begin() + 1, output_parent_cell_matrix_.end());
+    elem_interpolant = append_matrices_.concatenateMatrices(output_parent_cell_matrix_[0], rest,
+      AppendMatrixAlgorithm::Option::ROWS);
+    if (!elem_interpolant)
       return (false);
   }
- #endif
 
   return (true);
 }
@@ -334,27 +353,6 @@ void MarchingCubesAlgoP<TESSELATOR>::parallel( int proc, int nproc, size_t iso)
     }
   }
 
-  output_field_[iso*nproc+proc] = nullptr;
-  output_interpolant_matrix_[iso*nproc+proc] = nullptr;
-  output_parent_cell_matrix_[iso*nproc+proc] = nullptr;
-
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   output_geometry_[iso*nproc+proc] = 0;
-  #endif
-
-  if (build_field_)
-  {
-    output_field_[iso*nproc+proc] = tesselator_[proc]->get_field(isoval);
-  }
-  if (build_node_interpolant_)
-  {
-    output_interpolant_matrix_[iso*nproc+proc] = tesselator_[proc]->get_interpolant();
-  }
-  if (build_elem_interpolant_)
-  {
-    output_parent_cell_matrix_[iso*nproc+proc] = tesselator_[proc]->get_parent_cells();
-  }
-
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (build_geometry_)
   {
@@ -383,3 +381,141 @@ void MarchingCubesAlgoP<TESSELATOR>::parallel( int proc, int nproc, size_t iso)
   #endif
 
 }
+
+
+/// Merge the partial surfaces of all tesselators for one isovalue. Every
+/// tesselator worked on a contiguous range of cells, so visiting them in
+/// order and appending only the nodes that have not been seen yet yields
+/// exactly the node and element numbering of a single threaded run. Nodes
+/// on cut edges (node data) are matched through the edge map, nodes shared
+/// between faces (cell data) through the input node they were copied from.
+template<class TESSELATOR>
+void MarchingCubesAlgoP<TESSELATOR>::stitch(size_t iso)
+{
+  const double isoval = iso_values_[iso];
+
+  output_field_[iso] = nullptr;
+  output_interpolant_matrix_[iso] = nullptr;
+  output_parent_cell_matrix_[iso] = nullptr;
+
+  if (!build_field_) return;
+
+  if (tesselator_.size() == 1)
+  {
+    output_field_[iso] = tesselator_[0]->get_field(isoval);
+    if (build_node_interpolant_)
+      output_interpolant_matrix_[iso] = tesselator_[0]->get_interpolant();
+    if (build_elem_interpolant_)
+      output_parent_cell_matrix_[iso] = tesselator_[0]->get_parent_cells();
+    return;
+  }
+
+  const bool cell_data = (tesselator_[0]->basis_order_ == 0);
+
+  FieldInformation fi(tesselator_[0]->get_field(isoval));
+  FieldHandle output = CreateField(fi);
+  VMesh* omesh = output->vmesh();
+
+  size_t max_nodes = 0, max_elems = 0;
+  for (size_t p = 0; p < tesselator_.size(); p++)
+  {
+    VMesh* lmesh = tesselator_[p]->get_field(isoval)->vmesh();
+    max_nodes += lmesh->num_nodes();
+    max_elems += lmesh->num_elems();
+  }
+  omesh->node_reserve(max_nodes);
+  omesh->elem_reserve(max_elems);
+
+  BaseMC::edge_hash_type edge_map;
+  std::vector<index_type> node_map;
+  std::vector<index_type> cell_map;
+
+  VMesh::Node::array_type nodes;
+
+  for (size_t p = 0; p < tesselator_.size(); p++)
+  {
+    TESSELATOR* tess = tesselator_[p];
+    FieldHandle local = tess->get_field(isoval);
+    VMesh* lmesh = local->vmesh();
+
+    const size_type num_local_nodes = lmesh->num_nodes();
+    std::vector<VMesh::Node::index_type> local_to_merged(num_local_nodes);
+    Point pt;
+
+    if (cell_data)
+    {
+      const std::vector<index_type>& lnode_map = tess->node_map();
+      if (node_map.empty()) node_map.resize(lnode_map.size(), -1);
+
+      std::vector<index_type> source_node(num_local_nodes, -1);
+      for (size_t n = 0; n < lnode_map.size(); n++)
+        if (lnode_map[n] >= 0) source_node[lnode_map[n]] = n;
+
+      for (index_type n = 0; n < num_local_nodes; n++)
+      {
+        index_type& merged = node_map[source_node[n]];
+        if (merged < 0)
+        {
+          lmesh->get_point(pt, VMesh::Node::index_type(n));
+          merged = omesh->add_point(pt);
+        }
+        local_to_merged[n] = merged;
+      }
+    }
+    else
+    {
+      std::vector<const BaseMC::edgepair_t*> source_edge(num_local_nodes, nullptr);
+      for (const auto& edge : tess->edge_map())
+        source_edge[edge.second] = &edge.first;
+
+      for (index_type n = 0; n < num_local_nodes; n++)
+      {
+        const auto loc = edge_map.find(*source_edge[n]);
+        if (loc == edge_map.end())
+        {
+          lmesh->get_point(pt, VMesh::Node::index_type(n));
+          const VMesh::Node::index_type merged = omesh->add_point(pt);
+          edge_map[*source_edge[n]] = merged;
+          local_to_merged[n] = merged;
+        }
+        else
+        {
+          local_to_merged[n] = loc->second;
+        }
+      }
+    }
+
+    const size_type num_local_elems = lmesh->num_elems();
+    std::vector<VMesh::Elem::index_type> local_elem_to_merged(num_local_elems);
+    for (VMesh::Elem::index_type e = 0; e < num_local_elems; e++)
+    {
+      lmesh->get_nodes(nodes, e);
+      for (size_t k = 0; k < nodes.size(); k++)
+        nodes[k] = local_to_merged[nodes[k]];
+      local_elem_to_merged[e] = omesh->add_elem(nodes);
+    }
+
+    if (cell_data)
+    {
+      // Each cut face is recorded by exactly one of its two cells
+      for (const auto& edge : tess->edge_map())
+        edge_map[edge.first] = local_elem_to_merged[edge.second];
+    }
+
+    cell_map.insert(cell_map.end(), tess->cell_map().begin(), tess->cell_map().end());
+  }
+
+  output->vfield()->resize_values();
+  output->vfield()->set_all_values(isoval);
+  output_field_[iso] = output;
+
+  if (build_node_interpolant_)
+  {
+    const size_type ncols = cell_data ? tesselator_[0]->num_input_cells() : tesselator_[0]->num_input_nodes();
+    output_interpolant_matrix_[iso] = BaseMC::build_interpolant(edge_map, ncols);
+  }
+  if (build_elem_interpolant_)
+  {
+    output_parent_cell_matrix_[iso] = BaseMC::build_parent_cells(cell_map, tesselator_[0]->num_input_cells());
+  }
+}
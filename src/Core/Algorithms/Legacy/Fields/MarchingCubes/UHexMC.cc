@@ -55,7 +55,6 @@ void UHexMC::reset( int /*n*/, bool build_field, bool build_geom, bool )
   mesh_->size(csize);
   ncells_ = csize;
 
- #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (basis_order_ == 0)
   {
     mesh_->synchronize(Mesh::FACES_E|Mesh::ELEM_NEIGHBORS_E);
@@ -65,6 +64,7 @@ void UHexMC::reset( int /*n*/, bool build_field, bool build_geom, bool )
     }
   }
 
+ #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   triangles_ = 0;
   if (build_geom)
   {
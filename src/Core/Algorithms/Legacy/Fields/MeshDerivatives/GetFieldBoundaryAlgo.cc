@@ -33,10 +33,15 @@
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/HexVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopologyBuilder.h>
+#include <Core/Thread/Parallel.h>
 
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Datatypes/PropertyManagerExtensions.h>
 
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 
 using namespace SCIRun;
@@ -44,6 +49,9 @@ using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+ALGORITHM_PARAMETER_DEF(Fields, BoundaryMethod);
 
 AlgorithmOutputName GetFieldBoundaryAlgo::BoundaryField("BoundaryField");
 AlgorithmOutputName GetFieldBoundaryAlgo::MappingMatrix("Mapping");
@@ -51,6 +59,217 @@ AlgorithmOutputName GetFieldBoundaryAlgo::MappingMatrix("Mapping");
 GetFieldBoundaryAlgo::GetFieldBoundaryAlgo()
 {
   addOption(AlgorithmParameterName("mapping"),"auto","auto|node|elem|none");
+  addOption(Parameters::BoundaryMethod,"auto","auto|neighbors|sort");
+}
+
+bool
+GetFieldBoundaryAlgo::use_sorted_faces(const FieldInformation& fi) const
+{
+  if (checkOption(Parameters::BoundaryMethod,"neighbors")) return (false);
+  if (fi.is_tetvolmesh() || fi.is_hexvolmesh()) return (true);
+  if (checkOption(Parameters::BoundaryMethod,"sort"))
+    remark("Sorting faces is only supported for TetVol and HexVol meshes, using the element neighbors instead");
+  return (false);
+}
+
+namespace {
+
+const size_t grain = 4096;
+
+// Faces of the tets in the order in which TetVolMesh lists the delems of an
+// element, each entered CCW from outside looking in. HexVolFaceTable does
+// the same for the hexes.
+const int tet_faces[4][3] = { {1,2,3}, {0,3,2}, {0,1,3}, {0,2,1} };
+
+// Extracts the boundary of a TetVolMesh or HexVolMesh from the cell
+// connectivity alone. The canonical keys of all element faces are sorted,
+// a face is on the boundary if all of its occurrences belong to one element.
+// Faces and nodes are numbered with prefix sums in the order in which the
+// element by element search over the delems visits them, hence the output
+// is the same as the one built from the face tables.
+template <int K, int F, int N>
+void
+sort_boundary_faces(VMesh* imesh, const int (&local_faces)[F][K],
+                    std::vector<index_type>& faces,
+                    std::vector<index_type>& elem_map,
+                    std::vector<index_type>& node_map)
+{
+  const size_type num_elems = imesh->num_elems();
+  const size_type num_nodes = imesh->num_nodes();
+
+  std::vector<index_type> cells(num_elems*N);
+  Parallel::For(0, num_elems, grain, [&](size_t begin, size_t end)
+  {
+    VMesh::Node::array_type nodes;
+    for (size_t c = begin; c < end; c++)
+    {
+      imesh->get_nodes(nodes, VMesh::Elem::index_type(c));
+      for (int k = 0; k < N; k++) cells[c*N+k] = nodes[k];
+    }
+  });
+
+  auto face_nodes = [&](index_type i, index_type* n)
+  {
+    const index_type* nodes = &cells[(i / F) * N];
+    const int* local = local_faces[i % F];
+    for (int k = 0; k < K; k++) n[k] = nodes[local[k]];
+    // Faces with a repeated node are lines, which tets with repeated nodes
+    // have, and are left out like degenerate hex faces.
+    if constexpr (K == 3) return (n[0] != n[1] && n[1] != n[2] && n[2] != n[0]);
+    else return (order_hex_face_nodes(n[0], n[1], n[2], n[3]));
+  };
+
+  MeshTopologyBuilder<K> builder;
+  builder.build(num_elems*F, [&](index_type i,
+                                 typename MeshTopologyBuilder<K>::key_type& key)
+  {
+    index_type n[K];
+    if (!face_nodes(i, n)) return false;
+    if constexpr (K == 3)
+    {
+      std::copy(n, n+K, key.begin());
+      std::sort(key.begin(), key.end());
+    }
+    else
+    {
+      hex_face_key(n, key);
+    }
+    return true;
+  });
+
+  const size_type num_occurrences = num_elems*F;
+  std::vector<index_type> offset(num_occurrences);
+  Parallel::For(0, num_occurrences, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
+    {
+      const index_type u = builder.unique(i);
+      offset[i] = (u >= 0 && builder.occurrence(u, 0) / F ==
+                   builder.occurrence(u, builder.num_occurrences(u) - 1) / F) ? 1 : 0;
+    }
+  });
+
+  const size_type num_faces = parallel_exclusive_scan(offset);
+
+  // Nodes of the boundary faces, taken from the first occurrence of the face
+  elem_map.resize(num_faces);
+  faces.resize(num_faces*K);
+  Parallel::For(0, num_occurrences, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
+    {
+      const index_type f = offset[i];
+      if ((i + 1 < static_cast<size_t>(num_occurrences) ? offset[i+1] : num_faces) == f) continue;
+      elem_map[f] = i / F;
+      face_nodes(builder.occurrence(builder.unique(i), 0), &faces[f*K]);
+    }
+  });
+
+  // Number the nodes in the order in which they are first used
+  const index_type unused = num_faces*K;
+  std::vector<std::atomic<index_type> > first_use(num_nodes);
+  Parallel::For(0, num_nodes, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t q = begin; q < end; q++) first_use[q].store(unused, std::memory_order_relaxed);
+  });
+  Parallel::For(0, num_faces*K, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+    {
+      std::atomic<index_type>& first = first_use[faces[p]];
+      index_type current = first.load(std::memory_order_relaxed);
+      while (static_cast<index_type>(p) < current &&
+             !first.compare_exchange_weak(current, p, std::memory_order_relaxed));
+    }
+  });
+
+  std::vector<index_type> renumber(num_faces*K);
+  Parallel::For(0, num_faces*K, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+      renumber[p] = (first_use[faces[p]].load(std::memory_order_relaxed) == static_cast<index_type>(p)) ? 1 : 0;
+  });
+  const size_type num_used = parallel_exclusive_scan(renumber);
+
+  node_map.resize(num_used);
+  Parallel::For(0, num_faces*K, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+    {
+      const index_type first = first_use[faces[p]].load(std::memory_order_relaxed);
+      if (first == static_cast<index_type>(p)) node_map[renumber[p]] = faces[p];
+    }
+  });
+  Parallel::For(0, num_faces*K, grain, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+      faces[p] = renumber[first_use[faces[p]].load(std::memory_order_relaxed)];
+  });
+}
+
+// Builds the boundary field of a tet or hex mesh by sorting face keys, the
+// maps give the input element of every output element and the input node
+// of every output node.
+void
+sorted_field_boundary(FieldHandle input, FieldHandle output,
+                      std::vector<index_type>& elem_map,
+                      std::vector<index_type>& node_map)
+{
+  VMesh* imesh = input->vmesh();
+  VMesh* omesh = output->vmesh();
+  VField* ifield = input->vfield();
+  VField* ofield = output->vfield();
+
+  std::vector<index_type> faces;
+  int face_size;
+  if (imesh->is_tetvolmesh())
+  {
+    sort_boundary_faces<3,4,4>(imesh, tet_faces, faces, elem_map, node_map);
+    face_size = 3;
+  }
+  else
+  {
+    sort_boundary_faces<4,6,8>(imesh, HexVolFaceTable, faces, elem_map, node_map);
+    face_size = 4;
+  }
+
+  omesh->node_reserve(node_map.size());
+  omesh->elem_reserve(elem_map.size());
+
+  Point point;
+  for (size_t q = 0; q < node_map.size(); q++)
+  {
+    imesh->get_center(point, VMesh::Node::index_type(node_map[q]));
+    omesh->add_node(point);
+  }
+
+  VMesh::Node::array_type onodes(face_size);
+  for (size_t f = 0; f < elem_map.size(); f++)
+  {
+    for (int k = 0; k < face_size; k++) onodes[k] = faces[f*face_size+k];
+    omesh->add_elem(onodes);
+  }
+
+  ofield->resize_fdata();
+
+  if (ifield->basis_order() == 0)
+  {
+    Parallel::For(0, elem_map.size(), grain, [&](size_t begin, size_t end)
+    {
+      for (size_t f = begin; f < end; f++)
+        ofield->copy_value(ifield, VMesh::Elem::index_type(elem_map[f]), VMesh::Elem::index_type(f));
+    });
+  }
+  else if (ifield->basis_order() == 1)
+  {
+    Parallel::For(0, node_map.size(), grain, [&](size_t begin, size_t end)
+    {
+      for (size_t q = begin; q < end; q++)
+        ofield->copy_value(ifield, VMesh::Node::index_type(node_map[q]), VMesh::Node::index_type(q));
+    });
+  }
+}
+
 }
 
 struct IndexHash
@@ -123,6 +342,39 @@ GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output, MatrixHandle&
   auto ifield = input->vfield();
   auto ofield = output->vfield();
 
+  if (use_sorted_faces(fi))
+  {
+    std::vector<index_type> sorted_elems;
+    std::vector<index_type> sorted_nodes;
+    sorted_field_boundary(input, output, sorted_elems, sorted_nodes);
+
+    mapping.reset();
+
+    typedef SparseRowMatrix::Triplet T;
+    std::vector<T> tripletList;
+    if (ifield->basis_order() == 0)
+    {
+      tripletList.reserve(sorted_elems.size());
+      for (size_t f = 0; f < sorted_elems.size(); f++)
+        tripletList.push_back(T(f, sorted_elems[f], 1));
+      SparseRowMatrixHandle mat(new SparseRowMatrix(sorted_elems.size(), imesh->num_elems()));
+      mat->setFromTriplets(tripletList.begin(), tripletList.end());
+      mapping = mat;
+    }
+    else if (ifield->basis_order() == 1)
+    {
+      tripletList.reserve(sorted_nodes.size());
+      for (size_t q = 0; q < sorted_nodes.size(); q++)
+        tripletList.push_back(T(q, sorted_nodes[q], 1));
+      SparseRowMatrixHandle mat(new SparseRowMatrix(sorted_nodes.size(), imesh->num_nodes()));
+      mat->setFromTriplets(tripletList.begin(), tripletList.end());
+      mapping = mat;
+    }
+
+    CopyProperties(*input, *output);
+    return (true);
+  }
+
   imesh->synchronize(Mesh::DELEMS_E | Mesh::ELEM_NEIGHBORS_E);
 
   /// These are all virtual iterators, virtual index_types and array_types
@@ -366,6 +618,15 @@ GetFieldBoundaryAlgo::run(FieldHandle input, FieldHandle& output) const
   auto ifield = input->vfield();
   auto ofield = output->vfield();
 
+  if (use_sorted_faces(fi))
+  {
+    std::vector<index_type> sorted_elems;
+    std::vector<index_type> sorted_nodes;
+    sorted_field_boundary(input, output, sorted_elems, sorted_nodes);
+    CopyProperties(*input, *output);
+    return (true);
+  }
+
   imesh->synchronize(Mesh::DELEMS_E|Mesh::ELEM_NEIGHBORS_E);
 
   /// These are all virtual iterators, virtual index_types and array_types
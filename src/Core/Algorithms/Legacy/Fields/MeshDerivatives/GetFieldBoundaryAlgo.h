@@ -30,6 +30,7 @@
 #define CORE_ALGORITHMS_FIELDS_MESHDERIVATIVES_GETFIELDBOUNDARY_H 1
 
 #include <Core/Datatypes/DatatypeFwd.h>
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
 #include <Core/Thread/Interruptible.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
 
@@ -40,6 +41,8 @@ namespace Core {
 namespace Algorithms {
 namespace Fields {
 
+  ALGORITHM_PARAMETER_DECL(BoundaryMethod);
+
 class SCISHARE GetFieldBoundaryAlgo : public AlgorithmBase, public Thread::Interruptible
 {
 public:
@@ -54,6 +57,11 @@ public:
   bool run(FieldHandle input, FieldHandle& output) const;
 
   AlgorithmOutput run(const AlgorithmInput& input) const override;
+
+private:
+  /// TetVol and HexVol boundaries can be found by sorting the faces of all
+  /// elements, which does not need the face and neighbor tables.
+  bool use_sorted_faces(const FieldInformation& fi) const;
 };
 
 }}}}
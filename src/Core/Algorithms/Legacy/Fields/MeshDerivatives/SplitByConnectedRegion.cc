@@ -35,12 +35,16 @@
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Bundle/Bundle.h>
+#include <Core/Thread/Parallel.h>
+
+#include <atomic>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Fields, SortDomainBySize);
 const AlgorithmOutputName SplitFieldByConnectedRegionAlgo::OutputField1("OutputField1");
@@ -53,6 +57,43 @@ const AlgorithmOutputName SplitFieldByConnectedRegionAlgo::OutputField7("OutputF
 const AlgorithmOutputName SplitFieldByConnectedRegionAlgo::OutputField8("OutputField8");
 const AlgorithmOutputName SplitFieldByConnectedRegionAlgo::OutputBundle("OutputBundle");
 
+namespace {
+
+const size_t node_grain = 4096;
+const size_t elem_grain = 4096;
+
+// Concurrent union find: roots are only ever linked to a smaller root with a
+// compare and swap, and paths are halved on the way up.
+index_type
+find_set(std::vector<std::atomic<index_type> >& parent, index_type x)
+{
+  index_type p = parent[x].load(std::memory_order_relaxed);
+  while (p != x)
+  {
+    index_type gp = parent[p].load(std::memory_order_relaxed);
+    if (gp != p) parent[x].compare_exchange_weak(p,gp,std::memory_order_relaxed);
+    x = gp;
+    p = parent[x].load(std::memory_order_relaxed);
+  }
+  return (x);
+}
+
+void
+unite_sets(std::vector<std::atomic<index_type> >& parent, index_type a, index_type b)
+{
+  while (true)
+  {
+    a = find_set(parent,a);
+    b = find_set(parent,b);
+    if (a == b) return;
+    if (a < b) std::swap(a,b);
+    index_type expected = a;
+    if (parent[a].compare_exchange_strong(expected,b)) return;
+  }
+}
+
+}
+
 class SortSizes
 {
   public:
@@ -122,156 +163,153 @@ std::vector<FieldHandle> SplitFieldByConnectedRegionAlgo::run(FieldHandle input)
   VField* ifield = input->vfield();
   VMesh*  imesh  = input->vmesh();
 
-  VField::index_type k = 0;
-
   VMesh::size_type num_nodes = imesh->num_nodes();
   VMesh::size_type num_elems = imesh->num_elems();
 
-  VField::size_type surfsize = static_cast<VField::size_type>(pow(num_elems, 2.0 / 3.0));
-  std::vector<VMesh::Elem::index_type> buffer;
-  buffer.reserve(surfsize);
-
-  imesh->synchronize(Mesh::NODE_NEIGHBORS_E|Mesh::ELEM_NEIGHBORS_E|Mesh::DELEMS_E);
-
-  std::vector<index_type> elemmap(num_elems, 0);
-  std::vector<index_type> nodemap(num_nodes, 0);
-  std::vector<index_type> renumber(num_nodes,0);
-  std::vector<short> visited(num_elems, 0);
-
-  VMesh::Node::array_type nnodes;
-  VMesh::Elem::array_type neighbors;
+  // Label the connected regions with a union find over the nodes: all the
+  // nodes of an element are merged into one set. Only the element
+  // connectivity is needed, hence no neighbor tables need to be
+  // synchronized.
+  std::vector<std::atomic<index_type> > parent(num_nodes);
+  Parallel::For(0, num_nodes, node_grain, [&](size_t begin, size_t end)
+  {
+    for (size_t q = begin; q < end; q++) parent[q].store(static_cast<index_type>(q), std::memory_order_relaxed);
+  });
 
-  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  Parallel::For(0, num_elems, elem_grain, [&](size_t begin, size_t end)
   {
-    // if list of elements to process is empty ad the next one
-    if (buffer.size() == 0)
+    VMesh::Node::array_type nnodes;
+    for (size_t idx = begin; idx < end; idx++)
     {
-      if(visited[idx] == 0) { buffer.push_back(idx); k++; }
+      imesh->get_nodes(nnodes,VMesh::Elem::index_type(idx));
+      for (size_t q=1; q<nnodes.size(); q++) unite_sets(parent,nnodes[0],nnodes[q]);
     }
+  });
 
-    if (buffer.size() > 0)
+  // Number the regions in the order of their first element, i.e. in the
+  // same order as a search that starts at the lowest unvisited element.
+  std::vector<index_type> elemmap(num_elems);
+  Parallel::For(0, num_elems, elem_grain, [&](size_t begin, size_t end)
+  {
+    VMesh::Node::array_type nnodes;
+    for (size_t idx = begin; idx < end; idx++)
     {
-      for (size_t i=0; i< buffer.size(); i++)
-      {
-        VField::index_type j = buffer[i];
-        if (visited[j] > 0) { continue; }
-        visited[j] = 1;
+      imesh->get_nodes(nnodes,VMesh::Elem::index_type(idx));
+      elemmap[idx] = find_set(parent,nnodes[0]);
+    }
+  });
 
-        imesh->get_nodes(nnodes,buffer[i]);
-        for (size_t q=0; q<nnodes.size(); q++)
-        {
-          imesh->get_elems(neighbors,nnodes[q]);
-          for (size_t p=0; p<neighbors.size(); p++)
-          {
-            if(visited[neighbors[p]] == 0)
-            {
-              buffer.push_back(neighbors[p]);
-              visited[neighbors[p]] = -1;
-            }
-          }
-        }
+  std::vector<index_type> region(num_nodes, -1);
+  index_type k = 0;
+  for (VMesh::Elem::index_type idx=0; idx<num_elems; idx++)
+  {
+    index_type& r = region[elemmap[idx]];
+    if (r < 0) r = k++;
+    elemmap[idx] = r;
+  }
 
-        if (j >= static_cast<index_type>(elemmap.size())) elemmap.resize(j+1);
+  // Nodes that are not part of any element have no region
+  std::vector<index_type> nodemap(num_nodes);
+  Parallel::For(0, num_nodes, node_grain, [&](size_t begin, size_t end)
+  {
+    for (size_t q = begin; q < end; q++) nodemap[q] = region[find_set(parent,q)];
+  });
+
+  // Sort the nodes and elements by region, keeping their relative order, so
+  // every output field can be filled from its own list in a single pass
+  std::vector<index_type> node_offset(k+1, 0);
+  std::vector<index_type> elem_offset(k+1, 0);
+  for (VMesh::Node::index_type q=0;q<num_nodes;q++) if (nodemap[q] >= 0) node_offset[nodemap[q]+1]++;
+  for (VMesh::Elem::index_type q=0;q<num_elems;q++) elem_offset[elemmap[q]+1]++;
+  for (index_type p=0; p<k; p++)
+  {
+    node_offset[p+1] += node_offset[p];
+    elem_offset[p+1] += elem_offset[p];
+  }
 
-        elemmap[j] = k;
-        for (size_t p=0;p<nnodes.size();p++)
-        {
-          if (static_cast<size_t>(nnodes[p]) >= nodemap.size())
-            nodemap.resize(nnodes[p]+1);
-          nodemap[nnodes[p]] = k;
-        }
-      }
-      buffer.clear();
+  std::vector<index_type> region_nodes(node_offset[k]);
+  std::vector<index_type> region_elems(elem_offset[k]);
+  std::vector<index_type> renumber(num_nodes, 0);
+  {
+    std::vector<index_type> node_fill(node_offset.begin(), node_offset.end()-1);
+    std::vector<index_type> elem_fill(elem_offset.begin(), elem_offset.end()-1);
+    for (VMesh::Node::index_type q=0;q<num_nodes;q++)
+    {
+      if (nodemap[q] < 0) continue;
+      index_type& pos = node_fill[nodemap[q]];
+      renumber[q] = pos - node_offset[nodemap[q]];
+      region_nodes[pos++] = q;
     }
+    for (VMesh::Elem::index_type q=0;q<num_elems;q++)
+      region_elems[elem_fill[elemmap[q]]++] = q;
   }
 
- output.resize(k);
-  for (size_type p=0; p<k; p++)
+  output.resize(k);
+  for (index_type p=0; p<k; p++)
   {
-    VField* ofield;
-    VMesh* omesh;
-    MeshHandle mesh;
-    FieldHandle field;
-
-    VField::size_type nn = 0;
-    VField::size_type ne = 0;
-
-    for (VField::index_type q=0;q<num_nodes;q++) if (nodemap[q] == p+1) nn++;
-    for (VField::index_type q=0;q<num_elems;q++) if (elemmap[q] == p+1) ne++;
-
-    mesh = CreateMesh(fi);
+    MeshHandle mesh = CreateMesh(fi);
     if (!mesh)
     {
       THROW_ALGORITHM_INPUT_ERROR("Could not create output field.");
     }
-    omesh = mesh->vmesh();
 
-    omesh->node_reserve(nn);
-    omesh->elem_reserve(ne);
+    mesh->vmesh()->node_reserve(node_offset[p+1]-node_offset[p]);
+    mesh->vmesh()->elem_reserve(elem_offset[p+1]-elem_offset[p]);
 
-    field = CreateField(fi,mesh);
+    FieldHandle field = CreateField(fi,mesh);
     if (field == nullptr)
     {
       THROW_ALGORITHM_INPUT_ERROR("Could not create output field");
     }
-
-    ofield = field->vfield();
     output[p] = field;
+  }
 
+  // Every region writes only into its own field
+  Parallel::For(0, k, 1, [&](size_t begin, size_t end)
+  {
     Point point;
-    for (index_type q=0;q<num_nodes;q++)
+    VMesh::Node::array_type elemnodes;
+
+    for (size_t p = begin; p < end; p++)
     {
-      if (nodemap[q] == p+1)
+      VField* ofield = output[p]->vfield();
+      VMesh* omesh = output[p]->vmesh();
+
+      for (index_type j=node_offset[p]; j<node_offset[p+1]; j++)
       {
-        imesh->get_center(point,VMesh::Node::index_type(q));
-        renumber[q] = omesh->add_point(point);
+        imesh->get_center(point,VMesh::Node::index_type(region_nodes[j]));
+        omesh->add_point(point);
       }
-    }
 
-    VMesh::Node::array_type elemnodes;
-    for (index_type q=0;q<num_elems;q++)
-    {
-      if (elemmap[q] == p+1)
+      for (index_type j=elem_offset[p]; j<elem_offset[p+1]; j++)
       {
-        imesh->get_nodes(elemnodes,VMesh::Elem::index_type(q));
+        imesh->get_nodes(elemnodes,VMesh::Elem::index_type(region_elems[j]));
         for (size_t r=0; r< elemnodes.size(); r++)
         {
           elemnodes[r] = VMesh::Node::index_type(renumber[elemnodes[r]]);
         }
         omesh->add_elem(elemnodes);
       }
-    }
 
-    ofield->resize_fdata();
+      ofield->resize_fdata();
 
-    if (ifield->basis_order() == 1)
-    {
-      VField::index_type qq = 0;
-      for (VField::index_type q=0;q<num_nodes;q++)
+      if (ifield->basis_order() == 1)
       {
-        if (nodemap[q] == p+1)
-        {
-          ofield->copy_value(ifield,q,qq); qq++;
-        }
+        for (index_type j=node_offset[p]; j<node_offset[p+1]; j++)
+          ofield->copy_value(ifield,region_nodes[j],j-node_offset[p]);
       }
-    }
 
-    if (ifield->basis_order() == 0)
-    {
-      VField::index_type qq = 0;
-      for (VField::index_type q=0;q<num_elems;q++)
+      if (ifield->basis_order() == 0)
       {
-        if (elemmap[q] == p+1)
-        {
-          ofield->copy_value(ifield,q,qq); qq++;
-        }
+        for (index_type j=elem_offset[p]; j<elem_offset[p+1]; j++)
+          ofield->copy_value(ifield,region_elems[j],j-elem_offset[p]);
       }
-    }
 
-   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-    ofield->copy_properties(ifield);
-   #endif
-  }
+     #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
+      ofield->copy_properties(ifield);
+     #endif
+    }
+  });
 
   if (sortDomainBySize)
   {
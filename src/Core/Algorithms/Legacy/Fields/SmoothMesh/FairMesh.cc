@@ -30,6 +30,11 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Thread/Parallel.h>
+
+#include <boost/math/constants/constants.hpp>
+#include <algorithm>
+#include <cmath>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -37,15 +42,168 @@ using namespace SCIRun::Core::Algorithms::Fields;
 using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Utility;
 using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Fields, FairMeshMethod);
 ALGORITHM_PARAMETER_DEF(Fields, NumIterations);
 ALGORITHM_PARAMETER_DEF(Fields, Lambda);
 ALGORITHM_PARAMETER_DEF(Fields, FilterCutoff);
 
+namespace {
+
+// Neighborhoods of all nodes in compressed row form: the entries of node i
+// are stored in [offsets[i], offsets[i+1]). For the equal weight methods an
+// entry is a neighboring node, for the desbrun method an entry is a pair of
+// nodes forming the edge opposite to node i in one of its elements.
+struct NodeNeighborhoods
+{
+  std::vector<VMesh::index_type> offsets;
+  std::vector<VMesh::index_type> nodes;
+};
+
+const size_t node_grain = 1024;
+
+void
+build_neighbor_nodes(VMesh* mesh, NodeNeighborhoods& nbrs)
+{
+  VMesh::size_type num_nodes = mesh->num_nodes();
+  mesh->synchronize(Mesh::NODE_NEIGHBORS_E);
+
+  nbrs.offsets.resize(num_nodes+1);
+  nbrs.nodes.clear();
+
+  VMesh::Node::array_type neighbors;
+  for (VMesh::Node::index_type idx=0; idx<num_nodes; idx++)
+  {
+    nbrs.offsets[idx] = static_cast<VMesh::index_type>(nbrs.nodes.size());
+    mesh->get_neighbors(neighbors,idx);
+    nbrs.nodes.insert(nbrs.nodes.end(),neighbors.begin(),neighbors.end());
+  }
+  nbrs.offsets[num_nodes] = static_cast<VMesh::index_type>(nbrs.nodes.size());
+}
+
+void
+build_opposite_edges(VMesh* mesh, NodeNeighborhoods& nbrs)
+{
+  VMesh::size_type num_nodes = mesh->num_nodes();
+  mesh->synchronize(Mesh::NODE_NEIGHBORS_E|Mesh::EPSILON_E);
+
+  nbrs.offsets.resize(num_nodes+1);
+  nbrs.nodes.clear();
+
+  VMesh::Elem::array_type elems;
+  VMesh::Node::array_type nodes;
+
+  for (VMesh::Node::index_type idx=0; idx<num_nodes; idx++)
+  {
+    nbrs.offsets[idx] = static_cast<VMesh::index_type>(nbrs.nodes.size()/2);
+    mesh->get_elems(elems,idx);
+    for (size_t j = 0; j<elems.size(); j++)
+    {
+      mesh->get_nodes(nodes,elems[j]);
+      // make it circular
+      nodes.push_back(nodes[0]);
+
+      for (size_t k=1;k < nodes.size();k++)
+      {
+        // get all edges that are not connected to the node itself
+        if(nodes[k-1] != idx && nodes[k] != idx)
+        {
+          nbrs.nodes.push_back(nodes[k-1]);
+          nbrs.nodes.push_back(nodes[k]);
+        }
+      }
+    }
+  }
+  nbrs.offsets[num_nodes] = static_cast<VMesh::index_type>(nbrs.nodes.size()/2);
+}
+
+// Umbrella operator: vector from a node to the average of its neighbors
+Vector
+equal_weight_displacement(const Point* point, const NodeNeighborhoods& nbrs,
+                          VMesh::index_type idx)
+{
+  const VMesh::index_type begin = nbrs.offsets[idx];
+  const VMesh::index_type end = nbrs.offsets[idx+1];
+
+  Vector d(0.0,0.0,0.0);
+  if (begin == end) return (d);
+
+  const Point& p0 = point[idx];
+  double w = 1.0/(end-begin);
+  for (VMesh::index_type j = begin; j < end; j++)
+  {
+    d += w* (point[nbrs.nodes[j]]-p0);
+  }
+  return (d);
+}
+
+// Curvature normal of a node, with weights recomputed from the current
+// positions of the opposite edges
+Vector
+desbrun_displacement(const Point* point, const NodeNeighborhoods& nbrs,
+                     VMesh::index_type idx, double epsilon)
+{
+  // if no neighborhood, do not move the node
+  Vector d(0.0,0.0,0.0);
+  const VMesh::index_type begin = nbrs.offsets[idx];
+  const VMesh::index_type end = nbrs.offsets[idx+1];
+  if (begin == end) return (d);
+
+  // Center location of this node
+  const Point& p0 = point[idx];
+
+  // total weight
+  double totw = 0.0;
+
+  for (VMesh::index_type j = begin; j < end; j++)
+  {
+    const Point& p1 = point[nbrs.nodes[2*j]];
+    const Point& p2 = point[nbrs.nodes[2*j+1]];
+
+    // vectors pointing to the two neighbor nodes
+    Vector e1 = p2-p0;
+    Vector e2 = p1-p0;
+
+    // Get vector between neighbors
+    Vector p12 = p1-p2;
+
+    // Squared distance between neighbors
+    double e = Dot(p12,p12);
+
+    if (e > 0.0)
+    {
+      double dot = Dot(p1-p0,p12)/e;
+      Point p3 = p1 - dot*p12;
+
+      double A = (p1-p3).length();
+      double B = (p0-p3).length();
+      double C = (p2-p3).length();
+
+      // if B approaches zero, we have a flat
+      // triangle, hence we need to bounce back the node
+      // towards the other side. Hence ignoring these
+      // directions
+      if (B >= 10*epsilon)
+      {
+        if (dot < 0.0) A = -A;
+        if (dot > 1.0) C = -C;
+        totw += (A+C)/B;
+
+        d += (A/B)*e1 + (C/B)*e2;
+      }
+    }
+  }
+
+  if (totw != 0.0) d *= (1.0 / totw);
+  return (d);
+}
+
+}
+
 FairMeshAlgo::FairMeshAlgo()
 {
-  addOption(Parameters::FairMeshMethod,"fast","fast|desbrun");
+  addOption(Parameters::FairMeshMethod,"fast","fast|desbrun|chebyshev");
   addParameter(Parameters::NumIterations,50);
   addParameter(Parameters::Lambda,0.6307);
   addParameter(Parameters::FilterCutoff,0.1);
@@ -87,164 +245,110 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
   VMesh* mesh = output->vmesh();
   VMesh::size_type num_nodes = mesh->num_nodes();
   mesh->unsynchronize(Mesh::NORMALS_E);
+  if (num_nodes == 0) return (true);
 
-  if (method == "fast")
-  {
-    // Fast neighborhoods
-    std::vector<VMesh::Node::array_type > neighborhoods(num_nodes);
-    mesh->synchronize(Mesh::NODE_NEIGHBORS_E);
+  NodeNeighborhoods nbrs;
+  if (method == "desbrun") build_opposite_edges(mesh,nbrs);
+  else build_neighbor_nodes(mesh,nbrs);
+
+  // Every sweep reads the positions of the previous sweep and writes into a
+  // second buffer, so all nodes can be updated concurrently.
+  Point* point = mesh->get_points_pointer();
+  std::vector<Point> buffer(num_nodes);
+  Point* cur = point;
+  Point* next = &(buffer[0]);
 
-    for (VMesh::Node::index_type idx=0; idx<num_nodes; idx++)
+  if (method == "chebyshev")
+  {
+    // Chebyshev low pass filter: the umbrella operator W = I - K has its
+    // spectrum in [-1,1], so the ideal filter that keeps the frequencies
+    // k < filter_cutoff is expanded in Chebyshev polynomials T_n(W) and
+    // evaluated with the three term recurrence, one sweep per degree.
+    // Jackson damping suppresses the ringing of the truncated series and
+    // the coefficients are normalized so that translations are preserved.
+    // NumIterations is the degree of the polynomial, i.e. the number of
+    // sweeps, whereas the other methods do a lambda and a mu sweep each.
+    const int degree = get(Parameters::NumIterations).toInt();
+    if (degree < 1) return (true);
+
+    const double pi = boost::math::constants::pi<double>();
+    const double theta = std::acos(std::max(-1.0,std::min(1.0,1.0-filter_cutoff)));
+    const double alpha = pi/(degree+2);
+
+    std::vector<double> coef(degree+1);
+    double total = 0.0;
+    for (int n=0; n<=degree; n++)
     {
-      mesh->get_neighbors(neighborhoods[idx],idx);
+      double c = (n == 0) ? theta/pi : 2.0*std::sin(n*theta)/(n*pi);
+      double g = ((degree+2-n)*std::cos(n*alpha) +
+                   std::sin(n*alpha)/std::tan(alpha))/(degree+2);
+      coef[n] = c*g;
+      total += coef[n];
     }
+    for (int n=0; n<=degree; n++) coef[n] /= total;
 
-    std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
-    Point p0;
-    for (int it = 0; it<num_iter; it++)
-    {
-      for (VMesh::index_type idx=0; idx<num_nodes;idx++)
-      {
-        p0 = point[idx];
-        Vector d(0.0,0.0,0.0);
-        VMesh::Node::array_type &neighbors = neighborhoods[idx];
-        double w = 1.0/(neighbors.size());
-        for (size_t j=0; j<neighbors.size(); j++)
-        {
-          d += w* (point[neighbors[j]]-p0);
-        }
-        disp[idx] = d;
-      }
+    // prev and cur hold the last two terms T_{n-2}(W)x and T_{n-1}(W)x
+    std::vector<Point> original(point,point+num_nodes);
+    std::vector<Point> buffer2(num_nodes);
+    Point* prev = &(original[0]);
+    cur = &(buffer2[0]);
 
-      if (it % 2 == 0)
-      {
-        for (VMesh::Node::index_type idx=0; idx<num_nodes;idx++)
-          point[idx] = point[idx]+ lambda*disp[idx];
-      }
-      else
+    Parallel::For(0, num_nodes, node_grain, [&](size_t begin, size_t end)
+    {
+      for (size_t idx = begin; idx < end; idx++)
       {
-        for (VMesh::Node::index_type idx=0; idx<num_nodes;idx++)
-          point[idx] = point[idx]+  mu*disp[idx];
+        cur[idx] = prev[idx] + equal_weight_displacement(prev,nbrs,idx);
+        point[idx] = coef[0]*prev[idx];
+        point[idx].addscaled(cur[idx],coef[1]);
       }
-      update_progress_max(it,num_iter);
-    }
-  }
-  else
-  {
-    // desbrun method
-    std::vector<std::vector<std::pair<VMesh::index_type,VMesh::index_type> > > neighborhoods(num_nodes);
-    mesh->synchronize(Mesh::NODE_NEIGHBORS_E|Mesh::EPSILON_E);
-
-    VMesh::Elem::array_type elems;
-    VMesh::Node::array_type nodes;
+    });
+    update_progress_max(1,degree);
 
-    for (VMesh::Node::index_type idx=0; idx<num_nodes; idx++)
+    for (int n = 2; n <= degree; n++)
     {
-      std::vector<std::pair<VMesh::index_type,VMesh::index_type> > &neighborhood = neighborhoods[idx];
-      mesh->get_elems(elems,idx);
-      for (size_t j = 0; j<elems.size(); j++)
+      Parallel::For(0, num_nodes, node_grain, [&](size_t begin, size_t end)
       {
-        mesh->get_nodes(nodes,elems[j]);
-        // make it circular
-        nodes.push_back(nodes[0]);
-
-        for (size_t k=1;k < nodes.size();k++)
+        for (size_t idx = begin; idx < end; idx++)
         {
-          // get all edges that are not connected to the node itself
-          if(nodes[k-1] != idx && nodes[k] != idx)
-          {
-            neighborhood.push_back(std::pair<VMesh::index_type,VMesh::index_type>(nodes[k-1],nodes[k]));
-          }
+          // T_n(W)x = 2 W T_{n-1}(W)x - T_{n-2}(W)x
+          next[idx] = cur[idx] + (cur[idx]-prev[idx]) +
+            2.0*equal_weight_displacement(cur,nbrs,idx);
+          point[idx].addscaled(next[idx],coef[n]);
         }
-      }
+      });
+      Point* tmp = prev; prev = cur; cur = next; next = tmp;
+      update_progress_max(n,degree);
     }
+    return (true);
+  }
 
-    std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
-    Point p0;
+  const bool desbrun = (method == "desbrun");
+  const double epsilon = desbrun ? mesh->get_epsilon() : 0.0;
 
-    double epsilon = mesh->get_epsilon();
+  for (int it = 0; it<num_iter; it++)
+  {
+    const double factor = (it % 2 == 0) ? lambda : mu;
 
-    for (int it = 0; it<num_iter; it++)
+    Parallel::For(0, num_nodes, node_grain, [&](size_t begin, size_t end)
     {
-
-      for (VMesh::index_type idx=0; idx<num_nodes;idx++)
+      if (desbrun)
       {
-        // Center location of this node
-        p0 = point[idx];
-        Vector d(0.0,0.0,0.0);
-
-        // neighborhood points
-        Point p1, p2, p3;
-        Vector p12;
-
-        // get local neighborhood pairs
-        const std::vector<std::pair<VMesh::index_type,VMesh::index_type> > &neighborhood = neighborhoods[idx];
-
-        // if no neighborhood continue
-        if (neighborhood.empty()) continue;
-
-        // total weight
-        double totw = 0.0;
-
-        for (size_t j = 0; j < neighborhood.size(); j++)
-        {
-          p1 = point[neighborhood[j].first];
-          p2 = point[neighborhood[j].second];
-
-          // vectors pointing to the two neighbor nodes
-          Vector e1 = p2-p0;
-          Vector e2 = p1-p0;
-
-          // Get vector between neighbors
-          p12 = p1-p2;
-
-          // Squared distance between neighbors
-          double e = Dot(p12,p12);
-
-          if (e > 0.0)
-          {
-            double dot = Dot(p1-p0,p12)/e;
-            p3 = p1 - dot*p12;
-
-            double A = (p1-p3).length();
-            double B = (p0-p3).length();
-            double C = (p2-p3).length();
-
-            // if B approaches zero, we have a flat
-            // triangle, hence we need to bounce back the node
-            // towards the other side. Hence ignoring these
-            // directions
-            if (B >= 10*epsilon)
-            {
-              if (dot < 0.0) A = -A;
-              if (dot > 1.0) C = -C;
-              totw += (A+C)/B;
-
-              d += (A/B)*e1 + (C/B)*e2;
-            }
-          }
-        }
-
-        /// set the displacement vector for this node.
-        if (totw != 0.0) disp[idx] = d * (1.0 / totw);
-      }
-
-      if (it % 2 == 0)
-      {
-        for (VMesh::Node::index_type idx=0; idx<num_nodes;idx++)
-          point[idx] = point[idx]+ lambda*disp[idx];
+        for (size_t idx = begin; idx < end; idx++)
+          next[idx] = cur[idx] + factor*desbrun_displacement(cur,nbrs,idx,epsilon);
       }
       else
       {
-        for (VMesh::Node::index_type idx=0; idx<num_nodes;idx++)
-          point[idx] = point[idx]+  mu*disp[idx];
+        for (size_t idx = begin; idx < end; idx++)
+          next[idx] = cur[idx] + factor*equal_weight_displacement(cur,nbrs,idx);
       }
-      update_progress_max(it,num_iter);
-    }
+    });
+
+    std::swap(cur,next);
+    update_progress_max(it,num_iter);
   }
 
+  if (cur != point) std::copy(cur,cur+num_nodes,point);
+
   return (true);
 }
 
@@ -42,10 +42,14 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Logging/Log.h>
+#include <Core/Logging/ExecutionTrace.h>
 
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <type_traits>
 #include <boost/shared_array.hpp>
 
 using namespace SCIRun;
@@ -56,6 +60,105 @@ using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::FiniteElements;
 using namespace SCIRun::Core::Logging;
 
+namespace
+{
+// Convert a conductivity table matrix with 1, 6 or 9 columns into tensors
+void convert_conductivity_table(DenseMatrixHandle ctable,
+                                std::vector<std::pair<std::string, Tensor>>& tensors)
+{
+  tensors.clear();
+  auto mat = ctable;
+  // Only if we can convert it into a dense matrix, otherwise skip it
+  if (mat)
+  {
+    auto data = mat->data();
+    size_type m = mat->nrows();
+    size_type n = mat->ncols();
+    Tensor tensor;
+
+    // Case the table has isotropic conductivities
+    if (mat->ncols() == 1)
+    {
+      for (size_type p=0; p<m;p++)
+      {
+        // Set the diagonals to the proper version.
+        tensor.val(0,0) = data[p*n+0];
+        tensor.val(1,0) = 0.0;
+        tensor.val(2,0) = 0.0;
+        tensor.val(0,1) = 0.0;
+        tensor.val(1,1) = data[p*n+0];
+        tensor.val(2,1) = 0.0;
+        tensor.val(0,2) = 0.0;
+        tensor.val(1,2) = 0.0;
+        tensor.val(2,2) = data[p*n+0];
+        tensors.push_back(std::make_pair("",tensor));
+      }
+    }
+
+    // Use our compressed way of storing tensors
+    if (mat->ncols() == 6)
+    {
+      for (size_type p=0; p<m;p++)
+      {
+        tensor.val(0,0) = data[0+p*n];
+        tensor.val(1,0) = data[1+p*n];
+        tensor.val(2,0) = data[2+p*n];
+        tensor.val(0,1) = data[1+p*n];
+        tensor.val(1,1) = data[3+p*n];
+        tensor.val(2,1) = data[4+p*n];
+        tensor.val(0,2) = data[2+p*n];
+        tensor.val(1,2) = data[4+p*n];
+        tensor.val(2,2) = data[5+p*n];
+        tensors.push_back(std::make_pair("",tensor));
+      }
+    }
+
+    // Use the full symmetric tensor. We will make the tensor symmetric here.
+    if (mat->ncols() == 9)
+    {
+      for (size_type p=0; p<m;p++)
+      {
+        tensor.val(0,0) = data[0+p*n];
+        tensor.val(1,0) = data[1+p*n];
+        tensor.val(2,0) = data[2+p*n];
+        tensor.val(0,1) = data[1+p*n];
+        tensor.val(1,1) = data[4+p*n];
+        tensor.val(2,1) = data[5+p*n];
+        tensor.val(0,2) = data[2+p*n];
+        tensor.val(1,2) = data[5+p*n];
+        tensor.val(2,2) = data[8+p*n];
+        tensors.push_back(std::make_pair("",tensor));
+      }
+    }
+  }
+}
+
+void create_numerical_integration(VMesh* mesh,
+                                  std::vector<VMesh::coords_type>& p,
+                                  std::vector<double>& w,
+                                  std::vector<std::vector<double>>& d)
+{
+  int int_basis = 1;
+  if (mesh->is_quad_element() ||
+      mesh->is_hex_element() ||
+      mesh->is_prism_element())
+  {
+    int_basis = 2;
+  }
+
+  mesh->get_gaussian_scheme(p,w,int_basis);
+  d.resize(p.size());
+  for (size_t j=0; j<p.size();j++)
+  {
+    mesh->get_derivate_weights(p[j],d[j],1);
+    size_t pad_size = ( 3 - p[ j ].size() ) * d[ j ].size();
+
+    if (pad_size > 0)
+      d[j].resize(pad_size + d[j].size(), 0.0);
+  }
+}
+}
+
 namespace SCIRun {
 	namespace Core {
 		namespace Algorithms {
@@ -70,13 +173,69 @@ template <typename T>
 class BuildFEMatrixAlgoImpl
 {
 public:
-  explicit BuildFEMatrixAlgoImpl(const AlgorithmBase* algo) : algo_(algo) {}
+  BuildFEMatrixAlgoImpl(const AlgorithmBase* algo, SharedPointer<FEAssemblyPlan>* plan) : algo_(algo), plan_(plan) {}
   bool run(FieldHandle input, Datatypes::DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const;
 private:
+  bool run_plan(FieldHandle input, Datatypes::DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const;
+
   const AlgorithmBase* algo_;
-  mutable int generation_ = 0;
-  mutable std::vector<std::vector<T>> basis_values_;
-  mutable matrix_pointer_type<T> basis_fematrix_;
+  // Assembly plan owned by the algorithm, only used for real valued fields
+  SharedPointer<FEAssemblyPlan>* plan_;
+};
+
+// Reusable assembly of linear elements. The sparsity pattern, the position
+// of every local stiffness entry in the global matrix and the gradients of
+// the basis functions at the integration points only depend on the mesh.
+// A new set of conductivities is hence assembled with a scatter-add, either
+// over the rows of the matrix, which are distributed over the threads, or
+// over groups of element blocks that share no nodes, in which every element
+// matrix is computed once. In both cases no two threads write the same entry.
+class FEAssemblyPlan
+{
+public:
+  static bool supports(FieldHandle input);
+
+  bool matches(FieldHandle input) const;
+  bool build(const AlgorithmBase* algo, FieldHandle input);
+  bool assemble(const AlgorithmBase* algo, FieldHandle input,
+                const std::vector<std::pair<std::string, Tensor>>& tensors,
+                bool colored, SparseRowMatrixHandle& output);
+
+private:
+  static constexpr size_t grainSize = 1024;
+  static constexpr index_type blockSize = 64;
+
+  void collect_columns(index_type row, std::vector<index_type>& cols) const;
+  void color_elements();
+  void scatter_rows(double* values) const;
+  void scatter_colors(double* values) const;
+
+  std::weak_ptr<Mesh> mesh_;
+  unsigned int generation_ = 0;
+
+  index_type num_nodes_ = 0;
+  index_type num_elems_ = 0;
+  index_type local_dimension_ = 0;
+  index_type num_points_ = 0;
+
+  SparseRowMatrixHandle pattern_;
+  // Per element and integration point the x, y and z component of the
+  // gradient of every basis function in world space
+  std::vector<double> gradients_;
+  // Quadrature weight times the jacobian per element and integration point
+  std::vector<double> weights_;
+  // Index into the value array of every local stiffness matrix entry
+  std::vector<index_type> scatter_;
+  // Nodes of every element
+  std::vector<index_type> elem_nodes_;
+  // The local rows (element*local_dimension+node) that add to a matrix row
+  std::vector<index_type> row_offsets_;
+  std::vector<index_type> row_entries_;
+  // Element blocks sorted by color, blocks of one color share no nodes
+  std::vector<index_type> color_offsets_;
+  std::vector<index_type> color_blocks_;
+  // Scratch space for the tensor of every element: xx, xy, xz, yy, yz, zz
+  std::vector<double> conductivities_;
 };
 
 // Helper class
@@ -184,73 +343,7 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
   // We added a second system of adding a conductivity table, using a matrix
   // Convert that matrix into the conductivity table
   if (ctable)
-  {
-    tensors_.clear();
-    auto mat = ctable;
-    // Only if we can convert it into a dense matrix, otherwise skip it
-    if (mat)
-    {
-      auto data = mat->data();
-      size_type m = mat->nrows();
-      size_type n = mat->ncols();
-      Tensor tensor;
-
-      // Case the table has isotropic conductivities
-      if (mat->ncols() == 1)
-      {
-        for (size_type p=0; p<m;p++)
-        {
-          // Set the diagonals to the proper version.
-          tensor.val(0,0) = data[p*n+0];
-          tensor.val(1,0) = 0.0;
-          tensor.val(2,0) = 0.0;
-          tensor.val(0,1) = 0.0;
-          tensor.val(1,1) = data[p*n+0];
-          tensor.val(2,1) = 0.0;
-          tensor.val(0,2) = 0.0;
-          tensor.val(1,2) = 0.0;
-          tensor.val(2,2) = data[p*n+0];
-          tensors_.push_back(std::make_pair("",tensor));
-        }
-      }
-
-      // Use our compressed way of storing tensors
-      if (mat->ncols() == 6)
-      {
-        for (size_type p=0; p<m;p++)
-        {
-          tensor.val(0,0) = data[0+p*n];
-          tensor.val(1,0) = data[1+p*n];
-          tensor.val(2,0) = data[2+p*n];
-          tensor.val(0,1) = data[1+p*n];
-          tensor.val(1,1) = data[3+p*n];
-          tensor.val(2,1) = data[4+p*n];
-          tensor.val(0,2) = data[2+p*n];
-          tensor.val(1,2) = data[4+p*n];
-          tensor.val(2,2) = data[5+p*n];
-          tensors_.push_back(std::make_pair("",tensor));
-        }
-      }
-
-      // Use the full symmetric tensor. We will make the tensor symmetric here.
-      if (mat->ncols() == 9)
-      {
-        for (size_type p=0; p<m;p++)
-        {
-          tensor.val(0,0) = data[0+p*n];
-          tensor.val(1,0) = data[1+p*n];
-          tensor.val(2,0) = data[2+p*n];
-          tensor.val(0,1) = data[1+p*n];
-          tensor.val(1,1) = data[4+p*n];
-          tensor.val(2,1) = data[5+p*n];
-          tensor.val(0,2) = data[2+p*n];
-          tensor.val(1,2) = data[5+p*n];
-          tensor.val(2,2) = data[8+p*n];
-          tensors_.push_back(std::make_pair("",tensor));
-        }
-      }
-    }
-  }
+    convert_conductivity_table(ctable, tensors_);
 
   success_.resize(numprocessors_,true);
 
@@ -291,24 +384,7 @@ FEMBuilder<T>::create_numerical_integration(std::vector<VMesh::coords_type> &p,
                                          std::vector<std::vector<double> > &d)
 {
   //ScopedTimeLogger s1("FEMBuilder::create_numerical_integration");
-  int int_basis = 1;
-  if (mesh_->is_quad_element() ||
-      mesh_->is_hex_element() ||
-      mesh_->is_prism_element())
-  {
-    int_basis = 2;
-  }
-
-  mesh_->get_gaussian_scheme(p,w,int_basis);
-  d.resize(p.size());
-  for (size_t j=0; j<p.size();j++)
-  {
-    mesh_->get_derivate_weights(p[j],d[j],1);
-    size_t pad_size = ( 3 - p[ j ].size() ) * d[ j ].size();
-
-    if (pad_size > 0)
-      d[j].resize(pad_size + d[j].size(), 0.0);
-  }
+  ::create_numerical_integration(mesh_, p, w, d);
 }
 
 /// build line of the local stiffness matrix
@@ -1072,147 +1148,496 @@ FEMBuilder<T>::parallel(int proc_num)
 
 const AlgorithmParameterName BuildFEMatrixAlgo::ForceSymmetry("ForceSymmetry");
 const AlgorithmParameterName BuildFEMatrixAlgo::GenerateBasis("GenerateBasis");
+const AlgorithmParameterName BuildFEMatrixAlgo::ElementColoring("ElementColoring");
 
-template <typename T>
-bool
-BuildFEMatrixAlgoImpl<T>::run(FieldHandle input, DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const
+bool FEAssemblyPlan::supports(FieldHandle input)
 {
-  ScopedAlgorithmStatusReporter s(algo_, "BuildFEMatrix");
+  auto mesh = input->vmesh();
+  return mesh->is_linearmesh() && mesh->dimensionality() >= 1 &&
+    mesh->num_nodes_per_elem() > 0;
+}
 
-  if (!input)
+bool FEAssemblyPlan::matches(FieldHandle input) const
+{
+  auto mesh = mesh_.lock();
+  return mesh && mesh == input->mesh() &&
+    generation_ == static_cast<unsigned int>(input->vmesh()->generation());
+}
+
+void FEAssemblyPlan::collect_columns(index_type row, std::vector<index_type>& cols) const
+{
+  cols.clear();
+  for (index_type p = row_offsets_[row]; p < row_offsets_[row+1]; p++)
   {
-    algo_->error("Could not obtain input field");
-    return false;
+    const index_type* nodes = &elem_nodes_[(row_entries_[p]/local_dimension_)*local_dimension_];
+    cols.insert(cols.end(), nodes, nodes + local_dimension_);
   }
+  std::sort(cols.begin(), cols.end());
+  cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+}
 
-  if (input->vfield()->is_vector())
+bool FEAssemblyPlan::build(const AlgorithmBase* algo, FieldHandle input)
+{
+  auto mesh = input->vmesh();
+  mesh_.reset();
+  pattern_.reset();
+
+  VMesh::Node::size_type num_nodes;
+  VMesh::Elem::size_type num_elems;
+  mesh->size(num_nodes);
+  mesh->size(num_elems);
+  if (num_nodes == 0)
   {
-    algo_->error("This function has not yet been defined for elements with vector data");
+    algo->error("Mesh size < 0");
     return false;
   }
 
-  if (input->vfield()->basis_order()!=0)
+  std::vector<VMesh::coords_type> points;
+  std::vector<double> weights;
+  std::vector<std::vector<double>> derivatives;
+  create_numerical_integration(mesh, points, weights, derivatives);
+
+  const index_type ld = mesh->num_nodes_per_elem();
+  const index_type np = points.size();
+  num_nodes_ = num_nodes;
+  num_elems_ = num_elems;
+  local_dimension_ = ld;
+  num_points_ = np;
+
+  elem_nodes_.resize(num_elems_*ld);
+  gradients_.resize(num_elems_*np*ld*3);
+  weights_.resize(num_elems_*np);
+
+  // Node lists, basis gradients and integration weights of every element
+  std::atomic<bool> negative(false);
+  const double vol = mesh->get_element_size();
+  Parallel::For(0, num_elems_, grainSize, [&](size_t begin, size_t end)
   {
-    algo_->error("This function has only been defined for data that is located at the elements");
+    VMesh::Node::array_type nodes;
+    double Ji[9];
+    for (size_t e = begin; e < end && !negative; e++)
+    {
+      const VMesh::Elem::index_type elem(e);
+      mesh->get_nodes(nodes, elem);
+      for (index_type k = 0; k < ld; k++)
+        elem_nodes_[e*ld+k] = nodes[k];
+
+      for (index_type q = 0; q < np; q++)
+      {
+        auto detJ = mesh->inverse_jacobian(points[q], elem, Ji);
+        if (detJ <= 0.0)
+        {
+          negative = true;
+          return;
+        }
+        weights_[e*np+q] = detJ*weights[q]*vol;
+
+        const double* Nx = &derivatives[q][0];
+        const double* Ny = &derivatives[q][ld];
+        const double* Nz = &derivatives[q][2*ld];
+        double* g = &gradients_[(e*np+q)*ld*3];
+        for (index_type k = 0; k < ld; k++)
+        {
+          g[3*k]   = Nx[k]*Ji[0] + Ny[k]*Ji[1] + Nz[k]*Ji[2];
+          g[3*k+1] = Nx[k]*Ji[3] + Ny[k]*Ji[4] + Nz[k]*Ji[5];
+          g[3*k+2] = Nx[k]*Ji[6] + Ny[k]*Ji[7] + Nz[k]*Ji[8];
+        }
+      }
+    }
+  });
+
+  if (negative)
+  {
+    algo->error("Mesh has elements with negative jacobians, check the order of the nodes that define an element");
     return false;
   }
 
-  if (ctable)
+  // Bucket the local rows by the matrix row they add to
+  row_offsets_.assign(num_nodes_+1, 0);
+  for (auto node : elem_nodes_)
+    row_offsets_[node+1]++;
+  std::partial_sum(row_offsets_.begin(), row_offsets_.end(), row_offsets_.begin());
+
+  row_entries_.resize(elem_nodes_.size());
+  std::vector<index_type> fill(row_offsets_.begin(), row_offsets_.end()-1);
+  for (size_t p = 0; p < elem_nodes_.size(); p++)
+    row_entries_[fill[elem_nodes_[p]]++] = p;
+
+  // Sparsity pattern: the nodes of all the elements sharing a node
+  std::vector<index_type> rows(num_nodes_+1, 0);
+  Parallel::For(0, num_nodes_, grainSize, [&](size_t begin, size_t end)
   {
-    if ((ctable->ncols() != 1)&&(ctable->ncols() != 6)&&(ctable->ncols() != 9))
+    std::vector<index_type> cols;
+    for (size_t i = begin; i < end; i++)
     {
-      algo_->error("Conductivity table needs to have 1, 6, or 9 columns");
-      return false;
+      collect_columns(i, cols);
+      rows[i+1] = cols.size();
     }
-    if (ctable->nrows() == 0)
+  });
+  std::partial_sum(rows.begin(), rows.end(), rows.begin());
+
+  std::vector<index_type> columns(rows[num_nodes_]);
+  Parallel::For(0, num_nodes_, grainSize, [&](size_t begin, size_t end)
+  {
+    std::vector<index_type> cols;
+    for (size_t i = begin; i < end; i++)
     {
-      algo_->error("ConductivityTable is empty");
-      return false;
+      collect_columns(i, cols);
+      std::copy(cols.begin(), cols.end(), columns.begin() + rows[i]);
     }
-  }
+  });
 
-  FEMBuilder<T> builder(algo_);
+  auto pattern = makeShared<SparseRowMatrix>(num_nodes_, num_nodes_, rows.data(), columns.data(), columns.size());
+  pattern->makeCompressed();
 
-  if (algo_->get(BuildFEMatrixAlgo::GenerateBasis).toBool())
+  // Location of every local stiffness entry in the value array
+  scatter_.resize(num_elems_*ld*ld);
+  const auto outer = pattern->outerIndexPtr();
+  const auto inner = pattern->innerIndexPtr();
+  Parallel::For(0, num_nodes_, grainSize, [&](size_t begin, size_t end)
   {
-    if (!ctable)
+    for (size_t i = begin; i < end; i++)
     {
-      std::vector<std::pair<std::string,Tensor> > tens;
+      const auto first = inner + outer[i];
+      const auto last = inner + outer[i+1];
+      for (index_type p = row_offsets_[i]; p < row_offsets_[i+1]; p++)
+      {
+        const index_type entry = row_entries_[p];
+        const index_type* nodes = &elem_nodes_[(entry/ld)*ld];
+        index_type* s = &scatter_[entry*ld];
+        for (index_type j = 0; j < ld; j++)
+          s[j] = std::lower_bound(first, last, nodes[j]) - inner;
+      }
+    }
+  });
+
+  color_offsets_.clear();
+  color_blocks_.clear();
+  conductivities_.resize(num_elems_*6);
+  pattern_ = pattern;
+  mesh_ = input->mesh();
+  generation_ = mesh->generation();
+  return true;
+}
 
-      input->properties().get_property("conductivity_table",tens);
+bool FEAssemblyPlan::assemble(const AlgorithmBase* algo, FieldHandle input,
+                              const std::vector<std::pair<std::string, Tensor>>& tensors,
+                              bool colored, SparseRowMatrixHandle& output)
+{
+  auto field = input->vfield();
 
-      if (!tens.empty())
+  std::atomic<bool> out_of_range(false);
+  Parallel::For(0, num_elems_, grainSize, [&](size_t begin, size_t end)
+  {
+    Tensor tensor;
+    for (size_t e = begin; e < end; e++)
+    {
+      const VMesh::Elem::index_type elem(e);
+      if (tensors.empty())
+      {
+        field->get_value(tensor, elem);
+      }
+      else
       {
-        ctable.reset(new DenseMatrix(tens.size(), 1));
-        auto data = ctable->data();
-        for (size_t i=0; i<tens.size();i++)
+        int tensor_index;
+        field->get_value(tensor_index, elem);
+        if (tensor_index < 0 || tensor_index >= static_cast<int>(tensors.size()))
         {
-          auto t = tens[i].second.val(0,0);
-          data[i] = t;
+          out_of_range = true;
+          return;
         }
+        tensor = tensors[tensor_index].second;
       }
+      double* c = &conductivities_[6*e];
+      c[0] = tensor.val(0,0);
+      c[1] = tensor.val(0,1);
+      c[2] = tensor.val(0,2);
+      c[3] = tensor.val(1,1);
+      c[4] = tensor.val(1,2);
+      c[5] = tensor.val(2,2);
     }
+  });
 
-    if (ctable)
+  if (out_of_range)
+  {
+    algo->error("Conductivity index is larger than the conductivity table");
+    return false;
+  }
+
+  // The output is handed downstream, so it cannot share the value array
+  auto stiffness = makeShared<SparseRowMatrix>(*pattern_);
+  if (colored)
+  {
+    if (color_offsets_.empty())
+      color_elements();
+    scatter_colors(stiffness->valuePtr());
+  }
+  else
+  {
+    scatter_rows(stiffness->valuePtr());
+  }
+
+  output = stiffness;
+  return true;
+}
+
+void FEAssemblyPlan::scatter_rows(double* values) const
+{
+  const index_type ld = local_dimension_;
+  const index_type np = num_points_;
+  const auto outer = pattern_->outerIndexPtr();
+  Parallel::For(0, num_nodes_, grainSize, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
     {
-      auto nconds = ctable->nrows();
-      if ( (input->vmesh()->generation() != generation_) ||
-          (!basis_fematrix_) )
+      std::fill(values + outer[i], values + outer[i+1], 0.0);
+      for (index_type p = row_offsets_[i]; p < row_offsets_[i+1]; p++)
       {
-        auto con = makeShared<DenseMatrix>(nconds, 1, 0.0);
-        auto data = con->data();
-
-        if (!builder.build_matrix(input, con, basis_fematrix_) )
+        const index_type entry = row_entries_[p];
+        const index_type e = entry/ld;
+        const index_type k = entry - e*ld;
+        const double* c = &conductivities_[6*e];
+        if (c[0] == 0.0 && c[1] == 0.0 && c[2] == 0.0 &&
+            c[3] == 0.0 && c[4] == 0.0 && c[5] == 0.0)
+          continue;
+
+        const index_type* s = &scatter_[entry*ld];
+        for (index_type q = 0; q < np; q++)
         {
-          algo_->error("Build matrix method failed when building FEMatrix structure");
-          return false;
+          const double* g = &gradients_[(e*np+q)*ld*3];
+          const double w = weights_[e*np+q];
+          // Conductivity tensor times the gradient of basis function k
+          const double sx = w*(g[3*k]*c[0] + g[3*k+1]*c[1] + g[3*k+2]*c[2]);
+          const double sy = w*(g[3*k]*c[1] + g[3*k+1]*c[3] + g[3*k+2]*c[4]);
+          const double sz = w*(g[3*k]*c[2] + g[3*k+1]*c[4] + g[3*k+2]*c[5]);
+          for (index_type j = 0; j < ld; j++)
+            values[s[j]] += g[3*j]*sx + g[3*j+1]*sy + g[3*j+2]*sz;
         }
+      }
+    }
+  });
+}
 
-        if (!basis_fematrix_)
-        {
-          algo_->error("Failed to build FEMatrix structure");
-          return false;
-        }
+// Greedy coloring of blocks of consecutive elements: every block gets the
+// lowest color that none of the blocks sharing one of its nodes has. Whole
+// blocks are assembled by one thread, which keeps the writes of neighboring
+// elements close together.
+void FEAssemblyPlan::color_elements()
+{
+  const index_type ld = local_dimension_;
+  const index_type block_entries = ld*blockSize;
+  const index_type num_blocks = (num_elems_ + blockSize - 1)/blockSize;
+
+  // Blocks touching every node, the entries of a row are sorted by element
+  std::vector<index_type> node_offsets(num_nodes_+1, 0);
+  std::vector<index_type> node_blocks;
+  node_blocks.reserve(num_nodes_*4);
+  for (index_type i = 0; i < num_nodes_; i++)
+  {
+    index_type previous = -1;
+    for (index_type p = row_offsets_[i]; p < row_offsets_[i+1]; p++)
+    {
+      const index_type block = row_entries_[p]/block_entries;
+      if (block != previous)
+        node_blocks.push_back(block);
+      previous = block;
+    }
+    node_offsets[i+1] = node_blocks.size();
+  }
 
-        basis_values_.resize(nconds);
-        for (size_type i=0; i < nconds; i++)
-        {
-          matrix_pointer_type<T> stiffness;
-          /// @todo: can initialize array using std::fill
-          data[i] = 1.0;
+  std::vector<index_type> color(num_blocks, -1);
+  std::vector<index_type> visited(num_nodes_, -1);
+  std::vector<index_type> used;
+  for (index_type b = 0; b < num_blocks; b++)
+  {
+    const index_type last = std::min((b+1)*blockSize, num_elems_)*ld;
+    for (index_type n = b*block_entries; n < last; n++)
+    {
+      const index_type node = elem_nodes_[n];
+      if (visited[node] == b)
+        continue;
+      visited[node] = b;
+      for (index_type p = node_offsets[node]; p < node_offsets[node+1]; p++)
+      {
+        const index_type neighbor = color[node_blocks[p]];
+        if (neighbor >= 0)
+          used[neighbor] = b;
+      }
+    }
+    index_type c = 0;
+    while (c < static_cast<index_type>(used.size()) && used[c] == b)
+      c++;
+    if (c == static_cast<index_type>(used.size()))
+      used.push_back(-1);
+    color[b] = c;
+  }
 
-          if (!builder.build_matrix(input, con, stiffness) )
-          {
-            algo_->error("Build matrix method failed for one of the tissue types");
-            return false;
-          }
+  color_offsets_.assign(used.size()+1, 0);
+  for (auto c : color)
+    color_offsets_[c+1]++;
+  std::partial_sum(color_offsets_.begin(), color_offsets_.end(), color_offsets_.begin());
 
-          if (!stiffness)
+  color_blocks_.resize(num_blocks);
+  std::vector<index_type> fill(color_offsets_.begin(), color_offsets_.end()-1);
+  for (index_type b = 0; b < num_blocks; b++)
+    color_blocks_[fill[color[b]]++] = b;
+}
+
+void FEAssemblyPlan::scatter_colors(double* values) const
+{
+  const index_type ld = local_dimension_;
+  const index_type np = num_points_;
+  Parallel::For(0, pattern_->nonZeros(), 16*grainSize, [&](size_t begin, size_t end)
+  {
+    std::fill(values + begin, values + end, 0.0);
+  });
+
+  for (size_t color = 0; color+1 < color_offsets_.size(); color++)
+  {
+    Parallel::For(color_offsets_[color], color_offsets_[color+1], 1, [&](size_t begin, size_t end)
+    {
+      std::vector<double> lk(ld*ld);
+      for (size_t b = begin; b < end; b++)
+      {
+        const index_type first = color_blocks_[b]*blockSize;
+        const index_type last = std::min(first + blockSize, num_elems_);
+        for (index_type e = first; e < last; e++)
+        {
+          const double* c = &conductivities_[6*e];
+          if (c[0] == 0.0 && c[1] == 0.0 && c[2] == 0.0 &&
+              c[3] == 0.0 && c[4] == 0.0 && c[5] == 0.0)
+            continue;
+
+          // Element matrix, computed as upper triangle as it is symmetric
+          std::fill(lk.begin(), lk.end(), 0.0);
+          for (index_type q = 0; q < np; q++)
           {
-            algo_->error("Failed to build FEMatrix component for one of the tissue types");
-            return false;
+            const double* g = &gradients_[(e*np+q)*ld*3];
+            const double w = weights_[e*np+q];
+            for (index_type k = 0; k < ld; k++)
+            {
+              const double sx = w*(g[3*k]*c[0] + g[3*k+1]*c[1] + g[3*k+2]*c[2]);
+              const double sy = w*(g[3*k]*c[1] + g[3*k+1]*c[3] + g[3*k+2]*c[4]);
+              const double sz = w*(g[3*k]*c[2] + g[3*k+1]*c[4] + g[3*k+2]*c[5]);
+              for (index_type j = k; j < ld; j++)
+                lk[k*ld+j] += g[3*j]*sx + g[3*j+1]*sy + g[3*j+2]*sz;
+            }
           }
 
-          basis_values_[i].resize(stiffness->nonZeros());
-          for (size_type p=0; p< stiffness->nonZeros(); p++)
+          const index_type* s = &scatter_[e*ld*ld];
+          for (index_type k = 0; k < ld; k++)
           {
-            basis_values_[i][p] = stiffness->valuePtr()[p];
+            values[s[k*ld+k]] += lk[k*ld+k];
+            for (index_type j = k+1; j < ld; j++)
+            {
+              values[s[k*ld+j]] += lk[k*ld+j];
+              values[s[j*ld+k]] += lk[k*ld+j];
+            }
           }
-          data[i] = 0.0;
         }
-
-        generation_ = input->vmesh()->generation();
       }
+    });
+  }
+}
 
-      output.reset(basis_fematrix_->clone());
-
-      auto sum = output->valuePtr();
-      auto cdata = ctable->data();
-      auto n = ctable->ncols();
+template <typename T>
+bool
+BuildFEMatrixAlgoImpl<T>::run_plan(FieldHandle input, DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const
+{
+  if constexpr (std::is_same<T, double>::value)
+  {
+    const bool keepPlan = algo_->get(BuildFEMatrixAlgo::GenerateBasis).toBool();
+    const bool colored = algo_->get(BuildFEMatrixAlgo::ElementColoring).toBool();
 
-      if (!basis_values_.empty())
+    std::vector<std::pair<std::string, Tensor>> tensors;
+    if (ctable)
+      convert_conductivity_table(ctable, tensors);
+    else if (keepPlan)
+      input->properties().get_property("conductivity_table", tensors);
+
+    // Without GenerateBasis the plan only lives for this run
+    SharedPointer<FEAssemblyPlan> localPlan;
+    auto& plan = keepPlan ? *plan_ : localPlan;
+    if (!plan || !plan->matches(input))
+    {
+      plan.reset();
+      ScopedTraceSpan span("BuildFEMatrix::build_plan");
+      auto newPlan = makeShared<FEAssemblyPlan>();
+      if (!newPlan->build(algo_, input))
       {
-        for (size_t p=0; p < basis_values_[0].size(); p++)
-          sum[p] = 0.0;
+        algo_->error("Build matrix method failed when building FEMatrix structure");
+        return false;
       }
+      plan = newPlan;
+    }
 
-      for (auto i=0; i<nconds; i++)
-      {
-        auto weight = cdata[i*n];
-        for (size_t p=0; p < basis_values_[i].size(); p++)
-        {
-          sum[p] += weight * basis_values_[i][p];
-        }
-      }
+    {
+      ScopedTraceSpan span("BuildFEMatrix::assemble");
+      span.addArg("colored", colored ? 1 : 0);
+      if (!plan->assemble(algo_, input, tensors, colored, output))
+        return false;
+    }
 
+    if (algo_->get(BuildFEMatrixAlgo::ForceSymmetry).toBool())
+    {
+      matrix_type<T> transpose = output->transpose();
+      output.reset(new matrix_type<T>(0.5*(transpose + *output)));
     }
-    else
+    return true;
+  }
+  else
+  {
+    return false;
+  }
+}
+
+template <typename T>
+bool
+BuildFEMatrixAlgoImpl<T>::run(FieldHandle input, DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const
+{
+  ScopedAlgorithmStatusReporter s(algo_, "BuildFEMatrix");
+
+  if (!input)
+  {
+    algo_->error("Could not obtain input field");
+    return false;
+  }
+
+  if (input->vfield()->is_vector())
+  {
+    algo_->error("This function has not yet been defined for elements with vector data");
+    return false;
+  }
+
+  if (input->vfield()->basis_order()!=0)
+  {
+    algo_->error("This function has only been defined for data that is located at the elements");
+    return false;
+  }
+
+  if (ctable)
+  {
+    if ((ctable->ncols() != 1)&&(ctable->ncols() != 6)&&(ctable->ncols() != 9))
     {
-      algo_->error("No conductivity table present: The generate_basis option only works for indexed conductivities");
+      algo_->error("Conductivity table needs to have 1, 6, or 9 columns");
+      return false;
+    }
+    if (ctable->nrows() == 0)
+    {
+      algo_->error("ConductivityTable is empty");
       return false;
     }
   }
 
+  if ((algo_->get(BuildFEMatrixAlgo::GenerateBasis).toBool() ||
+       algo_->get(BuildFEMatrixAlgo::ElementColoring).toBool()) &&
+      plan_ && FEAssemblyPlan::supports(input))
+  {
+    return run_plan(input, ctable, output);
+  }
+
+  FEMBuilder<T> builder(algo_);
+
   if (!builder.build_matrix(input,ctable,output) )
   {
     algo_->error("Build matrix method failed to build output matrix");
@@ -1241,7 +1666,7 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
   if (field && field->vfield() && field->vfield()->is_complex_double())
 	{
 		matrix_pointer_type<complex> stiffness;
-	  BuildFEMatrixAlgoImpl<complex> impl(this);
+	  BuildFEMatrixAlgoImpl<complex> impl(this, nullptr);
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.--complex detected	");
 		output[Stiffness_Matrix_Complex] = stiffness;
@@ -1249,7 +1674,8 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
 	else
 	{
 		matrix_pointer_type<double> stiffness;
-	  BuildFEMatrixAlgoImpl<double> impl(this);
+	  Guard g(planLock_.get());
+	  BuildFEMatrixAlgoImpl<double> impl(this, &plan_);
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
 		output[Stiffness_Matrix] = stiffness;
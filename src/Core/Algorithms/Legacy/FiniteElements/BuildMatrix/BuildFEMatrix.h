@@ -31,6 +31,7 @@
 
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Thread/Mutex.h>
 #include <Core/Algorithms/Legacy/FiniteElements/share.h>
 
 namespace SCIRun {
@@ -38,11 +39,14 @@ namespace SCIRun {
 		namespace Algorithms {
 			namespace FiniteElements {
 
+class FEAssemblyPlan;
+
 class SCISHARE BuildFEMatrixAlgo : public AlgorithmBase
 {
   public:
     static const AlgorithmParameterName ForceSymmetry;
     static const AlgorithmParameterName GenerateBasis;
+    static const AlgorithmParameterName ElementColoring;
 
     static const AlgorithmInputName Conductivity_Table;
     static const AlgorithmOutputName Stiffness_Matrix;
@@ -55,12 +59,21 @@ class SCISHARE BuildFEMatrixAlgo : public AlgorithmBase
       addParameter(ForceSymmetry, false);
 
       // Store intermediate results to speed up computation for
-      // for instance conductivity search
-      // This option only works for an indexed conductivity table
+      // for instance conductivity search. The sparsity pattern and the
+      // basis gradients of every element are kept as long as the mesh
+      // does not change, so only the conductivities are scattered again
       addParameter(GenerateBasis, false);
+
+      // Assemble linear elements by groups of elements that share no nodes,
+      // so every element matrix is computed once instead of once per node
+      addParameter(ElementColoring, false);
     }
 
     AlgorithmOutput run(const AlgorithmInput &) const override;
+
+  private:
+    mutable std::shared_ptr<FEAssemblyPlan> plan_;
+    mutable Thread::Mutex planLock_;
 };
 
 }}}}
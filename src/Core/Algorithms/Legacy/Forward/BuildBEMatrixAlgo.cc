@@ -38,6 +38,7 @@
 #include <Core/Algorithms/Legacy/Forward/BuildBEMatrixAlgo.h>
 
 #include <algorithm>
+#include <array>
 #include <map>
 #include <iostream>
 #include <string>
@@ -54,11 +55,13 @@
 #include <Core/GeometryPrimitives/Vector.h>
 #include <Core/GeometryPrimitives/Point.h>
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <Core/Thread/Parallel.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms::Forward;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
 
 ALGORITHM_PARAMETER_DEF(Forward, FieldNameList);
 ALGORITHM_PARAMETER_DEF(Forward, FieldTypeList);
@@ -491,6 +494,45 @@ double BuildBEMatrixBase::do_radon_g(
   return g2 * aV.length();
 }
 
+namespace
+{
+  // Triangles of a surface, read from the mesh once so that the kernels can
+  // evaluate rows of a block on several threads at the same time.
+  struct BEMTriangles
+  {
+    explicit BEMTriangles(VMesh* hsurf)
+    {
+      const size_t nfaces = static_cast<size_t>(hsurf->num_faces());
+      nodes.resize(nfaces);
+      points.resize(nfaces);
+
+      VMesh::Node::array_type fnodes;
+      for (size_t f = 0; f < nfaces; ++f)
+      {
+        hsurf->get_nodes(fnodes, VMesh::Face::index_type(f));
+        for (int i = 0; i < 3; ++i)
+        {
+          nodes[f][i] = static_cast<VMesh::index_type>(fnodes[i]);
+          points[f][i] = hsurf->get_point(fnodes[i]);
+        }
+      }
+    }
+
+    size_t size() const { return nodes.size(); }
+
+    std::vector<std::array<VMesh::index_type, 3> > nodes;
+    std::vector<std::array<Point, 3> > points;
+
+    // Only used by the G kernels
+    std::vector<DenseMatrix> cruse_weights;
+    std::vector<Vector> centroids;
+    std::vector<double> areas;
+  };
+
+  // Rows of observation points handed to one task at a time.
+  const size_t bemRowGrain = 4;
+}
+
 class BuildBEMatrixBaseCompute : public BuildBEMatrixBase
 {
 public:
@@ -509,41 +551,28 @@ public:
   MatrixType&,
   double,
   double,
-  const std::vector<double>& );
-};
+  const std::vector<double>&);
 
-void BuildBEMatrixBase::make_auto_G_allocate(VMesh* hsurf, DenseMatrixHandle &h_GG_)
-{
-  auto nnodes = numNodes(hsurf);
-  h_GG_.reset(new DenseMatrix(nnodes, nnodes, 0.0));
-}
-
-void BuildBEMatrixBase::make_auto_G(VMesh* hsurf, DenseMatrixHandle &h_GG_,
-double in_cond, double out_cond, const std::vector<double>& avInn)
-{
-  make_auto_G_allocate(hsurf, h_GG_);
-  BuildBEMatrixBaseCompute::make_auto_G_compute(hsurf, *h_GG_, in_cond, out_cond, avInn);
-}
-
-template <class MatrixType>
-void BuildBEMatrixBaseCompute::make_auto_G_compute(VMesh* hsurf, MatrixType& auto_G,
-  double in_cond, double out_cond, const std::vector<double>& avInn)
-{
-  //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
-  const double mult = 1/(4*M_PI)*(out_cond - in_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
+private:
+  struct RadonRule
+  {
+    RadonRule();
+    DenseMatrix R_W; // Radon Points Weights
+    double s, r;
+  };
 
-  VMesh::Node::array_type nodes;
+  static void prepare_G(BEMTriangles& tris, const std::vector<double>& avInn, const RadonRule& rule);
 
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
+  template <class RowType>
+  static void add_P_row(const Point& pp, VMesh::index_type self, const BEMTriangles& tris, double mult, DenseMatrix& coef, RowType&& row);
 
-  double area;
+  template <class RowType>
+  static void add_G_row(const Vector& op, VMesh::index_type self, const BEMTriangles& tris, const RadonRule& rule, double mult,
+    DenseMatrix& g_coef, DenseMatrix& temp, DenseMatrix& g_values, RowType&& row);
+};
 
+BuildBEMatrixBaseCompute::RadonRule::RadonRule() : R_W(1, 7)
+{
   double sqrt15 = sqrt(15.0);
   //R_W(0,0) = 9/40; // <- Burak! FIX ME!
   R_W(0,0) = 9.0/40.0;
@@ -554,46 +583,127 @@ void BuildBEMatrixBaseCompute::make_auto_G_compute(VMesh* hsurf, MatrixType& aut
   R_W(0,5) = R_W(0,4);
   R_W(0,6) = R_W(0,4);
 
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
+  s = (1 - sqrt15) / 7;
+  r = (1 + sqrt15) / 7;
+}
 
+void BuildBEMatrixBaseCompute::prepare_G(BEMTriangles& tris, const std::vector<double>& avInn, const RadonRule& rule)
+{
+  const size_t nfaces = tris.size();
+  tris.cruse_weights.assign(nfaces, DenseMatrix(3, 7));
+  tris.centroids.resize(nfaces);
+  tris.areas.resize(nfaces);
 
-  hsurf->begin(fi); hsurf->end(fie);
-  for (; fi != fie; ++fi)
+  Parallel::For(0, nfaces, 64, [&](size_t begin, size_t end)
+  {
+    for (size_t f = begin; f < end; ++f)
+    {
+      Vector p1(tris.points[f][0]);
+      Vector p2(tris.points[f][1]);
+      Vector p3(tris.points[f][2]);
+
+      tris.areas[f] = avInn[f];
+      get_cruse_weights(p1, p2, p3, rule.s, rule.r, tris.areas[f], tris.cruse_weights[f]);
+      tris.centroids[f] = (p1 + p2 + p3) / 3.0;
+    }
+  });
+}
+
+// Contributions of all triangles to the P row of one observation point.
+// Triangles that contain the observation point (self) are skipped.
+template <class RowType>
+void BuildBEMatrixBaseCompute::add_P_row(const Point& pp, VMesh::index_type self, const BEMTriangles& tris, double mult,
+  DenseMatrix& coef, RowType&& row)
+{
+  for (size_t f = 0; f < tris.size(); ++f)
   { //! find contributions from every triangle
-    hsurf->get_nodes(nodes, *fi);
-    Vector p1(hsurf->get_point(nodes[0]));
-    Vector p2(hsurf->get_point(nodes[1]));
-    Vector p3(hsurf->get_point(nodes[2]));
+    const std::array<VMesh::index_type, 3>& nodes = tris.nodes[f];
+    if (self == nodes[0] || self == nodes[1] || self == nodes[2])
+      continue;
 
-    area = avInn[*fi];
+    Vector v1 = tris.points[f][0] - pp;
+    Vector v2 = tris.points[f][1] - pp;
+    Vector v3 = tris.points[f][2] - pp;
 
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
-    hsurf->begin(ni); hsurf->end(nie);
-    for (; ni != nie; ++ni)
-    { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf->get_point(ppi));
+    getOmega(v1, v2, v3, coef);
 
-      if (ppi == nodes[0])       bem_sing(p1, p2, p3, 0, g_values);
-      else if (ppi == nodes[1])       bem_sing(p1, p2, p3, 1, g_values);
-      else if (ppi == nodes[2])       bem_sing(p1, p2, p3, 2, g_values);
-      else
-      {
-        get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
+    for (int i=0; i<3; ++i)
+      row(nodes[i]) -= coef(0,i)*mult;
+  }
+}
 
-        for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
+// Contributions of all triangles to the G row of one observation point.
+// Triangles that contain the observation point (self) use the singular
+// weights.
+template <class RowType>
+void BuildBEMatrixBaseCompute::add_G_row(const Vector& op, VMesh::index_type self, const BEMTriangles& tris, const RadonRule& rule,
+  double mult, DenseMatrix& g_coef, DenseMatrix& temp, DenseMatrix& g_values, RowType&& row)
+{
+  for (size_t f = 0; f < tris.size(); ++f)
+  { //! find contributions from every triangle
+    const std::array<VMesh::index_type, 3>& nodes = tris.nodes[f];
+    Vector p1(tris.points[f][0]);
+    Vector p2(tris.points[f][1]);
+    Vector p3(tris.points[f][2]);
+
+    if (self == nodes[0])       bem_sing(p1, p2, p3, 0, g_values);
+    else if (self == nodes[1])       bem_sing(p1, p2, p3, 1, g_values);
+    else if (self == nodes[2])       bem_sing(p1, p2, p3, 2, g_values);
+    else
+    {
+      get_g_coef(p1, p2, p3, op, rule.s, rule.r, tris.centroids[f], g_coef);
 
-        g_values = area * (cruse_weights * temp.transpose());
-      } // else
+      for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*rule.R_W(0,i);
 
-      for (int i=0; i<3; ++i)
-        auto_G(static_cast<uint64_t>(ppi), static_cast<uint64_t>(nodes[i]))+=g_values(i,0)*mult;
+      g_values = tris.areas[f] * (tris.cruse_weights[f] * temp.transpose());
     }
+
+    for (int i=0; i<3; ++i)
+      row(nodes[i]) += g_values(i,0)*mult;
   }
 }
 
+void BuildBEMatrixBase::make_auto_G_allocate(VMesh* hsurf, DenseMatrixHandle &h_GG_)
+{
+  auto nnodes = numNodes(hsurf);
+  h_GG_.reset(new DenseMatrix(nnodes, nnodes, 0.0));
+}
+
+void BuildBEMatrixBase::make_auto_G(VMesh* hsurf, DenseMatrixHandle &h_GG_,
+double in_cond, double out_cond, const std::vector<double>& avInn)
+{
+  make_auto_G_allocate(hsurf, h_GG_);
+  BuildBEMatrixBaseCompute::make_auto_G_compute(hsurf, *h_GG_, in_cond, out_cond, avInn);
+}
+
+template <class MatrixType>
+void BuildBEMatrixBaseCompute::make_auto_G_compute(VMesh* hsurf, MatrixType& auto_G,
+  double in_cond, double out_cond, const std::vector<double>& avInn)
+{
+  //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
+  const double mult = 1/(4*M_PI)*(out_cond - in_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
+
+  const RadonRule rule;
+  BEMTriangles tris(hsurf);
+  prepare_G(tris, avInn, rule);
+
+  // Every observation point only writes its own row, so the rows are
+  // independent and are accumulated in the same order as the serial loop.
+  const size_t nnodes = static_cast<size_t>(numNodes(hsurf));
+  Parallel::For(0, nnodes, bemRowGrain, [&](size_t begin, size_t end)
+  {
+    DenseMatrix g_coef(1, 7);
+    DenseMatrix temp(1,7);
+    DenseMatrix g_values(3, 1);
+
+    for (size_t ppi = begin; ppi < end; ++ppi)
+    { //! for every node
+      Vector op(hsurf->get_point(VMesh::Node::index_type(ppi)));
+      add_G_row(op, static_cast<VMesh::index_type>(ppi), tris, rule, mult, g_coef, temp, g_values, auto_G.row(ppi));
+    }
+  });
+}
+
 void BuildBEMatrixBase::make_cross_G_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_GG_)
 {
   h_GG_.reset(new DenseMatrix(numNodes(hsurf1), numNodes(hsurf2), 0.0));
@@ -613,60 +723,24 @@ void BuildBEMatrixBaseCompute::make_cross_G_compute(VMesh* hsurf1, VMesh* hsurf2
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
 
-  VMesh::Node::array_type nodes;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
-
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
-
-  double area;
-
-  double sqrt15 = sqrt(15.0);
-  //R_W(0,0) = 9/40; // <- Burak! FIX ME!
-  R_W(0,0) = 9.0/40.0;
-  R_W(0,1) = (155 + sqrt15) / 1200;
-  R_W(0,2) = R_W(0,1);
-  R_W(0,3) = R_W(0,1);
-  R_W(0,4) = (155 - sqrt15) / 1200;
-  R_W(0,5) = R_W(0,4);
-  R_W(0,6) = R_W(0,4);
-
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
+  const RadonRule rule;
+  BEMTriangles tris(hsurf2);
+  prepare_G(tris, avInn, rule);
 
-  hsurf2->begin(fi); hsurf2->end(fie);
-  for (; fi != fie; ++fi)
-  { //! find contributions from every triangle
-    hsurf2->get_nodes(nodes, *fi);
-    Vector p1(hsurf2->get_point(nodes[0]));
-    Vector p2(hsurf2->get_point(nodes[1]));
-    Vector p3(hsurf2->get_point(nodes[2]));
+  const size_t nnodes = static_cast<size_t>(numNodes(hsurf1));
 
-    area = avInn[*fi];
-
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
+  Parallel::For(0, nnodes, bemRowGrain, [&](size_t begin, size_t end)
+  {
+    DenseMatrix g_coef(1, 7);
+    DenseMatrix temp(1,7);
+    DenseMatrix g_values(3, 1);
 
-    hsurf1->begin(ni); hsurf1->end(nie);
-    for (; ni != nie; ++ni)
+    for (size_t ppi = begin; ppi < end; ++ppi)
     { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf1->get_point(ppi));
-      get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
-
-      for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
-
-      g_values = area * (cruse_weights * temp.transpose());
-
-      for (int i=0; i<3; ++i)
-        cross_G(static_cast<uint64_t>(ppi), static_cast<uint64_t>(nodes[i]))+=g_values(i,0)*mult;
+      Vector op(hsurf1->get_point(VMesh::Node::index_type(ppi)));
+      add_G_row(op, -1, tris, rule, mult, g_coef, temp, g_values, cross_G.row(ppi));
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_cross_P_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_PP_)
@@ -686,32 +760,17 @@ void BuildBEMatrixBaseCompute::make_cross_P_compute(VMesh* hsurf1, VMesh* hsurf2
 {
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-  int i;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
-
-  hsurf1->begin(ni); hsurf1->end(nie);
-  for (; ni != nie; ++ni){ //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf1->get_point(ppi);
-
-    hsurf2->begin(fi); hsurf2->end(fie);
-    for (; fi != fie; ++fi){ //! find contributions from every triangle
-
-      hsurf2->get_nodes(nodes, *fi);
-      Vector v1 = hsurf2->get_point(nodes[0]) - pp;
-      Vector v2 = hsurf2->get_point(nodes[1]) - pp;
-      Vector v3 = hsurf2->get_point(nodes[2]) - pp;
-
-      getOmega(v1, v2, v3, coef);
+  BEMTriangles tris(hsurf2);
+  const size_t nnodes = static_cast<size_t>(numNodes(hsurf1));
 
-      for (i=0; i<3; ++i)
-        cross_P(static_cast<uint64_t>(ppi), static_cast<uint64_t>(nodes[i]))-=coef(0,i)*mult;
+  Parallel::For(0, nnodes, bemRowGrain, [&](size_t begin, size_t end)
+  {
+    DenseMatrix coef(1, 3);
+    for (size_t ppi = begin; ppi < end; ++ppi)
+    { //! for every node
+      add_P_row(hsurf1->get_point(VMesh::Node::index_type(ppi)), -1, tris, mult, coef, cross_P.row(ppi));
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_auto_P_allocate(VMesh* hsurf, DenseMatrixHandle &h_PP_)
@@ -738,43 +797,20 @@ void BuildBEMatrixBaseCompute::make_auto_P_compute(VMesh* hsurf, MatrixType& aut
   auto nnodes = auto_P.rows();
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
 
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
-
-  unsigned int i;
-
-  hsurf->begin(ni); hsurf->end(nie);
-
-  for (; ni != nie; ++ni)
-  { //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf->get_point(ppi);
+  BEMTriangles tris(hsurf);
 
-    hsurf->begin(fi); hsurf->end(fie);
-
-    for (; fi != fie; ++fi)
-    { //! find contributions from every triangle
-      hsurf->get_nodes(nodes, *fi);
-      if (ppi!=nodes[0] && ppi!=nodes[1] && ppi!=nodes[2])
-      {
-        Vector v1 = hsurf->get_point(nodes[0]) - pp;
-        Vector v2 = hsurf->get_point(nodes[1]) - pp;
-        Vector v3 = hsurf->get_point(nodes[2]) - pp;
-
-        getOmega(v1, v2, v3, coef);
-
-        for (i=0; i<3; ++i)
-          auto_P(static_cast<uint64_t>(ppi), static_cast<uint64_t>(nodes[i]))-=coef(0,i)*mult;
-      }
+  Parallel::For(0, static_cast<size_t>(nnodes), bemRowGrain, [&](size_t begin, size_t end)
+  {
+    DenseMatrix coef(1, 3);
+    for (size_t ppi = begin; ppi < end; ++ppi)
+    { //! for every node
+      add_P_row(hsurf->get_point(VMesh::Node::index_type(ppi)), static_cast<VMesh::index_type>(ppi), tris, mult, coef, auto_P.row(ppi));
     }
-  }
+  });
 
   //! accounting for autosolid angle
   auto sumOfRows = auto_P.rowwise().sum().eval();
-  for (i=0; i<nnodes; ++i)
+  for (unsigned int i=0; i<nnodes; ++i)
   {
     auto_P(i,i) = out_cond - sumOfRows(i);
   }
@@ -1303,13 +1339,15 @@ MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
   DenseMatrixHandle Pns;
   DenseMatrixHandle Gns;
   make_auto_P(surface, Pss, 1.0, 0.0);
-  make_cross_P(nodes, surface, Pns, 1.0, 0.0);
+  make_cross_P_allocate(nodes, surface, Pns);
+  make_cross_P_compute(nodes, surface, *Pns, 1.0, 0.0);
 
   std::vector<double> area;
   pre_calc_tri_areas( surface, area );
 
   make_auto_G( surface, Gss, 1.0, 0.0, area );
-  make_cross_G( nodes, surface, Gns, 1.0, 0.0, area );
+  make_cross_G_allocate(nodes, surface, Gns);
+  make_cross_G_compute(nodes, surface, *Gns, 1.0, 0.0, area);
 
   return makeShared<DenseMatrix>(*Pns - (*Gns * Gss->inverse() * *Pss));
 }
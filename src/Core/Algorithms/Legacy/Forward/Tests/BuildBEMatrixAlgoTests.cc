@@ -0,0 +1,127 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Legacy/Forward/BuildBEMatrixAlgo.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <map>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::Forward;
+
+namespace
+{
+  // Sphere made by subdividing the faces of an octahedron.
+  FieldHandle sphere(double radius, int levels)
+  {
+    std::vector<Point> points = { Point(1,0,0), Point(-1,0,0), Point(0,1,0), Point(0,-1,0), Point(0,0,1), Point(0,0,-1) };
+    std::vector<std::array<int, 3> > faces = { {0,2,4}, {2,1,4}, {1,3,4}, {3,0,4}, {2,0,5}, {1,2,5}, {3,1,5}, {0,3,5} };
+
+    for (int level = 0; level < levels; ++level)
+    {
+      std::map<std::pair<int, int>, int> midpoints;
+      auto midpoint = [&](int a, int b)
+      {
+        auto key = std::make_pair(std::min(a, b), std::max(a, b));
+        auto loc = midpoints.find(key);
+        if (loc != midpoints.end()) return loc->second;
+        Vector m = (Vector(points[a]) + Vector(points[b])) * 0.5;
+        m.normalize();
+        points.push_back(Point(m));
+        return midpoints[key] = static_cast<int>(points.size()) - 1;
+      };
+
+      std::vector<std::array<int, 3> > refined;
+      for (const auto& f : faces)
+      {
+        int ab = midpoint(f[0], f[1]), bc = midpoint(f[1], f[2]), ca = midpoint(f[2], f[0]);
+        refined.push_back({ f[0], ab, ca });
+        refined.push_back({ ab, f[1], bc });
+        refined.push_back({ ca, bc, f[2] });
+        refined.push_back({ ab, bc, ca });
+      }
+      faces.swap(refined);
+    }
+
+    FieldInformation fi(mesh_info_type::TRISURFMESH_E, databasis_info_type::LINEARDATA_E, data_info_type::DOUBLE_E);
+    auto field = CreateField(fi);
+    auto vmesh = field->vmesh();
+    for (const auto& p : points)
+      vmesh->add_point(Point(Vector(p) * radius));
+    for (const auto& f : faces)
+    {
+      VMesh::Node::array_type nodes(3);
+      for (int i = 0; i < 3; ++i)
+        nodes[i] = f[i];
+      vmesh->add_elem(nodes);
+    }
+    field->vfield()->resize_values();
+    return field;
+  }
+
+  DenseMatrixHandle transferMatrix(const bemfield_vector& fields)
+  {
+    auto algo = BEMAlgoImplFactory::create(fields);
+    return castMatrix::toDense(algo->compute(fields));
+  }
+}
+
+// Without sources between the surfaces a constant potential on the heart
+// gives a constant potential of the same magnitude on the torso.
+TEST(BuildBEMatrixAlgoTests, ConstantHeartPotentialIsTransferredToTorso)
+{
+  bemfield heart(sphere(0.1, 3));
+  heart.surface = true;
+  heart.insideconductivity = 0.0;
+  heart.outsideconductivity = 1.0;
+  heart.set_source_dirichlet();
+
+  bemfield torso(sphere(1.0, 3));
+  torso.surface = true;
+  torso.insideconductivity = 1.0;
+  torso.outsideconductivity = 0.0;
+  torso.set_measurement_neumann();
+
+  bemfield_vector fields = { heart, torso };
+  auto transfer = transferMatrix(fields);
+
+  ASSERT_TRUE(transfer != nullptr);
+  ASSERT_EQ(torso.field_->vmesh()->num_nodes(), transfer->rows());
+  ASSERT_EQ(heart.field_->vmesh()->num_nodes(), transfer->cols());
+  DenseColumnMatrix torsoPotential = *transfer * DenseColumnMatrix::Ones(transfer->cols());
+  EXPECT_NEAR(1.0, std::fabs(torsoPotential(0)), 1e-2);
+  for (int i = 1; i < torsoPotential.size(); ++i)
+    EXPECT_NEAR(torsoPotential(0), torsoPotential(i), 1e-2);
+}
@@ -38,8 +38,10 @@
 #include <Core/Datatypes/MatrixTypeConversions.h>
 
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Thread/Parallel.h>
 
 #include <Core/Utils/Exception.h>
+#include <Eigen/Eigenvalues>
 
 using namespace SCIRun;
 using namespace Core;
@@ -90,6 +92,62 @@ using namespace Inverse;
 //////// fi compute inverse solution
 ////////////////////////
 
+/////////////////////////
+///////// compute L-curve norms
+    bool SolveInverseProblemWithStandardTikhonovImpl::computeLcurveNorms(const std::vector<double>& lambdaArray,
+        const DenseMatrix& forwardMatrix, const DenseMatrix& measuredData,
+        const DenseMatrix* sourceWeighting, const DenseMatrix* sensorWeighting,
+        std::vector<double>& rho, std::vector<double>& eta) const
+    {
+        //............................
+        //  OPERATIONS PERFORMED IN THIS SECTION:
+        //      One generalized eigendecomposition of (M1, M2) replaces the factorization of G for every lambda
+        //............................
+        //
+        //      M1 * V = M2 * V * diag(mu),   V^T * M2 * V = I
+        //      G^-1 = V * diag(1 / (mu + lambda^2)) * V^T
+        //      x = (M3 * V) * diag(1 / (mu + lambda^2)) * (V^T * y)
+        //
+        //      Hence per lambda only the diagonal scaling changes, and the residual C*(A*x - y) and the
+        //      weighted solution R*x follow from the projected matrices C*A*M3*V and R*M3*V
+        //...........................................................................................................
+        Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> gsvd(M1, M2);
+        if (gsvd.info() != Eigen::Success)
+            return false;
+
+        const Eigen::VectorXd& mu = gsvd.eigenvalues();
+        const Eigen::MatrixXd z = gsvd.eigenvectors().transpose() * y;
+
+        Eigen::MatrixXd solutionBasis = M3 * gsvd.eigenvectors();
+        Eigen::MatrixXd residualBasis = forwardMatrix * solutionBasis;
+        Eigen::MatrixXd data = measuredData;
+        if (sensorWeighting)
+        {
+            residualBasis = (*sensorWeighting) * residualBasis;
+            data = (*sensorWeighting) * data;
+        }
+        if (sourceWeighting)
+            solutionBasis = (*sourceWeighting) * solutionBasis;
+
+        const int nLambda = lambdaArray.size();
+        rho.resize(nLambda);
+        eta.resize(nLambda);
+        Core::Thread::Parallel::For(0, nLambda, 1, [&](size_t begin, size_t end)
+        {
+            Eigen::MatrixXd coefficients;
+            for (size_t j = begin; j < end; j++)
+            {
+                const double lambda2 = lambdaArray[j] * lambdaArray[j];
+                coefficients = (mu.array() + lambda2).inverse().matrix().asDiagonal() * z;
+                rho[j] = (residualBasis * coefficients - data).norm();
+                eta[j] = (solutionBasis * coefficients).norm();
+            }
+        });
+        return true;
+    }
+//////// fi compute L-curve norms
+////////////////////////
+
 /////// precomputeInverseMatrices
 ///////////////
     void SolveInverseProblemWithStandardTikhonovImpl::preAllocateInverseMatrices(const DenseMatrix& forwardMatrix, const
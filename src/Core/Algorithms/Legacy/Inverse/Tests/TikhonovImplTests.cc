@@ -0,0 +1,72 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithStandardTikhonovImpl.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Inverse;
+
+namespace
+{
+  void expectLcurveMatchesSolvingEachLambda(int M, int N, TikhonovAlgoAbstractBase::AlgorithmChoice choice)
+  {
+    DenseMatrix forward = DenseMatrix::Random(M, N);
+    DenseMatrix measured = DenseMatrix::Random(M, 2);
+    DenseMatrix sensorWeighting = DenseMatrix::Identity(M, M) * 2.0;
+    DenseMatrix empty;
+
+    SolveInverseProblemWithStandardTikhonovImpl standard(forward, measured, empty, empty, choice, 0, 0);
+    const TikhonovImpl& impl = standard;
+    auto lambdas = impl.computeLambdaArray(1e-4, 1, 25);
+
+    std::vector<double> rho, eta;
+    ASSERT_TRUE(impl.computeLcurveNorms(lambdas, forward, measured, nullptr, &sensorWeighting, rho, eta));
+    ASSERT_EQ(lambdas.size(), rho.size());
+    ASSERT_EQ(lambdas.size(), eta.size());
+
+    for (size_t j = 0; j < lambdas.size(); j++)
+    {
+      auto solution = impl.computeInverseSolution(lambdas[j], false);
+      DenseMatrix residual = sensorWeighting * (forward * solution - measured);
+      EXPECT_NEAR(residual.norm(), rho[j], 1e-8 * measured.norm());
+      EXPECT_NEAR(solution.norm(), eta[j], 1e-8 * solution.norm());
+    }
+  }
+}
+
+TEST(TikhonovImplTests, LcurveNormsMatchSolvingEachLambdaUnderdetermined)
+{
+  expectLcurveMatchesSolvingEachLambda(12, 30, TikhonovAlgoAbstractBase::AlgorithmChoice::automatic);
+}
+
+TEST(TikhonovImplTests, LcurveNormsMatchSolvingEachLambdaOverdetermined)
+{
+  expectLcurveMatchesSolvingEachLambda(30, 12, TikhonovAlgoAbstractBase::AlgorithmChoice::automatic);
+}
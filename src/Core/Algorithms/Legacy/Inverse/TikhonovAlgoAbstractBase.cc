@@ -319,48 +319,48 @@ double TikhonovAlgoAbstractBase::computeLcurve(
 
   lambdaArray[0] = lambdaMin;
 
-  // for all lambdas
-  for (int j = 0; j < nLambda; j++)
+  auto forwardDense = castMatrix::toDense(forwardMatrix);
+  auto measuredDense = castMatrix::toDense(measuredData);
+  auto sourceDense = castMatrix::toDense(sourceWeighting);
+  auto sensorDense = castMatrix::toDense(sensorWeighting);
+  if (sourceDense && sourceDense->ncols() != forwardDense->ncols())
+  {
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException()
+                          << ErrorMessage(" Solution weighting matrix unexpectedly does not "
+                                          "fit to compute the weighted solution norm. "));
+  }
+
+  // implementations that decompose the system once evaluate all lambdas together
+  const bool normsComputed = algoImpl.computeLcurveNorms(lambdaArray, *forwardDense,
+      *measuredDense, sourceDense.get(), sensorDense.get(), rho, eta);
+
+  // otherwise solve for all lambdas
+  for (int j = 0; j < nLambda && !normsComputed; j++)
   {
     solution = algoImpl.computeInverseSolution(lambdaArray[j], false);
-    lambdamatrix->put(j, 0, lambdaArray[j]);
 
     // if using source regularization matrix, apply it to compute Rx (for the eta computations)
-    if (sourceWeighting)
-    {
-      if (solution.nrows() ==
-          sourceWeighting->ncols())  // check that regularization matrix and solution match sizes
-      {
-        auto sw = castMatrix::toDense(sourceWeighting);
-        Rx = (*sw) * solution;
-      }
-      else
-      {
-        BOOST_THROW_EXCEPTION(AlgorithmProcessingException()
-                              << ErrorMessage(" Solution weighting matrix unexpectedly does not "
-                                              "fit to compute the weighted solution norm. "));
-      }
-    }
+    if (sourceDense)
+      Rx = (*sourceDense) * solution;
     else
       Rx = solution;
 
-    auto forward = castMatrix::toDense(forwardMatrix);
-    auto Ax = (*forward) * solution;
-    auto measured = castMatrix::toDense(measuredData);
-    auto residualSolution = Ax - (*measured);
+    auto residualSolution = (*forwardDense) * solution - (*measuredDense);
 
-    // if using source regularization matrix, apply it to compute Rx (for the eta computations)
-    if (sensorWeighting)
-    {
-      auto sw = castMatrix::toDense(sensorWeighting);
-      CAx = (*sw) * residualSolution;
-    }
+    // if using sensor regularization matrix, apply it to the residual (for the rho computations)
+    if (sensorDense)
+      CAx = (*sensorDense) * residualSolution;
     else
       CAx = residualSolution;
 
     // compute rho and eta. Using Frobenious norm when using matrices
     rho[j] = CAx.norm();
     eta[j] = Rx.norm();
+  }
+
+  for (int j = 0; j < nLambda; j++)
+  {
+    lambdamatrix->put(j, 0, lambdaArray[j]);
     lambdamatrix->put(j, 1, rho[j]);
     lambdamatrix->put(j, 2, eta[j]);
   }
@@ -46,3 +46,14 @@
 
 		return lambdaArray;
 	}
+
+	// no shortcut by default: the caller solves for every lambda
+	bool SCIRun::Core::Algorithms::Inverse::TikhonovImpl::computeLcurveNorms( const std::vector<double>& /*lambdaArray*/,
+		const SCIRun::Core::Datatypes::DenseMatrix& /*forwardMatrix*/,
+		const SCIRun::Core::Datatypes::DenseMatrix& /*measuredData*/,
+		const SCIRun::Core::Datatypes::DenseMatrix* /*sourceWeighting*/,
+		const SCIRun::Core::Datatypes::DenseMatrix* /*sensorWeighting*/,
+		std::vector<double>& /*rho*/, std::vector<double>& /*eta*/ ) const
+	{
+		return false;
+	}
@@ -57,6 +57,15 @@ namespace Inverse {
 		// default lambda step. Can ve overriden if necessary (see TSVD as reference)
 		virtual std::vector<double> computeLambdaArray( double lambdaMin, double lambdaMax, int nLambda ) const;
 
+		// residual norm (rho) and weighted solution norm (eta) for every lambda of the L-curve.
+		// Returns false if the implementation has no faster way than solving for each lambda.
+		virtual bool computeLcurveNorms( const std::vector<double>& lambdaArray,
+			const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix,
+			const SCIRun::Core::Datatypes::DenseMatrix& measuredData,
+			const SCIRun::Core::Datatypes::DenseMatrix* sourceWeighting,
+			const SCIRun::Core::Datatypes::DenseMatrix* sensorWeighting,
+			std::vector<double>& rho, std::vector<double>& eta ) const;
+
 	};
 
 	}}}}
@@ -30,9 +30,12 @@
 // PORTED SCIRUN v4 CODE //
 ///////////////////////////
 
+#include <algorithm>
+
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
 #include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelPreconditioners.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
@@ -48,7 +51,7 @@ SolveLinearSystemAlgo::SolveLinearSystemAlgo()
 {
   // For solver
   addOption(Variables::Method,"cg","jacobi|cg|bicg|minres");
-  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi");
+  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi|IC|AMG");
 
   addParameter(Variables::TargetError, 1e-5);
   addParameter(Variables::MaxIterations, 500);
@@ -73,23 +76,71 @@ SolveLinearSystemAlgo::SolveLinearSystemAlgo()
 class SolveLinearSystemParallelAlgo : public ParallelLinearAlgebraBase
 {
 public:
-  explicit SolveLinearSystemParallelAlgo(const AlgorithmBase* base);
+  SolveLinearSystemParallelAlgo(const AlgorithmBase* base, std::shared_ptr<ParallelPreconditioner> preconditioner);
 
   bool run(SparseRowMatrixHandle a, DenseColumnMatrixHandle b,
             DenseColumnMatrixHandle x0, DenseColumnMatrixHandle& x,
             DenseColumnMatrixHandle& convergence) const;
+  // Multiple right hand sides, one per column of b
+  bool run(SparseRowMatrixHandle a, DenseMatrixHandle b,
+            DenseMatrixHandle x0, DenseMatrixHandle& x,
+            DenseColumnMatrixHandle& convergence) const;
 protected:
+  bool setup_preconditioner(ParallelLinearAlgebra& PLA, SolverInputs& matrices,
+    const ParallelLinearAlgebra::ParallelMatrix& A, ParallelLinearAlgebra::ParallelVector& DIAG) const;
+  // Z = M^-1 * R, where M is either DIAG or the IC/AMG preconditioner
+  void apply_preconditioner(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& DIAG,
+    const ParallelLinearAlgebra::ParallelVector& R, ParallelLinearAlgebra::ParallelVector& Z) const;
+
   const AlgorithmBase* algo_;
   std::string pre_conditioner_;
+  std::shared_ptr<ParallelPreconditioner> preconditioner_;
   DenseColumnMatrixHandle convergence_;
 };
 
-SolveLinearSystemParallelAlgo::SolveLinearSystemParallelAlgo(const AlgorithmBase* base) : algo_(base),
+SolveLinearSystemParallelAlgo::SolveLinearSystemParallelAlgo(const AlgorithmBase* base,
+  std::shared_ptr<ParallelPreconditioner> preconditioner) : algo_(base),
   pre_conditioner_(base->getOption(Variables::Preconditioner)),
+  preconditioner_(preconditioner),
   convergence_(new DenseColumnMatrix(base->get(Variables::MaxIterations).toInt()))
 {
 }
 
+bool
+SolveLinearSystemParallelAlgo::setup_preconditioner(ParallelLinearAlgebra& PLA, SolverInputs& matrices,
+  const ParallelLinearAlgebra::ParallelMatrix& A, ParallelLinearAlgebra::ParallelVector& DIAG) const
+{
+  if (pre_conditioner_ == "Jacobi")
+  {
+    PLA.absdiag(A,DIAG);
+    double max = PLA.max(DIAG);
+    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
+  }
+  else
+  {
+    PLA.ones(DIAG);
+  }
+
+  if (preconditioner_ && !preconditioner_->setup(PLA, matrices.A, A))
+  {
+    if (PLA.first())
+      algo_->error("Could not build the " + pre_conditioner_ + " preconditioner");
+    PLA.wait();
+    return (false);
+  }
+  return (true);
+}
+
+void
+SolveLinearSystemParallelAlgo::apply_preconditioner(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& DIAG,
+  const ParallelLinearAlgebra::ParallelVector& R, ParallelLinearAlgebra::ParallelVector& Z) const
+{
+  if (preconditioner_)
+    preconditioner_->apply(PLA, R, Z);
+  else
+    PLA.mult(R,DIAG,Z);
+}
+
 bool
 SolveLinearSystemParallelAlgo::run(SparseRowMatrixHandle a, DenseColumnMatrixHandle b,
                                    DenseColumnMatrixHandle x0, DenseColumnMatrixHandle& x,
@@ -125,20 +176,46 @@ SolveLinearSystemParallelAlgo::run(SparseRowMatrixHandle a, DenseColumnMatrixHan
   return (true);
 }
 
+bool
+SolveLinearSystemParallelAlgo::run(SparseRowMatrixHandle a, DenseMatrixHandle b,
+                                   DenseMatrixHandle x0, DenseMatrixHandle& x,
+                                   DenseColumnMatrixHandle& convergence) const
+{
+  SolverInputs matrices;
+  matrices.A = a;
+  matrices.B = b;
+  matrices.X0 = x0;
+
+  x = makeShared<DenseMatrix>(x0->nrows(), x0->ncols());
+  matrices.X = x;
+
+  convergence = convergence_;
+
+  if(!start_parallel(matrices))
+  {
+    const std::string msg = "Encountered an error while running parallel linear algebra";
+    algo_->error(msg);
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << SCIRun::Core::ErrorMessage(msg));
+  }
+
+  return (true);
+}
+
 //------------------------------------------------------------------
 // CG Solver with simple preconditioner
 
 class SolveLinearSystemCGAlgo : public SolveLinearSystemParallelAlgo
 {
   public:
-    explicit SolveLinearSystemCGAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+    SolveLinearSystemCGAlgo(const AlgorithmBase* base, std::shared_ptr<ParallelPreconditioner> preconditioner) :
+      SolveLinearSystemParallelAlgo(base, preconditioner) {}
     bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const override;
 };
 
 bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 {
   ParallelLinearAlgebra::ParallelMatrix A;
-  ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN, DIAG, R, Z, P;
+  ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN, DIAG, R, Z, P, W, S;
 
   double tolerance =     algo_->get(Variables::TargetError).toDouble();
   int    max_iter =      algo_->get(Variables::MaxIterations).toInt();
@@ -170,7 +247,9 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
        !PLA.new_vector(DIAG) ||
        !PLA.new_vector(R) ||
        !PLA.new_vector(Z) ||
-       !PLA.new_vector(P))
+       !PLA.new_vector(P) ||
+       !PLA.new_vector(W) ||
+       !PLA.new_vector(S))
   {
     if (PLA.first())
     {
@@ -189,16 +268,8 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
   PLA.copy(X0,XMIN);
 
   // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  if (!setup_preconditioner(PLA, matrices, A, DIAG))
+    return (false);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
@@ -227,7 +298,20 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
     return (true);
   }
 
-  double bkden = 0.0;
+  // Chronopoulos/Gear form of preconditioned CG: the three inner products
+  // of an iteration are computed while multiplying with A and reduced
+  // together, and the vector updates are fused into a single pass.
+  // This needs two barriers per iteration instead of four.
+  const ParallelLinearAlgebra::ParallelVector* diag = preconditioner_ ? nullptr : &DIAG;
+  apply_preconditioner(PLA,DIAG,R,Z);
+  PLA.zeros(P);
+  PLA.zeros(S);
+
+  double gamma, delta, rr;
+  PLA.mult_dots(A,Z,W,R,gamma,delta,rr);
+
+  double alpha = 0.0;
+  double gamma_old = 0.0;
 
   int cnt = 0;
   double log_target = log(tolerance);
@@ -256,28 +340,24 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
       return true;
     }
 
-    PLA.mult(R,DIAG,Z);
-    double bknum = PLA.dot(Z,R);
-
+    double beta = 0.0;
     if (niter == 0)
     {
-      PLA.copy(Z,P);
+      alpha = gamma/delta;
     }
     else
     {
-      double bk = bknum/bkden;
-      PLA.scale_add(bk,P,Z,P);
+      beta = gamma/gamma_old;
+      alpha = gamma/(delta - beta*gamma/alpha);
     }
-    PLA.mult(A,P,Z);
-    bkden = bknum;
+    gamma_old = gamma;
 
-    double akden = PLA.dot(Z,P);
-    double ak=bknum/akden;
-
-    PLA.scale_add(ak,P,X,X);
-    PLA.scale_add(-ak,Z,R,R);
+    PLA.cg_update(alpha,beta,Z,W,P,S,X,R,diag);
+    if (preconditioner_)
+      apply_preconditioner(PLA,DIAG,R,Z);
+    PLA.mult_dots(A,Z,W,R,gamma,delta,rr);
 
-    error = PLA.norm(R)/bnorm;
+    error = sqrt(rr)/bnorm;
     if (error < xmin)
     {
       PLA.copy(X,XMIN);
@@ -338,12 +418,181 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
 }
 
 
+//------------------------------------------------------------------
+// CG Solver for multiple right hand sides. Every right hand side has its own
+// CG recurrence, but all of them share the sparse matrix products and the
+// reductions, so the matrix is read once per iteration for all vectors.
+
+class SolveLinearSystemBlockCGAlgo : public SolveLinearSystemParallelAlgo
+{
+  public:
+    SolveLinearSystemBlockCGAlgo(const AlgorithmBase* base, std::shared_ptr<ParallelPreconditioner> preconditioner) :
+      SolveLinearSystemParallelAlgo(base, preconditioner) {}
+    bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const override;
+};
+
+bool SolveLinearSystemBlockCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
+{
+  ParallelLinearAlgebra::ParallelMatrix A;
+  ParallelLinearAlgebra::ParallelMultiVector B, X, X0, XMIN, R, Z, P, W, S;
+  ParallelLinearAlgebra::ParallelVector DIAG, RC, ZC;
+
+  double tolerance =     algo_->get(Variables::TargetError).toDouble();
+  int    max_iter =      algo_->get(Variables::MaxIterations).toInt();
+  int    niter = 0;
+  const size_t nvec = matrices.numVectors();
+
+  if ( !PLA.add_matrix(matrices.A, A) ||
+       !PLA.add_multi_vector(matrices.B, B) ||
+       !PLA.add_multi_vector(matrices.X0, X0) ||
+       !PLA.add_multi_vector(matrices.X, XMIN))
+  {
+    if (PLA.first())
+      algo_->error("Could not link matrices");
+    PLA.wait();
+    return (false);
+  }
+  if ( !PLA.new_multi_vector(nvec, X) ||
+       !PLA.new_multi_vector(nvec, R) ||
+       !PLA.new_multi_vector(nvec, Z) ||
+       !PLA.new_multi_vector(nvec, P) ||
+       !PLA.new_multi_vector(nvec, W) ||
+       !PLA.new_multi_vector(nvec, S) ||
+       !PLA.new_vector(DIAG) ||
+       !PLA.new_vector(RC) ||
+       !PLA.new_vector(ZC))
+  {
+    if (PLA.first())
+      algo_->error("Could not allocate enough memory for algorithm");
+    PLA.wait();
+    return (false);
+  }
+
+  PLA.copy(X0,X);
+  PLA.copy(X0,XMIN);
+
+  // Build a preconditioner
+  if (!setup_preconditioner(PLA, matrices, A, DIAG))
+    return (false);
+
+  PLA.mult(A,X,R);
+  PLA.sub(B,R,R);
+
+  std::vector<double> bnorm, error;
+  PLA.norm(B,bnorm);
+  PLA.norm(R,error);
+  for (size_t c = 0; c < nvec; ++c)
+  {
+    if (bnorm[c] == 0.0) bnorm[c] = 1.0;
+    error[c] /= bnorm[c];
+  }
+
+  // Like the single vector solver, every column returns its lowest error iterate
+  std::vector<double> xmin(error);
+  double maxerror = *std::max_element(error.begin(), error.end());
+  double orig = maxerror;
+
+  // Same Chronopoulos/Gear recurrence as the single vector CG solver
+  auto precondition = [&]()
+  {
+    for (size_t c = 0; c < nvec; ++c)
+    {
+      if (error[c] <= tolerance)
+        continue;
+      PLA.get_column(R,c,RC);
+      preconditioner_->apply(PLA,RC,ZC);
+      PLA.set_column(ZC,c,Z);
+    }
+  };
+  const ParallelLinearAlgebra::ParallelVector* diag = preconditioner_ ? nullptr : &DIAG;
+  if (preconditioner_)
+    precondition();
+  else
+    PLA.mult(DIAG,R,Z);
+  PLA.zeros(P);
+  PLA.zeros(S);
+
+  std::vector<double> gamma, delta, rr;
+  PLA.mult_dots(A,Z,W,R,gamma,delta,rr);
+  std::vector<double> alpha(nvec, 0.0), beta(nvec, 0.0), gamma_old(nvec, 0.0);
+
+  int cnt = 0;
+  double log_target = log(tolerance);
+  double log_orig =  log(orig);
+  double log_scale = log_orig - log_target;
+
+  while (maxerror > tolerance && niter < max_iter)
+  {
+    // Converged right hand sides keep their solution
+    for (size_t c = 0; c < nvec; ++c)
+    {
+      if (error[c] <= tolerance)
+      {
+        alpha[c] = beta[c] = 0.0;
+        continue;
+      }
+      double den = delta[c];
+      beta[c] = 0.0;
+      if (niter > 0 && alpha[c] != 0.0)
+      {
+        beta[c] = gamma[c]/gamma_old[c];
+        den -= beta[c]*gamma[c]/alpha[c];
+      }
+      alpha[c] = den != 0.0 ? gamma[c]/den : 0.0;
+      gamma_old[c] = gamma[c];
+    }
+
+    PLA.cg_update(alpha,beta,Z,W,P,S,X,R,diag);
+    if (preconditioner_)
+      precondition();
+    PLA.mult_dots(A,Z,W,R,gamma,delta,rr);
+
+    for (size_t c = 0; c < nvec; ++c)
+    {
+      error[c] = sqrt(rr[c])/bnorm[c];
+      if (error[c] < xmin[c])
+      {
+        PLA.copy_column(X,c,XMIN);
+        xmin[c] = error[c];
+      }
+    }
+    maxerror = *std::max_element(error.begin(), error.end());
+
+    if (PLA.first())
+      (*convergence_)[niter] = *std::max_element(xmin.begin(), xmin.end());
+
+    niter++;
+
+    cnt++;
+    if (cnt == 20)
+    {
+      cnt = 0;
+      algo_->update_progress((log_orig-log(maxerror))/log_scale);
+    }
+  }
+
+  if (PLA.first())
+  {
+    std::ostringstream ostr;
+    if (maxerror <= tolerance)
+      ostr << "Solver converged for " << nvec << " right hand sides after " << niter << " iterations with error " << maxerror;
+    else
+      ostr << "Solver stopped after " << niter << " iterations. Largest error of " << nvec << " right hand sides was " << maxerror;
+    algo_->remark(ostr.str());
+  }
+
+  PLA.wait();
+
+  return true;
+}
+
 //------------------------------------------------------------------
 // BICG Solver with simple preconditioner
 class SolveLinearSystemBICGAlgo : public SolveLinearSystemParallelAlgo
 {
   public:
-    explicit SolveLinearSystemBICGAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+    SolveLinearSystemBICGAlgo(const AlgorithmBase* base, std::shared_ptr<ParallelPreconditioner> preconditioner) :
+      SolveLinearSystemParallelAlgo(base, preconditioner) {}
     bool parallel(ParallelLinearAlgebra& PLA,
                           SolverInputs& matrices) const override;
 };
@@ -399,16 +648,8 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(X0,XMIN);
 
   // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  if (!setup_preconditioner(PLA, matrices, A, DIAG))
+    return (false);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
@@ -460,8 +701,8 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
       return (true);
     }
 
-    PLA.mult(R,DIAG,Z);
-    PLA.mult(R1,DIAG,Z1);
+    apply_preconditioner(PLA,DIAG,R,Z);
+    apply_preconditioner(PLA,DIAG,R1,Z1);
 
     double bknum = PLA.dot(Z,R1);
 
@@ -558,7 +799,8 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 class SolveLinearSystemMINRESAlgo : public SolveLinearSystemParallelAlgo
 {
 public:
-  explicit SolveLinearSystemMINRESAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+  SolveLinearSystemMINRESAlgo(const AlgorithmBase* base, std::shared_ptr<ParallelPreconditioner> preconditioner) :
+      SolveLinearSystemParallelAlgo(base, preconditioner) {}
   bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const override;
 };
 
@@ -618,16 +860,8 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(X0,XMIN);
 
   // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  if (!setup_preconditioner(PLA, matrices, A, DIAG))
+    return (false);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
@@ -656,7 +890,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(R,VOLD);
   PLA.copy(R,V);
 
-  PLA.mult(DIAG,V,V);
+  apply_preconditioner(PLA,DIAG,V,V);
 
   double beta1   = sqrt(PLA.dot(V,VOLD));
   double snprod  = beta1;
@@ -673,7 +907,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(VOLD,VOLDER);
   PLA.copy(V,VOLD);
 
-  PLA.mult(DIAG,V,V);
+  apply_preconditioner(PLA,DIAG,V,V);
 
   double betaold = beta1;
   double beta = sqrt(PLA.dot(VOLD,V));
@@ -734,7 +968,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     PLA.copy(VOLD,VOLDER);
     PLA.copy(V,VOLD);
 
-    PLA.mult(DIAG,V,V);
+    apply_preconditioner(PLA,DIAG,V,V);
 
     betaold = beta;
     beta = sqrt(PLA.dot(VOLD,V));
@@ -910,7 +1144,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 class SolveLinearSystemJACOBIAlgo : public SolveLinearSystemParallelAlgo
 {
 public:
-  explicit SolveLinearSystemJACOBIAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+  explicit SolveLinearSystemJACOBIAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base, nullptr) {}
   bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const override;
 };
 
@@ -1067,6 +1301,28 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   return (true);
 }
 
+std::shared_ptr<ParallelPreconditioner> SolveLinearSystemAlgo::preconditioner(const std::string& name) const
+{
+  Thread::Guard g(preconditionerLock_.get());
+  if (name != preconditionerName_)
+  {
+    preconditionerName_ = name;
+    if (name == "IC")
+      preconditioner_ = std::make_shared<ParallelIncompleteCholesky>();
+    else if (name == "AMG")
+      preconditioner_ = std::make_shared<ParallelAlgebraicMultigrid>();
+    else
+      preconditioner_.reset();
+  }
+  return preconditioner_;
+}
+
+size_t SolveLinearSystemAlgo::numPreconditionerBuilds() const
+{
+  Thread::Guard g(preconditionerLock_.get());
+  return preconditioner_ ? preconditioner_->numBuilds() : 0;
+}
+
 bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
                            DenseColumnMatrixHandle b,
                            DenseColumnMatrixHandle x0,
@@ -1147,10 +1403,16 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
 
   std::string method = getOption(Variables::Method);
 
+  // Solves sharing a cached preconditioner are serialized
+  auto precond = preconditioner(getOption(Variables::Preconditioner));
+  std::unique_lock<std::mutex> lock(preconditionerLock_, std::defer_lock);
+  if (precond)
+    lock.lock();
+
   DenseColumnMatrixHandle conv;
   if (method == "cg")
   {
-    SolveLinearSystemCGAlgo algo(this);
+    SolveLinearSystemCGAlgo algo(this, precond);
     if(!algo.run(A,b,x0,x,conv))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Conjugate Gradient method failed"));
@@ -1158,7 +1420,7 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   }
   else if (method == "bicg")
   {
-    SolveLinearSystemBICGAlgo algo(this);
+    SolveLinearSystemBICGAlgo algo(this, precond);
     if(!(algo.run(A,b,x0,x,conv)))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("BiConjugate Gradient method failed"));
@@ -1174,7 +1436,7 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   }
   else if (method == "minres")
   {
-    SolveLinearSystemMINRESAlgo algo(this);
+    SolveLinearSystemMINRESAlgo algo(this, precond);
     if(!(algo.run(A,b,x0,x,conv)))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("MINRES method failed"));
@@ -1200,11 +1462,93 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   return true;
 }
 
+bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
+                           DenseMatrixHandle b,
+                           DenseMatrixHandle x0,
+                           DenseMatrixHandle& x) const
+{
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(A, "No matrix A is given");
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(b, "No matrix b is given");
+
+  if (!x0)
+  {
+    // create an x0 matrix
+    x0 = makeShared<DenseMatrix>(DenseMatrix::Zero(b->nrows(), b->ncols()));
+  }
+
+  if (x0->nrows() != b->nrows() || x0->ncols() != b->ncols())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix x0 and b need to have the same size");
+  }
+
+  if (A->nrows() != A->ncols())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A is not square");
+  }
+
+  if (A->nrows() != b->nrows())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A and b do not have the same number of rows");
+  }
+
+  std::string method = getOption(Variables::Method);
+
+  if (method != "cg")
+  {
+    // The other methods solve one right hand side at a time
+    x = makeShared<DenseMatrix>(b->nrows(), b->ncols());
+    for (size_t c = 0; c < b->ncols(); ++c)
+    {
+      DenseColumnMatrixHandle bc(new DenseColumnMatrix(b->col(c)));
+      DenseColumnMatrixHandle x0c(new DenseColumnMatrix(x0->col(c)));
+      DenseColumnMatrixHandle xc;
+      if (!run(A, bc, x0c, xc))
+        return false;
+      x->col(c) = *xc;
+    }
+    return true;
+  }
+
+  ScopedAlgorithmStatusReporter ssr(this, "SolveLinearSystem");
+
+  double tolerance = get(Variables::TargetError).toDouble();
+  int maxIterations = get(Variables::MaxIterations).toInt();
+  ENSURE_POSITIVE_DOUBLE(tolerance, "Tolerance out of range!");
+  ENSURE_POSITIVE_INT(maxIterations, "Max iterations out of range!");
+
+  auto precond = preconditioner(getOption(Variables::Preconditioner));
+  std::unique_lock<std::mutex> lock(preconditionerLock_, std::defer_lock);
+  if (precond)
+    lock.lock();
+
+  DenseColumnMatrixHandle conv;
+  SolveLinearSystemBlockCGAlgo algo(this, precond);
+  if (!algo.run(A, b, x0, x, conv))
+  {
+    BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Conjugate Gradient method failed"));
+  }
+
+  return true;
+}
+
 AlgorithmOutput SolveLinearSystemAlgo::run(const AlgorithmInput& input) const
 {
   auto lhs = input.get<SparseRowMatrix>(Variables::LHS);
   auto rhs = input.get<DenseColumnMatrix>(Variables::RHS);
 
+  if (!rhs)
+  {
+    auto rhsMatrix = input.get<DenseMatrix>(Variables::RHS);
+    DenseMatrixHandle solutions;
+    if (!run(lhs, rhsMatrix, DenseMatrixHandle(), solutions))
+    {
+      BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("SolveLinearSystem Algo returned false--need to improve error conditions so it throws before returning."));
+    }
+    AlgorithmOutput output;
+    output[Variables::Solution] = solutions;
+    return output;
+  }
+
   DenseColumnMatrixHandle solution;
 
   bool success = run(lhs, rhs, DenseColumnMatrixHandle(), solution);
@@ -35,6 +35,7 @@
 
 #include <Core/Algorithms/Base/AlgorithmBase.h>
 #include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Thread/Mutex.h>
 #include <Core/Algorithms/Math/share.h>
 
 namespace SCIRun {
@@ -42,8 +43,12 @@ namespace Core {
 namespace Algorithms {
 namespace Math {
 
+class ParallelPreconditioner;
+
 // Solve a linear system in parallel using a standard iterative method
 // Method solves A*x = b, with x0 being the initializer for the solution
+// The IC and AMG preconditioners are kept between runs, so solving the same
+// matrix again only redoes their setup when the matrix changed.
 
 class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
 {
@@ -61,7 +66,24 @@ class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
              Datatypes::DenseColumnMatrixHandle x0,
              Datatypes::DenseColumnMatrixHandle& x) const;
 
+    // Solve for all columns of b at once. With the cg method the columns are
+    // iterated together, so every iteration reads A only once.
+    bool run(Datatypes::SparseRowMatrixHandle A,
+             Datatypes::DenseMatrixHandle b,
+             Datatypes::DenseMatrixHandle x0,
+             Datatypes::DenseMatrixHandle& x) const;
+
     AlgorithmOutput run(const AlgorithmInput& input) const override;
+
+    // Number of times the current IC or AMG preconditioner was built
+    size_t numPreconditionerBuilds() const;
+
+  private:
+    std::shared_ptr<ParallelPreconditioner> preconditioner(const std::string& name) const;
+
+    mutable std::shared_ptr<ParallelPreconditioner> preconditioner_;
+    mutable std::string preconditionerName_;
+    mutable Thread::Mutex preconditionerLock_;
 };
 
 
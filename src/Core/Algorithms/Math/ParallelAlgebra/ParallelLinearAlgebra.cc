@@ -33,6 +33,9 @@
 ///////////////////////////
 
 #include <cfloat>
+#include <climits>
+#include <algorithm>
+#include <numeric>
 
 #include <Core/Datatypes/Matrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
@@ -59,15 +62,11 @@ ParallelLinearAlgebra::ParallelLinearAlgebra(ParallelLinearAlgebraSharedData& da
   proc_(proc),
   nproc_(data.numProcs())
 {
-  // Compute local size
-  size_ = data.getSize();
-  local_size_ = size_/nproc_;
-
   // Compute start and end index for this thread
-  start_ = proc*local_size_;
-  end_   = (proc+1)*local_size_;
-  if (proc == nproc_-1) end_ = size_;
-  if (proc == nproc_-1) local_size_ = end_ - start_;
+  size_ = data.getSize();
+  start_ = data.rowStart(proc);
+  end_   = data.rowStart(proc+1);
+  local_size_ = end_ - start_;
   local_size16_ = (local_size_&(~0xf));
 
   // Set reduction buffers
@@ -126,6 +125,48 @@ bool ParallelLinearAlgebra::new_vector(ParallelVector& V)
   return(add_vector(mat,V));
 }
 
+bool ParallelLinearAlgebra::add_multi_vector(DenseMatrixHandle mat, ParallelMultiVector& V)
+{
+  if (!mat) { return (false); }
+  if (mat->nrows() != size_) { return (false); }
+
+  V.data_ = mat->data();
+  V.size_ = size_;
+  V.ncols_ = mat->ncols();
+
+  return true;
+}
+
+bool ParallelLinearAlgebra::new_multi_vector(size_t ncols, ParallelMultiVector& V)
+{
+  wait();
+
+  data_.setSuccess(proc_);
+  if (proc_ == 0)
+  {
+    try
+    {
+      DenseMatrixHandle mat(makeShared<DenseMatrix>(data_.getSize(), ncols));
+      data_.setCurrentMultiVector(mat);
+      data_.addMultiVector(mat);
+    }
+    catch (...)
+    {
+      data_.setFail(0);
+    }
+  }
+
+  wait();
+
+  if (!data_.isSuccess(0))
+    return false;
+
+  auto mat = data_.getCurrentMultiVector();
+  wait();
+
+  return(add_multi_vector(mat,V));
+}
+
 bool ParallelLinearAlgebra::add_matrix(SparseRowMatrixHandle mat, ParallelMatrix& M)
 {
   if (!mat) return (false);
@@ -140,10 +181,120 @@ bool ParallelLinearAlgebra::add_matrix(SparseRowMatrixHandle mat, ParallelMatrix
   M.m_ = mat->nrows();
   M.n_ = mat->ncols();
   M.nnz_ = mat->nonZeros();
+  M.sliced_ = nullptr;
+
+  // The system matrix is multiplied every iteration, give it a vectorized layout
+  if (mat == data_.inputs().A && build_sliced_matrix(mat))
+    M.sliced_ = &data_.slicedMatrix();
 
   return (true);
 }
 
+bool ParallelLinearAlgebra::build_sliced_matrix(SparseRowMatrixHandle mat)
+{
+  const size_t C = SlicedEllpackMatrix::chunkSize;
+  SlicedEllpackMatrix& S = data_.slicedMatrix();
+  if (mat->ncols() > INT_MAX)
+    return false;
+
+  wait();
+  if (S.valid_)
+    return true;
+
+  const index_type* rows = mat->outerIndexPtr();
+  const index_type* columns = mat->innerIndexPtr();
+  const double* values = mat->valuePtr();
+
+  // Partition boundaries are multiples of the chunk size, so every thread
+  // sorts and fills only its own chunks
+  const size_t first_chunk = (start_+C-1)/C;
+  const size_t last_chunk = (end_+C-1)/C;
+
+  auto length = [rows](index_type r) { return rows[r+1]-rows[r]; };
+  for (size_t w=start_; w<end_; w+=SlicedEllpackMatrix::sortWindow)
+  {
+    const size_t wend = std::min(w+SlicedEllpackMatrix::sortWindow, end_);
+    index_type* slots = &S.rows_[w];
+    std::iota(slots, slots+(wend-w), static_cast<index_type>(w));
+    std::stable_sort(slots, slots+(wend-w),
+      [&length](index_type r1, index_type r2) { return length(r1) > length(r2); });
+  }
+  for (size_t j=end_; j<last_chunk*C; j++) S.rows_[j] = -1;
+
+  for (size_t c=first_chunk; c<last_chunk; c++)
+  {
+    index_type width = 0;
+    for (size_t l=0; l<C; l++)
+    {
+      const index_type r = S.rows_[c*C+l];
+      if (r >= 0) width = std::max(width, length(r));
+    }
+    S.offsets_[c+1] = width*C;
+  }
+  wait();
+
+  data_.setSuccess(proc_);
+  if (proc_ == 0)
+  {
+    S.offsets_[0] = 0;
+    for (size_t c=1; c<S.offsets_.size(); c++) S.offsets_[c] += S.offsets_[c-1];
+    const size_t stored = S.offsets_.back();
+    if (stored > SlicedEllpackMatrix::maxFillRatio*mat->nonZeros() + C)
+    {
+      data_.setFail(0);
+    }
+    else
+    {
+      try
+      {
+        // Left uninitialized, every thread touches its own chunks first
+        S.columns_.reset(new int[stored]);
+        S.data_.reset(new double[stored]);
+      }
+      catch (...)
+      {
+        data_.setFail(0);
+      }
+    }
+  }
+  wait();
+
+  if (!data_.isSuccess(0))
+    return false;
+
+  for (size_t c=first_chunk; c<last_chunk; c++)
+  {
+    const size_t offset = S.offsets_[c];
+    const size_t width = (S.offsets_[c+1]-offset)/C;
+    for (size_t l=0; l<C; l++)
+    {
+      const index_type r = S.rows_[c*C+l];
+      const index_type row_idx = r >= 0 ? rows[r] : 0;
+      const size_t len = r >= 0 ? length(r) : 0;
+      for (size_t j=0; j<width; j++)
+      {
+        const size_t k = offset+j*C+l;
+        if (j < len)
+        {
+          S.columns_[k] = static_cast<int>(columns[row_idx+j]);
+          S.data_[k] = values[row_idx+j];
+        }
+        else
+        {
+          S.columns_[k] = 0;
+          S.data_[k] = 0.0;
+        }
+      }
+    }
+  }
+  wait();
+
+  if (proc_ == 0) S.valid_ = true;
+  wait();
+
+  return true;
+}
+
 /// @todo: refactor duplication
 
 void ParallelLinearAlgebra::mult(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
@@ -633,6 +784,31 @@ void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelVector&
   double* idata = b.data_;
   double* odata = r.data_;
 
+  if (a.sliced_)
+  {
+    // Sliced ELLPACK: the lanes of a chunk are independent rows
+    const size_t C = SlicedEllpackMatrix::chunkSize;
+    const SlicedEllpackMatrix& S = *a.sliced_;
+    for (size_t c=(start_+C-1)/C; c*C<end_; c++)
+    {
+      double sum[C] = {};
+      const size_t offset = S.offsets_[c];
+      const size_t width = (S.offsets_[c+1]-offset)/C;
+      const double* data = S.data_.get()+offset;
+      const int* columns = S.columns_.get()+offset;
+      for (size_t j=0; j<width; j++, data+=C, columns+=C)
+      {
+        for (size_t l=0; l<C; l++) sum[l] += data[l]*idata[columns[l]];
+      }
+      const index_type* rows = &S.rows_[c*C];
+      for (size_t l=0; l<C; l++)
+      {
+        if (rows[l] >= 0) odata[rows[l]] = sum[l];
+      }
+    }
+    return;
+  }
+
   double* data = a.data_;
   auto rows = a.rows_;
   auto columns = a.columns_;
@@ -650,6 +826,110 @@ void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelVector&
   }
 }
 
+void ParallelLinearAlgebra::mult_dots(const ParallelMatrix& a, const ParallelVector& u, ParallelVector& w,
+  const ParallelVector& r, double& ru, double& wu, double& rr)
+{
+  wait();
+
+  const double* idata = u.data_;
+  const double* rdata = r.data_;
+  double* odata = w.data_;
+  std::vector<double> sums(3, 0.0);
+
+  if (a.sliced_)
+  {
+    const size_t C = SlicedEllpackMatrix::chunkSize;
+    const SlicedEllpackMatrix& S = *a.sliced_;
+    for (size_t c=(start_+C-1)/C; c*C<end_; c++)
+    {
+      double sum[C] = {};
+      const size_t offset = S.offsets_[c];
+      const size_t width = (S.offsets_[c+1]-offset)/C;
+      const double* data = S.data_.get()+offset;
+      const int* columns = S.columns_.get()+offset;
+      for (size_t j=0; j<width; j++, data+=C, columns+=C)
+      {
+        for (size_t l=0; l<C; l++) sum[l] += data[l]*idata[columns[l]];
+      }
+      const index_type* rows = &S.rows_[c*C];
+      for (size_t l=0; l<C; l++)
+      {
+        const index_type i = rows[l];
+        if (i < 0) continue;
+        odata[i] = sum[l];
+        sums[0] += rdata[i]*idata[i];
+        sums[1] += sum[l]*idata[i];
+        sums[2] += rdata[i]*rdata[i];
+      }
+    }
+  }
+  else
+  {
+    const double* data = a.data_;
+    auto rows = a.rows_;
+    auto columns = a.columns_;
+
+    for(size_t i=start_;i<end_;i++)
+    {
+      double sum = 0.0;
+      index_type row_idx = rows[i];
+      index_type next_idx = rows[i+1];
+      for(index_type j=row_idx;j<next_idx;j++)
+      {
+        sum+=data[j]*idata[columns[j]];
+      }
+      odata[i]=sum;
+      sums[0] += rdata[i]*idata[i];
+      sums[1] += sum*idata[i];
+      sums[2] += rdata[i]*rdata[i];
+    }
+  }
+
+  reduce_sum(sums);
+  ru = sums[0];
+  wu = sums[1];
+  rr = sums[2];
+}
+
+void ParallelLinearAlgebra::cg_update(double alpha, double beta, ParallelVector& u, const ParallelVector& w,
+  ParallelVector& p, ParallelVector& s, ParallelVector& x, ParallelVector& r, const ParallelVector* diag)
+{
+  double* u_ptr = u.data_+start_;
+  const double* w_ptr = w.data_+start_;
+  double* p_ptr = p.data_+start_;
+  double* s_ptr = s.data_+start_;
+  double* x_ptr = x.data_+start_;
+  double* r_ptr = r.data_+start_;
+
+  if (diag)
+  {
+    const double* d_ptr = diag->data_+start_;
+    for (size_t j=0; j<local_size_; j++)
+    {
+      const double pj = u_ptr[j] + beta*p_ptr[j];
+      const double sj = w_ptr[j] + beta*s_ptr[j];
+      const double rj = r_ptr[j] - alpha*sj;
+      p_ptr[j] = pj;
+      s_ptr[j] = sj;
+      x_ptr[j] += alpha*pj;
+      r_ptr[j] = rj;
+      u_ptr[j] = d_ptr[j]*rj;
+    }
+  }
+  else
+  {
+    for (size_t j=0; j<local_size_; j++)
+    {
+      const double pj = u_ptr[j] + beta*p_ptr[j];
+      const double sj = w_ptr[j] + beta*s_ptr[j];
+      p_ptr[j] = pj;
+      s_ptr[j] = sj;
+      x_ptr[j] += alpha*pj;
+      r_ptr[j] -= alpha*sj;
+    }
+  }
+}
+
 void ParallelLinearAlgebra::mult_trans(ParallelMatrix& a, ParallelVector& b, ParallelVector& r)
 {
   wait();
@@ -767,10 +1047,251 @@ double ParallelLinearAlgebra::reduce_min(double val)
 
 
 
+size_t SolverInputs::numVectors() const
+{
+  return B ? std::max<size_t>(B->ncols(), 1) : 1;
+}
+void ParallelLinearAlgebra::reduce_sum(std::vector<double>& vals)
+{
+  // The buffers hold one slot per thread and right hand side, more values
+  // are reduced in several rounds
+  const size_t chunk = data_.reduceBufferSize()/nproc_;
+  for (size_t offset=0; offset<vals.size(); offset+=chunk)
+  {
+    const size_t k = std::min(chunk, vals.size()-offset);
+    int buffer = reduce_buffer_;
+    double* slots = reduce_[buffer];
+    for (size_t c=0; c<k; c++) slots[proc_*k+c] = vals[offset+c];
+    if (reduce_buffer_)
+      reduce_buffer_ = 0;
+    else
+      reduce_buffer_ = 1;
+    wait();
+
+    for (size_t c=0; c<k; c++)
+    {
+      double ret = 0.0; for (int j=0; j<nproc_;j++) ret += slots[j*k+c];
+      vals[offset+c] = ret;
+    }
+  }
+}
+
+//------------------------------------------------------------------
+// Multi vector operations: the matrix is streamed once for all vectors
+
+namespace
+{
+  // One row of a sparse matrix times k interleaved vectors. The vectors are
+  // processed in blocks with local accumulators, so the inner loop vectorizes.
+  void row_product(const double* data, SCIRun::index_type row_idx, SCIRun::index_type next_idx,
+    const SCIRun::index_type* columns, const double* b, size_t k, double* r)
+  {
+    const size_t block = 8;
+    size_t c0 = 0;
+    for (; c0+block<=k; c0+=block)
+    {
+      double sum[block] = {};
+      for (SCIRun::index_type j=row_idx; j<next_idx; j++)
+      {
+        const double val = data[j];
+        const double* b_ptr = b+columns[j]*k+c0;
+        for (size_t c=0; c<block; c++) sum[c] += val*b_ptr[c];
+      }
+      for (size_t c=0; c<block; c++) r[c0+c] = sum[c];
+    }
+    if (c0 < k)
+    {
+      double sum[block] = {};
+      const size_t rest = k-c0;
+      for (SCIRun::index_type j=row_idx; j<next_idx; j++)
+      {
+        const double val = data[j];
+        const double* b_ptr = b+columns[j]*k+c0;
+        for (size_t c=0; c<rest; c++) sum[c] += val*b_ptr[c];
+      }
+      for (size_t c=0; c<rest; c++) r[c0+c] = sum[c];
+    }
+  }
+}
+
+void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelMultiVector& b, ParallelMultiVector& r)
+{
+  wait();
+
+  const size_t k = b.ncols_;
+  double* idata = b.data_;
+  double* odata = r.data_;
+
+  double* data = a.data_;
+  auto rows = a.rows_;
+  auto columns = a.columns_;
+
+  for(size_t i=start_;i<end_;i++)
+  {
+    row_product(data, rows[i], rows[i+1], columns, idata, k, odata+i*k);
+  }
+}
+
+void ParallelLinearAlgebra::mult(const ParallelVector& a, const ParallelMultiVector& b, ParallelMultiVector& r)
+{
+  const size_t k = b.ncols_;
+  for (size_t i=start_; i<end_; i++)
+  {
+    const double s = a.data_[i];
+    double* b_ptr = b.data_+i*k;
+    double* r_ptr = r.data_+i*k;
+    for (size_t c=0; c<k; c++) r_ptr[c] = s*b_ptr[c];
+  }
+}
+
+void ParallelLinearAlgebra::sub(const ParallelMultiVector& a, const ParallelMultiVector& b, ParallelMultiVector& r)
+{
+  const size_t k = a.ncols_;
+  double* a_ptr = a.data_+start_*k;
+  double* b_ptr = b.data_+start_*k;
+  double* r_ptr = r.data_+start_*k;
+  for (size_t j=0; j<local_size_*k; j++) r_ptr[j] = a_ptr[j]-b_ptr[j];
+}
+
+void ParallelLinearAlgebra::copy(const ParallelMultiVector& a, ParallelMultiVector& r)
+{
+  const size_t k = a.ncols_;
+  std::copy(a.data_+start_*k, a.data_+end_*k, r.data_+start_*k);
+}
+
+void ParallelLinearAlgebra::zeros(ParallelMultiVector& r)
+{
+  const size_t k = r.ncols_;
+  std::fill(r.data_+start_*k, r.data_+end_*k, 0.0);
+}
+
+void ParallelLinearAlgebra::scale_add(const std::vector<double>& s, const ParallelMultiVector& a, const ParallelMultiVector& b, ParallelMultiVector& r)
+{
+  const size_t k = a.ncols_;
+  for (size_t i=start_; i<end_; i++)
+  {
+    double* a_ptr = a.data_+i*k;
+    double* b_ptr = b.data_+i*k;
+    double* r_ptr = r.data_+i*k;
+    for (size_t c=0; c<k; c++) r_ptr[c] = s[c]*a_ptr[c]+b_ptr[c];
+  }
+}
+
+void ParallelLinearAlgebra::dot(const ParallelMultiVector& a, const ParallelMultiVector& b, std::vector<double>& r)
+{
+  const size_t k = a.ncols_;
+  r.assign(k, 0.0);
+  for (size_t i=start_; i<end_; i++)
+  {
+    double* a_ptr = a.data_+i*k;
+    double* b_ptr = b.data_+i*k;
+    for (size_t c=0; c<k; c++) r[c] += a_ptr[c]*b_ptr[c];
+  }
+  reduce_sum(r);
+}
+
+void ParallelLinearAlgebra::norm(const ParallelMultiVector& a, std::vector<double>& r)
+{
+  dot(a, a, r);
+  for (auto& v : r) v = sqrt(v);
+}
+
+void ParallelLinearAlgebra::mult_dots(const ParallelMatrix& a, const ParallelMultiVector& u, ParallelMultiVector& w,
+  const ParallelMultiVector& r, std::vector<double>& ru, std::vector<double>& wu, std::vector<double>& rr)
+{
+  wait();
+
+  const size_t k = u.ncols_;
+  const double* data = a.data_;
+  auto rows = a.rows_;
+  auto columns = a.columns_;
+
+  // ru, wu and rr of all vectors are reduced together
+  std::vector<double> sums(3*k, 0.0);
+  double* s_ru = &sums[0];
+  double* s_wu = s_ru+k;
+  double* s_rr = s_wu+k;
+
+  for(size_t i=start_;i<end_;i++)
+  {
+    double* w_ptr = w.data_+i*k;
+    row_product(data, rows[i], rows[i+1], columns, u.data_, k, w_ptr);
+
+    const double* u_ptr = u.data_+i*k;
+    const double* r_ptr = r.data_+i*k;
+    for (size_t c=0; c<k; c++)
+    {
+      s_ru[c] += r_ptr[c]*u_ptr[c];
+      s_wu[c] += w_ptr[c]*u_ptr[c];
+      s_rr[c] += r_ptr[c]*r_ptr[c];
+    }
+  }
+
+  reduce_sum(sums);
+  ru.assign(s_ru, s_ru+k);
+  wu.assign(s_wu, s_wu+k);
+  rr.assign(s_rr, s_rr+k);
+}
+
+void ParallelLinearAlgebra::cg_update(const std::vector<double>& alpha, const std::vector<double>& beta,
+  ParallelMultiVector& u, const ParallelMultiVector& w, ParallelMultiVector& p, ParallelMultiVector& s,
+  ParallelMultiVector& x, ParallelMultiVector& r, const ParallelVector* diag)
+{
+  const size_t k = u.ncols_;
+  for (size_t i=start_; i<end_; i++)
+  {
+    double* u_ptr = u.data_+i*k;
+    const double* w_ptr = w.data_+i*k;
+    double* p_ptr = p.data_+i*k;
+    double* s_ptr = s.data_+i*k;
+    double* x_ptr = x.data_+i*k;
+    double* r_ptr = r.data_+i*k;
+    for (size_t c=0; c<k; c++)
+    {
+      const double pc = u_ptr[c] + beta[c]*p_ptr[c];
+      const double sc = w_ptr[c] + beta[c]*s_ptr[c];
+      p_ptr[c] = pc;
+      s_ptr[c] = sc;
+      x_ptr[c] += alpha[c]*pc;
+      r_ptr[c] -= alpha[c]*sc;
+    }
+    if (diag)
+    {
+      const double d = diag->data_[i];
+      for (size_t c=0; c<k; c++) u_ptr[c] = d*r_ptr[c];
+    }
+  }
+}
+
+void ParallelLinearAlgebra::get_column(const ParallelMultiVector& a, size_t c, ParallelVector& r)
+{
+  const size_t k = a.ncols_;
+  for (size_t i=start_; i<end_; i++) r.data_[i] = a.data_[i*k+c];
+}
+
+void ParallelLinearAlgebra::set_column(const ParallelVector& a, size_t c, ParallelMultiVector& r)
+{
+  const size_t k = r.ncols_;
+  for (size_t i=start_; i<end_; i++) r.data_[i*k+c] = a.data_[i];
+}
+
+void ParallelLinearAlgebra::copy_column(const ParallelMultiVector& a, size_t c, ParallelMultiVector& r)
+{
+  const size_t k = r.ncols_;
+  for (size_t i=start_; i<end_; i++) r.data_[i*k+c] = a.data_[i*k+c];
+}
+
 bool ParallelLinearAlgebraBase::start_parallel(SolverInputs& matrices, int nproc) const
 {
   size_t size = matrices.A->nrows();
-  if (matrices.b->nrows() != size
+  if (matrices.B)
+  {
+    if (matrices.B->nrows() != size
+      || !matrices.X || matrices.X->nrows() != size || matrices.X->ncols() != matrices.B->ncols()
+      || !matrices.X0 || matrices.X0->nrows() != size || matrices.X0->ncols() != matrices.B->ncols())
+      return false;
+  }
+  else if (matrices.b->nrows() != size
     || matrices.x->nrows() != size
     || matrices.x0->nrows() != size)
     return false;
@@ -806,10 +1327,40 @@ ParallelLinearAlgebraSharedData::ParallelLinearAlgebraSharedData(const SolverInp
   imatrices_(inputs),
   barrier_("Parallel Linear Algebra", numProcs),
   numProcs_(numProcs),
-  reduce1_(numProcs),
-  reduce2_(numProcs)
+  // The fused kernels reduce three values per vector at once
+  reduce1_(numProcs*3*inputs.numVectors()),
+  reduce2_(numProcs*3*inputs.numVectors()),
+  partition_(numProcs+1, size_)
 {
-  if (inputs.b->nrows() != size_
+  // Balance the rows over the threads by their cost in an iteration: the
+  // nonzeros of the matrix product plus a few vector operations per row.
+  // Boundaries are aligned to the chunks of the sliced matrix layout.
+  const size_t C = SlicedEllpackMatrix::chunkSize;
+  inputs.A->makeCompressed();
+  const index_type* rows = inputs.A->outerIndexPtr();
+  const double rowCost = 2.0;
+  const double total = rows[size_] + rowCost*size_;
+  partition_[0] = 0;
+  size_t i = 0;
+  for (int p=1; p<numProcs; p++)
+  {
+    const double target = total*p/numProcs;
+    while (i < size_ && rows[i] + rowCost*i < target) i++;
+    partition_[p] = std::max(std::min(((i+C/2)/C)*C, size_), partition_[p-1]);
+  }
+
+  const size_t numChunks = (size_+C-1)/C;
+  sliced_.offsets_.assign(numChunks+1, 0);
+  sliced_.rows_.resize(numChunks*C);
+
+  if (inputs.B)
+  {
+    if (inputs.B->nrows() != size_
+      || inputs.X->nrows() != size_
+      || inputs.X0->nrows() != size_)
+      BOOST_THROW_EXCEPTION(AlgorithmInputException() << ErrorMessage("Dimension mismatch"));
+  }
+  else if (inputs.b->nrows() != size_
     || inputs.x->nrows() != size_
     || inputs.x0->nrows() != size_)
     BOOST_THROW_EXCEPTION(AlgorithmInputException() << ErrorMessage("Dimension mismatch")); /// @todo: use new DimensionMismatch exception type
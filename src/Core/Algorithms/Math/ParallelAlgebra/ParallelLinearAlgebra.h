@@ -35,6 +35,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <boost/noncopyable.hpp>
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Thread/Barrier.h>
@@ -55,23 +56,64 @@ namespace Math {
     Datatypes::DenseColumnMatrixHandle x0;
     Datatypes::DenseColumnMatrixHandle x;
 
+    // Multiple right hand sides, one column per right hand side. DenseMatrix
+    // is row major, so the entries of all vectors for one unknown are contiguous
+    Datatypes::DenseMatrixHandle B;
+    Datatypes::DenseMatrixHandle X0;
+    Datatypes::DenseMatrixHandle X;
+
+    size_t numVectors() const;
+
     void clear()
     {
       A.reset();
       b.reset();
       x0.reset();
       x.reset();
+      B.reset();
+      X0.reset();
+      X.reset();
     }
   };
 
+  // Sliced ELLPACK (SELL-C-sigma) copy of the system matrix. Rows are grouped
+  // in chunks of chunkSize rows that are stored column by column and padded to
+  // the longest row of the chunk, so the inner product loop runs across the rows
+  // of a chunk and vectorizes. Rows are sorted by length within windows of
+  // sortWindow rows to keep the padding small.
+  class SCISHARE SlicedEllpackMatrix : boost::noncopyable
+  {
+  public:
+    static constexpr size_t chunkSize = 8;
+    static constexpr size_t sortWindow = 256;
+
+    // Above this ratio of stored entries to nonzeros the padding costs more
+    // than the vectorization gains and the CSR kernel is used instead
+    static constexpr double maxFillRatio = 1.5;
+
+    bool valid_ = false;
+    // Start of each chunk in data_ and columns_, one extra entry at the end
+    std::vector<size_t> offsets_;
+    // Original row of each chunk slot, -1 for the padding of the last chunk
+    std::vector<index_type> rows_;
+    std::unique_ptr<int[]> columns_;
+    std::unique_ptr<double[]> data_;
+  };
+
   class SCISHARE ParallelLinearAlgebraSharedData : boost::noncopyable
   {
   public:
     explicit ParallelLinearAlgebraSharedData(const SolverInputs& inputs, int numProcs);
     size_t getSize() const { return size_; }
+    // First row owned by thread proc, the partition balances nonzeros
+    size_t rowStart(int proc) const { return partition_[proc]; }
+    SlicedEllpackMatrix& slicedMatrix() { return sliced_; }
     Datatypes::DenseColumnMatrixHandle getCurrentMatrix() const { return current_matrix_; }
     void setCurrentMatrix(Datatypes::DenseColumnMatrixHandle mat) { current_matrix_ = mat; }
     void addVector(Datatypes::DenseColumnMatrixHandle mat) { vectors_.push_back(mat); }
+    Datatypes::DenseMatrixHandle getCurrentMultiVector() const { return current_multi_vector_; }
+    void setCurrentMultiVector(Datatypes::DenseMatrixHandle mat) { current_multi_vector_ = mat; }
+    void addMultiVector(Datatypes::DenseMatrixHandle mat) { multi_vectors_.push_back(mat); }
     void setFlag(size_t i, bool b) { success_[i] = b; }
     void setSuccess(size_t i) { success_[i] = true; }
     void setFail(size_t i) { success_[i] = false; }
@@ -95,18 +137,23 @@ namespace Math {
 
     double* reduceBuffer1() { return &reduce1_[0]; }
     double* reduceBuffer2() { return &reduce2_[0]; }
+    size_t reduceBufferSize() const { return reduce1_.size(); }
 
   private:
     size_t size_;
     Datatypes::DenseColumnMatrixHandle current_matrix_;
     std::list<Datatypes::DenseColumnMatrixHandle> vectors_;
+    Datatypes::DenseMatrixHandle current_multi_vector_;
+    std::list<Datatypes::DenseMatrixHandle> multi_vectors_;
     std::vector<bool> success_;
     SolverInputs imatrices_;
     SCIRun::Core::Thread::Barrier barrier_;
     int numProcs_;
-    /// classes for communication
+    /// classes for communication, one slot per thread and vector
     std::vector<double> reduce1_;
     std::vector<double> reduce2_;
+    std::vector<size_t> partition_;
+    SlicedEllpackMatrix sliced_;
   };
 
 // The algorithm that uses this should derive from this class
@@ -145,6 +192,17 @@ public:
       size_t   m_;
       size_t   n_;
       size_t   nnz_;
+
+      // Vectorized copy used by mult when available
+      const SlicedEllpackMatrix* sliced_ = nullptr;
+  };
+
+  // Several vectors of the same size, entry (i,c) is stored at data_[i*ncols_+c]
+  class ParallelMultiVector {
+    public:
+      double* data_;
+      size_t size_;
+      size_t ncols_;
   };
 
   // Constructor
@@ -153,6 +211,8 @@ public:
   bool add_vector(Datatypes::DenseColumnMatrixHandle mat, ParallelVector& V);
   bool new_vector(ParallelVector& V);
   bool add_matrix(Datatypes::SparseRowMatrixHandle mat, ParallelMatrix& M);
+  bool add_multi_vector(Datatypes::DenseMatrixHandle mat, ParallelMultiVector& V);
+  bool new_multi_vector(size_t ncols, ParallelMultiVector& V);
 
   void mult(const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
   void sub(const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
@@ -189,9 +249,42 @@ public:
 
   void ones(ParallelVector& r);
 
+  // Fused operations, each makes one pass over memory and needs one barrier at most
+  // w = A*u, and in the same pass ru = dot(r,u), wu = dot(w,u), rr = dot(r,r)
+  void mult_dots(const ParallelMatrix& a, const ParallelVector& u, ParallelVector& w,
+    const ParallelVector& r, double& ru, double& wu, double& rr);
+  // p = u + beta*p; s = w + beta*s; x += alpha*p; r -= alpha*s; and u = diag*r
+  // unless diag is null
+  void cg_update(double alpha, double beta, ParallelVector& u, const ParallelVector& w,
+    ParallelVector& p, ParallelVector& s, ParallelVector& x, ParallelVector& r,
+    const ParallelVector* diag);
+
+  // Multi vector versions, results that are reduced have one entry per vector
+  void mult(const ParallelMatrix& a, const ParallelMultiVector& b, ParallelMultiVector& r);
+  void mult(const ParallelVector& a, const ParallelMultiVector& b, ParallelMultiVector& r);
+  void sub(const ParallelMultiVector& a, const ParallelMultiVector& b, ParallelMultiVector& r);
+  void copy(const ParallelMultiVector& a, ParallelMultiVector& r);
+  void zeros(ParallelMultiVector& r);
+  // r(:,c) = s[c]*a(:,c) + b(:,c);
+  void scale_add(const std::vector<double>& s, const ParallelMultiVector& a, const ParallelMultiVector& b, ParallelMultiVector& r);
+  void dot(const ParallelMultiVector& a, const ParallelMultiVector& b, std::vector<double>& r);
+  void norm(const ParallelMultiVector& a, std::vector<double>& r);
+  void mult_dots(const ParallelMatrix& a, const ParallelMultiVector& u, ParallelMultiVector& w,
+    const ParallelMultiVector& r, std::vector<double>& ru, std::vector<double>& wu, std::vector<double>& rr);
+  void cg_update(const std::vector<double>& alpha, const std::vector<double>& beta, ParallelMultiVector& u,
+    const ParallelMultiVector& w, ParallelMultiVector& p, ParallelMultiVector& s, ParallelMultiVector& x,
+    ParallelMultiVector& r, const ParallelVector* diag);
+  void get_column(const ParallelMultiVector& a, size_t c, ParallelVector& r);
+  void set_column(const ParallelVector& a, size_t c, ParallelMultiVector& r);
+  void copy_column(const ParallelMultiVector& a, size_t c, ParallelMultiVector& r);
+
   int  proc() { return proc_; }
   int  nproc() { return nproc_; }
 
+  // Row range [start, end) owned by this thread
+  size_t start() const { return start_; }
+  size_t end() const { return end_; }
+
   bool first() { return proc_ == 0; }
   void wait();
 
@@ -199,6 +292,8 @@ private:
   double reduce_sum(double val);
   double reduce_min(double val);
   double reduce_max(double val);
+  void reduce_sum(std::vector<double>& vals);
+  bool build_sliced_matrix(Datatypes::SparseRowMatrixHandle mat);
 
   ParallelLinearAlgebraSharedData& data_;
 
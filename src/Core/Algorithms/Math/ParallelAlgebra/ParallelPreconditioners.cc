@@ -0,0 +1,758 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <Eigen/Dense>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelPreconditioners.h>
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using SCIRun::index_type;
+
+namespace
+{
+  // Settings for the smoothed aggregation hierarchy
+  const double strengthThreshold = 0.08;
+  const size_t maxCoarseSize = 256;
+  const size_t maxLevels = 10;
+  const int smoothingSweeps = 2;
+}
+
+ParallelPreconditioner::ParallelPreconditioner() :
+  fingerprint_(0),
+  builds_(0),
+  ready_(false),
+  reuse_(false)
+{}
+
+ParallelPreconditioner::~ParallelPreconditioner()
+{}
+
+bool ParallelPreconditioner::setup(ParallelLinearAlgebra& PLA, SparseRowMatrixHandle matrix,
+  const ParallelLinearAlgebra::ParallelMatrix& A)
+{
+  if (PLA.first())
+    hashes_.assign(PLA.nproc(), 0);
+  PLA.wait();
+
+  // Values are part of the key, so a matrix that was altered in place is set up
+  // again. Every thread hashes the values of its own rows.
+  std::hash<double> hasher;
+  size_t hash = 0;
+  for (index_type k = A.rows_[PLA.start()]; k < A.rows_[PLA.end()]; ++k)
+    hash = (hash * 1099511628211ULL) ^ hasher(A.data_[k]);
+  hashes_[PLA.proc()] = hash;
+  PLA.wait();
+
+  if (PLA.first())
+  {
+    size_t fingerprint = A.m_ ^ (A.nnz_ << 16);
+    for (auto h : hashes_)
+      fingerprint = (fingerprint * 1099511628211ULL) ^ h;
+
+    reuse_ = ready_ && matrix_.lock() == matrix && fingerprint == fingerprint_ && reusable(PLA.nproc());
+    if (!reuse_)
+    {
+      ready_ = false;
+      matrix_ = matrix;
+      fingerprint_ = fingerprint;
+      builds_++;
+    }
+    attach(A);
+  }
+  PLA.wait();
+
+  if (!reuse_)
+  {
+    bool success = build(PLA, A);
+    if (PLA.first())
+      ready_ = success;
+  }
+  PLA.wait();
+
+  return ready_;
+}
+
+void ParallelPreconditioner::rowRange(size_t size, int proc, int nproc, size_t& start, size_t& end)
+{
+  // Even partitioning, used for matrices other than the system matrix
+  size_t local_size = size / nproc;
+  start = proc * local_size;
+  end = (proc + 1) * local_size;
+  if (proc == nproc - 1) end = size;
+}
+
+void ParallelPreconditioner::concatenate(const std::vector<CsrRows>& parts, size_t m, size_t n, CsrMatrix& M)
+{
+  M.m_ = m;
+  M.n_ = n;
+  M.rows_.clear();
+  M.rows_.reserve(m + 1);
+  M.rows_.push_back(0);
+
+  size_t nnz = 0;
+  for (const auto& part : parts)
+    nnz += part.columns_.size();
+  M.columns_.clear();
+  M.columns_.reserve(nnz);
+  M.data_.clear();
+  M.data_.reserve(nnz);
+
+  for (const auto& part : parts)
+  {
+    for (auto count : part.count_)
+      M.rows_.push_back(M.rows_.back() + count);
+    M.columns_.insert(M.columns_.end(), part.columns_.begin(), part.columns_.end());
+    M.data_.insert(M.data_.end(), part.data_.begin(), part.data_.end());
+  }
+}
+
+//------------------------------------------------------------------
+// Block Jacobi IC(0)
+
+bool ParallelIncompleteCholesky::reusable(int nproc) const
+{
+  return factors_.size() == static_cast<size_t>(nproc);
+}
+
+bool ParallelIncompleteCholesky::build(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelMatrix& A)
+{
+  if (PLA.first())
+  {
+    factors_.assign(PLA.nproc(), CsrMatrix());
+    work_.assign(PLA.nproc(), std::vector<double>());
+  }
+  PLA.wait();
+
+  const index_type start = PLA.start();
+  const index_type end = PLA.end();
+  const size_t size = end - start;
+
+  CsrMatrix& L = factors_[PLA.proc()];
+  L.m_ = size;
+  L.n_ = size;
+  L.rows_.assign(size + 1, 0);
+
+  std::vector<double> w(size, 0.0);
+  std::vector<index_type> marker(size, -1);
+
+  for (size_t i = 0; i < size; ++i)
+  {
+    const index_type row = start + i;
+    const index_type mark = i;
+    const size_t rowstart = L.columns_.size();
+    double aii = 0.0;
+
+    // Scatter the lower triangular part of this row that falls inside the block
+    for (index_type k = A.rows_[row]; k < A.rows_[row + 1]; ++k)
+    {
+      const index_type c = A.columns_[k];
+      if (c == row)
+      {
+        aii += A.data_[k];
+      }
+      else if (c >= start && c < row)
+      {
+        const index_type local = c - start;
+        if (marker[local] != mark)
+        {
+          marker[local] = mark;
+          w[local] = 0.0;
+          L.columns_.push_back(local);
+        }
+        w[local] += A.data_[k];
+      }
+    }
+    std::sort(L.columns_.begin() + rowstart, L.columns_.end());
+
+    double d = aii;
+    for (size_t p = rowstart; p < L.columns_.size(); ++p)
+    {
+      const index_type c = L.columns_[p];
+      const index_type diag = L.rows_[c + 1] - 1;
+
+      // w holds the finished entries of this row for columns below c
+      double sum = w[c];
+      for (index_type q = L.rows_[c]; q < diag; ++q)
+      {
+        if (marker[L.columns_[q]] == mark)
+          sum -= w[L.columns_[q]] * L.data_[q];
+      }
+
+      const double lic = sum / L.data_[diag];
+      w[c] = lic;
+      L.data_.push_back(lic);
+      d -= lic * lic;
+    }
+
+    // Guard against breakdown for matrices that are not diagonally dominant
+    if (!(d > 1e-12 * std::abs(aii)))
+      d = (aii != 0.0) ? std::abs(aii) : 1.0;
+
+    L.columns_.push_back(i);
+    L.data_.push_back(std::sqrt(d));
+    L.rows_[i + 1] = L.columns_.size();
+  }
+
+  work_[PLA.proc()].resize(size);
+  return true;
+}
+
+void ParallelIncompleteCholesky::apply(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& r,
+  ParallelLinearAlgebra::ParallelVector& z)
+{
+  const CsrMatrix& L = factors_[PLA.proc()];
+  std::vector<double>& y = work_[PLA.proc()];
+  const double* r_ptr = r.data_ + PLA.start();
+  double* z_ptr = z.data_ + PLA.start();
+  const size_t size = L.m_;
+
+  // Solve L*y = r
+  for (size_t i = 0; i < size; ++i)
+  {
+    const index_type diag = L.rows_[i + 1] - 1;
+    double sum = r_ptr[i];
+    for (index_type q = L.rows_[i]; q < diag; ++q)
+      sum -= L.data_[q] * y[L.columns_[q]];
+    y[i] = sum / L.data_[diag];
+  }
+
+  // Solve L^T*z = y
+  for (size_t i = size; i-- > 0;)
+  {
+    const index_type diag = L.rows_[i + 1] - 1;
+    const double yi = y[i] / L.data_[diag];
+    y[i] = yi;
+    for (index_type q = L.rows_[i]; q < diag; ++q)
+      y[L.columns_[q]] -= L.data_[q] * yi;
+  }
+
+  for (size_t i = 0; i < size; ++i)
+    z_ptr[i] = y[i];
+}
+
+//------------------------------------------------------------------
+// Smoothed aggregation AMG
+
+struct ParallelAlgebraicMultigrid::CoarseSolver
+{
+  Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXd> solver_;
+};
+
+namespace
+{
+  // Rows [start, end) of A*B, with B stored in CSR format
+  void multiplyRows(const index_type* rows, const index_type* columns, const double* data,
+    const std::vector<index_type>& brows, const std::vector<index_type>& bcolumns, const std::vector<double>& bdata,
+    size_t bcols, size_t start, size_t end,
+    std::vector<index_type>& count, std::vector<index_type>& ocolumns, std::vector<double>& odata)
+  {
+    std::vector<double> acc(bcols, 0.0);
+    std::vector<index_type> marker(bcols, -1);
+    std::vector<index_type> pattern;
+
+    for (size_t i = start; i < end; ++i)
+    {
+      const index_type mark = i;
+      pattern.clear();
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+      {
+        const index_type c = columns[k];
+        const double a = data[k];
+        for (index_type q = brows[c]; q < brows[c + 1]; ++q)
+        {
+          const index_type bc = bcolumns[q];
+          if (marker[bc] != mark)
+          {
+            marker[bc] = mark;
+            acc[bc] = 0.0;
+            pattern.push_back(bc);
+          }
+          acc[bc] += a * bdata[q];
+        }
+      }
+      std::sort(pattern.begin(), pattern.end());
+      for (auto c : pattern)
+      {
+        ocolumns.push_back(c);
+        odata.push_back(acc[c]);
+      }
+      count.push_back(pattern.size());
+    }
+  }
+}
+
+ParallelAlgebraicMultigrid::ParallelAlgebraicMultigrid() :
+  num_levels_(0),
+  num_aggregates_(0),
+  coarsest_(false)
+{
+  A0_.rows_ = nullptr;
+  A0_.columns_ = nullptr;
+  A0_.data_ = nullptr;
+  A0_.m_ = A0_.n_ = A0_.nnz_ = 0;
+}
+
+ParallelAlgebraicMultigrid::~ParallelAlgebraicMultigrid()
+{}
+
+void ParallelAlgebraicMultigrid::attach(const ParallelLinearAlgebra::ParallelMatrix& A)
+{
+  A0_ = A;
+}
+
+size_t ParallelAlgebraicMultigrid::levelSize(size_t level) const
+{
+  return level == 0 ? A0_.m_ : levels_[level].A_.m_;
+}
+
+void ParallelAlgebraicMultigrid::matrix(size_t level, const index_type*& rows, const index_type*& columns, const double*& data) const
+{
+  if (level == 0)
+  {
+    rows = A0_.rows_;
+    columns = A0_.columns_;
+    data = A0_.data_;
+  }
+  else
+  {
+    const CsrMatrix& A = levels_[level].A_;
+    rows = A.rows_.data();
+    columns = A.columns_.data();
+    data = A.data_.data();
+  }
+}
+
+void ParallelAlgebraicMultigrid::aggregate(size_t start, size_t end, index_type& count)
+{
+  // Aggregates do not cross the row ranges of the threads, so every thread
+  // aggregates its own rows and only follows strong connections inside them.
+  // Aggregates are numbered locally, starting at zero.
+  auto local = [start, end](index_type j)
+    { return static_cast<size_t>(j) >= start && static_cast<size_t>(j) < end; };
+  count = 0;
+
+  // Phase 1: nodes whose strong neighborhood is still free become roots
+  for (size_t i = start; i < end; ++i)
+  {
+    if (aggregates_[i] != -1 || std::none_of(strong_[i].begin(), strong_[i].end(), local)) continue;
+    bool free = std::all_of(strong_[i].begin(), strong_[i].end(),
+      [&](index_type j) { return !local(j) || aggregates_[j] == -1; });
+    if (free)
+    {
+      aggregates_[i] = count;
+      for (auto j : strong_[i])
+        if (local(j)) aggregates_[j] = count;
+      count++;
+    }
+  }
+
+  // Phase 2: attach the remaining nodes to a neighboring aggregate
+  std::vector<index_type> roots(aggregates_.begin() + start, aggregates_.begin() + end);
+  for (size_t i = start; i < end; ++i)
+  {
+    if (aggregates_[i] != -1) continue;
+    for (auto j : strong_[i])
+    {
+      if (local(j) && roots[j - start] != -1)
+      {
+        aggregates_[i] = roots[j - start];
+        break;
+      }
+    }
+  }
+
+  // Phase 3: whatever is left, including isolated nodes, forms new aggregates
+  for (size_t i = start; i < end; ++i)
+  {
+    if (aggregates_[i] != -1) continue;
+    aggregates_[i] = count;
+    for (auto j : strong_[i])
+      if (local(j) && aggregates_[j] == -1) aggregates_[j] = count;
+    count++;
+  }
+}
+
+void ParallelAlgebraicMultigrid::buildCoarseSolver(size_t level)
+{
+  const index_type *rows, *columns;
+  const double* data;
+  matrix(level, rows, columns, data);
+
+  const size_t size = levelSize(level);
+  Eigen::MatrixXd dense = Eigen::MatrixXd::Zero(size, size);
+  for (size_t i = 0; i < size; ++i)
+    for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+      dense(i, columns[k]) += data[k];
+
+  coarse_.reset(new CoarseSolver);
+  coarse_->solver_.compute(dense);
+  num_levels_ = level + 1;
+}
+
+bool ParallelAlgebraicMultigrid::build(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelMatrix&)
+{
+  const int proc = PLA.proc();
+  const int nproc = PLA.nproc();
+
+  if (PLA.first())
+  {
+    levels_.clear();
+    levels_.reserve(maxLevels);
+    levels_.emplace_back();
+    parts_.assign(nproc, CsrRows());
+    rho_.assign(nproc, 0.0);
+    counts_.assign(nproc, 0);
+    num_levels_ = 0;
+    coarse_.reset();
+  }
+
+  for (size_t level = 0; ; ++level)
+  {
+    const size_t size = levelSize(level);
+    size_t start, end;
+    levelRange(PLA, level, start, end);
+
+    const index_type *rows, *columns;
+    const double* data;
+    matrix(level, rows, columns, data);
+
+    if (PLA.first())
+    {
+      Level& L = levels_[level];
+      L.x_.assign(size, 0.0);
+      L.b_.assign(size, 0.0);
+      L.r_.assign(size, 0.0);
+      L.tmp_.assign(size, 0.0);
+      L.invdiag_.assign(size, 0.0);
+      diag_.assign(size, 0.0);
+      strong_.assign(size, std::vector<index_type>());
+      aggregates_.assign(size, -1);
+      coarsest_ = (size <= maxCoarseSize || level + 1 == maxLevels);
+    }
+    PLA.wait();
+
+    if (coarsest_)
+    {
+      if (PLA.first()) buildCoarseSolver(level);
+      PLA.wait();
+      break;
+    }
+
+    for (size_t i = start; i < end; ++i)
+    {
+      double d = 0.0;
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+        if (columns[k] == static_cast<index_type>(i)) d += data[k];
+      diag_[i] = d;
+      levels_[level].invdiag_[i] = (d != 0.0) ? 1.0 / d : 0.0;
+    }
+    PLA.wait();
+
+    // Strength of connection and a Gershgorin bound on the spectral radius of D^-1*A.
+    // Coarse operators spread their weight over more neighbors, hence the threshold
+    // is halved on every level.
+    const double theta = strengthThreshold * std::pow(0.5, static_cast<double>(level));
+    double rho = 0.0;
+    for (size_t i = start; i < end; ++i)
+    {
+      const double aii = diag_[i];
+      double offdiag = 0.0;
+      for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+      {
+        const index_type c = columns[k];
+        const double v = std::abs(data[k]);
+        if (c == static_cast<index_type>(i) || v == 0.0) continue;
+        offdiag += v;
+        if (v >= theta * std::sqrt(std::abs(aii * diag_[c])))
+          strong_[i].push_back(c);
+      }
+      if (aii != 0.0) rho = std::max(rho, 1.0 + offdiag / std::abs(aii));
+    }
+    rho_[proc] = rho;
+    aggregate(start, end, counts_[proc]);
+    PLA.wait();
+
+    // Shift the local aggregate numbers past the ones of the preceding threads
+    const index_type offset = std::accumulate(counts_.begin(), counts_.begin() + proc, index_type(0));
+    for (size_t i = start; i < end; ++i)
+      aggregates_[i] += offset;
+
+    if (PLA.first())
+    {
+      num_aggregates_ = std::accumulate(counts_.begin(), counts_.end(), index_type(0));
+      double maxrho = *std::max_element(rho_.begin(), rho_.end());
+      levels_[level].omega_ = 4.0 / (3.0 * (maxrho > 0.0 ? maxrho : 1.0));
+
+      // Stop when aggregation no longer reduces the problem size
+      coarsest_ = (4 * num_aggregates_ > 3 * size);
+      if (coarsest_) buildCoarseSolver(level);
+    }
+    PLA.wait();
+    if (coarsest_) break;
+
+    Level& L = levels_[level];
+    const size_t ncoarse = num_aggregates_;
+
+    // Smoothed prolongator P = (I - omega*D^-1*A)*T, with T the aggregate indicator
+    {
+      CsrRows& part = parts_[proc];
+      part.clear();
+      std::vector<double> acc(ncoarse, 0.0);
+      std::vector<index_type> marker(ncoarse, -1);
+      std::vector<index_type> pattern;
+
+      for (size_t i = start; i < end; ++i)
+      {
+        const index_type mark = i;
+        pattern.clear();
+        auto add = [&](index_type c, double v)
+        {
+          if (marker[c] != mark)
+          {
+            marker[c] = mark;
+            acc[c] = 0.0;
+            pattern.push_back(c);
+          }
+          acc[c] += v;
+        };
+
+        add(aggregates_[i], 1.0);
+        const double s = L.omega_ * L.invdiag_[i];
+        for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+          add(aggregates_[columns[k]], -s * data[k]);
+
+        std::sort(pattern.begin(), pattern.end());
+        index_type count = 0;
+        for (auto c : pattern)
+        {
+          if (acc[c] == 0.0) continue;
+          part.columns_.push_back(c);
+          part.data_.push_back(acc[c]);
+          count++;
+        }
+        part.count_.push_back(count);
+      }
+    }
+    PLA.wait();
+    if (PLA.first()) concatenate(parts_, size, ncoarse, L.P_);
+    PLA.wait();
+
+    // A*P
+    {
+      CsrRows& part = parts_[proc];
+      part.clear();
+      multiplyRows(rows, columns, data, L.P_.rows_, L.P_.columns_, L.P_.data_, ncoarse,
+        start, end, part.count_, part.columns_, part.data_);
+    }
+    PLA.wait();
+
+    if (PLA.first())
+    {
+      concatenate(parts_, size, ncoarse, AP_);
+
+      // R = P^T
+      CsrMatrix& R = L.R_;
+      R.m_ = ncoarse;
+      R.n_ = size;
+      R.rows_.assign(ncoarse + 1, 0);
+      for (auto c : L.P_.columns_) R.rows_[c + 1]++;
+      for (size_t j = 0; j < ncoarse; ++j) R.rows_[j + 1] += R.rows_[j];
+      R.columns_.resize(L.P_.columns_.size());
+      R.data_.resize(L.P_.data_.size());
+      std::vector<index_type> fill(R.rows_.begin(), R.rows_.end() - 1);
+      for (size_t i = 0; i < size; ++i)
+      {
+        for (index_type q = L.P_.rows_[i]; q < L.P_.rows_[i + 1]; ++q)
+        {
+          const index_type dest = fill[L.P_.columns_[q]]++;
+          R.columns_[dest] = i;
+          R.data_[dest] = L.P_.data_[q];
+        }
+      }
+    }
+    PLA.wait();
+
+    // Galerkin coarse operator R*(A*P)
+    {
+      size_t cstart, cend;
+      rowRange(ncoarse, proc, nproc, cstart, cend);
+      CsrRows& part = parts_[proc];
+      part.clear();
+      multiplyRows(L.R_.rows_.data(), L.R_.columns_.data(), L.R_.data_.data(),
+        AP_.rows_, AP_.columns_, AP_.data_, ncoarse,
+        cstart, cend, part.count_, part.columns_, part.data_);
+    }
+    PLA.wait();
+
+    if (PLA.first())
+    {
+      levels_.emplace_back();
+      concatenate(parts_, ncoarse, ncoarse, levels_[level + 1].A_);
+      AP_ = CsrMatrix();
+    }
+    PLA.wait();
+  }
+
+  if (PLA.first())
+  {
+    diag_.clear();
+    strong_.clear();
+    aggregates_.clear();
+    parts_.clear();
+  }
+  PLA.wait();
+
+  return true;
+}
+
+void ParallelAlgebraicMultigrid::levelRange(ParallelLinearAlgebra& PLA, size_t level, size_t& start, size_t& end) const
+{
+  // The finest level shares its vectors with the solver and has to use its partition
+  if (level == 0)
+  {
+    start = PLA.start();
+    end = PLA.end();
+  }
+  else
+  {
+    rowRange(levelSize(level), PLA.proc(), PLA.nproc(), start, end);
+  }
+}
+
+void ParallelAlgebraicMultigrid::smooth(ParallelLinearAlgebra& PLA, size_t level)
+{
+  Level& L = levels_[level];
+  const index_type *rows, *columns;
+  const double* data;
+  matrix(level, rows, columns, data);
+
+  size_t start, end;
+  levelRange(PLA, level, start, end);
+
+  PLA.wait();
+  for (size_t i = start; i < end; ++i)
+  {
+    double sum = L.b_[i];
+    for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+      sum -= data[k] * L.x_[columns[k]];
+    L.tmp_[i] = L.x_[i] + L.omega_ * L.invdiag_[i] * sum;
+  }
+  PLA.wait();
+  for (size_t i = start; i < end; ++i)
+    L.x_[i] = L.tmp_[i];
+}
+
+void ParallelAlgebraicMultigrid::cycle(ParallelLinearAlgebra& PLA, size_t level)
+{
+  Level& L = levels_[level];
+  const size_t size = levelSize(level);
+
+  if (level + 1 == num_levels_)
+  {
+    PLA.wait();
+    if (PLA.first())
+    {
+      Eigen::Map<const Eigen::VectorXd> b(L.b_.data(), size);
+      Eigen::Map<Eigen::VectorXd> x(L.x_.data(), size);
+      x = coarse_->solver_.solve(b);
+    }
+    PLA.wait();
+    return;
+  }
+
+  const index_type *rows, *columns;
+  const double* data;
+  matrix(level, rows, columns, data);
+
+  size_t start, end;
+  levelRange(PLA, level, start, end);
+
+  // Pre-smoothing, the first sweep starts from a zero initial guess
+  for (size_t i = start; i < end; ++i)
+    L.x_[i] = L.omega_ * L.invdiag_[i] * L.b_[i];
+  for (int sweep = 1; sweep < smoothingSweeps; ++sweep)
+    smooth(PLA, level);
+
+  PLA.wait();
+  for (size_t i = start; i < end; ++i)
+  {
+    double sum = L.b_[i];
+    for (index_type k = rows[i]; k < rows[i + 1]; ++k)
+      sum -= data[k] * L.x_[columns[k]];
+    L.r_[i] = sum;
+  }
+
+  // Restriction
+  Level& C = levels_[level + 1];
+  size_t cstart, cend;
+  rowRange(C.A_.m_, PLA.proc(), PLA.nproc(), cstart, cend);
+  PLA.wait();
+  for (size_t j = cstart; j < cend; ++j)
+  {
+    double sum = 0.0;
+    for (index_type q = L.R_.rows_[j]; q < L.R_.rows_[j + 1]; ++q)
+      sum += L.R_.data_[q] * L.r_[L.R_.columns_[q]];
+    C.b_[j] = sum;
+  }
+
+  cycle(PLA, level + 1);
+
+  // Prolongation of the coarse correction
+  PLA.wait();
+  for (size_t i = start; i < end; ++i)
+  {
+    double sum = 0.0;
+    for (index_type q = L.P_.rows_[i]; q < L.P_.rows_[i + 1]; ++q)
+      sum += L.P_.data_[q] * C.x_[L.P_.columns_[q]];
+    L.x_[i] += sum;
+  }
+
+  for (int sweep = 0; sweep < smoothingSweeps; ++sweep)
+    smooth(PLA, level);
+}
+
+void ParallelAlgebraicMultigrid::apply(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& r,
+  ParallelLinearAlgebra::ParallelVector& z)
+{
+  Level& L = levels_[0];
+  const size_t start = PLA.start();
+  const size_t end = PLA.end();
+
+  for (size_t i = start; i < end; ++i)
+    L.b_[i] = r.data_[i];
+
+  cycle(PLA, 0);
+
+  for (size_t i = start; i < end; ++i)
+    z.data_[i] = L.x_[i];
+}
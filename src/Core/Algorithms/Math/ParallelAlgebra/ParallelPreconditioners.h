@@ -0,0 +1,182 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_PARALLELALGEBRA_PARALLELPRECONDITIONERS_H
+#define CORE_ALGORITHMS_MATH_PARALLELALGEBRA_PARALLELPRECONDITIONERS_H
+
+#include <memory>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+// Preconditioners that are built and applied by all threads of a
+// ParallelLinearAlgebra solver. Setup is kept between solves: calling setup
+// again with the same (unchanged) matrix reuses the previous factorization or
+// hierarchy, so repeated solves with different right hand sides only pay for
+// the apply.
+
+class SCISHARE ParallelPreconditioner : boost::noncopyable
+{
+public:
+  ParallelPreconditioner();
+  virtual ~ParallelPreconditioner();
+
+  // Needs to be called by every thread before the first apply
+  bool setup(ParallelLinearAlgebra& PLA, Datatypes::SparseRowMatrixHandle matrix,
+             const ParallelLinearAlgebra::ParallelMatrix& A);
+
+  // z = M^-1 * r, needs to be called by every thread; r and z may be the same vector
+  virtual void apply(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& r,
+                     ParallelLinearAlgebra::ParallelVector& z) = 0;
+
+  // Number of times setup had to build the preconditioner
+  size_t numBuilds() const { return builds_; }
+
+protected:
+  virtual bool build(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelMatrix& A) = 0;
+  virtual void attach(const ParallelLinearAlgebra::ParallelMatrix&) {}
+  virtual bool reusable(int nproc) const = 0;
+
+  struct CsrMatrix
+  {
+    size_t m_ = 0;
+    size_t n_ = 0;
+    std::vector<index_type> rows_;
+    std::vector<index_type> columns_;
+    std::vector<double> data_;
+  };
+
+  // Rows of a matrix computed by one thread
+  struct CsrRows
+  {
+    std::vector<index_type> count_;
+    std::vector<index_type> columns_;
+    std::vector<double> data_;
+
+    void clear() { count_.clear(); columns_.clear(); data_.clear(); }
+  };
+
+  static void rowRange(size_t size, int proc, int nproc, size_t& start, size_t& end);
+  static void concatenate(const std::vector<CsrRows>& parts, size_t m, size_t n, CsrMatrix& M);
+
+private:
+  std::weak_ptr<Datatypes::SparseRowMatrix> matrix_;
+  std::vector<size_t> hashes_;
+  size_t fingerprint_;
+  size_t builds_;
+  bool ready_;
+  bool reuse_;
+};
+
+// Block Jacobi incomplete Cholesky, IC(0) on the diagonal block owned by each
+// thread. Both the factorization and the triangular solves run without any
+// synchronization between threads.
+
+class SCISHARE ParallelIncompleteCholesky : public ParallelPreconditioner
+{
+public:
+  void apply(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& r,
+             ParallelLinearAlgebra::ParallelVector& z) override;
+
+protected:
+  bool build(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelMatrix& A) override;
+  bool reusable(int nproc) const override;
+
+private:
+  // Lower triangular factor in block local numbering, diagonal stored last in every row
+  std::vector<CsrMatrix> factors_;
+  std::vector<std::vector<double>> work_;
+};
+
+// Smoothed aggregation algebraic multigrid, applied as one symmetric V-cycle
+// with damped Jacobi smoothing and a dense solve on the coarsest level.
+
+class SCISHARE ParallelAlgebraicMultigrid : public ParallelPreconditioner
+{
+public:
+  ParallelAlgebraicMultigrid();
+  ~ParallelAlgebraicMultigrid();
+
+  void apply(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelVector& r,
+             ParallelLinearAlgebra::ParallelVector& z) override;
+
+  size_t numLevels() const { return num_levels_; }
+
+protected:
+  bool build(ParallelLinearAlgebra& PLA, const ParallelLinearAlgebra::ParallelMatrix& A) override;
+  void attach(const ParallelLinearAlgebra::ParallelMatrix& A) override;
+  bool reusable(int) const override { return true; }
+
+private:
+  struct Level
+  {
+    CsrMatrix A_;
+    CsrMatrix P_;
+    CsrMatrix R_;
+    std::vector<double> invdiag_;
+    double omega_ = 0.0;
+    std::vector<double> x_, b_, r_, tmp_;
+  };
+
+  struct CoarseSolver;
+
+  // Level 0 uses the matrix of the solver directly
+  ParallelLinearAlgebra::ParallelMatrix A0_;
+
+  size_t levelSize(size_t level) const;
+  void levelRange(ParallelLinearAlgebra& PLA, size_t level, size_t& start, size_t& end) const;
+  void matrix(size_t level, const index_type*& rows, const index_type*& columns, const double*& data) const;
+  void aggregate(size_t start, size_t end, index_type& count);
+  void cycle(ParallelLinearAlgebra& PLA, size_t level);
+  void smooth(ParallelLinearAlgebra& PLA, size_t level);
+  void buildCoarseSolver(size_t level);
+
+  std::vector<Level> levels_;
+  size_t num_levels_;
+  std::unique_ptr<CoarseSolver> coarse_;
+
+  // Shared scratch space used while building the hierarchy
+  std::vector<CsrRows> parts_;
+  std::vector<double> rho_;
+  std::vector<double> diag_;
+  std::vector<std::vector<index_type>> strong_;
+  std::vector<index_type> aggregates_;
+  std::vector<index_type> counts_;
+  size_t num_aggregates_;
+  CsrMatrix AP_;
+  bool coarsest_;
+};
+
+}}}}
+
+#endif
@@ -608,6 +608,172 @@ TEST(ParallelArithmeticTests, CanMultiplyMatrixByVectorMulti)
   EXPECT_EQ(2,vR.data_[size-1]);
 }
 
+namespace
+{
+  // Rows in the middle of the matrix are much longer, like a refined region of a mesh
+  SparseRowMatrixHandle unevenMatrix()
+  {
+    SparseRowMatrixHandle m(makeShared<SparseRowMatrix>(size,size));
+    std::vector<SparseRowMatrix::Triplet> entries;
+    for (int i = 0; i < size; ++i)
+    {
+      const int length = (i >= 400 && i < 500) ? 60 : 3;
+      entries.emplace_back(i, i, 10.0);
+      for (int j = 1; j < length; ++j)
+        entries.emplace_back(i, (i + 17 * j) % size, -1.0 / j);
+    }
+    m->setFromTriplets(entries.begin(), entries.end());
+    return m;
+  }
+
+  SolverInputs unevenSystem()
+  {
+    SolverInputs system = getDummySystem();
+    system.A = unevenMatrix();
+    return system;
+  }
+}
+
+TEST(ParallelLinearAlgebraTests, PartitionBalancesNonzerosOverThreads)
+{
+  const int NUM_THREADS = 4;
+  auto system = unevenSystem();
+  ParallelLinearAlgebraSharedData data(system, NUM_THREADS);
+
+  EXPECT_EQ(0, data.rowStart(0));
+  EXPECT_EQ(size, data.rowStart(NUM_THREADS));
+
+  const auto rows = system.A->outerIndexPtr();
+  const double average = static_cast<double>(system.A->nonZeros()) / NUM_THREADS;
+  for (int p = 0; p < NUM_THREADS; ++p)
+  {
+    EXPECT_LE(data.rowStart(p), data.rowStart(p + 1));
+    EXPECT_EQ(0, data.rowStart(p) % SlicedEllpackMatrix::chunkSize);
+    const double nnz = rows[data.rowStart(p + 1)] - rows[data.rowStart(p)];
+    EXPECT_LT(nnz, 1.5 * average);
+  }
+}
+
+struct slicedMultiply
+{
+  slicedMultiply(ParallelLinearAlgebraSharedData& data, ParallelLinearAlgebra::ParallelVector& vR,
+    int proc, DenseColumnMatrixHandle x, DenseColumnMatrixHandle r, bool& sliced) :
+    data_(data), proc_(proc), vR_(vR), x_(x), r_(r), sliced_(sliced) {}
+
+  ParallelLinearAlgebraSharedData& data_;
+  int proc_;
+  ParallelLinearAlgebra::ParallelVector& vR_;
+  DenseColumnMatrixHandle x_, r_;
+  bool& sliced_;
+
+  void operator()()
+  {
+    ParallelLinearAlgebra pla(data_, proc_);
+
+    ParallelLinearAlgebra::ParallelMatrix m;
+    pla.add_matrix(data_.inputs().A, m);
+    if (pla.first())
+      sliced_ = m.sliced_ != nullptr;
+
+    ParallelLinearAlgebra::ParallelVector vX;
+    pla.add_vector(x_, vX);
+    pla.add_vector(r_, vR_);
+
+    pla.mult(m, vX, vR_);
+    pla.wait();
+  }
+};
+
+TEST(ParallelArithmeticTests, CanMultiplyMatrixByVectorWithSlicedLayoutMulti)
+{
+  const int NUM_THREADS = 3;
+  auto system = unevenSystem();
+  ParallelLinearAlgebraSharedData data(system, NUM_THREADS);
+
+  DenseColumnMatrixHandle x(makeShared<DenseColumnMatrix>(size));
+  for (int i = 0; i < size; ++i)
+    (*x)[i] = 1.0 + i % 13;
+  DenseColumnMatrixHandle r(makeShared<DenseColumnMatrix>(size));
+  r->setZero();
+
+  ParallelLinearAlgebra::ParallelVector vR;
+  bool sliced = false;
+  {
+    slicedMultiply mult_0(data, vR, 0, x, r, sliced);
+    slicedMultiply mult_1(data, vR, 1, x, r, sliced);
+    slicedMultiply mult_2(data, vR, 2, x, r, sliced);
+
+    std::thread t1(std::ref(mult_0));
+    std::thread t2(std::ref(mult_1));
+    std::thread t3(std::ref(mult_2));
+    t1.join();
+    t2.join();
+    t3.join();
+  }
+
+  EXPECT_TRUE(sliced);
+  DenseColumnMatrix expected = *system.A * *x;
+  EXPECT_COLUMN_MATRIX_EQ_BY_TWO_NORM(expected, *r, 1e-10);
+}
+
+TEST(ParallelArithmeticTests, FusedKernelsMatchSeparateOperations)
+{
+  auto system = unevenSystem();
+  ParallelLinearAlgebraSharedData data(system, 1);
+  ParallelLinearAlgebra pla(data, 0);
+
+  ParallelLinearAlgebra::ParallelMatrix m;
+  pla.add_matrix(system.A, m);
+
+  ParallelLinearAlgebra::ParallelVector u, w, r, p, s, x, d, expected;
+  pla.new_vector(u);
+  pla.new_vector(w);
+  pla.new_vector(r);
+  pla.new_vector(p);
+  pla.new_vector(s);
+  pla.new_vector(x);
+  pla.new_vector(d);
+  pla.new_vector(expected);
+  for (int i = 0; i < size; ++i)
+  {
+    u.data_[i] = 1.0 + i % 5;
+    r.data_[i] = 2.0 - i % 3;
+    p.data_[i] = 0.5 * (i % 7);
+    s.data_[i] = -0.25 * (i % 4);
+    x.data_[i] = i;
+    d.data_[i] = 0.1 + i % 2;
+  }
+
+  double ru, wu, rr;
+  pla.mult_dots(m, u, w, r, ru, wu, rr);
+  pla.mult(m, u, expected);
+  for (int i = 0; i < size; ++i)
+    EXPECT_DOUBLE_EQ(expected.data_[i], w.data_[i]);
+  EXPECT_DOUBLE_EQ(pla.dot(r, u), ru);
+  EXPECT_DOUBLE_EQ(pla.dot(w, u), wu);
+  EXPECT_DOUBLE_EQ(pla.dot(r, r), rr);
+
+  const double alpha = 0.3, beta = 0.7;
+  std::vector<double> pe(size), se(size), xe(size), re(size), ue(size);
+  for (int i = 0; i < size; ++i)
+  {
+    pe[i] = u.data_[i] + beta * p.data_[i];
+    se[i] = w.data_[i] + beta * s.data_[i];
+    xe[i] = x.data_[i] + alpha * pe[i];
+    re[i] = r.data_[i] - alpha * se[i];
+    ue[i] = d.data_[i] * re[i];
+  }
+  pla.cg_update(alpha, beta, u, w, p, s, x, r, &d);
+  for (int i = 0; i < size; ++i)
+  {
+    EXPECT_DOUBLE_EQ(pe[i], p.data_[i]);
+    EXPECT_DOUBLE_EQ(se[i], s.data_[i]);
+    EXPECT_DOUBLE_EQ(xe[i], x.data_[i]);
+    EXPECT_DOUBLE_EQ(re[i], r.data_[i]);
+    EXPECT_DOUBLE_EQ(ue[i], u.data_[i]);
+  }
+}
+
 TEST(ParallelArithmeticTests, CanSubtractVectors)
 {
   ParallelLinearAlgebraSharedData data(getDummySystem(),1);
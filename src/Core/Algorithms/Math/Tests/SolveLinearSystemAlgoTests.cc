@@ -147,3 +147,161 @@ TEST(SolveLinearSystemTests, DISABLED_CanSolveDarrell_MINRES)
   double solutionError = 2.4;
   CanSolveDarrellWithMethod("minres", solutionError);
 }
+
+namespace
+{
+  // 7 point finite difference Laplacian on an n^3 grid, shifted to make it SPD
+  SparseRowMatrixHandle laplacian3D(int n)
+  {
+    const int size = n*n*n;
+    auto index = [n](int i, int j, int k) { return (k*n + j)*n + i; };
+    std::vector<SparseRowMatrix::Triplet> triplets;
+    for (int k = 0; k < n; ++k)
+      for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+        {
+          const int row = index(i, j, k);
+          triplets.emplace_back(row, row, 6.01);
+          if (i > 0) triplets.emplace_back(row, index(i - 1, j, k), -1.0);
+          if (i < n - 1) triplets.emplace_back(row, index(i + 1, j, k), -1.0);
+          if (j > 0) triplets.emplace_back(row, index(i, j - 1, k), -1.0);
+          if (j < n - 1) triplets.emplace_back(row, index(i, j + 1, k), -1.0);
+          if (k > 0) triplets.emplace_back(row, index(i, j, k - 1), -1.0);
+          if (k < n - 1) triplets.emplace_back(row, index(i, j, k + 1), -1.0);
+        }
+    SparseRowMatrixHandle A(new SparseRowMatrix(size, size));
+    A->setFromTriplets(triplets.begin(), triplets.end());
+    return A;
+  }
+}
+
+class SolveLinearSystemPreconditionerTests : public TestWithParam<std::tuple<const char*, const char*>>
+{
+};
+
+TEST_P(SolveLinearSystemPreconditionerTests, SolvesLaplacianRepeatedly)
+{
+  auto A = laplacian3D(24);
+  DenseColumnMatrixHandle b(new DenseColumnMatrix(A->nrows()));
+  for (size_t i = 0; i < b->nrows(); ++i)
+    (*b)[i] = 1.0 + i % 5;
+
+  SolveLinearSystemAlgo algo;
+  algo.set(Variables::MaxIterations, 500);
+  algo.set(Variables::TargetError, 1e-8);
+  algo.setOption(Variables::Method, std::get<0>(GetParam()));
+  algo.setOption(Variables::Preconditioner, std::get<1>(GetParam()));
+  algo.setUpdaterFunc([](double) {});
+
+  DenseColumnMatrixHandle x0, solution;
+  ASSERT_TRUE(algo.run(A, b, x0, solution));
+  DenseColumnMatrix residual = *b - *A * *solution;
+  EXPECT_LT(residual.norm() / b->norm(), 1e-7);
+
+  const std::string preconditioner = std::get<1>(GetParam());
+  const size_t builds = (preconditioner == "IC" || preconditioner == "AMG") ? 1 : 0;
+  EXPECT_EQ(builds, algo.numPreconditionerBuilds());
+
+  // Second solve reuses the preconditioner setup and has to give the same answer
+  DenseColumnMatrixHandle again;
+  ASSERT_TRUE(algo.run(A, b, x0, again));
+  EXPECT_COLUMN_MATRIX_EQ_BY_TWO_NORM(*solution, *again, 1e-12);
+  EXPECT_EQ(builds, algo.numPreconditionerBuilds());
+
+  // Changing the values of the same matrix in place builds the preconditioner again
+  for (index_type k = 0; k < A->nonZeros(); ++k)
+    A->valuePtr()[k] *= 2.0;
+  DenseColumnMatrixHandle scaled;
+  ASSERT_TRUE(algo.run(A, b, x0, scaled));
+  EXPECT_EQ(2 * builds, algo.numPreconditionerBuilds());
+  residual = *b - *A * *scaled;
+  EXPECT_LT(residual.norm() / b->norm(), 1e-7);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  SolveLinearSystemWithPreconditioner,
+  SolveLinearSystemPreconditionerTests,
+  Values(
+    std::make_tuple("cg", "None"),
+    std::make_tuple("cg", "Jacobi"),
+    std::make_tuple("cg", "IC"),
+    std::make_tuple("cg", "AMG"),
+    std::make_tuple("bicg", "AMG"),
+    std::make_tuple("bicg", "IC")
+  ));
+
+TEST_P(SolveLinearSystemPreconditionerTests, SolvesMultipleRightHandSidesLikeSingleColumns)
+{
+  auto A = laplacian3D(16);
+  const int numRhs = 6;
+  DenseMatrixHandle B(new DenseMatrix(A->nrows(), numRhs));
+  for (size_t i = 0; i < B->nrows(); ++i)
+    for (int c = 0; c < numRhs; ++c)
+      (*B)(i, c) = 1.0 + (i * (c + 1)) % 7;
+
+  SolveLinearSystemAlgo algo;
+  algo.set(Variables::MaxIterations, 500);
+  algo.set(Variables::TargetError, 1e-10);
+  algo.setOption(Variables::Method, std::get<0>(GetParam()));
+  algo.setOption(Variables::Preconditioner, std::get<1>(GetParam()));
+  algo.setUpdaterFunc([](double) {});
+
+  DenseMatrixHandle X0, X;
+  ASSERT_TRUE(algo.run(A, B, X0, X));
+  ASSERT_EQ(B->nrows(), X->nrows());
+  ASSERT_EQ(numRhs, X->ncols());
+
+  for (int c = 0; c < numRhs; ++c)
+  {
+    DenseColumnMatrixHandle b(new DenseColumnMatrix(B->col(c)));
+    DenseColumnMatrixHandle x0, x;
+    ASSERT_TRUE(algo.run(A, b, x0, x));
+    DenseColumnMatrix column(X->col(c));
+    EXPECT_COLUMN_MATRIX_EQ_BY_TWO_NORM(*x, column, 1e-6);
+  }
+}
+
+TEST(SolveLinearSystemTests, MultipleRightHandSidesReturnLowestErrorIterates)
+{
+  // 1D diffusion with coefficients jumping over four orders of magnitude.
+  // CG does not reduce the residual monotonically on this matrix, so when it
+  // stops early the lowest error iterate differs from the last one.
+  const int n = 400;
+  std::vector<SparseRowMatrix::Triplet> triplets;
+  for (int i = 0; i < n; ++i)
+  {
+    const double left = (i / 20) % 2 ? 1e4 : 1.0;
+    const double right = ((i + 1) / 20) % 2 ? 1e4 : 1.0;
+    triplets.emplace_back(i, i, left + right);
+    if (i > 0) triplets.emplace_back(i, i - 1, -left);
+    if (i < n - 1) triplets.emplace_back(i, i + 1, -right);
+  }
+  SparseRowMatrixHandle A(new SparseRowMatrix(n, n));
+  A->setFromTriplets(triplets.begin(), triplets.end());
+
+  DenseMatrixHandle B(new DenseMatrix(n, 2));
+  for (int i = 0; i < n; ++i)
+  {
+    (*B)(i, 0) = 1.0;
+    (*B)(i, 1) = std::sin(0.1 * i);
+  }
+
+  SolveLinearSystemAlgo algo;
+  algo.set(Variables::MaxIterations, 60);
+  algo.set(Variables::TargetError, 1e-12);
+  algo.setOption(Variables::Method, "cg");
+  algo.setOption(Variables::Preconditioner, "None");
+  algo.setUpdaterFunc([](double) {});
+
+  DenseMatrixHandle X0, X;
+  ASSERT_TRUE(algo.run(A, B, X0, X));
+
+  for (int c = 0; c < 2; ++c)
+  {
+    DenseColumnMatrixHandle b(new DenseColumnMatrix(B->col(c)));
+    DenseColumnMatrixHandle x0, x;
+    ASSERT_TRUE(algo.run(A, b, x0, x));
+    DenseColumnMatrix column(X->col(c));
+    EXPECT_COLUMN_MATRIX_EQ_BY_TWO_NORM(*x, column, 1e-10);
+  }
+}
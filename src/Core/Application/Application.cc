@@ -39,6 +39,7 @@
 #include <Core/Command/GlobalCommandBuilderFromCommandLine.h>
 #include <Core/Logging/Log.h>
 #include <Core/Logging/ApplicationHelper.h>
+#include <Core/Logging/ExecutionTrace.h>
 #include <Core/IEPlugin/IEPluginInit.h>
 #include <Core/Utils/Exception.h>
 #include <Core/Application/Session/Session.h>
@@ -161,6 +162,18 @@ void Application::readCommandLine(int argc, const char* argv[])
       Thread::Parallel::SetMaximumCores(*maxCoresOption);
 
     LogSettings::Instance().setVerbose(parameters()->verboseMode());
+
+    auto traceFile = parameters()->traceFile();
+    if (traceFile)
+    {
+      ExecutionTracer::Instance().enable(*traceFile);
+      // console quit commands call exit() directly, so write the trace from an exit handler.
+      std::atexit([]()
+      {
+        if (!ExecutionTracer::Instance().writeChromeTrace())
+          std::cerr << "Failed to write execution trace to " << ExecutionTracer::Instance().outputFile() << std::endl;
+      });
+    }
   }
 }
 
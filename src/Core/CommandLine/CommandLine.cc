@@ -71,6 +71,7 @@ public:
       ("guiExpandFactor", po::value<double>(), "Expansion factor for high resolution displays")
       ("max-cores", po::value<unsigned int>(), "Limit the number of cores used by multithreaded algorithms")
       ("list-modules", "print list of available modules")
+      ("trace", po::value<std::string>(), "write a Chrome trace of module execution to this file")
       ;
 
       positional_.add("input-file", -1);
@@ -192,11 +193,12 @@ public:
     const std::optional<boost::filesystem::path>& pythonScriptFile,
     const std::optional<boost::filesystem::path>& dataDirectory,
     const std::optional<std::string>& networkToImport,
+    const std::optional<std::string>& traceFile,
     DeveloperParametersPtr devParams,
     const Flags& flags
    ) : entireCommandLine_(entireCommandLine),
     inputFiles_(inputFiles), pythonScriptFile_(pythonScriptFile), dataDirectory_(dataDirectory),
-    networkToImport_(networkToImport),
+    networkToImport_(networkToImport), traceFile_(traceFile),
     devParams_(devParams),
     flags_(flags)
   {}
@@ -221,6 +223,11 @@ public:
     return networkToImport_;
   }
 
+  std::optional<std::string> traceFile() const override
+  {
+    return traceFile_;
+  }
+
   bool help() const override
   {
     return flags_.help_;
@@ -302,6 +309,7 @@ private:
   std::optional<boost::filesystem::path> pythonScriptFile_;
   std::optional<boost::filesystem::path> dataDirectory_;
   std::optional<std::string> networkToImport_;
+  std::optional<std::string> traceFile_;
   DeveloperParametersPtr devParams_;
   Flags flags_;
 };
@@ -347,6 +355,7 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
     {
       dataDirectory = boost::filesystem::path(parsed["datadir"].as<std::string>());
     }
+    auto traceFile = parseOptionalArg<std::string>(parsed, "trace");
     auto importNetworkFile = std::optional<std::string>();
     if (parsed.count("import") != 0 && !parsed["import"].empty() && !parsed["import"].defaulted())
     {
@@ -359,6 +368,7 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
       pythonScriptFile,
       dataDirectory,
       importNetworkFile,
+      traceFile,
       makeShared<DeveloperParametersImpl>(
         parseOptionalArg<std::string>(parsed, "threadMode"),
         parseOptionalArg<std::string>(parsed, "reexecuteMode"),
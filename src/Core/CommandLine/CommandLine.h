@@ -51,6 +51,7 @@ namespace SCIRun {
         virtual std::optional<boost::filesystem::path> pythonScriptFile() const = 0;
         virtual std::optional<boost::filesystem::path> dataDirectory() const = 0;
         virtual std::optional<std::string> importNetworkFile() const = 0;
+        virtual std::optional<std::string> traceFile() const = 0;
         virtual bool help() const = 0;
         virtual bool version() const = 0;
         virtual bool executeNetwork() const = 0;
@@ -59,7 +59,8 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     "  --guiExpandFactor arg   Expansion factor for high resolution displays\n"
     "  --max-cores arg         Limit the number of cores used by multithreaded \n"
     "                          algorithms\n"
-    "  --list-modules          print list of available modules\n";
+    "  --list-modules          print list of available modules\n"
+    "  --trace arg             write a Chrome trace of module execution to this file\n";
 
   EXPECT_EQ(expectedHelp, parser.describe());
 
@@ -190,6 +191,17 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     EXPECT_TRUE(aph->quitAfterOneScriptedExecution());
   }
 
+  {
+    const char* argv[] = { "scirun.exe", "-E", "net.srn5", "--trace", "timeline.json" };
+    int argc = sizeof(argv) / sizeof(char*);
+
+    auto aph = parser.parse(argc, argv);
+
+    EXPECT_TRUE(aph->executeNetworkAndQuit());
+    ASSERT_TRUE(!!aph->traceFile());
+    EXPECT_EQ("timeline.json", *aph->traceFile());
+  }
+
   {
     const char* argv[] = { "scirun.exe", "--import", "oldnetwork.srn" };
     int argc = sizeof(argv) / sizeof(char*);
@@ -0,0 +1,431 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/ElemBVH.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+struct ElemBVH::Primitive
+{
+  double lo[3];
+  double hi[3];
+  double center[3];
+  Point a, b, c;
+  VMesh::index_type elem;
+
+  void set(const Point& pa, const Point& pb, const Point& pc, VMesh::index_type idx)
+  {
+    a = pa; b = pb; c = pc; elem = idx;
+    for (int k = 0; k < 3; k++)
+    {
+      lo[k] = std::min(std::min(a[k], b[k]), c[k]);
+      hi[k] = std::max(std::max(a[k], b[k]), c[k]);
+      center[k] = 0.5*(lo[k] + hi[k]);
+    }
+  }
+};
+
+struct ElemBVH::BuildTask
+{
+  size_t begin, end;
+  VMesh::index_type node, leaf;
+};
+
+namespace
+{
+  // Number of leaves of a tree over n primitives, together with the number
+  // for n+1 primitives. Every split halves the range, so both only depend
+  // on the counts one level down.
+  std::pair<size_t, size_t> leaf_counts(size_t n)
+  {
+    const size_t m = ElemBVH::PACKET_SIZE;
+    if (n <= m) return (std::make_pair(size_t(1), size_t(n+1 <= m ? 1 : 2)));
+
+    const std::pair<size_t, size_t> half = leaf_counts(n/2);
+    if (n % 2 == 0)
+      return (std::make_pair(2*half.first, half.first + half.second));
+    return (std::make_pair(half.first + half.second, 2*half.second));
+  }
+
+  inline size_t leaf_count(size_t n)
+  {
+    return (leaf_counts(n).first);
+  }
+
+  inline double box_distance2(const double lo[3], const double hi[3], const double p[3])
+  {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; k++)
+    {
+      const double d = std::max(std::max(lo[k] - p[k], p[k] - hi[k]), 0.0);
+      d2 += d*d;
+    }
+    return (d2);
+  }
+
+  // Closest point on the segment a + s*(b-a), s in [0,1].
+  inline void closest_on_segment(double ax, double ay, double az,
+                                 double ux, double uy, double uz,
+                                 double px, double py, double pz,
+                                 double& rx, double& ry, double& rz, double& d2)
+  {
+    const double uu = ux*ux + uy*uy + uz*uz;
+    const double up = ux*(px-ax) + uy*(py-ay) + uz*(pz-az);
+    const double t = up / std::max(uu, DBL_MIN);
+    // Clamps t to [0,1]; unlike min/max it leaves no branch in the lane loops
+    const double s = 0.5*(std::fabs(t) - std::fabs(t - 1.0) + 1.0);
+    rx = ax + s*ux; ry = ay + s*uy; rz = az + s*uz;
+    const double dx = px-rx, dy = py-ry, dz = pz-rz;
+    d2 = dx*dx + dy*dy + dz*dz;
+  }
+}
+
+bool
+ElemBVH::supports(VMesh* mesh)
+{
+  return (mesh->is_tri_element() || mesh->is_quad_element() || mesh->is_crv_element());
+}
+
+ElemBVH::ElemBVH(VMesh* mesh) :
+  num_prims_(0),
+  segments_(mesh->is_crv_element())
+{
+  const bool quads = mesh->is_quad_element();
+  const size_t num_elems = static_cast<size_t>(mesh->num_elems());
+  num_prims_ = quads ? 2*num_elems : num_elems;
+  if (num_prims_ == 0) return;
+
+  // Gather the vertices of all the primitives, a quadrilateral is split
+  // along its first diagonal.
+  std::vector<Primitive> prims(num_prims_);
+  Parallel::For(0, num_elems, 4096, [&](size_t begin, size_t end)
+  {
+    VMesh::Node::array_type nodes;
+    Point p[4];
+    for (size_t idx = begin; idx < end; idx++)
+    {
+      mesh->get_nodes(nodes, VMesh::Elem::index_type(idx));
+      const size_t nn = std::min(nodes.size(), size_t(4));
+      for (size_t j = 0; j < nn; j++) mesh->get_center(p[j], nodes[j]);
+
+      const VMesh::index_type elem = static_cast<VMesh::index_type>(idx);
+      if (segments_)
+      {
+        prims[idx].set(p[0], p[1], p[1], elem);
+      }
+      else if (quads)
+      {
+        prims[2*idx].set(p[0], p[1], p[2], elem);
+        prims[2*idx+1].set(p[0], p[2], p[3], elem);
+      }
+      else
+      {
+        prims[idx].set(p[0], p[1], p[2], elem);
+      }
+    }
+  });
+
+  const size_t num_leaves = leaf_count(num_prims_);
+  nodes_.resize(2*num_leaves - 1);
+  packets_.resize(num_leaves);
+
+  // Split the top of the tree on this thread until there are a few ranges
+  // per core, then build those subtrees concurrently. Their nodes and
+  // leaves are laid out in advance, so the tree is the same for any
+  // number of threads.
+  std::vector<BuildTask> tasks;
+  const size_t task_size = std::max(num_prims_ / (8*Parallel::NumCores()), size_t(1024));
+  build(prims, 0, num_prims_, 0, 0, &tasks, task_size);
+
+  Parallel::For(0, tasks.size(), 1, [&](size_t begin, size_t end)
+  {
+    for (size_t t = begin; t < end; t++)
+      build(prims, tasks[t].begin, tasks[t].end, tasks[t].node, tasks[t].leaf, nullptr, 0);
+  });
+}
+
+void
+ElemBVH::build(std::vector<Primitive>& prims, size_t begin, size_t end,
+               VMesh::index_type node, VMesh::index_type leaf,
+               std::vector<BuildTask>* tasks, size_t task_size)
+{
+  const size_t n = end - begin;
+  if (tasks && n <= task_size)
+  {
+    tasks->push_back({ begin, end, node, leaf });
+    return;
+  }
+
+  Node& bnode = nodes_[node];
+  double clo[3], chi[3];
+  for (int k = 0; k < 3; k++)
+  {
+    bnode.lo[k] = clo[k] = DBL_MAX;
+    bnode.hi[k] = chi[k] = -DBL_MAX;
+  }
+
+  for (size_t i = begin; i < end; i++)
+  {
+    const Primitive& prim = prims[i];
+    for (int k = 0; k < 3; k++)
+    {
+      bnode.lo[k] = std::min(bnode.lo[k], prim.lo[k]);
+      bnode.hi[k] = std::max(bnode.hi[k], prim.hi[k]);
+      clo[k] = std::min(clo[k], prim.center[k]);
+      chi[k] = std::max(chi[k], prim.center[k]);
+    }
+  }
+
+  if (n <= static_cast<size_t>(PACKET_SIZE))
+  {
+    bnode.right = -1;
+    bnode.leaf = leaf;
+
+    Packet& packet = packets_[leaf];
+    for (int l = 0; l < PACKET_SIZE; l++)
+    {
+      const Primitive& prim = prims[begin + std::min(static_cast<size_t>(l), n-1)];
+      packet.ax[l] = prim.a.x(); packet.ay[l] = prim.a.y(); packet.az[l] = prim.a.z();
+      packet.bx[l] = prim.b.x(); packet.by[l] = prim.b.y(); packet.bz[l] = prim.b.z();
+      packet.cx[l] = prim.c.x(); packet.cy[l] = prim.c.y(); packet.cz[l] = prim.c.z();
+      packet.elem[l] = prim.elem;
+    }
+    return;
+  }
+
+  // Median split along the longest axis of the centers. It keeps the tree
+  // balanced, however the element sizes are distributed.
+  int axis = 0;
+  if (chi[1]-clo[1] > chi[axis]-clo[axis]) axis = 1;
+  if (chi[2]-clo[2] > chi[axis]-clo[axis]) axis = 2;
+
+  const size_t mid = begin + n/2;
+  std::nth_element(prims.begin() + begin, prims.begin() + mid, prims.begin() + end,
+    [axis](const Primitive& p1, const Primitive& p2) { return (p1.center[axis] < p2.center[axis]); });
+
+  const size_t left_leaves = leaf_count(mid - begin);
+  const VMesh::index_type right = node + static_cast<VMesh::index_type>(2*left_leaves);
+  bnode.right = right;
+  bnode.leaf = -1;
+
+  build(prims, begin, mid, node+1, leaf, tasks, task_size);
+  build(prims, mid, end, right, leaf + static_cast<VMesh::index_type>(left_leaves), tasks, task_size);
+}
+
+double
+ElemBVH::closest_in_packet(const Packet& pk, const double p[3], Point& result, int& lane) const
+{
+  double rx[PACKET_SIZE], ry[PACKET_SIZE], rz[PACKET_SIZE], d2[PACKET_SIZE];
+  const double px = p[0], py = p[1], pz = p[2];
+
+  if (segments_)
+  {
+    for (int l = 0; l < PACKET_SIZE; l++)
+    {
+      closest_on_segment(pk.ax[l], pk.ay[l], pk.az[l],
+                         pk.bx[l]-pk.ax[l], pk.by[l]-pk.ay[l], pk.bz[l]-pk.az[l],
+                         px, py, pz, rx[l], ry[l], rz[l], d2[l]);
+    }
+  }
+  else
+  {
+    // The closest point is the projection on the plane if that falls
+    // inside the triangle, otherwise it is the closest point on one of the
+    // edges. All candidates are computed and selected without branches,
+    // so the compiler can run the lanes in vector registers. The quiet
+    // comparisons do not raise floating point exceptions, which would
+    // otherwise keep them from being vectorized.
+    for (int l = 0; l < PACKET_SIZE; l++)
+    {
+      const double ax = pk.ax[l], ay = pk.ay[l], az = pk.az[l];
+      const double abx = pk.bx[l]-ax, aby = pk.by[l]-ay, abz = pk.bz[l]-az;
+      const double bcx = pk.cx[l]-pk.bx[l], bcy = pk.cy[l]-pk.by[l], bcz = pk.cz[l]-pk.bz[l];
+      const double cax = ax-pk.cx[l], cay = ay-pk.cy[l], caz = az-pk.cz[l];
+
+      // Normal (b-a) x (c-a)
+      const double nx = abz*cay - aby*caz;
+      const double ny = abx*caz - abz*cax;
+      const double nz = aby*cax - abx*cay;
+      const double nn = nx*nx + ny*ny + nz*nz;
+
+      const double apx = px-ax, apy = py-ay, apz = pz-az;
+      const double bpx = px-pk.bx[l], bpy = py-pk.by[l], bpz = pz-pk.bz[l];
+      const double cpx = px-pk.cx[l], cpy = py-pk.cy[l], cpz = pz-pk.cz[l];
+
+      const double e0 = (aby*apz - abz*apy)*nx + (abz*apx - abx*apz)*ny + (abx*apy - aby*apx)*nz;
+      const double e1 = (bcy*bpz - bcz*bpy)*nx + (bcz*bpx - bcx*bpz)*ny + (bcx*bpy - bcy*bpx)*nz;
+      const double e2 = (cay*cpz - caz*cpy)*nx + (caz*cpx - cax*cpz)*ny + (cax*cpy - cay*cpx)*nz;
+      const bool inside = std::isgreater(nn, 0.0) & std::isgreaterequal(e0, 0.0) &
+                          std::isgreaterequal(e1, 0.0) & std::isgreaterequal(e2, 0.0);
+
+      const double t = (nx*apx + ny*apy + nz*apz) / std::max(nn, DBL_MIN);
+      const double qx = px - t*nx, qy = py - t*ny, qz = pz - t*nz;
+      const double dqx = px-qx, dqy = py-qy, dqz = pz-qz;
+      const double dq = dqx*dqx + dqy*dqy + dqz*dqz;
+
+      double r0x, r0y, r0z, d0, r1x, r1y, r1z, d1, r2x, r2y, r2z, dd2;
+      closest_on_segment(ax, ay, az, abx, aby, abz, px, py, pz, r0x, r0y, r0z, d0);
+      closest_on_segment(pk.bx[l], pk.by[l], pk.bz[l], bcx, bcy, bcz, px, py, pz, r1x, r1y, r1z, d1);
+      closest_on_segment(pk.cx[l], pk.cy[l], pk.cz[l], cax, cay, caz, px, py, pz, r2x, r2y, r2z, dd2);
+
+      // Selects are written as blends so every candidate is computed in all
+      // lanes; a plain ?: lets the compiler move them back into branches.
+      const double w01 = std::islessequal(d0, d1) ? 1.0 : 0.0;
+      double ex = r1x + w01*(r0x - r1x), ey = r1y + w01*(r0y - r1y), ez = r1z + w01*(r0z - r1z);
+      double de = std::min(d0, d1);
+      const double w2 = std::isless(dd2, de) ? 1.0 : 0.0;
+      ex += w2*(r2x - ex); ey += w2*(r2y - ey); ez += w2*(r2z - ez);
+      de = std::min(dd2, de);
+
+      const double wq = inside ? 1.0 : 0.0;
+      rx[l] = ex + wq*(qx - ex);
+      ry[l] = ey + wq*(qy - ey);
+      rz[l] = ez + wq*(qz - ez);
+      d2[l] = de + wq*(dq - de);
+    }
+  }
+
+  lane = 0;
+  for (int l = 1; l < PACKET_SIZE; l++)
+    if (d2[l] < d2[lane]) lane = l;
+
+  result = Point(rx[lane], ry[lane], rz[lane]);
+  return (d2[lane]);
+}
+
+bool
+ElemBVH::closest(const Point& p, double maxdist2, VMesh::index_type& hint, Hit& hit) const
+{
+  hit.elem = -1;
+  hit.distance = DBL_MAX;
+  if (nodes_.empty()) return (false);
+
+  const double pp[3] = { p.x(), p.y(), p.z() };
+  double best = maxdist2;
+  VMesh::index_type best_leaf = -1;
+  Point r;
+  int lane;
+
+  if (hint >= 0 && hint < static_cast<VMesh::index_type>(packets_.size()))
+  {
+    const double d2 = closest_in_packet(packets_[hint], pp, r, lane);
+    if (d2 < best)
+    {
+      best = d2; best_leaf = hint;
+      hit.point = r; hit.elem = packets_[hint].elem[lane];
+    }
+  }
+
+  // The tree is balanced, so its depth stays far below the stack size
+  VMesh::index_type stack[64];
+  double stack_d2[64];
+  int sp = 0;
+  stack[sp] = 0;
+  stack_d2[sp++] = box_distance2(nodes_[0].lo, nodes_[0].hi, pp);
+
+  while (sp > 0)
+  {
+    --sp;
+    if (stack_d2[sp] >= best) continue;
+    const Node& node = nodes_[stack[sp]];
+
+    if (node.leaf >= 0)
+    {
+      if (node.leaf == hint) continue;
+      const double d2 = closest_in_packet(packets_[node.leaf], pp, r, lane);
+      if (d2 < best)
+      {
+        best = d2; best_leaf = node.leaf;
+        hit.point = r; hit.elem = packets_[node.leaf].elem[lane];
+      }
+      continue;
+    }
+
+    // Visit the nearest child first, it is pushed last
+    const VMesh::index_type left = stack[sp] + 1;
+    const double dl = box_distance2(nodes_[left].lo, nodes_[left].hi, pp);
+    const double dr = box_distance2(nodes_[node.right].lo, nodes_[node.right].hi, pp);
+    if (dl <= dr)
+    {
+      if (dr < best) { stack[sp] = node.right; stack_d2[sp++] = dr; }
+      if (dl < best) { stack[sp] = left; stack_d2[sp++] = dl; }
+    }
+    else
+    {
+      if (dl < best) { stack[sp] = left; stack_d2[sp++] = dl; }
+      if (dr < best) { stack[sp] = node.right; stack_d2[sp++] = dr; }
+    }
+  }
+
+  if (best_leaf < 0) return (false);
+
+  hint = best_leaf;
+  hit.distance = std::sqrt(best);
+  return (true);
+}
+
+bool
+ElemBVH::find_closest_elem(double& dist, Point& result, VMesh::Elem::index_type& elem,
+                           const Point& p, double maxdist) const
+{
+  const double maxdist2 = (maxdist < 0.0) ? DBL_MAX : maxdist*maxdist;
+  VMesh::index_type hint = -1;
+  Hit hit;
+  if (!closest(p, maxdist2, hint, hit)) return (false);
+
+  dist = hit.distance;
+  result = hit.point;
+  elem = hit.elem;
+  return (true);
+}
+
+void
+ElemBVH::find_closest_elems(const Point* points, size_t num, Hit* hits, double maxdist) const
+{
+  const double maxdist2 = (maxdist < 0.0) ? DBL_MAX : maxdist*maxdist;
+  VMesh::index_type hint = -1;
+  for (size_t i = 0; i < num; i++)
+    closest(points[i], maxdist2, hint, hits[i]);
+}
+
+void
+ElemBVH::find_closest_elems(const std::vector<Point>& points, std::vector<Hit>& hits,
+                            double maxdist) const
+{
+  hits.resize(points.size());
+  Parallel::For(0, points.size(), 512, [&](size_t begin, size_t end)
+  {
+    find_closest_elems(&points[begin], end - begin, &hits[begin], maxdist);
+  });
+}
@@ -0,0 +1,144 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+///
+///@file  ElemBVH.h
+///
+///@brief Bounding volume hierarchy for closest point queries on the
+///       elements of curve and surface meshes.
+///
+
+#ifndef CORE_DATATYPES_LEGACY_FIELD_ELEMBVH_H
+#define CORE_DATATYPES_LEGACY_FIELD_ELEMBVH_H 1
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <vector>
+
+#include <Core/Datatypes/Legacy/Field/share.h>
+
+namespace SCIRun {
+
+/// The hierarchy is built from the triangles of a TriSurfMesh, the two
+/// triangles of every quadrilateral of a QuadSurfMesh (and of the structured
+/// quad meshes) or the edges of a CurveMesh. Unlike the uniform search grid
+/// used by VMesh::find_closest_elem its cost does not depend on how uniform
+/// the element sizes are. The hierarchy is a snapshot of the mesh: it needs
+/// to be rebuilt when the nodes or elements change. Queries do not modify
+/// it, so any number of threads can query the same hierarchy.
+class SCISHARE ElemBVH
+{
+  public:
+    struct Hit
+    {
+      /// Distance between the query point and the closest point
+      double distance;
+      /// Closest point on the mesh
+      Core::Geometry::Point point;
+      /// Element containing the closest point, -1 when nothing was found
+      VMesh::Elem::index_type elem;
+    };
+
+    /// Number of primitives that are tested together in a leaf.
+    static const int PACKET_SIZE = 4;
+
+    /// Whether the elements of the mesh can be put in a hierarchy.
+    static bool supports(VMesh* mesh);
+
+    /// Build the hierarchy, the ranges of the tree below the top levels are
+    /// built in parallel.
+    explicit ElemBVH(VMesh* mesh);
+
+    /// Same interface as VMesh::find_closest_elem: returns false if there
+    /// is no element within maxdist. A negative maxdist means unlimited.
+    bool find_closest_elem(double& dist,
+                           Core::Geometry::Point& result,
+                           VMesh::Elem::index_type& elem,
+                           const Core::Geometry::Point& p,
+                           double maxdist = -1.0) const;
+
+    /// Batched query on the calling thread. Consecutive points are assumed
+    /// to be close to each other: the leaf that held the previous answer is
+    /// tested first, which bounds the search of the next point.
+    void find_closest_elems(const Core::Geometry::Point* points, size_t num,
+                            Hit* hits, double maxdist = -1.0) const;
+
+    /// Batched query that is spread over all cores.
+    void find_closest_elems(const std::vector<Core::Geometry::Point>& points,
+                            std::vector<Hit>& hits,
+                            double maxdist = -1.0) const;
+
+    size_t num_primitives() const { return (num_prims_); }
+    size_t num_nodes() const { return (nodes_.size()); }
+    size_t num_leaves() const { return (packets_.size()); }
+
+  private:
+    struct Node
+    {
+      double lo[3];
+      double hi[3];
+      /// Index of the second child, the first one directly follows the node
+      VMesh::index_type right;
+      /// Index of the packet for a leaf, -1 for an inner node
+      VMesh::index_type leaf;
+    };
+
+    /// Structure of arrays layout so the distance to all the primitives of
+    /// a leaf is computed in one vectorizable loop. Unused lanes repeat the
+    /// last primitive of the leaf.
+    struct alignas(32) Packet
+    {
+      double ax[PACKET_SIZE], ay[PACKET_SIZE], az[PACKET_SIZE];
+      double bx[PACKET_SIZE], by[PACKET_SIZE], bz[PACKET_SIZE];
+      double cx[PACKET_SIZE], cy[PACKET_SIZE], cz[PACKET_SIZE];
+      VMesh::index_type elem[PACKET_SIZE];
+    };
+
+    struct Primitive;
+    struct BuildTask;
+
+    void build(std::vector<Primitive>& prims, size_t begin, size_t end,
+               VMesh::index_type node, VMesh::index_type leaf,
+               std::vector<BuildTask>* tasks, size_t task_size);
+
+    /// Squared distance to the closest primitive of a leaf, which is
+    /// returned in lane.
+    double closest_in_packet(const Packet& packet, const double p[3],
+                             Core::Geometry::Point& result, int& lane) const;
+
+    bool closest(const Core::Geometry::Point& p, double maxdist2,
+                 VMesh::index_type& hint, Hit& hit) const;
+
+    std::vector<Node> nodes_;
+    std::vector<Packet> packets_;
+    size_t num_prims_;
+    bool segments_;
+};
+
+} // end namespace SCIRun
+
+#endif
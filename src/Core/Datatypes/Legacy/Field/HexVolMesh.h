@@ -51,6 +51,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 
@@ -151,6 +152,77 @@ static const int
 HexVolFaceTable[6][4] = { {0,1,2,3},{7,6,5,4},{0,4,5,1},
                           {2,6,7,3},{3,7,4,0},{1,5,6,2}};
 
+/// Reorder the nodes of a face while maintaining CCW or CW orientation: the
+/// face starts at its smallest node, and a face with two equal neighboring
+/// nodes becomes a triangle whose last node is repeated. Degenerate faces
+/// (e.g. nodes on opposite corners are equal, or more then two nodes are
+/// equal) are rejected.
+template <class INDEX>
+bool order_hex_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4)
+{
+  // Check for degenerate or misformed face
+  // Opposite faces cannot be equal
+  if ((n1 == n3)||(n2==n4)) return (false);
+
+  // Face must have three unique identifiers otherwise it was condition
+  // n1==n3 || n2==n4 would be met.
+
+  if ((n1 < n2)&&(n1 < n3)&&(n1 < n4))
+  {
+  }
+  else if ((n2 < n3)&&(n2 < n4))
+  {
+    INDEX t;
+    // shift one position to left
+    t = n1; n1 = n2; n2 = n3; n3 = n4; n4 = t;
+  }
+  else if (n3 < n4)
+  {
+    INDEX t;
+    // shift two positions to left
+    t = n1; n1 = n3; n3 = t; t = n2; n2 = n4; n4 = t;
+  }
+  else
+  {
+    INDEX t;
+    // shift one positions to right
+    t = n4; n4 = n3; n3 = n2; n2 = n1; n1 = t;
+  }
+
+  if (n1==n2)
+  {
+    if (n3==n4) return (false); // this is a line not a face
+     n2 = n3; n3 = n4;
+  }
+  else if (n2 == n3)
+  {
+    if (n1==n4) return (false); // this is a line not a face
+    n3 = n4;
+  }
+  else if (n4 == n1)
+  {
+    n4 = n3;
+  }
+  return (true);
+}
+
+/// Canonical key of a face ordered by order_hex_face_nodes. It is the node
+/// order that PFaceNode::operator< compares, so faces that are equal have
+/// equal keys whatever their orientation.
+template <class INDEX, class KEY>
+void hex_face_key(const INDEX* n, KEY& key)
+{
+  key[0] = n[0];
+  if (n[2] == n[3])
+  {
+    key[1] = std::min(n[1], n[2]); key[2] = key[3] = std::max(n[1], n[2]);
+  }
+  else
+  {
+    key[1] = std::min(n[1], n[3]); key[2] = n[2]; key[3] = std::max(n[1], n[3]);
+  }
+}
+
 /////////////////////////////////////////////////////
 // Declarations for HexVolMesh class
 
@@ -2756,9 +2828,7 @@ protected:
     }
   };
 
-  using face_ht = std::unordered_map<PFace, typename Face::index_type, FaceHash>;
   using face_nt = std::unordered_map<PFaceNode, typename Face::index_type, FaceHash>;
-  using edge_ht = std::unordered_map<PEdge, typename Edge::index_type, EdgeHash>;
   using edge_nt = std::unordered_map<PEdgeNode, typename Edge::index_type, EdgeHash>;
 
   typedef std::vector<PFaceCell> face_ct;
@@ -2774,62 +2844,10 @@ protected:
   edge_ct edges_;
   edge_nt edge_table_;
 
-  inline
-  void hash_edge(typename Node::index_type n1, typename Node::index_type n2,
-                 index_type combind_index, edge_ht &table) const;
-
-  inline
-  void hash_face(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Node::index_type n3, typename Node::index_type n4,
-                 index_type combined_index, face_ht &table) const;
-
   template <class INDEX>
   bool order_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4) const
   {
-    // Check for degenerate or misformed face
-    // Opposite faces cannot be equal
-    if ((n1 == n3)||(n2==n4)) return (false);
-
-    // Face must have three unique identifiers otherwise it was condition
-    // n1==n3 || n2==n4 would be met.
-
-    if ((n1 < n2)&&(n1 < n3)&&(n1 < n4))
-    {
-    }
-    else if ((n2 < n3)&&(n2 < n4))
-    {
-      INDEX t;
-      // shift one position to left
-      t = n1; n1 = n2; n2 = n3; n3 = n4; n4 = t;
-    }
-    else if (n3 < n4)
-    {
-      INDEX t;
-      // shift two positions to left
-      t = n1; n1 = n3; n3 = t; t = n2; n2 = n4; n4 = t;
-    }
-    else
-    {
-      INDEX t;
-      // shift one positions to right
-      t = n4; n4 = n3; n3 = n2; n2 = n1; n1 = t;
-    }
-
-    if (n1==n2)
-    {
-      if (n3==n4) return (false); // this is a line not a face
-       n2 = n3; n3 = n4;
-    }
-    else if (n2 == n3)
-    {
-      if (n1==n4) return (false); // this is a line not a face
-      n3 = n4;
-    }
-    else if (n4 == n1)
-    {
-      n4 = n3;
-    }
-    return (true);
+    return (order_hex_face_nodes(n1, n2, n3, n4));
   }
 
   /// useful functors
@@ -3210,109 +3228,52 @@ HexVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             typename Node::index_type n4,
-                             index_type combined_index,
-                             face_ht &table) const
-{
-  // Reorder nodes while maintaining CCW or CW orientation
-  // Check for degenerate faces, if faces has degeneracy it
-  // will be ignored (e.g. nodes on opposite corners are equal,
-  // or more then two nodes are equal)
-
-  if (!(order_face_nodes(n1,n2,n3,n4))) return;
-  PFace f(n1, n2, n3, n4);
-
-
-  typename face_ht::iterator iter = table.find(f);
-
-  if (iter == table.end())
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are illegally adjacent." << std::endl;*/
-    }
-    else if ((f.cells_[0]>>3) == (combined_index>>3))
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are the same." << std::endl;
-           */
-    }
-    else
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_faces()
 {
-  face_table_.clear();
-
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(8);
-
-  face_ht table;
+  // 6 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[6][4] = { {0, 1, 2, 3}, {7, 6, 5, 4}, {0, 4, 5, 1},
+                                        {2, 6, 7, 3}, {3, 7, 4, 0}, {1, 5, 6, 2} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 3);
+
+  // Reorder nodes while maintaining CCW or CW orientation. Degenerate faces
+  // (e.g. nodes on opposite corners are equal, or more then two nodes are
+  // equal) are ignored.
+  auto ordered_nodes = [this](index_type i, index_type* n)
+  {
+    const under_type* nodes = &cells_[(i / 6) << 3];
+    const int* local = face_nodes[i % 6];
+    for (int k = 0; k < 4; ++k) n[k] = nodes[local[k]];
+    return order_face_nodes(n[0], n[1], n[2], n[3]);
+  };
 
-  while (ci != cie)
+  // Occurrence i is face i%6 of cell i/6.
+  MeshTopologyBuilder<4> builder;
+  builder.build(num_cells * 6, [&](index_type i,
+                                   MeshTopologyBuilder<4>::key_type& key)
   {
-    get_nodes(arr, *ci);
-    // 6 faces -- each is entered CCW from outside looking in
-    index_type cell_index = (*ci)<<3;
-    hash_face(arr[0], arr[1], arr[2], arr[3], cell_index, table);
-    hash_face(arr[7], arr[6], arr[5], arr[4], cell_index + 1, table);
-    hash_face(arr[0], arr[4], arr[5], arr[1], cell_index + 2, table);
-    hash_face(arr[2], arr[6], arr[7], arr[3], cell_index + 3, table);
-    hash_face(arr[3], arr[7], arr[4], arr[0], cell_index + 4, table);
-    hash_face(arr[1], arr[5], arr[6], arr[2], cell_index + 5, table);
+    index_type n[4];
+    if (!ordered_nodes(i, n)) return false;
+    hex_face_key(n, key);
+    return true;
+  });
 
-    ++ci;
-  }
-
-  faces_.resize(table.size());
-  boundary_faces_.resize(cells_.size()>>3);
+  auto combined_index = [](index_type i) { return ((i / 6) << 3) + i % 6; };
 
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
+  const size_type num_faces = builder.num_unique();
+  faces_.clear();
+  faces_.resize(num_faces);
+  builder.fill_face_cells(faces_, boundary_faces_, 6, combined_index);
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  // The table holds the nodes in the order of the first cell.
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  for (index_type u = 0; u < num_faces; ++u)
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2],pface.nodes_[3])] = uidx;
-
-    if (pface.cells_[1] == -1)
-    {
-      index_type cell = (pface.cells_[0]) >> 3;
-      index_type face = (pface.cells_[0]) & 0x7;
-      boundary_faces_[cell] |= 1 << face;
-    }
-
-    ++ht_iter; uidx++;
+    index_type n[4];
+    ordered_nodes(builder.occurrence(u, 0), n);
+    face_table_[PFaceNode(n[0], n[1], n[2], n[3])] = u;
   }
 
   synchronize_lock_.lock();
@@ -3320,73 +3281,52 @@ HexVolMesh<Basis>::compute_faces()
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht &table) const
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-  if (iter == table.end())
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  edge_ht table;
-  typename Node::array_type arr;
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    index_type cell_index = (*ci)<<4;
-    hash_edge(arr[0], arr[1], cell_index  , table);
-    hash_edge(arr[1], arr[2], cell_index+1, table);
-    hash_edge(arr[2], arr[3], cell_index+2, table);
-    hash_edge(arr[3], arr[0], cell_index+3, table);
-
-    hash_edge(arr[4], arr[5], cell_index+4, table);
-    hash_edge(arr[5], arr[6], cell_index+5, table);
-    hash_edge(arr[6], arr[7], cell_index+6, table);
-    hash_edge(arr[7], arr[4], cell_index+7, table);
-
-    hash_edge(arr[0], arr[4], cell_index+8, table);
-    hash_edge(arr[5], arr[1], cell_index+9, table);
-    hash_edge(arr[2], arr[6], cell_index+10,table);
-    hash_edge(arr[7], arr[3], cell_index+11,table);
-    ++ci;
-  }
+  static const int edge_nodes[12][2] = { {0, 1}, {1, 2}, {2, 3}, {3, 0},
+                                         {4, 5}, {5, 6}, {6, 7}, {7, 4},
+                                         {0, 4}, {5, 1}, {2, 6}, {7, 3} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 3);
+
+  // Occurrence i is edge i%12 of cell i/12, degenerate edges are left out.
+  MeshTopologyBuilder<2> builder;
+  builder.build(num_cells * 12, [this](index_type i,
+                                       MeshTopologyBuilder<2>::key_type& key)
+  {
+    const under_type* nodes = &cells_[(i / 12) << 3];
+    const int* local = edge_nodes[i % 12];
+    const index_type n1 = nodes[local[0]], n2 = nodes[local[1]];
+    if (n1 == n2) return false;
+    key[0] = std::min(n1, n2); key[1] = std::max(n1, n2);
+    return true;
+  });
 
   // dump edges into the edges_ container.
+  const size_type num_edges = builder.num_unique();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t u = begin; u < end; ++u)
+    {
+      typename PEdgeCell::cells_type& cells = edges_[u].cells_;
+      cells.resize(builder.num_occurrences(u));
+      for (size_t j = 0; j < cells.size(); ++j)
+      {
+        const index_type i = builder.occurrence(u, j);
+        cells[j] = ((i / 12) << 4) + i % 12;
+      }
+    }
+  });
 
-  edges_.resize(table.size());
-
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
-
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+  for (index_type u = 0; u < num_edges; ++u)
   {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
+    const MeshTopologyBuilder<2>::key_type& key = builder.key(u);
+    edge_table_[PEdgeNode(key[0], key[1])] = u;
   }
 
   synchronize_lock_.lock();
@@ -3677,13 +3617,30 @@ template <class Basis>
 void
 HexVolMesh<Basis>::compute_node_neighbors()
 {
+  // Group the corners of all cells by node, the corners of each node stay
+  // in increasing order.
+  MeshTopologyBuilder<1> builder;
+  builder.build(cells_.size(), [this](index_type i,
+                                      MeshTopologyBuilder<1>::key_type& key)
+  {
+    key[0] = cells_[i];
+    return true;
+  });
+
   node_neighbors_.clear();
   node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
+  Core::Thread::Parallel::For(0, builder.num_unique(), 1024,
+    [&](size_t begin, size_t end)
   {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+    for (size_t u = begin; u < end; ++u)
+    {
+      std::vector<typename Cell::index_type>& corners =
+        node_neighbors_[builder.key(u)[0]];
+      corners.resize(builder.num_occurrences(u));
+      for (size_t j = 0; j < corners.size(); ++j)
+        corners[j] = builder.occurrence(u, j);
+    }
+  });
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -0,0 +1,346 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+///
+///@file  MeshTopologyBuilder.h
+///
+///@brief Parallel construction of the edge, face and node neighbor tables
+///       of the unstructured volume meshes.
+///
+
+#ifndef CORE_DATATYPES_LEGACY_FIELD_MESHTOPOLOGYBUILDER_H
+#define CORE_DATATYPES_LEGACY_FIELD_MESHTOPOLOGYBUILDER_H 1
+
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Datatypes/Mesh/MeshTraits.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace SCIRun {
+
+/// Replaces the values by their exclusive prefix sums, computed in parallel
+/// ranges, and returns the total.
+template <class T>
+T parallel_exclusive_scan(std::vector<T>& values)
+{
+  const size_type n = static_cast<size_type>(values.size());
+  // Small arrays are not worth the synchronization.
+  const int tasks = static_cast<int>(std::max<size_type>(1,
+    std::min<size_type>(Core::Thread::Parallel::NumCores(), n / (1 << 16) + 1)));
+  auto first = [n, tasks](int t) { return n * t / tasks; };
+
+  std::vector<T> sums(tasks + 1, 0);
+  Core::Thread::Parallel::RunTasks([&](int t)
+  {
+    T sum = 0;
+    for (index_type i = first(t); i < first(t + 1); ++i) sum += values[i];
+    sums[t + 1] = sum;
+  }, tasks);
+  for (int t = 0; t < tasks; ++t) sums[t + 1] += sums[t];
+  Core::Thread::Parallel::RunTasks([&](int t)
+  {
+    T sum = sums[t];
+    for (index_type i = first(t); i < first(t + 1); ++i)
+    {
+      const T value = values[i];
+      values[i] = sum;
+      sum += value;
+    }
+  }, tasks);
+  return (sums[tasks]);
+}
+
+
+/// Numbers the edges or faces of a mesh from its cell connectivity. Every
+/// (cell, local edge or face) occurrence gets a canonical key of K node
+/// indices. The keys are radix sorted in parallel, which puts all the
+/// occurrences of one edge or face next to each other, and a parallel scan
+/// numbers the distinct keys in sorted order. The numbering therefore does
+/// not depend on the number of threads. The sort is stable, so the
+/// occurrences of a key stay in increasing order, which is the order the
+/// serial hash table builders visited them in.
+template <int K>
+class MeshTopologyBuilder
+{
+  public:
+    typedef std::array<index_type, K> key_type;
+
+    /// make_key(occurrence, key) fills in the canonical key of an
+    /// occurrence, it returns false for degenerate occurrences, which are
+    /// left out. Keys may not be negative. It is called from several threads
+    /// at once.
+    template <class MAKEKEY>
+    void build(size_type num_occurrences, const MAKEKEY& make_key);
+
+    /// Number of distinct edges or faces.
+    size_type num_unique() const
+      { return start_.empty() ? 0 : static_cast<size_type>(start_.size()) - 1; }
+    const key_type& key(index_type unique) const
+      { return records_[start_[unique]].key; }
+    size_type num_occurrences(index_type unique) const
+      { return start_[unique + 1] - start_[unique]; }
+    /// The i-th occurrence of a distinct edge or face.
+    index_type occurrence(index_type unique, index_type i) const
+      { return records_[start_[unique] + i].occurrence; }
+    /// Distinct edge or face of an occurrence, -1 if it was left out.
+    index_type unique(index_type occurrence) const
+      { return unique_[occurrence]; }
+
+    /// Fills in the cells of every distinct face and the boundary face bits
+    /// of every cell, for a face builder whose occurrence i is face
+    /// i % faces_per_cell of cell i / faces_per_cell. combined_index(i) is
+    /// the value the mesh stores for an occurrence. faces must hold
+    /// num_unique() faces whose cells are still unset.
+    template <class FACE, class COMBINED>
+    void fill_face_cells(std::vector<FACE>& faces,
+                         std::vector<unsigned char>& boundary_faces,
+                         int faces_per_cell,
+                         const COMBINED& combined_index) const;
+
+  private:
+    struct Record
+    {
+      key_type key;
+      index_type occurrence;
+    };
+
+    static const int DIGIT_BITS = 11;
+    static const size_type NUM_BUCKETS = size_type(1) << DIGIT_BITS;
+
+    int num_tasks(size_type n) const;
+    void sort(std::vector<Record>& buffer, int tasks, const key_type& max_key);
+
+    std::vector<Record> records_;
+    std::vector<index_type> start_;
+    std::vector<index_type> unique_;
+};
+
+
+template <int K>
+int
+MeshTopologyBuilder<K>::num_tasks(size_type n) const
+{
+  // Small meshes are not worth the synchronization.
+  const size_type per_task = 1 << 16;
+  const size_type tasks = std::min<size_type>(Core::Thread::Parallel::NumCores(),
+                                              n / per_task + 1);
+  return static_cast<int>(std::max<size_type>(tasks, 1));
+}
+
+
+template <int K>
+template <class MAKEKEY>
+void
+MeshTopologyBuilder<K>::build(size_type n, const MAKEKEY& make_key)
+{
+  const int tasks = num_tasks(n);
+  auto first = [n, tasks](int t) { return n * t / tasks; };
+
+  // Count the valid occurrences, then store them in order.
+  std::vector<size_type> offsets(tasks + 1, 0);
+  std::vector<key_type> max_keys(tasks);
+  Core::Thread::Parallel::RunTasks([&](int t)
+  {
+    key_type key, max_key;
+    max_key.fill(0);
+    size_type count = 0;
+    for (index_type i = first(t); i < first(t + 1); ++i)
+    {
+      if (!make_key(i, key)) continue;
+      ++count;
+      for (int k = 0; k < K; ++k) max_key[k] = std::max(max_key[k], key[k]);
+    }
+    offsets[t + 1] = count;
+    max_keys[t] = max_key;
+  }, tasks);
+
+  key_type max_key;
+  max_key.fill(0);
+  for (int t = 0; t < tasks; ++t)
+  {
+    offsets[t + 1] += offsets[t];
+    for (int k = 0; k < K; ++k) max_key[k] = std::max(max_key[k], max_keys[t][k]);
+  }
+
+  records_.clear();
+  records_.resize(offsets[tasks]);
+  Core::Thread::Parallel::RunTasks([&](int t)
+  {
+    Record record;
+    size_type j = offsets[t];
+    for (index_type i = first(t); i < first(t + 1); ++i)
+    {
+      if (!make_key(i, record.key)) continue;
+      record.occurrence = i;
+      records_[j++] = record;
+    }
+  }, tasks);
+
+  std::vector<Record> buffer(records_.size());
+  sort(buffer, num_tasks(records_.size()), max_key);
+  buffer = std::vector<Record>();
+
+  // Number the distinct keys: flag the first occurrence of every key, the
+  // scan of the flags is the number of the key that starts there.
+  const size_type m = static_cast<size_type>(records_.size());
+  auto is_head = [this](index_type i)
+    { return i == 0 || records_[i].key != records_[i - 1].key; };
+  std::vector<index_type> heads(m);
+  Core::Thread::Parallel::For(0, m, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i) heads[i] = is_head(i) ? 1 : 0;
+  });
+  const size_type num_keys = parallel_exclusive_scan(heads);
+
+  start_.resize(num_keys + 1);
+  start_[num_keys] = m;
+  unique_.assign(n, -1);
+  Core::Thread::Parallel::For(0, m, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (is_head(i)) start_[heads[i]] = i;
+      unique_[records_[i].occurrence] = is_head(i) ? heads[i] : heads[i] - 1;
+    }
+  });
+}
+
+
+template <int K>
+template <class FACE, class COMBINED>
+void
+MeshTopologyBuilder<K>::fill_face_cells(std::vector<FACE>& faces,
+                                        std::vector<unsigned char>& boundary_faces,
+                                        int faces_per_cell,
+                                        const COMBINED& combined_index) const
+{
+  const size_type num_faces = num_unique();
+  Core::Thread::Parallel::For(0, num_faces, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t u = begin; u < end; ++u)
+    {
+      const index_type first = occurrence(u, 0);
+      faces[u].cells_[0] = combined_index(first);
+      // The second cell is the first other cell sharing the face, any
+      // further cells are illegally adjacent and are ignored.
+      for (index_type j = 1; j < num_occurrences(u); ++j)
+      {
+        const index_type other = occurrence(u, j);
+        if (other / faces_per_cell != first / faces_per_cell)
+        {
+          faces[u].cells_[1] = combined_index(other);
+          break;
+        }
+      }
+    }
+  });
+
+  // A face is on the boundary of the cell it was first seen in if no other
+  // cell shares it. Degenerate faces are never on the boundary.
+  const size_type num_cells = static_cast<size_type>(unique_.size()) / faces_per_cell;
+  boundary_faces.assign(num_cells, 0);
+  Core::Thread::Parallel::For(0, num_cells, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c)
+    {
+      for (int f = 0; f < faces_per_cell; ++f)
+      {
+        const index_type i = static_cast<index_type>(c) * faces_per_cell + f;
+        const index_type u = unique_[i];
+        if (u < 0) continue;
+        if (faces[u].cells_[1] == MESH_NO_NEIGHBOR && occurrence(u, 0) == i)
+          boundary_faces[c] |= 1 << f;
+      }
+    }
+  });
+}
+
+
+template <int K>
+void
+MeshTopologyBuilder<K>::sort(std::vector<Record>& buffer, int tasks,
+                             const key_type& max_key)
+{
+  const size_type n = static_cast<size_type>(records_.size());
+  auto first = [n, tasks](int t) { return n * t / tasks; };
+  std::vector<size_type> histogram(tasks * NUM_BUCKETS);
+  Record* source = records_.data();
+  Record* target = buffer.data();
+
+  // Least significant digit first: the last key entry, then the others.
+  for (int k = K - 1; k >= 0; --k)
+  {
+    const unsigned long long largest = static_cast<unsigned long long>(max_key[k]);
+    for (int shift = 0; shift < 64 && (largest >> shift) != 0; shift += DIGIT_BITS)
+    {
+      auto digit = [k, shift](const Record& r)
+        { return (static_cast<unsigned long long>(r.key[k]) >> shift) & (NUM_BUCKETS - 1); };
+
+      Core::Thread::Parallel::RunTasks([&](int t)
+      {
+        size_type* counts = &histogram[t * NUM_BUCKETS];
+        std::fill(counts, counts + NUM_BUCKETS, 0);
+        for (index_type i = first(t); i < first(t + 1); ++i)
+          ++counts[digit(source[i])];
+      }, tasks);
+
+      // Turn the counts into the position where each task writes each
+      // digit: digits in order, and tasks in order within a digit.
+      size_type position = 0;
+      bool single_digit = false;
+      for (size_type b = 0; b < NUM_BUCKETS; ++b)
+      {
+        const size_type start = position;
+        for (int t = 0; t < tasks; ++t)
+        {
+          const size_type count = histogram[t * NUM_BUCKETS + b];
+          histogram[t * NUM_BUCKETS + b] = position;
+          position += count;
+        }
+        if (position - start == n) single_digit = true;
+      }
+      if (single_digit) continue;
+
+      Core::Thread::Parallel::RunTasks([&](int t)
+      {
+        size_type* positions = &histogram[t * NUM_BUCKETS];
+        for (index_type i = first(t); i < first(t + 1); ++i)
+          target[positions[digit(source[i])]++] = source[i];
+      }, tasks);
+      std::swap(source, target);
+    }
+  }
+
+  if (source != records_.data()) records_.swap(buffer);
+}
+
+} // end namespace SCIRun
+
+#endif
@@ -51,6 +51,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 
 #include <Core/Utils/Legacy/CheckSum.h>
@@ -1732,6 +1733,7 @@ protected:
   {
     ASSERTMSG(synchronized_ & Mesh::EDGES_E,
 	      "PrismVolMesh: Must call synchronize EDGES_E first");
+    array.resize(edges_[idx].cells_.size());
     for (size_t i=0; i<edges_[idx].cells_.size();i++)
       array[i] = static_cast<typename ARRAY::value_type>(edges_[idx].cells_[i]);
   }
@@ -2245,7 +2247,14 @@ protected:
 
     /// true if both have the same nodes (order does not matter)
     bool operator==(const PFace &f) const {
-      if (nodes_[2] == nodes_[3])
+      if (nodes_[3] == PRISM_DUMMY_NODE_INDEX)
+      {
+        return ((f.nodes_[3] == PRISM_DUMMY_NODE_INDEX) &&
+                (nodes_[0] == f.nodes_[0]) &&
+                (((nodes_[1]==f.nodes_[1])&&(nodes_[2] == f.nodes_[2]))||
+                 ((nodes_[1]==f.nodes_[2])&&(nodes_[2] == f.nodes_[1]))));
+      }
+      else if (nodes_[2] == nodes_[3])
       {
         return ((nodes_[0] == f.nodes_[0]) &&
                 (((nodes_[1]==f.nodes_[1])&&(nodes_[2] == f.nodes_[2]))||
@@ -2431,7 +2440,14 @@ protected:
 
     /// This is the hash function
     size_t operator()(const PFace &f) const {
-      if (f.nodes_[1] < f.nodes_[3] )
+      if (f.nodes_[3] == PRISM_DUMMY_NODE_INDEX)
+      {
+        return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
+              (up4_mask & (std::min(f.nodes_[1], f.nodes_[2]) << sz_quarter_int << sz_quarter_int)) |
+              (mid4_mask & (std::max(f.nodes_[1], f.nodes_[2]) << sz_quarter_int)) |
+              (low4_mask & f.nodes_[3]));
+      }
+      else if (f.nodes_[1] < f.nodes_[3] )
       {
         return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
               (up4_mask & (f.nodes_[1] << sz_quarter_int << sz_quarter_int)) |
@@ -2496,20 +2512,24 @@ protected:
   std::vector<PEdge>            edges_;
   edge_ht                  edge_table_;
 
-  inline
-  void hash_edge(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Cell::index_type ci, edge_ht &table) const;
-
-  inline
-  void hash_face(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Node::index_type n3, typename Node::index_type n4,
-                 index_type combined_index, face_ht &table) const;
-
   template <class INDEX>
   bool order_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4) const
   {
+    // Triangles start at their smallest node, so that the faces of two
+    // neighboring prisms compare equal in either orientation.
     if( n4 == PRISM_DUMMY_NODE_INDEX )
+    {
+      INDEX t;
+      if ((n2 < n1)&&(n2 < n3))
+      {
+        t = n1; n1 = n2; n2 = n3; n3 = t;
+      }
+      else if ((n3 < n1)&&(n3 < n2))
+      {
+        t = n3; n3 = n2; n2 = n1; n1 = t;
+      }
       return (true);
+    }
 
     // Check for degenerate or misformed face
     // Opposite faces cannot be equal
@@ -2886,166 +2906,120 @@ PrismVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 
 template <class Basis>
 void
-PrismVolMesh<Basis>::hash_face(typename Node::index_type n1,
-			       typename Node::index_type n2,
-			       typename Node::index_type n3,
-			       typename Node::index_type n4,
-			       index_type combined_index,
-			       face_ht &table) const
+PrismVolMesh<Basis>::compute_faces()
 {
-  // Reorder nodes while maintaining CCW or CW orientation
-  // Check for degenerate faces, if faces has degeneracy it
-  // will be ignored (e.g. nodes on opposite corners are equal,
-  // or more then two nodes are equal)
-
-  if (!(order_face_nodes(n1,n2,n3,n4))) return;
-  PFace f(n1, n2, n3, n4);
+  // 5 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[5][4] = { {0, 1, 2, -1}, {5, 4, 3, -1}, {1, 4, 5, 2},
+                                        {2, 5, 3, 0}, {0, 3, 4, 1} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() / 6);
+
+  // Reorder nodes while maintaining CCW or CW orientation. Degenerate faces
+  // (e.g. nodes on opposite corners are equal, or more then two nodes are
+  // equal) are ignored.
+  auto ordered_nodes = [this](index_type i, index_type* n)
+  {
+    const under_type* nodes = &cells_[(i / 5) * 6];
+    const int* local = face_nodes[i % 5];
+    for (int k = 0; k < 4; ++k)
+      n[k] = local[k] < 0 ? index_type(PRISM_DUMMY_NODE_INDEX) : nodes[local[k]];
+    return order_face_nodes(n[0], n[1], n[2], n[3]);
+  };
 
-  typename face_ht::iterator iter = table.find(f);
-  if (iter == table.end())
+  // Occurrence i is face i%5 of cell i/5. The key is the node order that
+  // PFace::operator== compares, so that faces that are equal have equal
+  // keys.
+  MeshTopologyBuilder<4> builder;
+  builder.build(num_cells * 5, [&](index_type i,
+                                   MeshTopologyBuilder<4>::key_type& key)
   {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
+    index_type n[4];
+    if (!ordered_nodes(i, n)) return false;
+    key[0] = n[0];
+    if (n[3] == index_type(PRISM_DUMMY_NODE_INDEX))
     {
-      //TODO: inject new logger
-      /*
-      std::cerr << "PrismVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index >> 3)
-           << " are illegally adjacent." << std::endl;*/
+      key[1] = std::min(n[1], n[2]); key[2] = std::max(n[1], n[2]); key[3] = n[3];
     }
-    else if ((f.cells_[0]>>3) == (combined_index>>3))
+    else if (n[2] == n[3])
     {
-      //TODO: inject new logger
-      /*
-      std::cerr << "PrismVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << " and #" << (combined_index>>3)
-           << " are the same." << std::endl;
-           */
+      key[1] = std::min(n[1], n[2]); key[2] = key[3] = std::max(n[1], n[2]);
     }
     else
     {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
+      key[1] = std::min(n[1], n[3]); key[2] = n[2]; key[3] = std::max(n[1], n[3]);
     }
-  }
-}
-
-template <class Basis>
-void
-PrismVolMesh<Basis>::compute_faces()
-{
-  face_table_.clear();
+    return true;
+  });
 
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(6);
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    // 5 faces -- each is entered CCW from outside looking in
-    index_type cell_index = (*ci)<<3;
-    hash_face(arr[0], arr[1], arr[2], PRISM_DUMMY_NODE_INDEX, cell_index, face_table_);
-    hash_face(arr[5], arr[4], arr[3], PRISM_DUMMY_NODE_INDEX, cell_index + 1, face_table_);
-    hash_face(arr[1], arr[4], arr[5], arr[2], cell_index + 2, face_table_);
-    hash_face(arr[2], arr[5], arr[3], arr[0], cell_index + 3, face_table_);
-    hash_face(arr[0], arr[3], arr[4], arr[1], cell_index + 4, face_table_);
+  auto combined_index = [](index_type i) { return ((i / 5) << 3) + i % 5; };
 
-    ++ci;
-  }
-
-  // dump edges into the edges_ container.
-  faces_.resize(face_table_.size());
-  typename std::vector<PFace>::iterator f_iter = faces_.begin();
-  typename face_ht::iterator ht_iter = face_table_.begin();
-
-  boundary_faces_.resize(cells_.size() /6);
-
-  index_type i = 0;
-  while (ht_iter != face_table_.end())
+  const size_type num_faces = builder.num_unique();
+  faces_.clear();
+  faces_.resize(num_faces);
+  Core::Thread::Parallel::For(0, num_faces, 4096, [&](size_t begin, size_t end)
   {
-    *f_iter = (*ht_iter).first;
-    (*ht_iter).second = i;
-
-    if ((*f_iter).cells_[1] == -1)
+    for (size_t u = begin; u < end; ++u)
     {
-      index_type cell = ((*f_iter).cells_[0]) >> 3;
-      index_type face = ((*f_iter).cells_[0]) & 0x7;
-      boundary_faces_[cell] |= 1 << face;
+      index_type n[4];
+      ordered_nodes(builder.occurrence(u, 0), n);
+      faces_[u] = PFace(n[0], n[1], n[2], n[3]);
     }
-    ++f_iter; ++ht_iter; i++;
-  }
+  });
+
+  builder.fill_face_cells(faces_, boundary_faces_, 5, combined_index);
+
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  for (index_type u = 0; u < num_faces; ++u)
+    face_table_[faces_[u]] = u;
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-PrismVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-			       typename Node::index_type n2,
-			       typename Cell::index_type ci,
-			       edge_ht &table) const
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-  if (iter == table.end())
-  {
-    e.cells_.push_back(ci); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(ci); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 PrismVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr;
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    hash_edge(arr[0], arr[1], *ci, edge_table_);
-    hash_edge(arr[1], arr[2], *ci, edge_table_);
-    hash_edge(arr[2], arr[0], *ci, edge_table_);
-
-    hash_edge(arr[3], arr[4], *ci, edge_table_);
-    hash_edge(arr[4], arr[5], *ci, edge_table_);
-    hash_edge(arr[5], arr[3], *ci, edge_table_);
-
-    hash_edge(arr[0], arr[3], *ci, edge_table_);
-    hash_edge(arr[4], arr[1], *ci, edge_table_);
-    hash_edge(arr[2], arr[5], *ci, edge_table_);
-    ++ci;
-  }
+  static const int edge_nodes[9][2] = { {0, 1}, {1, 2}, {2, 0}, {3, 4}, {4, 5},
+                                        {5, 3}, {0, 3}, {4, 1}, {2, 5} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() / 6);
+
+  // Occurrence i is edge i%9 of cell i/9, degenerate edges are left out.
+  MeshTopologyBuilder<2> builder;
+  builder.build(num_cells * 9, [this](index_type i,
+                                      MeshTopologyBuilder<2>::key_type& key)
+  {
+    const under_type* nodes = &cells_[(i / 9) * 6];
+    const int* local = edge_nodes[i % 9];
+    const index_type n1 = nodes[local[0]], n2 = nodes[local[1]];
+    if (n1 == n2) return false;
+    key[0] = std::min(n1, n2); key[1] = std::max(n1, n2);
+    return true;
+  });
 
   // dump edges into the edges_ container.
+  const size_type num_edges = builder.num_unique();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t u = begin; u < end; ++u)
+    {
+      const MeshTopologyBuilder<2>::key_type& key = builder.key(u);
+      PEdge& edge = edges_[u];
+      edge.nodes_[0] = key[0];
+      edge.nodes_[1] = key[1];
+      edge.cells_.resize(builder.num_occurrences(u));
+      for (size_t j = 0; j < edge.cells_.size(); ++j)
+        edge.cells_[j] = builder.occurrence(u, j) / 9;
+    }
+  });
 
-  edges_.resize(edge_table_.size());
-
-  typename std::vector<PEdge>::iterator e_iter = edges_.begin();
-  typename edge_ht::iterator ht_iter = edge_table_.begin();
-  while (ht_iter != edge_table_.end()) {
-    *e_iter = (*ht_iter).first;
-    (*ht_iter).second = static_cast<typename Edge::index_type>(
-                                                      e_iter - edges_.begin());
-    ++e_iter; ++ht_iter;
-  }
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+  for (index_type u = 0; u < num_edges; ++u)
+    edge_table_[edges_[u]] = u;
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
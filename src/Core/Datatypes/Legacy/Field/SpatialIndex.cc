@@ -0,0 +1,893 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/SpatialIndex.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  typedef SpatialIndex::index_type index_type;
+  typedef SpatialIndex::size_type size_type;
+
+  struct Box
+  {
+    double lo[3];
+    double hi[3];
+
+    void set(const BBox& b)
+    {
+      const Point bmin = b.get_min();
+      const Point bmax = b.get_max();
+      for (int k = 0; k < 3; k++) { lo[k] = bmin[k]; hi[k] = bmax[k]; }
+    }
+
+    void reset()
+    {
+      for (int k = 0; k < 3; k++) { lo[k] = DBL_MAX; hi[k] = -DBL_MAX; }
+    }
+
+    void extend(const Box& b)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        lo[k] = std::min(lo[k], b.lo[k]);
+        hi[k] = std::max(hi[k], b.hi[k]);
+      }
+    }
+
+    bool contains(const double p[3]) const
+    {
+      return (p[0] >= lo[0] && p[0] <= hi[0] &&
+              p[1] >= lo[1] && p[1] <= hi[1] &&
+              p[2] >= lo[2] && p[2] <= hi[2]);
+    }
+
+    bool overlaps(const Box& b) const
+    {
+      return (b.lo[0] <= hi[0] && b.hi[0] >= lo[0] &&
+              b.lo[1] <= hi[1] && b.hi[1] >= lo[1] &&
+              b.lo[2] <= hi[2] && b.hi[2] >= lo[2]);
+    }
+
+    double distance2(const double p[3]) const
+    {
+      double d2 = 0.0;
+      for (int k = 0; k < 3; k++)
+      {
+        const double d = std::max(std::max(lo[k] - p[k], p[k] - hi[k]), 0.0);
+        d2 += d*d;
+      }
+      return (d2);
+    }
+
+    double center(int k) const { return (0.5*(lo[k] + hi[k])); }
+  };
+
+  // Number of items of which the boxes are computed by one task.
+  const size_t GATHER_GRAIN = 4096;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Uniform grid
+
+  /// The bins of the grid are stored in a unit coordinate system, the same
+  /// way SearchGridT does it, so the grid follows a transform of the mesh.
+  class UniformGridIndex : public SpatialIndex
+  {
+    public:
+      UniformGridIndex(size_type num_items, const BoxFunction& box, const BBox& bounds);
+
+      Type type() const override { return (UNIFORM_GRID); }
+
+      bool visit(const Point& p, const Visitor& visitor) const override;
+      bool visit(const BBox& box, const Visitor& visitor) const override;
+      bool find_closest(index_type& item, double& dist2, const Point& p,
+                        double maxdist2, double stopdist2,
+                        const DistanceFunction& distance) const override;
+
+      bool insert(index_type item, const BBox& box) override;
+      bool remove(index_type item, const BBox& box) override;
+      bool transform(const Transform& t) override;
+
+    private:
+      void locate_clamp(index_type& i, index_type& j, index_type& k, const Point& p) const;
+      void bin_range(index_type lo[3], index_type hi[3], const BBox& box) const;
+      double min_distance_squared(const Point& p, index_type i, index_type j, index_type k) const;
+
+      index_type linearize(index_type i, index_type j, index_type k) const
+        { return (((i * nj_) + j) * nk_ + k); }
+
+      index_type ni_, nj_, nk_;
+      Transform transform_;
+      std::vector<std::vector<index_type> > bins_;
+  };
+
+  UniformGridIndex::UniformGridIndex(size_type num_items, const BoxFunction& box,
+                                     const BBox& bounds)
+  {
+    // Cubed root of the number of items to get a subdivision ballpark, the
+    // bins are distributed over the axes according to the extent.
+    const size_type s =
+      3*static_cast<size_type>((ceil(pow(static_cast<double>(num_items), (1.0/3.0))))/2.0 + 1.0);
+
+    Point bmin = bounds.get_min();
+    Vector diag = bounds.diagonal();
+    for (int k = 0; k < 3; k++)
+    {
+      if (!(diag[k] > 0.0)) { bmin[k] -= 0.5; diag[k] = 1.0; }
+    }
+
+    const double trace = diag.x() + diag.y() + diag.z();
+    ni_ = static_cast<size_type>(ceil(0.5 + diag.x()/trace*s));
+    nj_ = static_cast<size_type>(ceil(0.5 + diag.y()/trace*s));
+    nk_ = static_cast<size_type>(ceil(0.5 + diag.z()/trace*s));
+
+    transform_.pre_scale(Vector(1.0/ni_, 1.0/nj_, 1.0/nk_));
+    transform_.pre_scale(diag);
+    transform_.pre_translate(Vector(bmin));
+    transform_.compute_imat();
+    bins_.resize(ni_*nj_*nk_);
+
+    // Finding the bins of the items is done in parallel. The bins are
+    // filled afterwards in the order of the items, which is the same order
+    // a serial insert gives.
+    const size_t num = static_cast<size_t>(num_items);
+    const size_t num_chunks = (num + GATHER_GRAIN - 1) / GATHER_GRAIN;
+    std::vector<std::vector<std::pair<index_type, index_type> > > entries(num_chunks);
+
+    Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+    {
+      index_type lo[3], hi[3];
+      for (size_t c = begin; c < end; c++)
+      {
+        const size_t last = std::min(num, (c+1)*GATHER_GRAIN);
+        for (size_t idx = c*GATHER_GRAIN; idx < last; idx++)
+        {
+          const index_type item = static_cast<index_type>(idx);
+          bin_range(lo, hi, box(item));
+          for (index_type i = lo[0]; i <= hi[0]; i++)
+            for (index_type j = lo[1]; j <= hi[1]; j++)
+              for (index_type k = lo[2]; k <= hi[2]; k++)
+                entries[c].push_back(std::make_pair(linearize(i, j, k), item));
+        }
+      }
+    });
+
+    std::vector<size_type> counts(bins_.size(), 0);
+    for (size_t c = 0; c < num_chunks; c++)
+      for (size_t e = 0; e < entries[c].size(); e++) counts[entries[c][e].first]++;
+    for (size_t b = 0; b < bins_.size(); b++) bins_[b].reserve(counts[b]);
+
+    for (size_t c = 0; c < num_chunks; c++)
+    {
+      for (size_t e = 0; e < entries[c].size(); e++)
+        bins_[entries[c][e].first].push_back(entries[c][e].second);
+      std::vector<std::pair<index_type, index_type> >().swap(entries[c]);
+    }
+  }
+
+  void
+  UniformGridIndex::locate_clamp(index_type& i, index_type& j, index_type& k,
+                                 const Point& p) const
+  {
+    const Point r = transform_.unproject(p);
+    // Clamp in double space to avoid overflow errors.
+    i = static_cast<index_type>(std::min(std::max(floor(r.x()), 0.0), static_cast<double>(ni_-1)));
+    j = static_cast<index_type>(std::min(std::max(floor(r.y()), 0.0), static_cast<double>(nj_-1)));
+    k = static_cast<index_type>(std::min(std::max(floor(r.z()), 0.0), static_cast<double>(nk_-1)));
+  }
+
+  void
+  UniformGridIndex::bin_range(index_type lo[3], index_type hi[3], const BBox& box) const
+  {
+    // All corners are located, after a rotation of the mesh the corners of
+    // the box are no longer the corners in grid space.
+    const Point bmin = box.get_min();
+    const Point bmax = box.get_max();
+    lo[0] = lo[1] = lo[2] = std::numeric_limits<index_type>::max();
+    hi[0] = hi[1] = hi[2] = 0;
+    for (int c = 0; c < 8; c++)
+    {
+      const Point corner((c & 1) ? bmax.x() : bmin.x(),
+                         (c & 2) ? bmax.y() : bmin.y(),
+                         (c & 4) ? bmax.z() : bmin.z());
+      index_type ijk[3];
+      locate_clamp(ijk[0], ijk[1], ijk[2], corner);
+      for (int d = 0; d < 3; d++)
+      {
+        lo[d] = std::min(lo[d], ijk[d]);
+        hi[d] = std::max(hi[d], ijk[d]);
+      }
+    }
+  }
+
+  double
+  UniformGridIndex::min_distance_squared(const Point& p, index_type i,
+                                         index_type j, index_type k) const
+  {
+    Point r;
+    transform_.unproject(p, r);
+
+    // Splat the point onto the cell.
+    if (r.x() < i) { r.x(i); }
+    else if (r.x() > i+1) { r.x(i+1); }
+
+    if (r.y() < j) { r.y(j); }
+    else if (r.y() > j+1) { r.y(j+1); }
+
+    if (r.z() < k) { r.z(k); }
+    else if (r.z() > k+1) { r.z(k+1); }
+
+    // Project the cell intersection back to world space.
+    Point q;
+    transform_.project(r, q);
+
+    return ((p - q).length2());
+  }
+
+  bool
+  UniformGridIndex::visit(const Point& p, const Visitor& visitor) const
+  {
+    const Point r = transform_.unproject(p);
+    const double rx = floor(r.x());
+    const double ry = floor(r.y());
+    const double rz = floor(r.z());
+
+    if (rx < 0.0 || ry < 0.0 || rz < 0.0 || rx >= ni_ || ry >= nj_ || rz >= nk_)
+      return (false);
+
+    const std::vector<index_type>& bin = bins_[linearize(static_cast<index_type>(rx),
+      static_cast<index_type>(ry), static_cast<index_type>(rz))];
+    for (size_t q = 0; q < bin.size(); q++)
+      if (visitor(bin[q])) return (true);
+
+    return (false);
+  }
+
+  bool
+  UniformGridIndex::visit(const BBox& box, const Visitor& visitor) const
+  {
+    index_type lo[3], hi[3];
+    bin_range(lo, hi, box);
+    for (index_type i = lo[0]; i <= hi[0]; i++)
+      for (index_type j = lo[1]; j <= hi[1]; j++)
+        for (index_type k = lo[2]; k <= hi[2]; k++)
+        {
+          const std::vector<index_type>& bin = bins_[linearize(i, j, k)];
+          for (size_t q = 0; q < bin.size(); q++)
+            if (visitor(bin[q])) return (true);
+        }
+
+    return (false);
+  }
+
+  bool
+  UniformGridIndex::find_closest(index_type& item, double& dist2, const Point& p,
+                                 double maxdist2, double stopdist2,
+                                 const DistanceFunction& distance) const
+  {
+    index_type bi, bj, bk;
+    locate_clamp(bi, bj, bk, p);
+    index_type ei = bi, ej = bj, ek = bk;
+
+    double dmin = maxdist2;
+    bool found_one = false;
+    bool found;
+
+    do
+    {
+      found = true;
+      /// We need to do a full shell without any items that are closer
+      /// to make sure there no closer items in neighboring cells
+      for (index_type i = std::max(bi, index_type(0)); i <= std::min(ei, ni_-1); i++)
+      {
+        for (index_type j = std::max(bj, index_type(0)); j <= std::min(ej, nj_-1); j++)
+        {
+          for (index_type k = std::max(bk, index_type(0)); k <= std::min(ek, nk_-1); k++)
+          {
+            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
+            {
+              if (min_distance_squared(p, i, j, k) < dmin)
+              {
+                found = false;
+                const std::vector<index_type>& bin = bins_[linearize(i, j, k)];
+                for (size_t q = 0; q < bin.size(); q++)
+                {
+                  const double d = distance(bin[q]);
+                  if (d < dmin)
+                  {
+                    found_one = true;
+                    item = bin[q];
+                    dmin = d;
+                    if (dmin < stopdist2)
+                    {
+                      dist2 = dmin;
+                      return (true);
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+      bi--; ei++;
+      bj--; ej++;
+      bk--; ek++;
+    }
+    while (!found);
+
+    if (!found_one) return (false);
+    dist2 = dmin;
+    return (true);
+  }
+
+  bool
+  UniformGridIndex::insert(index_type item, const BBox& box)
+  {
+    index_type lo[3], hi[3];
+    bin_range(lo, hi, box);
+    for (index_type i = lo[0]; i <= hi[0]; i++)
+      for (index_type j = lo[1]; j <= hi[1]; j++)
+        for (index_type k = lo[2]; k <= hi[2]; k++)
+          bins_[linearize(i, j, k)].push_back(item);
+    return (true);
+  }
+
+  bool
+  UniformGridIndex::remove(index_type item, const BBox& box)
+  {
+    index_type lo[3], hi[3];
+    bin_range(lo, hi, box);
+    for (index_type i = lo[0]; i <= hi[0]; i++)
+      for (index_type j = lo[1]; j <= hi[1]; j++)
+        for (index_type k = lo[2]; k <= hi[2]; k++)
+        {
+          std::vector<index_type>& bin = bins_[linearize(i, j, k)];
+          bin.erase(std::remove(bin.begin(), bin.end(), item), bin.end());
+        }
+    return (true);
+  }
+
+  bool
+  UniformGridIndex::transform(const Transform& t)
+  {
+    transform_.pre_trans(t);
+    return (true);
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Trees
+
+  /// Shared storage and queries of the octree and the bounding volume
+  /// hierarchy. The children of a node are stored next to each other and a
+  /// leaf refers to a range of items_.
+  class TreeIndex : public SpatialIndex
+  {
+    public:
+      bool visit(const Point& p, const Visitor& visitor) const override;
+      bool visit(const BBox& box, const Visitor& visitor) const override;
+      bool find_closest(index_type& item, double& dist2, const Point& p,
+                        double maxdist2, double stopdist2,
+                        const DistanceFunction& distance) const override;
+
+    protected:
+      struct Node
+      {
+        Box box;
+        /// First child, or the first item of a leaf
+        index_type first;
+        /// Number of items of a leaf
+        index_type count;
+        /// Number of children, 0 for a leaf
+        int children;
+      };
+
+      struct Tree
+      {
+        std::vector<Node> nodes;
+        std::vector<index_type> items;
+      };
+
+      /// Both trees stay far below this depth, see the build functions.
+      static const int STACK_SIZE = 256;
+
+      void gather_boxes(size_type num_items, const BoxFunction& box);
+
+      static void make_leaf(Tree& tree, index_type node, const index_type* items, size_t num);
+
+      /// Move a subtree that was built on its own, with its root as node 0,
+      /// into the place of node.
+      void splice(index_type node, const Tree& sub);
+
+      std::vector<Box> boxes_;
+      Tree tree_;
+  };
+
+  void
+  TreeIndex::gather_boxes(size_type num_items, const BoxFunction& box)
+  {
+    boxes_.resize(num_items);
+    Parallel::For(0, boxes_.size(), GATHER_GRAIN, [&](size_t begin, size_t end)
+    {
+      for (size_t idx = begin; idx < end; idx++)
+        boxes_[idx].set(box(static_cast<index_type>(idx)));
+    });
+  }
+
+  void
+  TreeIndex::make_leaf(Tree& tree, index_type node, const index_type* items, size_t num)
+  {
+    Node& leaf = tree.nodes[node];
+    leaf.first = static_cast<index_type>(tree.items.size());
+    leaf.count = static_cast<index_type>(num);
+    leaf.children = 0;
+    tree.items.insert(tree.items.end(), items, items + num);
+  }
+
+  void
+  TreeIndex::splice(index_type node, const Tree& sub)
+  {
+    // Node j > 0 of the subtree goes to node_offset + j
+    const index_type node_offset = static_cast<index_type>(tree_.nodes.size()) - 1;
+    const index_type item_offset = static_cast<index_type>(tree_.items.size());
+
+    for (size_t j = 0; j < sub.nodes.size(); j++)
+    {
+      Node n = sub.nodes[j];
+      n.first += (n.children ? node_offset : item_offset);
+      if (j == 0) tree_.nodes[node] = n;
+      else tree_.nodes.push_back(n);
+    }
+    tree_.items.insert(tree_.items.end(), sub.items.begin(), sub.items.end());
+  }
+
+  bool
+  TreeIndex::visit(const Point& p, const Visitor& visitor) const
+  {
+    if (tree_.nodes.empty()) return (false);
+
+    const double pp[3] = { p.x(), p.y(), p.z() };
+    index_type stack[STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+      const Node& node = tree_.nodes[stack[--sp]];
+      if (!node.box.contains(pp)) continue;
+
+      if (node.children == 0)
+      {
+        for (index_type q = node.first; q < node.first + node.count; q++)
+        {
+          const index_type item = tree_.items[q];
+          if (boxes_[item].contains(pp) && visitor(item)) return (true);
+        }
+        continue;
+      }
+
+      for (int c = node.children - 1; c >= 0; c--) stack[sp++] = node.first + c;
+    }
+
+    return (false);
+  }
+
+  bool
+  TreeIndex::visit(const BBox& bbox, const Visitor& visitor) const
+  {
+    if (tree_.nodes.empty()) return (false);
+
+    Box box;
+    box.set(bbox);
+    index_type stack[STACK_SIZE];
+    int sp = 0;
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+      const Node& node = tree_.nodes[stack[--sp]];
+      if (!node.box.overlaps(box)) continue;
+
+      if (node.children == 0)
+      {
+        for (index_type q = node.first; q < node.first + node.count; q++)
+        {
+          const index_type item = tree_.items[q];
+          if (boxes_[item].overlaps(box) && visitor(item)) return (true);
+        }
+        continue;
+      }
+
+      for (int c = node.children - 1; c >= 0; c--) stack[sp++] = node.first + c;
+    }
+
+    return (false);
+  }
+
+  bool
+  TreeIndex::find_closest(index_type& item, double& dist2, const Point& p,
+                          double maxdist2, double stopdist2,
+                          const DistanceFunction& distance) const
+  {
+    if (tree_.nodes.empty()) return (false);
+
+    const double pp[3] = { p.x(), p.y(), p.z() };
+    index_type stack[STACK_SIZE];
+    double stack_d2[STACK_SIZE];
+    int sp = 0;
+    stack[sp] = 0;
+    stack_d2[sp++] = tree_.nodes[0].box.distance2(pp);
+
+    double dmin = maxdist2;
+    bool found_one = false;
+
+    while (sp > 0)
+    {
+      --sp;
+      if (stack_d2[sp] >= dmin) continue;
+      const Node& node = tree_.nodes[stack[sp]];
+
+      if (node.children == 0)
+      {
+        for (index_type q = node.first; q < node.first + node.count; q++)
+        {
+          const index_type idx = tree_.items[q];
+          if (boxes_[idx].distance2(pp) >= dmin) continue;
+
+          const double d = distance(idx);
+          if (d < dmin)
+          {
+            found_one = true;
+            item = idx;
+            dmin = d;
+            if (dmin < stopdist2)
+            {
+              dist2 = dmin;
+              return (true);
+            }
+          }
+        }
+        continue;
+      }
+
+      // Push the children that are in range, farthest first so the nearest
+      // one is visited first.
+      index_type child[8];
+      double child_d2[8];
+      int num = 0;
+      for (int c = 0; c < node.children; c++)
+      {
+        const double d = tree_.nodes[node.first + c].box.distance2(pp);
+        if (d >= dmin) continue;
+        int pos = num++;
+        while (pos > 0 && child_d2[pos-1] < d)
+        {
+          child[pos] = child[pos-1]; child_d2[pos] = child_d2[pos-1]; pos--;
+        }
+        child[pos] = node.first + c; child_d2[pos] = d;
+      }
+      for (int c = 0; c < num; c++) { stack[sp] = child[c]; stack_d2[sp++] = child_d2[c]; }
+    }
+
+    if (!found_one) return (false);
+    dist2 = dmin;
+    return (true);
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Octree
+
+  /// The cells are half open, so an item that is a point ends up in one
+  /// leaf only. An item is stored in every leaf its box overlaps.
+  class OctreeIndex : public TreeIndex
+  {
+    public:
+      OctreeIndex(size_type num_items, const BoxFunction& box, const BBox& bounds);
+
+      Type type() const override { return (OCTREE); }
+
+    private:
+      static const size_t LEAF_SIZE = 16;
+      static const int MAX_DEPTH = 12;
+      /// Depth at which the subtrees are handed to the threads, up to 8^2.
+      static const int TASK_DEPTH = 2;
+
+      struct BuildTask
+      {
+        index_type node;
+        Box cell;
+        std::vector<index_type> items;
+      };
+
+      void build(Tree& tree, index_type node, const Box& cell,
+                 std::vector<index_type>& items, int depth,
+                 std::vector<BuildTask>* tasks) const;
+
+      bool overlaps_cell(const Box& cell, index_type item) const
+      {
+        const Box& b = boxes_[item];
+        return (b.lo[0] < cell.hi[0] && b.hi[0] >= cell.lo[0] &&
+                b.lo[1] < cell.hi[1] && b.hi[1] >= cell.lo[1] &&
+                b.lo[2] < cell.hi[2] && b.hi[2] >= cell.lo[2]);
+      }
+  };
+
+  OctreeIndex::OctreeIndex(size_type num_items, const BoxFunction& box, const BBox& bounds)
+  {
+    gather_boxes(num_items, box);
+    if (boxes_.empty()) return;
+
+    Box root;
+    root.set(bounds);
+    for (size_t idx = 0; idx < boxes_.size(); idx++) root.extend(boxes_[idx]);
+    // The upper sides of a cell are open, make sure they are beyond any item
+    for (int k = 0; k < 3; k++)
+      root.hi[k] += 1e-6*std::max(root.hi[k] - root.lo[k], std::fabs(root.hi[k])) + DBL_MIN;
+
+    std::vector<index_type> items(boxes_.size());
+    for (size_t idx = 0; idx < items.size(); idx++) items[idx] = static_cast<index_type>(idx);
+
+    // Build the top levels on this thread and the subtrees below them
+    // concurrently, the result does not depend on the number of threads.
+    std::vector<BuildTask> tasks;
+    tree_.nodes.resize(1);
+    build(tree_, 0, root, items, 0, &tasks);
+
+    std::vector<Tree> subtrees(tasks.size());
+    Parallel::For(0, tasks.size(), 1, [&](size_t begin, size_t end)
+    {
+      for (size_t t = begin; t < end; t++)
+      {
+        subtrees[t].nodes.resize(1);
+        build(subtrees[t], 0, tasks[t].cell, tasks[t].items, TASK_DEPTH, nullptr);
+        std::vector<index_type>().swap(tasks[t].items);
+      }
+    });
+
+    for (size_t t = 0; t < tasks.size(); t++) splice(tasks[t].node, subtrees[t]);
+  }
+
+  void
+  OctreeIndex::build(Tree& tree, index_type node, const Box& cell,
+                     std::vector<index_type>& items, int depth,
+                     std::vector<BuildTask>* tasks) const
+  {
+    tree.nodes[node].box = cell;
+
+    if (items.size() <= LEAF_SIZE || depth >= MAX_DEPTH)
+    {
+      make_leaf(tree, node, items.data(), items.size());
+      return;
+    }
+
+    if (tasks && depth == TASK_DEPTH)
+    {
+      tasks->push_back(BuildTask{ node, cell, std::vector<index_type>() });
+      tasks->back().items.swap(items);
+      return;
+    }
+
+    Box child_cell[8];
+    std::vector<index_type> child_items[8];
+    size_t total = 0;
+    for (int c = 0; c < 8; c++)
+    {
+      for (int k = 0; k < 3; k++)
+      {
+        const double mid = cell.center(k);
+        const bool upper = ((c >> k) & 1) != 0;
+        child_cell[c].lo[k] = upper ? mid : cell.lo[k];
+        child_cell[c].hi[k] = upper ? cell.hi[k] : mid;
+      }
+      for (size_t q = 0; q < items.size(); q++)
+        if (overlaps_cell(child_cell[c], items[q])) child_items[c].push_back(items[q]);
+      total += child_items[c].size();
+    }
+
+    // Items that are as large as the cell would be copied into most of the
+    // children without separating anything.
+    if (total > 2*items.size())
+    {
+      make_leaf(tree, node, items.data(), items.size());
+      return;
+    }
+    std::vector<index_type>().swap(items);
+
+    const index_type first = static_cast<index_type>(tree.nodes.size());
+    tree.nodes[node].first = first;
+    tree.nodes[node].count = 0;
+    tree.nodes[node].children = 8;
+    tree.nodes.resize(tree.nodes.size() + 8);
+
+    for (int c = 0; c < 8; c++)
+      build(tree, first + c, child_cell[c], child_items[c], depth + 1, tasks);
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+  // Bounding volume hierarchy
+
+  /// Median split along the longest axis of the box centers, as ElemBVH
+  /// does. Every item is stored once.
+  class BVHIndex : public TreeIndex
+  {
+    public:
+      BVHIndex(size_type num_items, const BoxFunction& box);
+
+      Type type() const override { return (BVH); }
+
+    private:
+      static const size_t LEAF_SIZE = 4;
+
+      struct BuildTask
+      {
+        index_type node;
+        size_t begin, end;
+      };
+
+      void build(Tree& tree, index_type node, std::vector<index_type>& order,
+                 size_t begin, size_t end, std::vector<BuildTask>* tasks,
+                 size_t task_size) const;
+  };
+
+  BVHIndex::BVHIndex(size_type num_items, const BoxFunction& box)
+  {
+    gather_boxes(num_items, box);
+    if (boxes_.empty()) return;
+
+    std::vector<index_type> order(boxes_.size());
+    for (size_t idx = 0; idx < order.size(); idx++) order[idx] = static_cast<index_type>(idx);
+
+    // Split the top of the tree on this thread until there are a few ranges
+    // per core. The depth is about log2(n/LEAF_SIZE), far below STACK_SIZE.
+    std::vector<BuildTask> tasks;
+    const size_t task_size = std::max(order.size() / (8*Parallel::NumCores()), size_t(1024));
+    tree_.nodes.resize(1);
+    build(tree_, 0, order, 0, order.size(), &tasks, task_size);
+
+    std::vector<Tree> subtrees(tasks.size());
+    Parallel::For(0, tasks.size(), 1, [&](size_t begin, size_t end)
+    {
+      for (size_t t = begin; t < end; t++)
+      {
+        subtrees[t].nodes.resize(1);
+        build(subtrees[t], 0, order, tasks[t].begin, tasks[t].end, nullptr, 0);
+      }
+    });
+
+    for (size_t t = 0; t < tasks.size(); t++) splice(tasks[t].node, subtrees[t]);
+  }
+
+  void
+  BVHIndex::build(Tree& tree, index_type node, std::vector<index_type>& order,
+                  size_t begin, size_t end, std::vector<BuildTask>* tasks,
+                  size_t task_size) const
+  {
+    const size_t n = end - begin;
+    if (tasks && n <= task_size)
+    {
+      tasks->push_back({ node, begin, end });
+      return;
+    }
+
+    Box box, centers;
+    box.reset();
+    centers.reset();
+    for (size_t i = begin; i < end; i++)
+    {
+      const Box& b = boxes_[order[i]];
+      box.extend(b);
+      for (int k = 0; k < 3; k++)
+      {
+        centers.lo[k] = std::min(centers.lo[k], b.center(k));
+        centers.hi[k] = std::max(centers.hi[k], b.center(k));
+      }
+    }
+    tree.nodes[node].box = box;
+
+    if (n <= LEAF_SIZE)
+    {
+      make_leaf(tree, node, order.data() + begin, n);
+      return;
+    }
+
+    int axis = 0;
+    if (centers.hi[1]-centers.lo[1] > centers.hi[axis]-centers.lo[axis]) axis = 1;
+    if (centers.hi[2]-centers.lo[2] > centers.hi[axis]-centers.lo[axis]) axis = 2;
+
+    const size_t mid = begin + n/2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+      [this, axis](index_type i1, index_type i2)
+      { return (boxes_[i1].center(axis) < boxes_[i2].center(axis)); });
+
+    const index_type first = static_cast<index_type>(tree.nodes.size());
+    tree.nodes[node].first = first;
+    tree.nodes[node].count = 0;
+    tree.nodes[node].children = 2;
+    tree.nodes.resize(tree.nodes.size() + 2);
+
+    build(tree, first, order, begin, mid, tasks, task_size);
+    build(tree, first + 1, order, mid, end, tasks, task_size);
+  }
+}
+
+SpatialIndexHandle
+SpatialIndex::create(Type type, size_type num_items, const BoxFunction& box,
+                     const BBox& bounds)
+{
+  switch (type)
+  {
+    case OCTREE:
+      return (SpatialIndexHandle(new OctreeIndex(num_items, box, bounds)));
+    case BVH:
+      return (SpatialIndexHandle(new BVHIndex(num_items, box)));
+    default:
+      return (SpatialIndexHandle(new UniformGridIndex(num_items, box, bounds)));
+  }
+}
+
+std::string
+SpatialIndex::type_name(Type type)
+{
+  switch (type)
+  {
+    case OCTREE: return ("Octree");
+    case BVH: return ("BVH");
+    default: return ("UniformGrid");
+  }
+}
+
+SpatialIndex::~SpatialIndex()
+{
+}
+
+bool
+SpatialIndex::insert(index_type, const BBox&)
+{
+  return (false);
+}
+
+bool
+SpatialIndex::remove(index_type, const BBox&)
+{
+  return (false);
+}
+
+bool
+SpatialIndex::transform(const Transform&)
+{
+  return (false);
+}
@@ -0,0 +1,125 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+///
+///@file  SpatialIndex.h
+///
+///@brief Spatial indices that narrow down the nodes or elements of a mesh
+///       near a point or a box.
+///
+
+#ifndef CORE_DATATYPES_LEGACY_FIELD_SPATIALINDEX_H
+#define CORE_DATATYPES_LEGACY_FIELD_SPATIALINDEX_H 1
+
+#include <Core/GeometryPrimitives/BBox.h>
+#include <Core/GeometryPrimitives/Transform.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Utils/SmartPointers.h>
+#include <functional>
+#include <string>
+
+#include <Core/Datatypes/Legacy/Field/share.h>
+
+namespace SCIRun {
+
+class SpatialIndex;
+typedef SharedPointer<SpatialIndex> SpatialIndexHandle;
+
+/// An index stores a bounding box for every item (a node or an element) and
+/// returns the candidates for a query, the mesh does the exact geometric
+/// tests. Queries do not modify the index and keep their state on the
+/// stack, so any number of threads can query the same index.
+class SCISHARE SpatialIndex
+{
+  public:
+    typedef SCIRun::index_type index_type;
+    typedef SCIRun::size_type  size_type;
+
+    enum Type
+    {
+      /// Bins of equal size. Works best when the items have similar sizes.
+      UNIFORM_GRID = 0,
+      /// Adaptive subdivision of the bounding box, it refines where there
+      /// are many small items.
+      OCTREE,
+      /// Balanced bounding volume hierarchy, its depth does not depend on
+      /// how the items are distributed.
+      BVH
+    };
+
+    /// Returns the bounding box of an item. It is called from several
+    /// threads at once while an index is built.
+    typedef std::function<Core::Geometry::BBox(index_type)> BoxFunction;
+    /// Called for every candidate of a query, returning true ends the query.
+    typedef std::function<bool(index_type)> Visitor;
+    /// Squared distance between the query point and an item. It cannot be
+    /// smaller than the distance to the box of the item; DBL_MAX skips it.
+    typedef std::function<double(index_type)> DistanceFunction;
+
+    /// Build an index over the items 0 .. num_items-1, bounds should
+    /// enclose the boxes of all of them.
+    static SpatialIndexHandle create(Type type, size_type num_items,
+                                     const BoxFunction& box,
+                                     const Core::Geometry::BBox& bounds);
+
+    static std::string type_name(Type type);
+
+    virtual ~SpatialIndex();
+
+    virtual Type type() const = 0;
+
+    /// Visit the items that may contain p. Returns true if the visitor
+    /// ended the query.
+    virtual bool visit(const Core::Geometry::Point& p,
+                       const Visitor& visitor) const = 0;
+
+    /// Visit the items that may overlap box, an item can be visited more
+    /// than once.
+    virtual bool visit(const Core::Geometry::BBox& box,
+                       const Visitor& visitor) const = 0;
+
+    /// Find the item with the smallest distance that is below maxdist2.
+    /// The search stops as soon as an item closer than stopdist2 is found.
+    /// Returns false if no item is closer than maxdist2.
+    virtual bool find_closest(index_type& item, double& dist2,
+                              const Core::Geometry::Point& p,
+                              double maxdist2, double stopdist2,
+                              const DistanceFunction& distance) const = 0;
+
+    /// Incremental updates. They return false if the index cannot be
+    /// updated and needs to be rebuilt.
+    virtual bool insert(index_type item, const Core::Geometry::BBox& box);
+    virtual bool remove(index_type item, const Core::Geometry::BBox& box);
+
+    /// Apply a transform to the geometry that was indexed. Returns false if
+    /// the index needs to be rebuilt.
+    virtual bool transform(const Core::Geometry::Transform& t);
+};
+
+} // end namespace SCIRun
+
+#endif
@@ -0,0 +1,255 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/ElemBVH.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/GeometryPrimitives/CompGeom.h>
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  // Height field whose spacing shrinks quadratically towards the origin, so
+  // the element sizes differ by orders of magnitude.
+  Point surface_point(int i, int j, int n)
+  {
+    const double u = static_cast<double>(i)/n, v = static_cast<double>(j)/n;
+    const double x = u*u, y = v*v;
+    return (Point(x, y, 0.3*sin(3.0*x)*cos(2.0*y)));
+  }
+
+  MeshHandle make_surface(const std::string& type, int n)
+  {
+    FieldInformation fi(type, 1, "double");
+    MeshHandle mesh = CreateMesh(fi);
+    VMesh* vmesh = mesh->vmesh();
+
+    for (int j = 0; j <= n; j++)
+      for (int i = 0; i <= n; i++)
+        vmesh->add_point(surface_point(i, j, n));
+
+    auto add_elem = [vmesh](std::initializer_list<VMesh::index_type> ids)
+    {
+      VMesh::Node::array_type nodes(ids.size());
+      std::copy(ids.begin(), ids.end(), nodes.begin());
+      vmesh->add_elem(nodes);
+    };
+
+    for (int j = 0; j < n; j++)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        const VMesh::index_type n00 = j*(n+1) + i, n10 = n00 + 1;
+        const VMesh::index_type n01 = n00 + n + 1, n11 = n01 + 1;
+        if (type == "QuadSurfMesh")
+        {
+          add_elem({ n00, n10, n11, n01 });
+        }
+        else
+        {
+          add_elem({ n00, n10, n11 });
+          add_elem({ n00, n11, n01 });
+        }
+      }
+    }
+    return (mesh);
+  }
+
+  // Reference answer that tests every element.
+  double brute_force_distance(VMesh* mesh, const Point& p)
+  {
+    VMesh::Node::array_type nodes;
+    VMesh::Elem::size_type num_elems = mesh->num_elems();
+    double best = DBL_MAX;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      std::vector<Point> pts(nodes.size());
+      for (size_t k = 0; k < nodes.size(); k++) mesh->get_center(pts[k], nodes[k]);
+
+      Point r;
+      if (nodes.size() == 2)
+      {
+        best = std::min(best, distance_to_line2(p, pts[0], pts[1]));
+        continue;
+      }
+      closest_point_on_tri(r, p, pts[0], pts[1], pts[2]);
+      best = std::min(best, (p - r).length2());
+      if (nodes.size() == 4)
+      {
+        closest_point_on_tri(r, p, pts[0], pts[2], pts[3]);
+        best = std::min(best, (p - r).length2());
+      }
+    }
+    return (sqrt(best));
+  }
+
+  std::vector<Point> query_points(size_t num)
+  {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> coord(-0.5, 1.5);
+    std::vector<Point> points(num);
+    for (auto& p : points) p = Point(coord(gen), coord(gen), coord(gen));
+    return (points);
+  }
+}
+
+TEST(ElemBVHTests, SupportsCurveAndSurfaceMeshesOnly)
+{
+  FieldInformation tri("TriSurfMesh", 1, "double");
+  FieldInformation quad("QuadSurfMesh", 1, "double");
+  FieldInformation curve("CurveMesh", 1, "double");
+  FieldInformation tet("TetVolMesh", 1, "double");
+
+  EXPECT_TRUE(ElemBVH::supports(CreateMesh(tri)->vmesh()));
+  EXPECT_TRUE(ElemBVH::supports(CreateMesh(quad)->vmesh()));
+  EXPECT_TRUE(ElemBVH::supports(CreateMesh(curve)->vmesh()));
+  EXPECT_FALSE(ElemBVH::supports(CreateMesh(tet)->vmesh()));
+}
+
+TEST(ElemBVHTests, TriSurfMatchesBruteForceAndSearchGrid)
+{
+  MeshHandle mesh = make_surface("TriSurfMesh", 24);
+  VMesh* vmesh = mesh->vmesh();
+  vmesh->synchronize(Mesh::FIND_CLOSEST_ELEM_E);
+  ElemBVH bvh(vmesh);
+  EXPECT_EQ(bvh.num_primitives(), 2u*24*24);
+
+  for (const auto& p : query_points(300))
+  {
+    double dist, griddist;
+    Point r, gridr;
+    VMesh::Elem::index_type elem, gridelem;
+    ASSERT_TRUE(bvh.find_closest_elem(dist, r, elem, p));
+    ASSERT_TRUE(vmesh->find_closest_elem(griddist, gridr, gridelem, p));
+
+    EXPECT_NEAR(brute_force_distance(vmesh, p), dist, 1e-10);
+    EXPECT_NEAR(griddist, dist, 1e-10);
+    EXPECT_NEAR((p - r).length(), dist, 1e-10);
+
+    // The closest point has to lie on the element that was returned
+    Point onelem;
+    VMesh::Node::array_type nodes;
+    vmesh->get_nodes(nodes, elem);
+    Point a, b, c;
+    vmesh->get_center(a, nodes[0]);
+    vmesh->get_center(b, nodes[1]);
+    vmesh->get_center(c, nodes[2]);
+    closest_point_on_tri(onelem, r, a, b, c);
+    EXPECT_NEAR(0.0, (onelem - r).length(), 1e-10);
+  }
+}
+
+TEST(ElemBVHTests, QuadSurfMatchesBruteForce)
+{
+  MeshHandle mesh = make_surface("QuadSurfMesh", 20);
+  VMesh* vmesh = mesh->vmesh();
+  ElemBVH bvh(vmesh);
+  EXPECT_EQ(bvh.num_primitives(), 2u*20*20);
+
+  for (const auto& p : query_points(200))
+  {
+    double dist;
+    Point r;
+    VMesh::Elem::index_type elem;
+    ASSERT_TRUE(bvh.find_closest_elem(dist, r, elem, p));
+    EXPECT_NEAR(brute_force_distance(vmesh, p), dist, 1e-10);
+    EXPECT_GE(elem, 0);
+    EXPECT_LT(elem, 20*20);
+  }
+}
+
+TEST(ElemBVHTests, CurveMatchesBruteForce)
+{
+  FieldInformation fi("CurveMesh", 1, "double");
+  MeshHandle mesh = CreateMesh(fi);
+  VMesh* vmesh = mesh->vmesh();
+  const int n = 200;
+  for (int i = 0; i <= n; i++)
+  {
+    const double t = static_cast<double>(i)/n;
+    vmesh->add_point(Point(t*t, cos(6.0*t), sin(6.0*t)));
+  }
+  VMesh::Node::array_type nodes(2);
+  for (int i = 0; i < n; i++)
+  {
+    nodes[0] = i; nodes[1] = i+1;
+    vmesh->add_elem(nodes);
+  }
+
+  ElemBVH bvh(vmesh);
+  for (const auto& p : query_points(200))
+  {
+    double dist;
+    Point r;
+    VMesh::Elem::index_type elem;
+    ASSERT_TRUE(bvh.find_closest_elem(dist, r, elem, p));
+    EXPECT_NEAR(brute_force_distance(vmesh, p), dist, 1e-10);
+  }
+}
+
+TEST(ElemBVHTests, MaximumDistanceLimitsSearch)
+{
+  MeshHandle mesh = make_surface("TriSurfMesh", 8);
+  ElemBVH bvh(mesh->vmesh());
+
+  double dist;
+  Point r;
+  VMesh::Elem::index_type elem;
+  const Point p(0.5, 0.5, 10.0);
+  EXPECT_FALSE(bvh.find_closest_elem(dist, r, elem, p, 1.0));
+  EXPECT_TRUE(bvh.find_closest_elem(dist, r, elem, p, 20.0));
+  EXPECT_LT(dist, 20.0);
+}
+
+TEST(ElemBVHTests, BatchedQueriesMatchSingleQueries)
+{
+  MeshHandle mesh = make_surface("TriSurfMesh", 32);
+  ElemBVH bvh(mesh->vmesh());
+
+  const auto points = query_points(2000);
+  std::vector<ElemBVH::Hit> hits;
+  bvh.find_closest_elems(points, hits);
+  ASSERT_EQ(points.size(), hits.size());
+
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    double dist;
+    Point r;
+    VMesh::Elem::index_type elem;
+    ASSERT_TRUE(bvh.find_closest_elem(dist, r, elem, points[i]));
+    EXPECT_DOUBLE_EQ(dist, hits[i].distance);
+    EXPECT_GE(hits[i].elem, 0);
+  }
+}
@@ -0,0 +1,291 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  typedef std::vector<VMesh::index_type> IndexList;
+
+  struct CellType
+  {
+    int nodes_per_cell;
+    /// Local faces, -1 pads the triangles of the prisms.
+    std::vector<std::vector<int>> faces;
+    std::vector<std::pair<int, int>> edges;
+    /// Hexahedra list all the other nodes of their cells as node
+    /// neighbors, prisms only the nodes they share an edge with.
+    bool cell_node_neighbors;
+  };
+
+  const CellType hex_type = { 8,
+    { {0, 1, 2, 3}, {7, 6, 5, 4}, {0, 4, 5, 1}, {2, 6, 7, 3}, {3, 7, 4, 0}, {1, 5, 6, 2} },
+    { {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6}, {6, 7}, {7, 4},
+      {0, 4}, {5, 1}, {2, 6}, {7, 3} },
+    true };
+
+  const CellType prism_type = { 6,
+    { {0, 1, 2, -1}, {5, 4, 3, -1}, {1, 4, 5, 2}, {2, 5, 3, 0}, {0, 3, 4, 1} },
+    { {0, 1}, {1, 2}, {2, 0}, {3, 4}, {4, 5}, {5, 3}, {0, 3}, {1, 4}, {2, 5} },
+    false };
+
+  IndexList distinct(IndexList nodes)
+  {
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return (nodes);
+  }
+
+  /// Expected topology, computed straight from the cells. A face is keyed
+  /// by its distinct nodes. Quad faces with equal opposite corners, or with
+  /// fewer than three distinct nodes, do not exist.
+  struct Adjacency
+  {
+    std::map<IndexList, IndexList> face_cells;
+    std::map<IndexList, IndexList> edge_cells;
+    std::vector<std::set<VMesh::index_type>> node_neighbors;
+    std::vector<std::set<VMesh::index_type>> node_cells;
+
+    Adjacency(const CellType& type, const std::vector<IndexList>& cells, size_t num_nodes)
+      : node_neighbors(num_nodes), node_cells(num_nodes)
+    {
+      for (size_t c = 0; c < cells.size(); ++c)
+      {
+        const IndexList& n = cells[c];
+        for (const std::vector<int>& f : type.faces)
+        {
+          IndexList face;
+          for (int k : f) if (k >= 0) face.push_back(n[k]);
+          if (face.size() == 4 && (face[0] == face[2] || face[1] == face[3])) continue;
+          face = distinct(face);
+          if (face.size() < 3) continue;
+          face_cells[face].push_back(c);
+        }
+        for (const std::pair<int, int>& e : type.edges)
+        {
+          if (n[e.first] == n[e.second]) continue;
+          edge_cells[distinct({ n[e.first], n[e.second] })].push_back(c);
+          if (!type.cell_node_neighbors)
+          {
+            node_neighbors[n[e.first]].insert(n[e.second]);
+            node_neighbors[n[e.second]].insert(n[e.first]);
+          }
+        }
+        for (VMesh::index_type a : n)
+        {
+          node_cells[a].insert(c);
+          if (type.cell_node_neighbors)
+            for (VMesh::index_type b : n) if (b != a) node_neighbors[a].insert(b);
+        }
+      }
+    }
+  };
+
+  MeshHandle make_mesh(const std::string& type, const std::vector<Point>& points,
+                       const std::vector<IndexList>& cells)
+  {
+    FieldInformation fi(type, 1, "double");
+    MeshHandle mesh = CreateMesh(fi);
+    VMesh* vmesh = mesh->vmesh();
+    for (const Point& p : points) vmesh->add_point(p);
+    VMesh::Node::array_type nodes;
+    for (const IndexList& cell : cells)
+    {
+      nodes.assign(cell.begin(), cell.end());
+      vmesh->add_elem(nodes);
+    }
+    return (mesh);
+  }
+
+  IndexList as_list(const VMesh::Elem::array_type& elems)
+  {
+    IndexList list(elems.begin(), elems.end());
+    return (distinct(list));
+  }
+
+  IndexList as_list(const VMesh::Node::array_type& nodes)
+  {
+    IndexList list(nodes.begin(), nodes.end());
+    return (distinct(list));
+  }
+
+  void check_topology(const CellType& type, MeshHandle mesh,
+                      const std::vector<IndexList>& cells)
+  {
+    VMesh* vmesh = mesh->vmesh();
+    vmesh->synchronize(Mesh::NODE_NEIGHBORS_E | Mesh::EDGES_E |
+                       Mesh::FACES_E | Mesh::ELEM_NEIGHBORS_E);
+
+    VMesh::Node::size_type num_nodes;
+    VMesh::Edge::size_type num_edges;
+    VMesh::Face::size_type num_faces;
+    vmesh->size(num_nodes);
+    vmesh->size(num_edges);
+    vmesh->size(num_faces);
+    const Adjacency expected(type, cells, num_nodes);
+
+    VMesh::Node::array_type nodes;
+    VMesh::Elem::array_type elems;
+
+    ASSERT_EQ(expected.face_cells.size(), static_cast<size_t>(num_faces));
+    std::set<IndexList> seen;
+    for (VMesh::Face::index_type f = 0; f < num_faces; ++f)
+    {
+      vmesh->get_nodes(nodes, f);
+      const IndexList key = as_list(nodes);
+      EXPECT_TRUE(seen.insert(key).second);
+      auto it = expected.face_cells.find(key);
+      ASSERT_NE(expected.face_cells.end(), it);
+      vmesh->get_elems(elems, f);
+      EXPECT_EQ(it->second, as_list(elems));
+    }
+
+    ASSERT_EQ(expected.edge_cells.size(), static_cast<size_t>(num_edges));
+    for (VMesh::Edge::index_type e = 0; e < num_edges; ++e)
+    {
+      vmesh->get_nodes(nodes, e);
+      auto it = expected.edge_cells.find(as_list(nodes));
+      ASSERT_NE(expected.edge_cells.end(), it);
+      vmesh->get_elems(elems, e);
+      EXPECT_EQ(distinct(it->second), as_list(elems));
+    }
+
+    for (VMesh::Node::index_type n = 0; n < num_nodes; ++n)
+    {
+      vmesh->get_neighbors(nodes, n);
+      EXPECT_EQ(IndexList(expected.node_neighbors[n].begin(), expected.node_neighbors[n].end()),
+                as_list(nodes)) << "node " << n;
+      vmesh->get_elems(elems, n);
+      EXPECT_EQ(IndexList(expected.node_cells[n].begin(), expected.node_cells[n].end()),
+                as_list(elems)) << "node " << n;
+    }
+
+    // Cells are neighbors when they share a face, the shared faces are not
+    // on the boundary.
+    size_type boundary_faces = 0;
+    for (const auto& face : expected.face_cells)
+      if (face.second.size() == 1) ++boundary_faces;
+    size_type faces_seen_once = 0;
+    for (VMesh::Elem::index_type c = 0; c < static_cast<VMesh::index_type>(cells.size()); ++c)
+    {
+      IndexList neighbors;
+      for (const auto& face : expected.face_cells)
+        if (std::find(face.second.begin(), face.second.end(), c) != face.second.end())
+        {
+          if (face.second.size() == 1) ++faces_seen_once;
+          for (VMesh::index_type other : face.second)
+            if (other != c) neighbors.push_back(other);
+        }
+      vmesh->get_neighbors(elems, c);
+      EXPECT_EQ(distinct(neighbors), as_list(elems)) << "cell " << c;
+    }
+    EXPECT_EQ(boundary_faces, faces_seen_once);
+  }
+
+  /// n^3 unit hexahedra. Two degenerate cells are stacked on the first two
+  /// top cells: one with a collapsed edge, whose top and side quads become
+  /// triangles, and one whose top quad has equal opposite corners and is
+  /// not a face.
+  void hex_grid(int n, std::vector<Point>& points, std::vector<IndexList>& cells)
+  {
+    auto node = [n](int i, int j, int k) { return i + (n+1) * (j + (n+1) * k); };
+    for (int k = 0; k <= n; k++)
+      for (int j = 0; j <= n; j++)
+        for (int i = 0; i <= n; i++)
+          points.push_back(Point(i, j, k));
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+          cells.push_back({ node(i, j, k), node(i+1, j, k), node(i+1, j+1, k), node(i, j+1, k),
+                            node(i, j, k+1), node(i+1, j, k+1), node(i+1, j+1, k+1), node(i, j+1, k+1) });
+
+    const VMesh::index_type top = static_cast<VMesh::index_type>(points.size());
+    for (int j = 0; j <= 1; j++)
+      for (int i = 0; i <= 2; i++)
+        points.push_back(Point(i, j, n+1));
+    auto up = [top](int i, int j) { return top + i + 3 * j; };
+    cells.push_back({ node(0, 0, n), node(1, 0, n), node(1, 1, n), node(0, 1, n),
+                      up(0, 0), up(1, 0), up(1, 0), up(0, 1) });
+    cells.push_back({ node(1, 0, n), node(2, 0, n), node(2, 1, n), node(1, 1, n),
+                      up(1, 0), up(2, 0), up(1, 0), up(1, 1) });
+  }
+
+  /// n^3 unit hexahedra split into two prisms each. A degenerate prism with
+  /// a collapsed vertical edge, whose two quads at that edge become
+  /// triangles, sits on the first top prism.
+  void prism_grid(int n, std::vector<Point>& points, std::vector<IndexList>& cells)
+  {
+    auto node = [n](int i, int j, int k) { return i + (n+1) * (j + (n+1) * k); };
+    for (int k = 0; k <= n; k++)
+      for (int j = 0; j <= n; j++)
+        for (int i = 0; i <= n; i++)
+          points.push_back(Point(i, j, k));
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          cells.push_back({ node(i, j, k), node(i+1, j, k), node(i+1, j+1, k),
+                            node(i, j, k+1), node(i+1, j, k+1), node(i+1, j+1, k+1) });
+          cells.push_back({ node(i, j, k), node(i+1, j+1, k), node(i, j+1, k),
+                            node(i, j, k+1), node(i+1, j+1, k+1), node(i, j+1, k+1) });
+        }
+
+    const VMesh::index_type top = static_cast<VMesh::index_type>(points.size());
+    points.push_back(Point(1, 0, n+1));
+    points.push_back(Point(1, 1, n+1));
+    cells.push_back({ node(0, 0, n), node(1, 0, n), node(1, 1, n),
+                      node(0, 0, n), top, top + 1 });
+  }
+}
+
+TEST(MeshTopologyBuilderTest, HexVolMeshTablesMatchCellAdjacency)
+{
+  std::vector<Point> points;
+  std::vector<IndexList> cells;
+  hex_grid(3, points, cells);
+  check_topology(hex_type, make_mesh("HexVolMesh", points, cells), cells);
+}
+
+TEST(MeshTopologyBuilderTest, PrismVolMeshTablesMatchCellAdjacency)
+{
+  std::vector<Point> points;
+  std::vector<IndexList> cells;
+  prism_grid(3, points, cells);
+  check_topology(prism_type, make_mesh("PrismVolMesh", points, cells), cells);
+}
@@ -0,0 +1,222 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Datatypes/Legacy/Field/SpatialIndex.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  const SpatialIndex::Type index_types[] =
+    { SpatialIndex::UNIFORM_GRID, SpatialIndex::OCTREE, SpatialIndex::BVH };
+
+  // Coordinate that is clustered towards 0, so the cells near the origin
+  // are orders of magnitude smaller than the ones at the far side.
+  double graded(int i, int n)
+  {
+    const double u = static_cast<double>(i)/n;
+    return (u*u*u);
+  }
+
+  // Unit cube of n^3 graded hexahedra, each split into six tetrahedra around
+  // its main diagonal.
+  MeshHandle make_tetvol(int n)
+  {
+    return CreateCubeBlock(mesh_info_type::TETVOLMESH_E, n, databasis_info_type::LINEARDATA_E,
+      [n](int i, int j, int k) { return Point(graded(i, n), graded(j, n), graded(k, n)); })->mesh();
+  }
+
+  std::vector<Point> query_points(size_t num, double lo, double hi)
+  {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(lo, hi);
+    std::vector<Point> points(num);
+    for (size_t q = 0; q < num; q++)
+    {
+      // Half of the points go to the finely resolved corner
+      const double s = (q % 2) ? 0.05 : 1.0;
+      points[q] = Point(s*coord(gen), s*coord(gen), s*coord(gen));
+    }
+    return (points);
+  }
+
+  double distance_to_unit_cube(const Point& p)
+  {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; k++)
+    {
+      const double d = std::max(std::max(-p[k], p[k] - 1.0), 0.0);
+      d2 += d*d;
+    }
+    return (sqrt(d2));
+  }
+}
+
+TEST(SpatialIndexTests, IndexTypesMatchBruteForce)
+{
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> coord(0.0, 1.0);
+  std::vector<BBox> boxes(2000);
+  BBox bounds;
+  for (size_t idx = 0; idx < boxes.size(); idx++)
+  {
+    const Point c(pow(coord(gen), 3.0), coord(gen), coord(gen));
+    const double r = 0.05*coord(gen)*c.x();
+    boxes[idx] = BBox(c - Vector(r, r, r), c + Vector(r, r, r));
+    bounds.extend(boxes[idx]);
+  }
+
+  const std::vector<Point> points = query_points(300, -0.2, 1.2);
+
+  for (SpatialIndex::Type type : index_types)
+  {
+    SCOPED_TRACE(SpatialIndex::type_name(type));
+    SpatialIndexHandle index = SpatialIndex::create(type, boxes.size(),
+      [&boxes](SpatialIndex::index_type i) { return (boxes[i]); }, bounds);
+    ASSERT_EQ(type, index->type());
+
+    for (const Point& p : points)
+    {
+      // Every box that contains the point is a candidate
+      std::vector<SpatialIndex::index_type> found;
+      index->visit(p, [&found](SpatialIndex::index_type i) { found.push_back(i); return (false); });
+      for (size_t idx = 0; idx < boxes.size(); idx++)
+      {
+        if (boxes[idx].inside(p))
+        {
+          EXPECT_NE(found.end(), std::find(found.begin(), found.end(), SpatialIndex::index_type(idx)));
+        }
+      }
+
+      // Closest box center
+      auto distance = [&boxes, &p](SpatialIndex::index_type i) { return ((boxes[i].center() - p).length2()); };
+      double best = DBL_MAX;
+      for (size_t idx = 0; idx < boxes.size(); idx++)
+        best = std::min(best, distance(SpatialIndex::index_type(idx)));
+
+      SpatialIndex::index_type item;
+      double dist2;
+      ASSERT_TRUE(index->find_closest(item, dist2, p, DBL_MAX, 0.0, distance));
+      EXPECT_DOUBLE_EQ(best, dist2);
+      EXPECT_DOUBLE_EQ(best, distance(item));
+
+      // A limited search finds nothing beyond its radius
+      EXPECT_FALSE(index->find_closest(item, dist2, p, 0.5*best, 0.0, distance));
+    }
+  }
+}
+
+TEST(SpatialIndexTests, TetVolMeshQueriesMatchBruteForce)
+{
+  MeshHandle mesh = make_tetvol(12);
+  VMesh* vmesh = mesh->vmesh();
+  const std::vector<Point> points = query_points(400, -0.3, 1.3);
+
+  for (SpatialIndex::Type type : index_types)
+  {
+    SCOPED_TRACE(SpatialIndex::type_name(type));
+    ASSERT_TRUE(vmesh->set_spatial_index_type(type));
+    EXPECT_EQ(type, vmesh->get_spatial_index_type());
+    vmesh->synchronize(Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E|Mesh::FIND_CLOSEST_ELEM_E);
+
+    for (const Point& p : points)
+    {
+      const bool inside = distance_to_unit_cube(p) == 0.0;
+
+      VMesh::Elem::index_type elem = -1;
+      VMesh::coords_type coords;
+      ASSERT_EQ(inside, vmesh->locate(elem, coords, p));
+      if (inside)
+      {
+        ASSERT_EQ(3u, coords.size());
+        EXPECT_GE(std::min(std::min(coords[0], coords[1]), coords[2]), -1e-8);
+        EXPECT_LE(coords[0] + coords[1] + coords[2], 1.0 + 1e-8);
+      }
+
+      double dist;
+      Point result;
+      ASSERT_TRUE(vmesh->find_closest_elem(dist, result, coords, elem, p));
+      EXPECT_NEAR(distance_to_unit_cube(p), dist, 1e-10);
+
+      double best = DBL_MAX;
+      VMesh::Node::size_type num_nodes = vmesh->num_nodes();
+      for (VMesh::Node::index_type idx = 0; idx < num_nodes; idx++)
+      {
+        Point c;
+        vmesh->get_center(c, idx);
+        best = std::min(best, (c - p).length());
+      }
+
+      VMesh::Node::index_type node = -1;
+      ASSERT_TRUE(vmesh->find_closest_node(dist, result, node, p));
+      EXPECT_DOUBLE_EQ(best, dist);
+      EXPECT_DOUBLE_EQ(best, (result - p).length());
+
+      std::vector<VMesh::Node::index_type> nodes;
+      vmesh->find_closest_nodes(nodes, p, 2.0*best + 0.01);
+      std::sort(nodes.begin(), nodes.end());
+      EXPECT_TRUE(std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end());
+      EXPECT_TRUE(std::binary_search(nodes.begin(), nodes.end(), node));
+    }
+  }
+}
+
+TEST(SpatialIndexTests, IndicesFollowMeshTransform)
+{
+  MeshHandle mesh = make_tetvol(6);
+
+  Transform t;
+  t.pre_rotate(0.7, Vector(1.0, 2.0, 0.5));
+  t.pre_translate(Vector(3.0, -1.0, 2.0));
+
+  for (SpatialIndex::Type type : index_types)
+  {
+    SCOPED_TRACE(SpatialIndex::type_name(type));
+    MeshHandle copy(mesh->clone());
+    VMesh* cmesh = copy->vmesh();
+    cmesh->set_spatial_index_type(type);
+    cmesh->synchronize(Mesh::ELEM_LOCATE_E);
+    cmesh->transform(t);
+
+    for (const Point& p : query_points(100, 0.01, 0.99))
+    {
+      VMesh::Elem::index_type elem;
+      EXPECT_TRUE(cmesh->locate(elem, t.project(p)));
+    }
+  }
+}
@@ -34,6 +34,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 
 #include <gtest/gtest.h>
+#include <algorithm>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -68,3 +69,62 @@ TEST(TetVolMeshTest, CheckMeshIteratorTetVolMesh)
   ASSERT_EQ(c, 6);
 
 }
+
+TEST(TetVolMeshTest, TopologyTablesAreConsistent)
+{
+  const int n = 7;
+  // Unit cube of n^3 hexahedra, each split into six tetrahedra
+  MeshHandle mesh = CreateCubeBlock(mesh_info_type::TETVOLMESH_E, n)->mesh();
+  VMesh* vmesh = mesh->vmesh();
+  vmesh->synchronize(Mesh::NODE_NEIGHBORS_E | Mesh::EDGES_E | Mesh::FACES_E);
+
+  VMesh::Node::size_type num_nodes;
+  VMesh::Edge::size_type num_edges;
+  VMesh::Face::size_type num_faces;
+  VMesh::Elem::size_type num_elems;
+  vmesh->size(num_nodes);
+  vmesh->size(num_edges);
+  vmesh->size(num_faces);
+  vmesh->size(num_elems);
+
+  // A triangulated ball: V - E + F - C = 1
+  EXPECT_EQ(1, num_nodes - num_edges + num_faces - num_elems);
+
+  VMesh::Node::array_type nodes, edge_nodes;
+  VMesh::Face::array_type faces;
+  VMesh::Elem::array_type elems;
+
+  for (VMesh::Elem::index_type c = 0; c < num_elems; ++c)
+  {
+    vmesh->get_faces(faces, c);
+    ASSERT_EQ(4, faces.size());
+    for (size_t f = 0; f < faces.size(); ++f)
+    {
+      vmesh->get_elems(elems, faces[f]);
+      EXPECT_NE(elems.end(), std::find(elems.begin(), elems.end(), c));
+    }
+
+    vmesh->get_nodes(nodes, c);
+    for (size_t k = 0; k < nodes.size(); ++k)
+    {
+      vmesh->get_elems(elems, nodes[k]);
+      EXPECT_NE(elems.end(), std::find(elems.begin(), elems.end(), c));
+    }
+  }
+
+  for (VMesh::Edge::index_type e = 0; e < num_edges; ++e)
+  {
+    vmesh->get_nodes(edge_nodes, e);
+    ASSERT_EQ(2, edge_nodes.size());
+    EXPECT_NE(edge_nodes[0], edge_nodes[1]);
+  }
+
+  size_type boundary_faces = 0;
+  for (VMesh::Face::index_type f = 0; f < num_faces; ++f)
+  {
+    vmesh->get_elems(elems, f);
+    if (elems.size() == 1) ++boundary_faces;
+  }
+  EXPECT_EQ(12*n*n, boundary_faces);
+  EXPECT_EQ(4*num_elems, 2*num_faces - boundary_faces);
+}
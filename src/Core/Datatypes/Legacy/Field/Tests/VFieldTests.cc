@@ -31,7 +31,9 @@
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/GeometryPrimitives/Point.h>
+#include <Core/Persistent/Pstreams.h>
 #include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Testing/Utils/SCIRunUnitTests.h>
 
 #include <vector>
 
@@ -190,3 +192,43 @@ TEST(VFieldTest, TetVolMeshSetFieldValueTest2)
   }
 
 }
+
+TEST(VFieldTest, ChunkedStreamReadsValueSubset)
+{
+  FieldHandle field = CreateEmptyLatVol(40, 30, 20);
+  VField *vfield = field->vfield();
+  std::vector<double> values(vfield->num_values());
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = 0.25 * i;
+  vfield->set_values(values);
+
+  auto file = TestResources::rootDir() / "TransientOutput" / "chunkedLatVol.fld";
+  {
+    ChunkedBinaryPiostream stream(file.string(), Piostream::Direction::Write, 8192);
+    Pio(stream, field);
+    EXPECT_TRUE(stream.finish());
+  }
+
+  {
+    ChunkedBinaryPiostream stream(file.string(), Piostream::Direction::Read);
+    ASSERT_FALSE(stream.error());
+    auto block = stream.find_field_data();
+    ASSERT_TRUE(block != nullptr);
+    ASSERT_EQ(values.size(), block->count);
+    ASSERT_EQ(sizeof(double), block->element_size);
+    std::vector<double> subset(3000);
+    ASSERT_TRUE(stream.read_block(*block, 10000, subset.size(), subset.data()));
+    for (size_t i = 0; i < subset.size(); ++i)
+      EXPECT_EQ(values[10000 + i], subset[i]);
+    EXPECT_LT(stream.num_inflated_chunks(), stream.num_chunks() / 2);
+  }
+
+  auto stream = auto_istream(file.string());
+  ASSERT_TRUE(stream != nullptr);
+  FieldHandle roundTrip;
+  Pio(*stream, roundTrip);
+  ASSERT_TRUE(roundTrip != nullptr);
+  std::vector<double> readValues;
+  roundTrip->vfield()->get_values(readValues);
+  EXPECT_EQ(values, readValues);
+}
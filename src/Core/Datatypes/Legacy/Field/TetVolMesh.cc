@@ -148,6 +148,17 @@ public:
   VMesh::index_type* get_elems_pointer() const override;
 
   double inscribed_circumscribed_radius_metric(VMesh::Elem::index_type idx) const override;
+
+  bool set_spatial_index_type(SpatialIndex::Type type) override
+  {
+    this->mesh_->set_spatial_index_type(type);
+    return (true);
+  }
+
+  SpatialIndex::Type get_spatial_index_type() const override
+  {
+    return (this->mesh_->get_spatial_index_type());
+  }
 };
 
 /// Functions for creating the virtual interface for specific mesh types
@@ -36,7 +36,6 @@
 #include <Core/Containers/StackVector.h>
 #include <Core/Persistent/PersistentSTL.h>
 
-#include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/GeometryPrimitives/BBox.h>
 #include <Core/GeometryPrimitives/CompGeom.h>
 #include <Core/GeometryPrimitives/Point.h>
@@ -51,6 +50,8 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/MeshTopologyBuilder.h>
+#include <Core/Datatypes/Legacy/Field/SpatialIndex.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 #include <Core/Math/MiscMath.h>
@@ -61,6 +62,7 @@
 #include <Core/Thread/Mutex.h>
 #include <Core/Thread/ConditionVariable.h>
 
+#include <algorithm>
 #include <set>
 
 #include <Core/Datatypes/Legacy/Field/share.h>
@@ -328,8 +330,8 @@ public:
             while(!(mesh_->synchronized_ & Mesh::BOUNDING_BOX_E))
               mesh_->synchronize_cond_.wait(lock);
           }
-          if (sync_ & Mesh::NODE_LOCATE_E) mesh_->compute_node_grid();
-          if (sync_ & Mesh::ELEM_LOCATE_E) mesh_->compute_elem_grid();
+          if (sync_ & Mesh::NODE_LOCATE_E) mesh_->compute_node_index();
+          if (sync_ & Mesh::ELEM_LOCATE_E) mesh_->compute_elem_index();
         }
 
         mesh_->synchronize_lock_.lock();
@@ -410,6 +412,12 @@ public:
   bool unsynchronize(mask_type mask) override;
   bool clear_synchronization();
 
+  /// Select the spatial index used by the locate and find_closest
+  /// functions. Changing it drops the current indices, they are built again
+  /// by the next synchronize(NODE_LOCATE_E|ELEM_LOCATE_E).
+  void set_spatial_index_type(SpatialIndex::Type type);
+  SpatialIndex::Type get_spatial_index_type() const { return (spatial_index_type_); }
+
   /// Get the basis class.
   Basis& get_basis() { return basis_; }
 
@@ -916,83 +924,14 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
 	      "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).");
 
-    // get grid sizes
-    const size_type ni = node_grid_->get_ni()-1;
-    const size_type nj = node_grid_->get_nj()-1;
-    const size_type nk = node_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, bj, bk, ei, ej, ek;
-    node_grid_->unsafe_locate(bi, bj, bk, p);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) bi = ni;
-    if (bi < 0) bi = 0;
-    if (bj > nj) bj = nj;
-    if (bj < 0) bj = 0;
-    if (bk > nk) bk = nk;
-    if (bk < 0) bk = 0;
-
-    ei = bi; ej = bj; ek = bk;
-
-    double dmin = maxdist;
-    bool found = true;
-    bool found_one = false;
-    do
-    {
-      found = true;
-      /// We need to do a full shell without any elements that are closer
-      /// to make sure there no closer elements in neighboring searchgrid cells
-
-      for (index_type i = bi; i <= ei; i++)
-      {
-        if (i < 0 || i > ni) continue;
-        for (index_type j = bj; j <= ej; j++)
-        {
-        if (j < 0 || j > nj) continue;
-          for (index_type k = bk; k <= ek; k++)
-          {
-            if (k < 0 || k > nk) continue;
-            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
-            {
-              if (node_grid_->min_distance_squared(p, i, j, k) < dmin)
-              {
-                typename SearchGridT<index_type>::iterator it, eit;
-                found = false;
-                node_grid_->lookup_ijk(it,eit, i, j, k);
-
-                while (it != eit)
-                {
-                  const Core::Geometry::Point point = points_[*it];
-                  const double dist = (p-point).length2();
-
-                  if (dist < dmin)
-                  {
-                    found_one = true;
-                    result = point;
-                    node = INDEX(*it);
-                    dmin = dist;
-                    /// If we are closer than eps^2 we found a node close enough
-                    if (dmin < epsilon2_)
-                    {
-                      pdist = sqrt(dmin);
-                      return (true);
-                    }
-                  }
-                  ++it;
-                }
-              }
-            }
-          }
-        }
-      }
-      bi--;ei++;
-      bj--;ej++;
-      bk--;ek++;
-    }
-    while (!found) ;
+    index_type idx;
+    double dmin;
+    if (!node_index_->find_closest(idx, dmin, p, maxdist, epsilon2_,
+          [this, &p](index_type i) { return ((p - points_[i]).length2()); }))
+      return (false);
 
-    if (!found_one) return (false);
+    node = INDEX(idx);
+    result = points_[idx];
     pdist = sqrt(dmin);
     return (true);
   }
@@ -1005,63 +944,14 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
-    // get grid sizes
-    const size_type ni = node_grid_->get_ni()-1;
-    const size_type nj = node_grid_->get_nj()-1;
-    const size_type nk = node_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, bj, bk, ei, ej, ek;
-
-    Core::Geometry::Point max = p+Core::Geometry::Vector(maxdist,maxdist,maxdist);
-    Core::Geometry::Point min = p+Core::Geometry::Vector(-maxdist,-maxdist,-maxdist);
+    const Core::Geometry::Vector range(maxdist, maxdist, maxdist);
+    const double maxdist2 = maxdist*maxdist;
 
-    node_grid_->unsafe_locate(bi, bj, bk, min);
-    node_grid_->unsafe_locate(ei, ej, ek, max);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) bi = ni;
-    if (bi < 0) bi = 0;
-    if (bj > nj) bj = nj;
-    if (bj < 0) bj = 0;
-    if (bk > nk) bk = nk;
-    if (bk < 0) bk = 0;
-
-    if (ei > ni) ei = ni;
-    if (ei < 0) ei = 0;
-    if (ej > nj) ej = nj;
-    if (ej < 0) ej = 0;
-    if (ek > nk) ek = nk;
-    if (ek < 0) ek = 0;
-
-    double maxdist2 = maxdist*maxdist;
-
-    for (index_type i = bi; i <= ei; i++)
+    node_index_->visit(Core::Geometry::BBox(p - range, p + range), [&](index_type i)
     {
-      for (index_type j = bj; j <= ej; j++)
-      {
-        for (index_type k = bk; k <= ek; k++)
-        {
-          if (node_grid_->min_distance_squared(p, i, j, k) < maxdist2)
-          {
-            typename SearchGridT<index_type>::iterator  it, eit;
-            node_grid_->lookup_ijk(it, eit, i, j, k);
-
-            while (it != eit)
-            {
-              const Core::Geometry::Point point = points_[*it];
-              const double dist  = (p-point).length2();
-
-              if (dist < maxdist2)
-              {
-                nodes.push_back(*it);
-              }
-              ++it;
-            }
-          }
-        }
-      }
-    }
+      if ((p - points_[i]).length2() < maxdist2) nodes.push_back(i);
+      return (false);
+    });
 
     return(nodes.size() > 0);
   }
@@ -1077,64 +967,19 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
-    // get grid sizes
-    const size_type ni = node_grid_->get_ni()-1;
-    const size_type nj = node_grid_->get_nj()-1;
-    const size_type nk = node_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, bj, bk, ei, ej, ek;
+    const Core::Geometry::Vector range(maxdist, maxdist, maxdist);
+    const double maxdist2 = maxdist*maxdist;
 
-    Core::Geometry::Point max = p+Core::Geometry::Vector(maxdist,maxdist,maxdist);
-    Core::Geometry::Point min = p+Core::Geometry::Vector(-maxdist,-maxdist,-maxdist);
-
-    node_grid_->unsafe_locate(bi, bj, bk, min);
-    node_grid_->unsafe_locate(ei, ej, ek, max);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) bi = ni;
-    if (bi < 0) bi = 0;
-    if (bj > nj) bj = nj;
-    if (bj < 0) bj = 0;
-    if (bk > nk) bk = nk;
-    if (bk < 0) bk = 0;
-
-    if (ei > ni) ei = ni;
-    if (ei < 0) ei = 0;
-    if (ej > nj) ej = nj;
-    if (ej < 0) ej = 0;
-    if (ek > nk) ek = nk;
-    if (ek < 0) ek = 0;
-
-    double maxdist2 = maxdist*maxdist;
-
-    for (index_type i = bi; i <= ei; i++)
+    node_index_->visit(Core::Geometry::BBox(p - range, p + range), [&](index_type i)
     {
-      for (index_type j = bj; j <= ej; j++)
+      const double dist = (p - points_[i]).length2();
+      if (dist < maxdist2)
       {
-        for (index_type k = bk; k <= ek; k++)
-        {
-          if (node_grid_->min_distance_squared(p, i, j, k) < maxdist2)
-          {
-            typename SearchGridT<index_type>::iterator  it, eit;
-            node_grid_->lookup_ijk(it, eit, i, j, k);
-
-            while (it != eit)
-            {
-              const Core::Geometry::Point point = points_[*it];
-              const double dist  = (p-point).length2();
-
-              if (dist < maxdist2)
-              {
-                nodes.push_back(*it);
-                distances.push_back(dist);
-              }
-              ++it;
-            }
-          }
-        }
+        nodes.push_back(i);
+        distances.push_back(dist);
       }
-    }
+      return (false);
+    });
 
     return(nodes.size() > 0);
   }
@@ -1187,185 +1032,27 @@ public:
               "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
     // First check are we inside an element
-    SearchGridT<index_type>::iterator it, eit;
-    if (elem_grid_->lookup(it, eit, p))
+    index_type cidx = -1;
+    if (elem_index_->visit(p, [this, &p, &cidx](index_type i)
+        { cidx = i; return (inside(typename Elem::index_type(i), p)); }))
     {
-      while (it != eit)
-      {
-        if (inside(typename Elem::index_type(*it), p))
-        {
-          pdist = 0.0;
-          result = p;
-          elem = static_cast<INDEX>(*it);
-          ElemData ed(*this, elem);
-          basis_.get_coords(coords, p, ed);
-          return (true);
-        }
-        ++it;
-      }
+      pdist = 0.0;
+      result = p;
+      elem = static_cast<INDEX>(cidx);
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, p, ed);
+      return (true);
     }
 
     // If not start searching for the closest outer boundary
-    // get grid sizes
-    const size_type ni = elem_grid_->get_ni()-1;
-    const size_type nj = elem_grid_->get_nj()-1;
-    const size_type nk = elem_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, ei, bj, ej, bk, ek;
-    elem_grid_->unsafe_locate(bi, bj, bk, p);
-
-    // Clamp to closest point on the grid.
-    if (bi > ni) bi = ni;
-    if (bi < 0) bi = 0;
-    if (bj > nj) bj = nj;
-    if (bj < 0) bj = 0;
-    if (bk > nk) bk = nk;
-    if (bk < 0) bk = 0;
-
-    ei = bi; ej = bj; ek = bk;
-
-    double dmin = maxdist;
-    bool found = true;
-    bool found_one = false;
-
-    do
-    {
-      found = true;
-      /// We need to do a full shell without any elements that are closer
-      /// to make sure there no closer elements in neighboring searchgrid cells
-      for (index_type i = bi; i <= ei; i++)
-      {
-        if (i < 0 || i > ni) continue;
-        for (index_type j = bj; j <= ej; j++)
-        {
-        if (j < 0 || j > nj) continue;
-          for (index_type k = bk; k <= ek; k++)
-          {
-            if (k < 0 || k > nk) continue;
-            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
-            {
-              if (elem_grid_->min_distance_squared(p, i, j, k) < dmin)
-              {
-                found = false;
-                typename SearchGridT<index_type>::iterator it, eit;
-                elem_grid_->lookup_ijk(it,eit, i, j, k);
-
-                while (it != eit)
-                {
-                  Core::Geometry::Point r;
-                  index_type cidx = (*it);
-                  index_type idx = cidx*4;
-                  unsigned char b = boundary_faces_[cidx];
-                  if (b)
-                  {
-                    if (b & 0x1)
-                    {
-                      closest_point_on_tri(r, p,
-                                           points_[cells_[idx  ]],
-                                           points_[cells_[idx+2]],
-                                           points_[cells_[idx+1]]);
-                      const double dtmp = (p - r).length2();
-                      if (dtmp < dmin)
-                      {
-                        found_one = true;
-                        result = r;
-                        elem = INDEX(cidx);
-                        dmin = dtmp;
-
-                        if (dmin < epsilon2_)
-                        {
-                          pdist = sqrt(dmin);
-                          ElemData ed(*this,elem);
-                          basis_.get_coords(coords,result,ed);
-                          return (true);
-                        }
-                      }
-                    }
-                    if (b & 0x2)
-                    {
-                      closest_point_on_tri(r, p,
-                                           points_[cells_[idx+1]],
-                                           points_[cells_[idx+2]],
-                                           points_[cells_[idx+3]]);
-                      const double dtmp = (p - r).length2();
-                      if (dtmp < dmin)
-                      {
-                        found_one = true;
-                        result = r;
-                        elem = INDEX(cidx);
-                        dmin = dtmp;
-
-                        if (dmin < epsilon2_)
-                        {
-                          pdist = sqrt(dmin);
-                          ElemData ed(*this,elem);
-                          basis_.get_coords(coords,result,ed);
-                          return (true);
-                        }
-                      }
-                    }
-                    if (b & 0x4)
-                    {
-                      closest_point_on_tri(r, p,
-                                           points_[cells_[idx]],
-                                           points_[cells_[idx+1]],
-                                           points_[cells_[idx+3]]);
-                      const double dtmp = (p - r).length2();
-                      if (dtmp < dmin)
-                      {
-                        found_one = true;
-                        result = r;
-                        elem = INDEX(cidx);
-                        dmin = dtmp;
-
-                        if (dmin < epsilon2_)
-                        {
-                          pdist = sqrt(dmin);
-                          ElemData ed(*this,elem);
-                          basis_.get_coords(coords,result,ed);
-                          return (true);
-                        }
-                      }
-                    }
-                    if (b & 0x8)
-                    {
-                      closest_point_on_tri(r, p,
-                                           points_[cells_[idx]],
-                                           points_[cells_[idx+3]],
-                                           points_[cells_[idx+2]]);
-                      const double dtmp = (p - r).length2();
-                      if (dtmp < dmin)
-                      {
-                        found_one = true;
-                        result = r;
-                        elem = INDEX(cidx);
-                        dmin = dtmp;
-
-                        if (dmin < epsilon2_)
-                        {
-                          pdist = sqrt(dmin);
-                          ElemData ed(*this,elem);
-                          basis_.get_coords(coords,result,ed);
-                          return (true);
-                        }
-                      }
-                    }
-                  }
-                  ++it;
-                }
-              }
-            }
-          }
-        }
-      }
-      bi--;ei++;
-      bj--;ej++;
-      bk--;ek++;
-    }
-    while (!found) ;
+    double dmin;
+    if (!elem_index_->find_closest(cidx, dmin, p, maxdist, epsilon2_,
+          [this, &p](index_type i)
+          { Core::Geometry::Point r; return (closest_boundary_point(r, i, p)); }))
+      return (false);
 
-    if (!found_one) return (false);
+    closest_boundary_point(result, cidx, p);
+    elem = INDEX(cidx);
 
     ElemData ed(*this,elem);
     basis_.get_coords(coords,result,ed);
@@ -1965,74 +1652,13 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
               "TetVolMesh::locate_node requires synchronize(NODE_LOCATE_E).")
 
-    // get grid sizes
-    const size_type ni = node_grid_->get_ni()-1;
-    const size_type nj = node_grid_->get_nj()-1;
-    const size_type nk = node_grid_->get_nk()-1;
-
-    // Convert to grid coordinates.
-    index_type bi, bj, bk, ei, ej, ek;
-    node_grid_->unsafe_locate(bi, bj, bk, p);
-
-    // Clamp to l;..;,closest point on the grid.
-    if (bi > ni) bi =ni; if (bi < 0) bi = 0;
-    if (bj > nj) bj =nj; if (bj < 0) bj = 0;
-    if (bk > nk) bk =nk; if (bk < 0) bk = 0;
-
-    ei = bi;
-    ej = bj;
-    ek = bk;
-
-    double dmin = DBL_MAX;
-    bool found;
-    do
-    {
-      found = true;
-      /// We need to do a full shell without any elements that are closer
-      /// to make sure there no closer elements in neighboring searchgrid cells
-
-      for (index_type i = bi; i <= ei; i++)
-      {
-        if (i < 0 || i > ni) continue;
-        for (index_type j = bj; j <= ej; j++)
-        {
-          if (j < 0 || j > nj) continue;
-          for (index_type k = bk; k <= ek; k++)
-          {
-            if (k < 0 || k > nk) continue;
-            if (i == bi || i == ei || j == bj || j == ej || k == bk || k == ek)
-            {
-              if (node_grid_->min_distance_squared(p, i, j, k) < dmin)
-              {
-                found = false;
-                SearchGridT<index_type>::iterator it, eit;
-                node_grid_->lookup_ijk(it, eit, i, j, k);
-
-                while (it != eit)
-                {
-                  const Core::Geometry::Point point = points_[*it];
-                  const double dist = (p-point).length2();
-
-                  if (dist < dmin)
-                  {
-                    node = INDEX(*it);
-                    dmin = dist;
-
-                    if (dist < epsilon2_) return (true);
-                  }
-                  ++it;
-                }
-              }
-            }
-          }
-        }
-      }
-      bi--;ei++;
-      bj--;ej++;
-      bk--;ek++;
-    }
-    while ((!found)||(dmin == DBL_MAX)) ;
+    index_type idx;
+    double dmin;
+    if (!node_index_->find_closest(idx, dmin, p, DBL_MAX, epsilon2_,
+          [this, &p](index_type i) { return ((p - points_[i]).length2()); }))
+      return (false);
 
+    node = INDEX(idx);
     return (true);
   }
 
@@ -2114,18 +1740,12 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
-    typename SearchGridT<index_type>::iterator it, eit;
-    if (elem_grid_->lookup(it, eit, p))
+    index_type cidx = -1;
+    if (elem_index_->visit(p, [this, &p, &cidx](index_type i)
+        { cidx = i; return (inside(typename Elem::index_type(i), p)); }))
     {
-      while (it != eit)
-      {
-        if (inside(typename Elem::index_type(*it), p))
-        {
-          elem = static_cast<INDEX>(*it);
-          return (true);
-        }
-        ++it;
-      }
+      elem = static_cast<INDEX>(cidx);
+      return (true);
     }
     return (false);
   }
@@ -2139,24 +1759,12 @@ protected:
               "TetVolMesh::locate_elems requires synchronize(ELEM_LOCATE_E).")
 
     array.clear();
-    index_type is,js,ks;
-    index_type ie,je,ke;
-    elem_grid_->locate_clamp(is,js,ks,b.get_min());
-    elem_grid_->locate_clamp(ie,je,ke,b.get_max());
-    for (index_type i=is; i<=ie;i++)
-      for (index_type j=js; j<je;j++)
-        for (index_type k=ks; k<ke; k++)
-        {
-          typename SearchGridT<index_type>::iterator it, eit;
-          elem_grid_->lookup_ijk(it, eit, i, j, k);
-          while (it != eit)
-          {
-            size_t p=0;
-            for (;p<array.size();p++) if (array[p] == typename ARRAY::value_type(*it)) break;
-            if (p == array.size()) array.push_back(typename ARRAY::value_type(*it));
-            ++it;
-          }
-        }
+    elem_index_->visit(b, [&array](index_type i)
+    {
+      const typename ARRAY::value_type elem(i);
+      if (std::find(array.begin(), array.end(), elem) == array.end()) array.push_back(elem);
+      return (false);
+    });
 
     return (array.size() > 0);
   }
@@ -2187,20 +1795,14 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
-    typename SearchGridT<index_type>::iterator it, eit;
-    if (elem_grid_->lookup(it, eit, p))
+    index_type cidx = -1;
+    if (elem_index_->visit(p, [this, &p, &cidx](index_type i)
+        { cidx = i; return (inside(typename Elem::index_type(i), p)); }))
     {
-      while (it != eit)
-      {
-        if (inside(typename Elem::index_type(*it), p))
-        {
-          elem = static_cast<INDEX>(*it);
-          ElemData ed(*this, elem);
-          basis_.get_coords(coords, p, ed);
-          return (true);
-        }
-        ++it;
-      }
+      elem = static_cast<INDEX>(cidx);
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, p, ed);
+      return (true);
     }
 
     return (false);
@@ -2259,14 +1861,43 @@ protected:
   void compute_node_neighbors();
   void compute_edges();
   void compute_faces();
-  void compute_node_grid();
-  void compute_elem_grid();
+  void compute_node_index();
+  void compute_elem_index();
   void compute_bounding_box();
 
-  void insert_elem_into_grid(typename Elem::index_type ci);
-  void remove_elem_from_grid(typename Elem::index_type ci);
-  void insert_node_into_grid(typename Node::index_type ci);
-  void remove_node_from_grid(typename Node::index_type ci);
+  SpatialIndexHandle create_node_index() const;
+  SpatialIndexHandle create_elem_index() const;
+  Core::Geometry::BBox elem_index_box(index_type ci) const;
+  void insert_elem_into_index(typename Elem::index_type ci);
+  void remove_elem_from_index(typename Elem::index_type ci);
+
+  /// Squared distance to the closest point on the boundary faces of a cell,
+  /// DBL_MAX if none of its faces is on the boundary.
+  double closest_boundary_point(Core::Geometry::Point& result, index_type ci,
+                                const Core::Geometry::Point& p) const
+  {
+    static const int face_nodes[4][3] = { {0,2,1}, {1,2,3}, {0,1,3}, {0,3,2} };
+
+    const index_type idx = ci*4;
+    const unsigned char b = boundary_faces_[ci];
+    double dmin = DBL_MAX;
+    for (int f = 0; f < 4; f++)
+    {
+      if (!(b & (1 << f))) continue;
+      Core::Geometry::Point r;
+      closest_point_on_tri(r, p,
+                           points_[cells_[idx+face_nodes[f][0]]],
+                           points_[cells_[idx+face_nodes[f][1]]],
+                           points_[cells_[idx+face_nodes[f][2]]]);
+      const double dtmp = (p - r).length2();
+      if (dtmp < dmin)
+      {
+        result = r;
+        dmin = dtmp;
+      }
+    }
+    return (dmin);
+  }
 
   const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
 
@@ -2548,9 +2179,7 @@ protected:
     }
   };
 
-  using face_ht = std::unordered_map<PFace, typename Face::index_type, FaceHash>;
   using face_nt = std::unordered_map<PFaceNode, typename Face::index_type, FaceHash>;
-  using edge_ht = std::unordered_map<PEdge, typename Edge::index_type, EdgeHash>;
   using edge_nt = std::unordered_map<PEdgeNode, typename Edge::index_type, EdgeHash>;
 
   typedef std::vector<PFaceCell> face_ct;
@@ -2572,11 +2201,6 @@ protected:
 			  typename Cell::index_type ci,
 			  bool table_only = false);
 
-  inline void hash_edge(typename Node::index_type n1,
-                        typename Node::index_type n2,
-                        index_type combined_index,
-                        edge_ht& table);
-
   inline void add_edge(typename Node::index_type n1,
                         typename Node::index_type n2,
                         index_type combined_index);
@@ -2586,10 +2210,6 @@ protected:
                           typename Node::index_type n3,
                           typename Cell::index_type ci,
                           bool table_only = false);
-  inline void hash_face(typename Node::index_type n1,
-                        typename Node::index_type n2,
-                        typename Node::index_type n3,
-                        index_type ci, face_ht& table);
   inline void add_face(typename Node::index_type n1,
                        typename Node::index_type n2,
                        typename Node::index_type n3,
@@ -2598,13 +2218,14 @@ protected:
   std::vector<std::vector<typename Cell::index_type> > node_neighbors_;
   std::vector<unsigned char> boundary_faces_;
 
-  /// This grid is used as an acceleration structure to expedite calls
-  ///  to locate.  For each cell in the grid, we store a list of which
-  ///  tets overlap that grid cell -- to find the tet which contains a
-  ///  point, we simply find which grid cell contains that point, and
-  ///  then search just those tets that overlap that grid cell.
-  SharedPointer<SearchGridT<index_type> >  node_grid_;
-  SharedPointer<SearchGridT<index_type> >  elem_grid_;
+  /// These indices are used as acceleration structures to expedite calls
+  ///  to locate.  The element index stores the bounding box of every tet,
+  ///  to find the tet which contains a point, we only test the tets of
+  ///  which the box contains that point.
+  SpatialIndexHandle            node_index_;
+  SpatialIndexHandle            elem_index_;
+  /// Kind of index built by synchronize(NODE_LOCATE_E|ELEM_LOCATE_E)
+  SpatialIndex::Type            spatial_index_type_;
 
   // Lock and Condition Variable for hand shaking
   mutable Core::Thread::Mutex                 synchronize_lock_;
@@ -2662,6 +2283,7 @@ TetVolMesh<Basis>::TetVolMesh() :
   face_table_(),
   edges_(0),
   edge_table_(),
+  spatial_index_type_(SpatialIndex::UNIFORM_GRID),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2684,6 +2306,7 @@ TetVolMesh<Basis>::TetVolMesh(const TetVolMesh &copy) :
   face_table_(),
   edges_(0),
   edge_table_(),
+  spatial_index_type_(SpatialIndex::UNIFORM_GRID),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2701,6 +2324,7 @@ TetVolMesh<Basis>::TetVolMesh(const TetVolMesh &copy) :
 
   points_ = copy.points_;
   cells_ = copy.cells_;
+  spatial_index_type_ = copy.spatial_index_type_;
 
   // Epsilon does not require much space, hence copy those
   synchronized_ |= copy.synchronized_ & Mesh::BOUNDING_BOX_E;
@@ -2897,8 +2521,9 @@ TetVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
     synchronized_ |= BOUNDING_BOX_E;
   }
 
-  if (node_grid_) { node_grid_->transform(t); }
-  if (elem_grid_) { elem_grid_->transform(t); }
+  // An index that cannot follow the transform is rebuilt
+  if (node_index_ && !node_index_->transform(t)) node_index_ = create_node_index();
+  if (elem_index_ && !elem_index_->transform(t)) elem_index_ = create_elem_index();
 
   synchronize_lock_.unlock();
 }
@@ -2947,103 +2572,43 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             index_type combined_index,
-                             face_ht& table)
-{
-  PFace f(n1, n2, n3);
-
-  typename face_ht::iterator iter = table.find(f);
-  if (iter == table.end())
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << ", #" << (f.cells_[1]>>2) << ", and #"
-           << (combined_index>>2) << " are illegally adjacent." << std::endl;
-           */
-    }
-    else if ((f.cells_[0]>>2) == (combined_index>>2))
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << " and #" << (combined_index>>2)
-           << " are the same." << std::endl;*/
-    }
-    else
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
-
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_faces()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(4);
+  // 4 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[4][3] = { {0, 2, 1}, {1, 2, 3}, {0, 1, 3}, {0, 3, 2} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 2);
 
-  face_ht table;
-
-  while (ci != cie)
+  // Occurrence i is face i&3 of cell i>>2, which is also its combined index.
+  MeshTopologyBuilder<3> builder;
+  builder.build(num_cells << 2, [this](index_type i,
+                                       MeshTopologyBuilder<3>::key_type& key)
   {
-    get_nodes(arr, *ci);
-    // 4 faces -- each is entered CCW from outside looking in
-
-    index_type cell_index = (*ci)<<2;
-    hash_face(arr[0], arr[2], arr[1], cell_index, table);
-    hash_face(arr[1], arr[2], arr[3], cell_index + 1, table);
-    hash_face(arr[0], arr[1], arr[3], cell_index + 2, table);
-    hash_face(arr[0], arr[3], arr[2], cell_index + 3, table);
-    ++ci;
-  }
-
-  faces_.resize(table.size());
-
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
+    const under_type* nodes = &cells_[i & ~index_type(3)];
+    const int* local = face_nodes[i & 3];
+    PFaceNode f(nodes[local[0]], nodes[local[1]], nodes[local[2]]);
+    key[0] = f.nodes_[0]; key[1] = f.nodes_[1]; key[2] = f.nodes_[2];
+    return true;
+  });
 
-  boundary_faces_.resize(cells_.size() >> 2);
+  const size_type num_faces = builder.num_unique();
+  faces_.clear();
+  faces_.resize(num_faces);
+  builder.fill_face_cells(faces_, boundary_faces_, 4,
+                          [](index_type i) { return i; });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  face_table_.clear();
+  face_table_.reserve(num_faces);
+  for (index_type u = 0; u < num_faces; ++u)
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2])] = uidx;
-
-    if (pface.cells_[1] == -1)
-    {
-      index_type cell = (pface.cells_[0]) >> 2;
-      index_type face = (pface.cells_[0]) & 0x3;
-      boundary_faces_[cell] |= 1 << face;
-    }
-    ++ht_iter; uidx++;
+    const MeshTopologyBuilder<3>::key_type& key = builder.key(u);
+    face_table_[PFaceNode(key[0], key[1], key[2])] = u;
   }
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
-
-
 }
 
 
@@ -3081,65 +2646,49 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht& table)
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-
-  if (iter == table.end())
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  edge_ht table;
+  static const int edge_nodes[6][2] = { {0, 1}, {1, 2}, {2, 0}, {3, 0}, {3, 1}, {3, 2} };
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 2);
 
-  typename Node::array_type arr;
-  while (ci != cie)
+  // Occurrence i is edge i%6 of cell i/6, degenerate edges are left out.
+  MeshTopologyBuilder<2> builder;
+  builder.build(num_cells * 6, [this](index_type i,
+                                      MeshTopologyBuilder<2>::key_type& key)
   {
-    get_nodes(arr, *ci);
-    index_type cell_index = (*ci)<<3;
-    hash_edge(arr[0], arr[1], cell_index  ,table);
-    hash_edge(arr[1], arr[2], cell_index+1,table);
-    hash_edge(arr[2], arr[0], cell_index+2,table);
-    hash_edge(arr[3], arr[0], cell_index+3,table);
-    hash_edge(arr[3], arr[1], cell_index+4,table);
-    hash_edge(arr[3], arr[2], cell_index+5,table);
-    ++ci;
-  }
-
-  edges_.resize(table.size());
+    const under_type* nodes = &cells_[(i / 6) << 2];
+    const int* local = edge_nodes[i % 6];
+    const index_type n1 = nodes[local[0]], n2 = nodes[local[1]];
+    if (n1 == n2) return false;
+    key[0] = std::min(n1, n2); key[1] = std::max(n1, n2);
+    return true;
+  });
 
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
+  const size_type num_edges = builder.num_unique();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 4096, [&](size_t begin, size_t end)
+  {
+    for (size_t u = begin; u < end; ++u)
+    {
+      std::vector<index_type>& cells = edges_[u].cells_;
+      cells.resize(builder.num_occurrences(u));
+      for (size_t j = 0; j < cells.size(); ++j)
+      {
+        const index_type i = builder.occurrence(u, j);
+        cells[j] = ((i / 6) << 3) + i % 6;
+      }
+    }
+  });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  edge_table_.clear();
+  edge_table_.reserve(num_edges);
+  for (index_type u = 0; u < num_edges; ++u)
   {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
+    const MeshTopologyBuilder<2>::key_type& key = builder.key(u);
+    edge_table_[PEdgeNode(key[0], key[1])] = u;
   }
 
   synchronize_lock_.lock();
@@ -3312,8 +2861,8 @@ TetVolMesh<Basis>::clear_synchronization()
   node_neighbors_.clear();
   boundary_faces_.clear();
 
-  node_grid_.reset();
-  elem_grid_.reset();
+  node_index_.reset();
+  elem_index_.reset();
 
   synchronize_lock_.unlock();
 
@@ -3577,8 +3126,8 @@ TetVolMesh<Basis>::create_cell_syncinfo(typename Cell::index_type ci)
     create_cell_edges(ci);
   if (synchronized_&Mesh::FACES_E)
     create_cell_faces(ci);
-  if (synchronized_ & Mesh::LOCATE_E)
-    insert_elem_into_grid(ci);
+  if (synchronized_ & Mesh::ELEM_LOCATE_E)
+    insert_elem_into_index(ci);
   synchronize_lock_.unlock();
 }
 
@@ -3593,8 +3142,8 @@ TetVolMesh<Basis>::delete_cell_syncinfo(typename Cell::index_type ci)
     delete_cell_edges(ci);
   if (synchronized_&Mesh::FACES_E)
     delete_cell_faces(ci);
-  if (synchronized_ & Mesh::LOCATE_E)
-    remove_elem_from_grid(ci);
+  if (synchronized_ & Mesh::ELEM_LOCATE_E)
+    remove_elem_from_index(ci);
   synchronize_lock_.unlock();
 }
 
@@ -3629,8 +3178,8 @@ TetVolMesh<Basis>::create_cell_syncinfo_special(typename Cell::index_type ci)
     add_face(arr[0], arr[1], arr[3], cell_index+2);
     add_face(arr[0], arr[3], arr[2], cell_index+3);
   }
-  if (synchronized_ & Mesh::LOCATE_E)
-    insert_elem_into_grid(ci);
+  if (synchronized_ & Mesh::ELEM_LOCATE_E)
+    insert_elem_into_index(ci);
   synchronize_lock_.unlock();
 }
 
@@ -3645,8 +3194,8 @@ TetVolMesh<Basis>::delete_cell_syncinfo_special(typename Cell::index_type ci)
     delete_cell_edges(ci, true);
   if (synchronized_&Mesh::FACES_E)
     delete_cell_faces(ci, true);
-  if (synchronized_ & Mesh::LOCATE_E)
-    remove_elem_from_grid(ci);
+  if (synchronized_ & Mesh::ELEM_LOCATE_E)
+    remove_elem_from_index(ci);
   synchronize_lock_.unlock();
 }
 
@@ -3670,13 +3219,30 @@ template <class Basis>
 void
 TetVolMesh<Basis>::compute_node_neighbors()
 {
+  // Group the corners of all cells by node, the corners of each node stay
+  // in increasing order.
+  MeshTopologyBuilder<1> builder;
+  builder.build(cells_.size(), [this](index_type i,
+                                      MeshTopologyBuilder<1>::key_type& key)
+  {
+    key[0] = cells_[i];
+    return true;
+  });
+
   node_neighbors_.clear();
   node_neighbors_.resize(points_.size());
-  index_type i, num_cells = cells_.size();
-  for (i = 0; i < num_cells; i++)
+  Core::Thread::Parallel::For(0, builder.num_unique(), 1024,
+    [&](size_t begin, size_t end)
   {
-    node_neighbors_[cells_[i]].push_back(i);
-  }
+    for (size_t u = begin; u < end; ++u)
+    {
+      std::vector<typename Cell::index_type>& corners =
+        node_neighbors_[builder.key(u)[0]];
+      corners.resize(builder.num_occurrences(u));
+      for (size_t j = 0; j < corners.size(); ++j)
+        corners[j] = builder.occurrence(u, j);
+    }
+  });
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::NODE_NEIGHBORS_E;
@@ -3719,12 +3285,9 @@ TetVolMesh<Basis>::get_weights(const Core::Geometry::Point &p, typename Node::ar
 }
 
 template <class Basis>
-void
-TetVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
+Core::Geometry::BBox
+TetVolMesh<Basis>::elem_index_box(index_type ci) const
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
-
   const index_type idx = ci*4;
   Core::Geometry::BBox box;
   box.extend(points_[cells_[idx]]);
@@ -3732,69 +3295,63 @@ TetVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[cells_[idx+2]]);
   box.extend(points_[cells_[idx+3]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  return (box);
 }
 
-
 template <class Basis>
 void
-TetVolMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
+TetVolMesh<Basis>::insert_elem_into_index(typename Elem::index_type ci)
 {
-  const index_type idx = ci*4;
-  Core::Geometry::BBox box;
-  box.extend(points_[cells_[idx]]);
-  box.extend(points_[cells_[idx+1]]);
-  box.extend(points_[cells_[idx+2]]);
-  box.extend(points_[cells_[idx+3]]);
-  box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  // An octree or hierarchy is not updated in place, it is rebuilt by the
+  // next synchronize(ELEM_LOCATE_E).
+  if (elem_index_ && !elem_index_->insert(ci, elem_index_box(ci)))
+  {
+    elem_index_.reset();
+    synchronized_ &= ~Mesh::ELEM_LOCATE_E;
+  }
 }
 
+
 template <class Basis>
 void
-TetVolMesh<Basis>::insert_node_into_grid(typename Node::index_type ni)
+TetVolMesh<Basis>::remove_elem_from_index(typename Elem::index_type ci)
 {
-  /// @todo:  This can crash if you insert a new cell outside of the grid.
-  // Need to recompute grid at that point.
-  node_grid_->insert(ni,points_[ni]);
+  if (elem_index_ && !elem_index_->remove(ci, elem_index_box(ci)))
+  {
+    elem_index_.reset();
+    synchronized_ &= ~Mesh::ELEM_LOCATE_E;
+  }
 }
 
 template <class Basis>
-void
-TetVolMesh<Basis>::remove_node_from_grid(typename Node::index_type ni)
+SpatialIndexHandle
+TetVolMesh<Basis>::create_elem_index() const
+{
+  typename Elem::size_type esz;  size(esz);
+  Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
+
+  return (SpatialIndex::create(spatial_index_type_, esz,
+    [this](index_type ci) { return (elem_index_box(ci)); }, b));
+}
+
+template <class Basis>
+SpatialIndexHandle
+TetVolMesh<Basis>::create_node_index() const
 {
-  node_grid_->remove(ni,points_[ni]);
+  typename Node::size_type nsz;  size(nsz);
+  Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
+
+  return (SpatialIndex::create(spatial_index_type_, nsz,
+    [this](index_type ni) { return (Core::Geometry::BBox(points_[ni], points_[ni])); }, b));
 }
 
 template <class Basis>
 void
-TetVolMesh<Basis>::compute_elem_grid()
+TetVolMesh<Basis>::compute_elem_index()
 {
   if (bbox_.valid())
   {
-    // Cubed root of number of cells to get a subdivision ballpark.
-
-    typename Elem::size_type esz;  size(esz);
-
-    const size_type s =
-      3*static_cast<size_type>((ceil(pow(static_cast<double>(esz) , (1.0/3.0))))/2.0 + 1.0);
-
-    Core::Geometry::Vector diag  = bbox_.diagonal();
-    double trace = (diag.x()+diag.y()+diag.z());
-    size_type sx = static_cast<size_type>(ceil(0.5+diag.x()/trace*s));
-    size_type sy = static_cast<size_type>(ceil(0.5+diag.y()/trace*s));
-    size_type sz = static_cast<size_type>(ceil(0.5+diag.z()/trace*s));
-
-    Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
-    elem_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Elem::iterator ci, cie;
-    begin(ci); end(cie);
-    while(ci != cie)
-    {
-      insert_elem_into_grid(*ci);
-      ++ci;
-    }
+    elem_index_ = create_elem_index();
   }
 
   synchronize_lock_.lock();
@@ -3804,34 +3361,12 @@ TetVolMesh<Basis>::compute_elem_grid()
 
 template <class Basis>
 void
-TetVolMesh<Basis>::compute_node_grid()
+TetVolMesh<Basis>::compute_node_index()
 {
   ASSERTMSG(bbox_.valid(),"TetVolMesh BBox not valid");
   if (bbox_.valid())
   {
-    // Cubed root of number of cells to get a subdivision ballpark.
-
-    typename Elem::size_type esz;  size(esz);
-
-    const size_type s =  3*static_cast<size_type>
-                  ((ceil(pow(static_cast<double>(esz) , (1.0/3.0))))/2.0 + 1.0);
-
-    Core::Geometry::Vector diag  = bbox_.diagonal();
-    double trace = (diag.x()+diag.y()+diag.z());
-    size_type sx = static_cast<size_type>(ceil(0.5+diag.x()/trace*s));
-    size_type sy = static_cast<size_type>(ceil(0.5+diag.y()/trace*s));
-    size_type sz = static_cast<size_type>(ceil(0.5+diag.z()/trace*s));
-
-    Core::Geometry::BBox b = bbox_; b.extend(10*epsilon_);
-    node_grid_.reset(new SearchGridT<index_type>(sx, sy, sz, b.get_min(), b.get_max()));
-
-    typename Node::iterator ni, nie;
-    begin(ni); end(nie);
-    while(ni != nie)
-    {
-      insert_node_into_grid(*ni);
-      ++ni;
-    }
+    node_index_ = create_node_index();
   }
 
   synchronize_lock_.lock();
@@ -3839,6 +3374,21 @@ TetVolMesh<Basis>::compute_node_grid()
   synchronize_lock_.unlock();
 }
 
+template <class Basis>
+void
+TetVolMesh<Basis>::set_spatial_index_type(SpatialIndex::Type type)
+{
+  synchronize_lock_.lock();
+  if (type != spatial_index_type_)
+  {
+    spatial_index_type_ = type;
+    node_index_.reset();
+    elem_index_.reset();
+    synchronized_ &= ~Mesh::LOCATE_E;
+  }
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_bounding_box()
@@ -91,6 +91,18 @@ VMesh::get_node_search_grid()
   ASSERTFAIL("VMesh interface: get_node_search_grid() has not been implemented");
 }
 
+bool
+VMesh::set_spatial_index_type(SpatialIndex::Type)
+{
+  return (false);
+}
+
+SpatialIndex::Type
+VMesh::get_spatial_index_type() const
+{
+  return (SpatialIndex::UNIFORM_GRID);
+}
+
 void
 VMesh::get_nodes(Node::array_type& nodes, Node::index_type i) const
 {
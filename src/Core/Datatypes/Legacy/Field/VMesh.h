@@ -33,6 +33,7 @@
 #include <Core/Containers/StackBasedVector.h>
 #include <Core/Containers/StackVector.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/SpatialIndex.h>
 #include <Core/Datatypes/Legacy/Field/FieldVIndex.h>
 #include <Core/Datatypes/Legacy/Field/FieldVIterator.h>
 
@@ -326,6 +327,11 @@ public:
   virtual SharedPointer<SearchGridT<SCIRun::index_type> > get_elem_search_grid();
   virtual SharedPointer<SearchGridT<SCIRun::index_type> > get_node_search_grid();
 
+  /// Select the spatial index of a mesh that supports more than one,
+  /// returns false if the mesh has only its own search grid.
+  virtual bool set_spatial_index_type(SpatialIndex::Type type);
+  virtual SpatialIndex::Type get_spatial_index_type() const;
+
   /// test for special case where the mesh is empty
   /// empty meshes may need a special treatment
   inline bool is_empty() const
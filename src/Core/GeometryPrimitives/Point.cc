@@ -27,6 +27,7 @@
 
 
 #include <Core/Persistent/Persistent.h>
+#include <Core/Persistent/PersistentSTL.h>
 #include <Core/GeometryPrimitives/Point.h>
 #include <iostream>
 #include <sstream>
@@ -185,3 +186,10 @@ const TypeDescription* SCIRun::get_type_description(Core::Geometry::Point*)
   }
   return td;
 }
+
+void
+SCIRun::Pio(Piostream& stream, std::vector<Point>& data)
+{
+  static_assert(sizeof(Point) == 3 * sizeof(double), "Point must be three packed doubles for block io");
+  Pio_packed(stream, data);
+}
@@ -225,6 +225,8 @@ inline Point Max(const Point& p1, const Point& p2)
 /// @todo: This one is obsolete when last part dynamic compilation is gone
 SCISHARE const std::string& Point_get_h_file_path();
 SCISHARE const SCIRun::TypeDescription* get_type_description(Core::Geometry::Point*);
+/// Node arrays are read and written as one block of packed doubles.
+SCISHARE void Pio(Piostream&, std::vector<Core::Geometry::Point>&);
 }
 
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
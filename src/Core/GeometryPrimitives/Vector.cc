@@ -32,6 +32,7 @@
 
 #include <Core/GeometryPrimitives/Vector.h>
 #include <Core/Persistent/Persistent.h>
+#include <Core/Persistent/PersistentSTL.h>
 
 #include <iostream>
 #include <sstream>
@@ -202,3 +203,10 @@ Vector SCIRun::Core::Geometry::vectorFromString(const std::string& str)
   istr >> v;
   return v;
 }
+
+void
+SCIRun::Pio(Piostream& stream, std::vector<Vector>& data)
+{
+  static_assert(sizeof(Vector) == 3 * sizeof(double), "Vector must be three packed doubles for block io");
+  Pio_packed(stream, data);
+}
@@ -486,6 +486,8 @@ SCISHARE const TypeDescription* get_type_description(Vector*);
 }}
 /// @todo: This one is obsolete when dynamic compilation will be abandoned
 const std::string& Vector_get_h_file_path();
+/// Vector data is read and written as one block of packed doubles.
+SCISHARE void Pio(Piostream&, std::vector<Core::Geometry::Vector>&);
 }
 
 #endif
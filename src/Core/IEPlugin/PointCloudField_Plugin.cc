@@ -35,6 +35,7 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/PointCloudMesh.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Utils/Legacy/NumericTextFile.h>
 #include <Core/Utils/Legacy/StringUtil.h>
 
 using namespace SCIRun;
@@ -109,19 +110,34 @@ FieldHandle SCIRun::TextToPointCloudField_reader(LoggerHandle pr, const char *fi
 		}
 	}
 
-  int ncols = 0;
-  int nrows = 0;
-  int line_ncols = 0;
-  int num_pts = 0;
-
-  std::string line;
+  // The file is parsed in parallel, every line that holds numbers is a row.
+  // A first row with a single number is a header with the number of points.
+  NumericTextFile pts_file;
+  if (!pts_file.read(pts_fn))
+  {
+    if (pr) pr->error("Could not open and read file: " + pts_fn);
+    return (result);
+  }
 
-  // Read file, get number of rows, cols...
+  const size_t first_row = (pts_file.num_rows() > 0 && pts_file.row_size(0) == 1) ? 1 : 0;
+  const size_t nrows = pts_file.num_rows() - first_row;
 
-	bool has_header_pts = false;
-	bool first_line_pts = true;
+  size_t ncols = 0;
+  if (!pts_file.same_row_size(first_row, ncols))
+  {
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
+    return (result);
+  }
 
-  std::vector<double> values;
+  if (first_row > 0)
+  {
+    const size_t num_pts = static_cast<size_t>(pts_file.row(0)[0]);
+    if (num_pts != nrows)
+    {
+      if (pr) pr->warning("Number of points listed in header (" + boost::lexical_cast<std::string>(num_pts) +
+                          ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(nrows) + ")");
+    }
+  }
 
   FieldInformation fi("PointCloudMesh", "ConstantBasis", "double");
   result = CreateField(fi);
@@ -129,84 +145,16 @@ FieldHandle SCIRun::TextToPointCloudField_reader(LoggerHandle pr, const char *fi
   VMesh *mesh = result->vmesh();
   VField *field = result->vfield();
 
+  if (ncols == 2 || ncols == 3)
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-    try
-    {
-      inputfile.open(pts_fn.c_str());
-
-      while( getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-        line_ncols = values.size();
-
-        if (first_line_pts)
-        {
-          if (line_ncols > 0)
-          {
-            if (line_ncols == 1)
-            {
-              has_header_pts = true;
-              num_pts = static_cast<int>(values[0]) + 1;
-              continue;
-            }
-            else if ((line_ncols > 1))
-            {
-              has_header_pts = false;
-              first_line_pts = false;
-              nrows++;
-              ncols = line_ncols;
-            }
-          }
-        }
-        else
-        {
-          if (line_ncols > 0)
-          {
-            nrows++;
-            if (ncols > 0)
-            {
-              if (ncols != line_ncols)
-              {
-                if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
-                return (result);
-              }
-            }
-            else
-            {
-              ncols = line_ncols;
-            }
-          }
-        }
-        // fill in 3D or 2D points by row
-        if (values.size() == 3) mesh->add_point(Point(values[0], values[1], values[2]));
-        if (values.size() == 2) mesh->add_point(Point(values[0], values[1], 0.0));
-      }
-      if ( has_header_pts && (num_pts != nrows) )
-      {
-        if (pr) pr->warning("Number of points listed in header (" + boost::lexical_cast<std::string>(num_pts) +
-                            ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(nrows) + ")");
-      }
-    }
-    catch (...)
+    mesh->node_reserve(nrows);
+    for (size_t i = 0; i < nrows; ++i)
     {
-      if (pr) pr->error("Could not open and read file: " + pts_fn);
-      return (result);
+      // fill in 3D or 2D points by row
+      const double* values = pts_file.row(first_row + i);
+      if (ncols == 3) mesh->add_point(Point(values[0], values[1], values[2]));
+      else mesh->add_point(Point(values[0], values[1], 0.0));
     }
-    inputfile.close();
   }
 
   field->resize_values();
@@ -43,9 +43,11 @@
 #include <Core/IEPlugin/SimpleTextFileToMatrix_Plugin.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Utils/Legacy/NumericTextFile.h>
 #include <Core/Utils/Legacy/StringUtil.h>
 #include <Core/Logging/LoggerInterface.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -59,112 +61,35 @@ MatrixHandle SCIRun::SimpleTextFileMatrix_reader(LoggerHandle pr, const char *fi
 {
   DenseMatrixHandle result;
 
-  SCIRun::size_type ncols = 0;
-  SCIRun::size_type nrows = 0;
-  SCIRun::size_type line_ncols = 0;
-
-  std::string line;
-
-  // STAGE 1 - SCAN THE FILE TO DETERMINE THE DIMENSIONS OF THE MATRIX
-  // AND CHECK THE FILE'S INTEGRITY.
-
-  std::vector<double> values;
-
+  // The file is parsed in parallel, every line that holds numbers is a row
+  // of the matrix.
+  NumericTextFile file;
+  if (!file.read(filename))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    try
-    {
-      inputfile.open(filename);
-
-      while( getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-        line_ncols = values.size();
-
-        if (line_ncols > 0)
-        {
-          nrows++;
-          if (ncols > 0)
-          {
-            if (ncols != line_ncols)
-            {
-              if (pr)  pr->error("Improper format of text file, not every line contains the same amount of numbers");
-              return (result);
-            }
-          }
-          else
-          {
-            ncols = line_ncols;
-          }
-        }
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open file: "+std::string(filename));
-      return (result);
-    }
-    inputfile.close();
+    if (pr) pr->error("Could not open file: "+std::string(filename));
+    return (result);
   }
 
-  // STAGE 2 - NOW ACTUALLY READ AND STORE THE MATRIX
-
+  size_t ncols = 0;
+  if (!file.same_row_size(0, ncols))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    result.reset(new DenseMatrix(nrows,ncols));
-    if (!result)
-    {
-      if (pr) pr->error("Could not allocate matrix");
-      return(result);
-    }
-
-    double* dataptr = result->data();
-    int k = 0;
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of numbers");
+    return (result);
+  }
 
-    try
-    {
-      inputfile.open(filename);
+  const size_t nrows = file.num_rows();
+  result.reset(new DenseMatrix(nrows,ncols));
+  if (!result)
+  {
+    if (pr) pr->error("Could not allocate matrix");
+    return(result);
+  }
 
-      while( getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-        for (size_t j=0; j<values.size();j++) dataptr[k++] = values[j];
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open and read file: "+std::string(filename));
-      return (result);
-    }
-    inputfile.close();
+  double* dataptr = result->data();
+  for (size_t r = 0; r < nrows; r++)
+  {
+    const double* values = file.row(r);
+    std::copy(values, values + ncols, dataptr + r*ncols);
   }
   return(result);
 }
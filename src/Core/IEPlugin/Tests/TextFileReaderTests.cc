@@ -0,0 +1,289 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/IEPlugin/TetVolField_Plugin.h>
+#include <Core/IEPlugin/TriSurfField_Plugin.h>
+#include <Core/IEPlugin/SimpleTextFileToMatrix_Plugin.h>
+#include <Core/Utils/Legacy/NumericTextFile.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Testing/Utils/SCIRunUnitTests.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  boost::filesystem::path writeTextFile(const std::string& name, const std::string& contents)
+  {
+    boost::filesystem::path file(TestResources::rootDir() / "TransientOutput" / name);
+    std::ofstream out(file.string());
+    out << contents;
+    return file;
+  }
+}
+
+TEST(NumericTextFileTests, SkipsCommentsAndSeparators)
+{
+  auto file = writeTextFile("numeric_text_file.txt",
+    "# comment\n"
+    "1, 2.5,\t-3e2\r\n"
+    "\n"
+    "% another comment\n"
+    "\"4\" 5 6\n"
+    "7 8");
+
+  NumericTextFile parsed;
+  ASSERT_TRUE(parsed.read(file.string()));
+  ASSERT_EQ(3u, parsed.num_rows());
+
+  size_t ncols = 0;
+  EXPECT_FALSE(parsed.same_row_size(0, ncols));
+  ASSERT_TRUE(parsed.same_row_size(2, ncols));
+  EXPECT_EQ(2u, ncols);
+  EXPECT_EQ(3u, parsed.row_size(0));
+  EXPECT_EQ(2u, parsed.row_size(2));
+  EXPECT_DOUBLE_EQ(2.5, parsed.row(0)[1]);
+  EXPECT_DOUBLE_EQ(-300.0, parsed.row(0)[2]);
+  EXPECT_DOUBLE_EQ(4.0, parsed.row(1)[0]);
+  EXPECT_DOUBLE_EQ(8.0, parsed.row(2)[1]);
+  EXPECT_FALSE(parsed.contains(0.0));
+
+  boost::filesystem::remove(file);
+}
+
+TEST(NumericTextFileTests, MissingFileFails)
+{
+  NumericTextFile parsed;
+  EXPECT_FALSE(parsed.read((TestResources::rootDir() / "TransientOutput" / "does_not_exist.pts").string()));
+}
+
+TEST(NumericTextFileTests, SmallChunksGiveTheSameRows)
+{
+  // Rows of different lengths, comments, blank lines, one line that spans
+  // many chunks and no newline at the end.
+  std::ostringstream contents;
+  size_t expected_rows = 0;
+  for (int i = 0; i < 200; i++)
+  {
+    if (i % 17 == 0) contents << "# comment " << i << "\n\n";
+    for (int j = 0; j <= i % 5; j++) contents << (j > 0 ? " " : "") << i * 0.5 + j;
+    contents << "\n";
+    expected_rows++;
+  }
+  for (int j = 0; j < 100; j++) contents << j << ",";
+  contents << "\n7 8 9";
+  expected_rows += 2;
+  auto file = writeTextFile("numeric_text_chunks.txt", contents.str());
+
+  NumericTextFile reference;
+  ASSERT_TRUE(reference.read(file.string()));
+  ASSERT_EQ(expected_rows, reference.num_rows());
+  EXPECT_EQ(100u, reference.row_size(200));
+  EXPECT_DOUBLE_EQ(99.5 + 4, reference.row(199)[4]);
+
+  for (size_t chunk_size : { 1, 2, 7, 64, 1000 })
+  {
+    NumericTextFile parsed;
+    parsed.set_chunk_size(chunk_size);
+    ASSERT_TRUE(parsed.read(file.string()));
+    ASSERT_EQ(reference.num_rows(), parsed.num_rows()) << "chunk size " << chunk_size;
+    for (size_t row = 0; row < reference.num_rows(); row++)
+    {
+      ASSERT_EQ(reference.row_size(row), parsed.row_size(row)) << "chunk size " << chunk_size << ", row " << row;
+      for (size_t k = 0; k < reference.row_size(row); k++)
+        EXPECT_EQ(reference.row(row)[k], parsed.row(row)[k]);
+    }
+  }
+
+  boost::filesystem::remove(file);
+}
+
+TEST(TetVolFieldPluginTests, ReadsOneBasedElementsWithHeader)
+{
+  auto pts = writeTextFile("text_tetvol.pts",
+    "5\n"
+    "0 0 0\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "0 0 1\n"
+    "1,1,1\n");
+  auto elem = writeTextFile("text_tetvol.elem",
+    "# two tets\n"
+    "1 2 3 4\n"
+    "2 3 4 5\n");
+
+  FieldHandle field = TextToTetVolField_reader(nullptr, pts.string().c_str());
+  ASSERT_TRUE(field != nullptr);
+  VMesh* mesh = field->vmesh();
+  EXPECT_EQ(5, mesh->num_nodes());
+  ASSERT_EQ(2, mesh->num_elems());
+
+  VMesh::Node::array_type nodes;
+  mesh->get_nodes(nodes, VMesh::Elem::index_type(1));
+  ASSERT_EQ(4u, nodes.size());
+  EXPECT_EQ(1, nodes[0]);
+  EXPECT_EQ(4, nodes[3]);
+
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(elem);
+}
+
+TEST(TetVolFieldPluginTests, ReadsZeroBasedElementsWithoutHeader)
+{
+  auto pts = writeTextFile("text_tetvol0.pts",
+    "0 0 0\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "0 0 1\n");
+  auto elem = writeTextFile("text_tetvol0.elem", "0 1 2 3\n");
+
+  FieldHandle field = TextToTetVolField_reader(nullptr, pts.string().c_str());
+  ASSERT_TRUE(field != nullptr);
+  VMesh* mesh = field->vmesh();
+  EXPECT_EQ(4, mesh->num_nodes());
+  ASSERT_EQ(1, mesh->num_elems());
+
+  VMesh::Node::array_type nodes;
+  mesh->get_nodes(nodes, VMesh::Elem::index_type(0));
+  ASSERT_EQ(4u, nodes.size());
+  EXPECT_EQ(0, nodes[0]);
+  EXPECT_EQ(3, nodes[3]);
+  EXPECT_EQ(Core::Geometry::Point(0, 0, 1), mesh->get_point(VMesh::Node::index_type(3)));
+
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(elem);
+}
+
+TEST(TetVolFieldPluginTests, ElementsWithThreeNodesFail)
+{
+  auto pts = writeTextFile("text_tetvol_bad.pts", "0 0 0\n1 0 0\n0 1 0\n");
+  auto elem = writeTextFile("text_tetvol_bad.elem", "1 2 3\n");
+  EXPECT_FALSE(TextToTetVolField_reader(nullptr, pts.string().c_str()));
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(elem);
+}
+
+TEST(TriSurfFieldPluginTests, ReadsZeroBasedFacesOfPlanarPoints)
+{
+  auto pts = writeTextFile("text_trisurf.pts",
+    "0 0\n"
+    "1 0\n"
+    "0 1\n"
+    "1 1\n");
+  auto fac = writeTextFile("text_trisurf.fac",
+    "0 1 2\n"
+    "1 3 2\n");
+
+  FieldHandle field = TextToTriSurfField_reader(nullptr, pts.string().c_str());
+  ASSERT_TRUE(field != nullptr);
+  VMesh* mesh = field->vmesh();
+  EXPECT_EQ(4, mesh->num_nodes());
+  ASSERT_EQ(2, mesh->num_elems());
+  EXPECT_EQ(Core::Geometry::Point(1, 1, 0), mesh->get_point(VMesh::Node::index_type(3)));
+
+  VMesh::Node::array_type nodes;
+  mesh->get_nodes(nodes, VMesh::Elem::index_type(1));
+  ASSERT_EQ(3u, nodes.size());
+  EXPECT_EQ(1, nodes[0]);
+  EXPECT_EQ(3, nodes[1]);
+  EXPECT_EQ(2, nodes[2]);
+
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(fac);
+}
+
+TEST(TriSurfFieldPluginTests, HeaderLimitsTheRowsRead)
+{
+  auto pts = writeTextFile("text_trisurf_header.pts",
+    "3\n"
+    "0 0 0\n"
+    "1 0 0\n"
+    "0 1 0\n"
+    "5 5 5\n");
+  auto fac = writeTextFile("text_trisurf_header.fac",
+    "1\n"
+    "# one based\n"
+    "1 2 3\n");
+
+  FieldHandle field = TextToTriSurfField_reader(nullptr, pts.string().c_str());
+  ASSERT_TRUE(field != nullptr);
+  VMesh* mesh = field->vmesh();
+  EXPECT_EQ(3, mesh->num_nodes());
+  ASSERT_EQ(1, mesh->num_elems());
+
+  VMesh::Node::array_type nodes;
+  mesh->get_nodes(nodes, VMesh::Elem::index_type(0));
+  ASSERT_EQ(3u, nodes.size());
+  EXPECT_EQ(0, nodes[0]);
+  EXPECT_EQ(2, nodes[2]);
+
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(fac);
+}
+
+TEST(TriSurfFieldPluginTests, FacesWithFourNodesFail)
+{
+  auto pts = writeTextFile("text_trisurf_bad.pts", "0 0 0\n1 0 0\n0 1 0\n1 1 0\n");
+  auto fac = writeTextFile("text_trisurf_bad.fac", "1 2 3 4\n");
+  EXPECT_FALSE(TextToTriSurfField_reader(nullptr, pts.string().c_str()));
+  boost::filesystem::remove(pts);
+  boost::filesystem::remove(fac);
+}
+
+TEST(SimpleTextFileMatrixTests, ReadsDenseMatrix)
+{
+  auto file = writeTextFile("simple_text_matrix.txt",
+    "% 2 x 3\n"
+    "1 2 3\n"
+    "4,5,6\n");
+
+  auto matrix = SimpleTextFileMatrix_reader(nullptr, file.string().c_str());
+  auto dense = std::dynamic_pointer_cast<DenseMatrix>(matrix);
+  ASSERT_TRUE(dense != nullptr);
+  ASSERT_EQ(2, dense->nrows());
+  ASSERT_EQ(3, dense->ncols());
+  EXPECT_DOUBLE_EQ(2.0, (*dense)(0, 1));
+  EXPECT_DOUBLE_EQ(4.0, (*dense)(1, 0));
+  EXPECT_DOUBLE_EQ(6.0, (*dense)(1, 2));
+
+  boost::filesystem::remove(file);
+}
+
+TEST(SimpleTextFileMatrixTests, RaggedRowsFail)
+{
+  auto file = writeTextFile("simple_text_ragged.txt", "1 2 3\n4 5\n");
+  EXPECT_FALSE(SimpleTextFileMatrix_reader(nullptr, file.string().c_str()));
+  boost::filesystem::remove(file);
+}
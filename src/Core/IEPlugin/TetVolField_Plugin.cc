@@ -32,8 +32,10 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Logging/LoggerInterface.h>
 #include <Core/IEPlugin/TriSurfField_Plugin.h>
+#include <Core/Utils/Legacy/NumericTextFile.h>
 #include <Core/Utils/Legacy/StringUtil.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -178,202 +180,75 @@ FieldHandle SCIRun::TextToTetVolField_reader(LoggerHandle pr, const char *filena
     }
   }
 
-  int ncols = 0;
-  int nrows = 0;
-  int line_ncols = 0;
-  int num_nodes = 0, num_elems = 0;
-
-  std::string line;
-
-  // STAGE 1 - SCAN THE FILE TO DETERMINE THE NUMBER OF NODES
-  // AND CHECK THE FILE'S INTEGRITY.
-
-  bool has_header_pts = false;
-  bool first_line_pts = true;
-
-  bool has_header = false;
-  bool first_line = true;
-
-  bool has_data = false;
-
-  std::vector<double> values;
-
+  // Both files are parsed in parallel, every line that holds numbers is a
+  // row. A first row with a single number is a header with the number of
+  // rows that follow.
+  NumericTextFile pts_file;
+  if (!pts_file.read(pts_fn))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-    try
-    {
-      inputfile.open(pts_fn.c_str());
-
-      while (getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
+    if (pr) pr->error("Could not open and read file: " + pts_fn);
+    return (result);
+  }
 
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
+  const bool has_header_pts = (pts_file.num_rows() > 0 && pts_file.row_size(0) == 1);
+  const size_t first_pts = has_header_pts ? 1 : 0;
+  size_t num_nodes = pts_file.num_rows() - first_pts;
+  size_t pts_ncols = 0;
 
-        multiple_from_string(line,values);
-        line_ncols = values.size();
+  if (!pts_file.same_row_size(first_pts, pts_ncols))
+  {
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
+    return (result);
+  }
 
-        if (first_line_pts)
-        {
-          if (line_ncols > 0)
-          {
-            if (line_ncols == 1)
-            {
-              has_header_pts = true;
-              num_nodes = static_cast<int>(values[0]) + 1;
-            }
-            else if ((line_ncols > 1))
-            {
-              has_header_pts = false;
-              first_line_pts = false;
-              nrows++;
-              ncols = line_ncols;
-            }
-          }
-        }
-        else
-        {
-          if (line_ncols > 0)
-          {
-            nrows++;
-            if (ncols > 0)
-            {
-              if (ncols != line_ncols)
-              {
-                if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
-                return (result);
-              }
-            }
-            else
-            {
-              ncols = line_ncols;
-            }
-          }
-        }
-      }
-    }
-    catch (...)
+  if (has_header_pts)
+  {
+    const size_t header_nodes = static_cast<size_t>(pts_file.row(0)[0]);
+    if (header_nodes != num_nodes)
     {
-      if (pr) pr->error("Could not open and read file: " + pts_fn);
-      return (result);
+      if (pr) pr->warning("Number of nodes listed in header (" + boost::lexical_cast<std::string>(header_nodes) +
+                          ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(num_nodes) + ")");
+      num_nodes = std::min(num_nodes, header_nodes);
     }
-    inputfile.close();
   }
 
-  if (0 == num_nodes)
-  {
-    num_nodes = nrows;
-  }
-  else if ( has_header_pts && (nrows != num_nodes) )
+  NumericTextFile elems_file;
+  if (!elems_file.read(elems_fn))
   {
-    if (pr) pr->warning("Number of nodes listed in header (" + boost::lexical_cast<std::string>(num_nodes) +
-                        ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(nrows) + ")");
+    if (pr) pr->error("Could not open and read file: " + elems_fn);
+    return (result);
   }
 
-  nrows = 0;
-  ncols = 0;
-  line_ncols = 0;
+  const bool has_header = (elems_file.num_rows() > 0 && elems_file.row_size(0) == 1);
+  const size_t first_elem = has_header ? 1 : 0;
+  size_t num_elems = elems_file.num_rows() - first_elem;
+  size_t ncols = 0;
 
-  bool zero_based = false;
+  if (!elems_file.same_row_size(first_elem, ncols))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-    try
-    {
-      inputfile.open(elems_fn.c_str());
-
-      while (getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-        line_ncols = values.size();
-
-        for (size_t j=0; j<values.size(); j++) if (values[j] == 0.0) zero_based = true;
-
-        if (first_line)
-        {
-          if (line_ncols > 0)
-          {
-            if (line_ncols == 1)
-            {
-              has_header = true;
-              num_elems = static_cast<int>(values[0]) + 1;
-            }
-            else if (line_ncols > 3)
-            {
-              has_header = false;
-              first_line = false;
-              nrows++;
-              ncols = line_ncols;
-              if (ncols == 5) has_data = true;
-            }
-            else
-            {
-              if (pr)  pr->error("Improper format of text file, some lines do not contain 4 entries");
-              return (result);
-            }
-          }
-        }
-        else
-        {
-          if (line_ncols > 0)
-          {
-            nrows++;
-            if (ncols > 0)
-            {
-              if (ncols != line_ncols)
-              {
-                if (pr)  pr->error("Improper format of text file, not every line contains the same amount of node references");
-                return (result);
-              }
-            }
-            else
-            {
-              ncols = line_ncols;
-              if (ncols == 5) has_data = true;
-            }
-          }
-        }
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open and read file: " + elems_fn);
-      return (result);
-    }
-    inputfile.close();
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of node references");
+    return (result);
   }
-
-  if (0 == num_elems)
+  if (num_elems > 0 && ncols < 4)
   {
-    num_elems = nrows;
+    if (pr)  pr->error("Improper format of text file, some lines do not contain 4 entries");
+    return (result);
   }
-  else if ( has_header && (nrows != num_elems) )
+
+  if (has_header)
   {
-    if (pr) pr->warning("Number of elements listed in header (" + boost::lexical_cast<std::string>(num_elems) +
-                        ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(nrows) + ")");
+    const size_t header_elems = static_cast<size_t>(elems_file.row(0)[0]);
+    if (header_elems != num_elems)
+    {
+      if (pr) pr->warning("Number of elements listed in header (" + boost::lexical_cast<std::string>(header_elems) +
+                          ") does not match number of non-header rows in file (" + boost::lexical_cast<std::string>(num_elems) + ")");
+      num_elems = std::min(num_elems, header_elems);
+    }
   }
 
+  const bool has_data = (ncols == 5);
+  const bool zero_based = elems_file.contains(0.0);
+
   // add data to elems (constant basis)
   FieldInformation fi("TetVolMesh",-1,"double");
   if (has_data) fi.make_constantdata();
@@ -385,90 +260,27 @@ FieldHandle SCIRun::TextToTetVolField_reader(LoggerHandle pr, const char *filena
   mesh->node_reserve(num_nodes);
   mesh->elem_reserve(num_elems);
 
+  for (size_t i = 0; i < num_nodes; ++i)
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    try
-    {
-      inputfile.open(pts_fn.c_str());
-
-      std::vector<double> vdata(3);
-
-      for (int i = 0; i < num_nodes && getline(inputfile,line,'\n'); ++i)
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-
-        if (values.size() == 3) mesh->add_point(Point(values[0],values[1],values[2]));
-        if (values.size() == 2) mesh->add_point(Point(values[0],values[1],0.0));
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open and process file: " + pts_fn);
-      return (result);
-    }
-    inputfile.close();
+    const double* values = pts_file.row(first_pts + i);
+    if (pts_ncols == 3) mesh->add_point(Point(values[0],values[1],values[2]));
+    if (pts_ncols == 2) mesh->add_point(Point(values[0],values[1],0.0));
   }
 
   std::vector<double> fvalues;
+  if (has_data) fvalues.reserve(num_elems);
 
-  {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    try
-    {
-      inputfile.open(elems_fn.c_str());
-
-      VMesh::Node::array_type vdata;
-      vdata.resize(4);
-
-      std::vector<VMesh::index_type> ivalues;
-
-      for (int i = 0; i < num_elems && getline(inputfile,line,'\n'); ++i)
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
+  VMesh::Node::array_type vdata(4);
+  const VMesh::index_type offset = zero_based ? 0 : 1;
 
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,ivalues);
-        for (size_t j=0; j<ivalues.size() && j<4; j++)
-        {
-          if (zero_based) vdata[j] = ivalues[j];
-          else vdata[j] = ivalues[j]-1;
-        }
-        if (ivalues.size() > 4) fvalues.push_back(ivalues[4]);
+  for (size_t i = 0; i < num_elems; ++i)
+  {
+    const double* values = elems_file.row(first_elem + i);
+    for (size_t j = 0; j < 4; j++)
+      vdata[j] = static_cast<VMesh::index_type>(values[j]) - offset;
+    if (has_data) fvalues.push_back(static_cast<VMesh::index_type>(values[4]));
 
-        if (ivalues.size() > 3) mesh->add_elem(vdata);
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open and process file: " + elems_fn);
-      return (result);
-    }
-    inputfile.close();
+    mesh->add_elem(vdata);
   }
 
   if (has_data)
@@ -31,11 +31,13 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Logging/LoggerInterface.h>
 #include <Core/IEPlugin/TriSurfField_Plugin.h>
+#include <Core/Utils/Legacy/NumericTextFile.h>
 #include <Core/Utils/Legacy/StringUtil.h>
 #include <Core/Algorithms/Legacy/DataIO/VTKToTriSurfReader.h>
 #include <Core/Algorithms/Legacy/DataIO/TriSurfSTLASCIIConverter.h>
 #include <Core/Algorithms/Legacy/DataIO/TriSurfSTLBinaryConverter.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -197,184 +199,59 @@ FieldHandle SCIRun::TextToTriSurfField_reader(LoggerHandle pr, const char *filen
   }
 
 
-  int ncols = 0;
-  int nrows = 0;
-  int line_ncols = 0;
-  int num_elems = 0, num_nodes = 0;
-
-  std::string line;
-
-  // STAGE 1 - SCAN THE FILE TO DETERMINE THE NUMBER OF NODES
-  // AND CHECK THE FILE'S INTEGRITY.
-
-  bool first_line_pts = true;
-  bool first_line = true;
-
-  std::vector<double> values;
-
+  // Both files are parsed in parallel, every line that holds numbers is a
+  // row. A first row with a single number is a header with the number of
+  // rows that follow.
+  NumericTextFile pts_file;
+  if (!pts_file.read(pts_fn))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-    try
-    {
-      inputfile.open(pts_fn.c_str());
-
-      while ( getline(inputfile,line,'\n') )
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
+    if (pr) pr->error("Could not open file: " + pts_fn);
+    return (result);
+  }
 
-        multiple_from_string(line,values);
-        line_ncols = values.size();
+  const size_t first_pts = (pts_file.num_rows() > 0 && pts_file.row_size(0) == 1) ? 1 : 0;
+  size_t num_nodes = pts_file.num_rows() - first_pts;
+  if (first_pts > 0)
+    num_nodes = std::min(num_nodes, static_cast<size_t>(pts_file.row(0)[0]));
 
-        if (first_line_pts)
-        {
-          if (line_ncols > 0)
-          {
-            if (line_ncols == 1)
-            {
-              num_nodes =  static_cast<int>(values[0]) + 1;
-            }
-            else if ((line_ncols == 3)||(line_ncols == 2))
-            {
-              first_line_pts = false;
-              nrows++;
-              ncols = line_ncols;
-            }
-            else
-            {
-              if (pr)  pr->error("Improper format of text file, some lines contain more than 3 entries");
-              return (result);
-            }
-          }
-        }
-        else
-        {
-          if (line_ncols > 0)
-          {
-            nrows++;
-            if (ncols > 0)
-            {
-              if (ncols != line_ncols)
-              {
-                if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
-                return (result);
-              }
-            }
-            else
-            {
-              ncols = line_ncols;
-            }
-          }
-        }
-      }
-    }
-    catch (...) {
-      if (pr) pr->error("Could not open file: " + pts_fn);
-      return (result);
-    }
-    inputfile.close();
+  size_t pts_ncols = 0;
+  if (!pts_file.same_row_size(first_pts, pts_ncols))
+  {
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
+    return (result);
   }
-
-  if (0 == num_nodes) {
-    num_nodes = nrows;
+  if (num_nodes > 0 && pts_ncols != 2 && pts_ncols != 3)
+  {
+    if (pr)  pr->error("Improper format of text file, some lines contain more than 3 entries");
+    return (result);
   }
 
-  nrows = 0;
-  ncols = 0;
-  line_ncols = 0;
-
-  bool zero_based = false;
-
+  NumericTextFile fac_file;
+  if (!fac_file.read(fac_fn))
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-    try
-    {
-      inputfile.open(fac_fn.c_str());
-
-      while( getline(inputfile,line,'\n'))
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-        line_ncols = values.size();
+    if (pr) pr->error("Could not open file: " + fac_fn);
+    return (result);
+  }
 
-        for (size_t j=0; j<values.size(); j++) if (values[j] == 0.0) zero_based = true;
+  const size_t first_elem = (fac_file.num_rows() > 0 && fac_file.row_size(0) == 1) ? 1 : 0;
+  size_t num_elems = fac_file.num_rows() - first_elem;
+  if (first_elem > 0)
+    num_elems = std::min(num_elems, static_cast<size_t>(fac_file.row(0)[0]));
 
-        if (first_line)
-        {
-          if (line_ncols > 0)
-          {
-            if (line_ncols == 1)
-            {
-              num_elems =  static_cast<int>(values[0]) + 1;
-            }
-            else if (line_ncols == 3)
-            {
-              first_line = false;
-              nrows++;
-              ncols = line_ncols;
-            }
-            else
-            {
-              if (pr)  pr->error("Improper format of text file, some lines do not contain 3 entries");
-              return (result);
-            }
-          }
-        }
-        else
-        {
-          if (line_ncols > 0)
-          {
-            nrows++;
-            if (ncols > 0)
-            {
-              if (ncols != line_ncols)
-              {
-                if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
-                return (result);
-              }
-            }
-            else
-            {
-              ncols = line_ncols;
-            }
-          }
-        }
-      }
-    }
-    catch (...) {
-      if (pr) pr->error("Could not open file: " + fac_fn);
-      return (result);
-    }
-    inputfile.close();
+  size_t ncols = 0;
+  if (!fac_file.same_row_size(first_elem, ncols))
+  {
+    if (pr)  pr->error("Improper format of text file, not every line contains the same amount of coordinates");
+    return (result);
   }
-
-  if (0 == num_elems)
+  if (num_elems > 0 && ncols != 3)
   {
-    num_elems = nrows;
+    if (pr)  pr->error("Improper format of text file, some lines do not contain 3 entries");
+    return (result);
   }
 
+  const bool zero_based = fac_file.contains(0.0);
+
   FieldInformation fi("TriSurfMesh", 1,"double");
   result = CreateField(fi);
 
@@ -383,87 +260,22 @@ FieldHandle SCIRun::TextToTriSurfField_reader(LoggerHandle pr, const char *filen
   mesh->node_reserve(num_nodes);
   mesh->elem_reserve(num_elems);
 
+  for (size_t i = 0; i < num_nodes; ++i)
   {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    try
-    {
-      inputfile.open(pts_fn.c_str());
-
-      std::vector<double> vdata(3);
-
-      for(int i = 0; i < num_nodes && getline(inputfile,line,'\n'); ++i)
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0;p<line.size();p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,values);
-
-        if (values.size() == 3) mesh->add_point(Point(values[0],values[1],values[2]));
-        if (values.size() == 2) mesh->add_point(Point(values[0],values[1],0.0));
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open file: "+std::string(pts_fn));
-      return (result);
-    }
-    inputfile.close();
+    const double* values = pts_file.row(first_pts + i);
+    if (pts_ncols == 3) mesh->add_point(Point(values[0],values[1],values[2]));
+    else mesh->add_point(Point(values[0],values[1],0.0));
   }
 
-  {
-    std::ifstream inputfile;
-    inputfile.exceptions( std::ifstream::badbit );
-
-    try
-    {
-      inputfile.open(fac_fn.c_str());
-
-      VMesh::Node::array_type vdata;
-      vdata.resize(3);
-
-      std::vector<VMesh::index_type> ivalues;
-
-      for (int i = 0; i < num_elems && getline(inputfile,line,'\n'); ++i)
-      {
-        if (line.size() > 0)
-        {
-          // block out comments
-          if ((line[0] == '#')||(line[0] == '%')) continue;
-        }
-
-        // replace comma's and tabs with white spaces
-        for (size_t p = 0; p < line.size(); p++)
-        {
-          if ((line[p] == '\t')||(line[p] == ',')||(line[p]=='"')) line[p] = ' ';
-        }
-
-        multiple_from_string(line,ivalues);
-        for (size_t j = 0; j < ivalues.size() && j < 3; j++)
-        {
-          if (zero_based) vdata[j] = ivalues[j];
-          else vdata[j] = ivalues[j]-1;
-        }
+  VMesh::Node::array_type vdata(3);
+  const VMesh::index_type offset = zero_based ? 0 : 1;
 
-        if (ivalues.size() > 2) mesh->add_elem(vdata);
-      }
-    }
-    catch (...)
-    {
-      if (pr) pr->error("Could not open file: "+std::string(fac_fn));
-      return (result);
-    }
-    inputfile.close();
+  for (size_t i = 0; i < num_elems; ++i)
+  {
+    const double* values = fac_file.row(first_elem + i);
+    for (size_t j = 0; j < 3; j++)
+      vdata[j] = static_cast<VMesh::index_type>(values[j]) - offset;
+    mesh->add_elem(vdata);
   }
 
   return (result);
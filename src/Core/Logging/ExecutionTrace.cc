@@ -0,0 +1,181 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Core/Logging/ExecutionTrace.h>
+#include <Core/Utils/StringUtil.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace SCIRun::Core::Logging;
+
+CORE_SINGLETON_IMPLEMENTATION(ExecutionTracer)
+
+ExecutionTracer::ExecutionTracer() : epoch_(std::chrono::steady_clock::now())
+{
+}
+
+void ExecutionTracer::enable(const std::string& outputFile)
+{
+  outputFile_ = outputFile;
+  enabled_ = true;
+}
+
+void ExecutionTracer::disable()
+{
+  enabled_ = false;
+}
+
+long long ExecutionTracer::nowMicroseconds() const
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+int ExecutionTracer::currentThreadId()
+{
+  static std::atomic<int> nextId{1};
+  thread_local const int id = nextId++;
+  return id;
+}
+
+void ExecutionTracer::markQueued(const std::string& key)
+{
+  if (!enabled())
+    return;
+  const auto now = nowMicroseconds();
+  std::lock_guard<std::mutex> g(lock_);
+  queued_[key] = now;
+}
+
+std::optional<long long> ExecutionTracer::takeQueuedTime(const std::string& key)
+{
+  std::lock_guard<std::mutex> g(lock_);
+  auto q = queued_.find(key);
+  if (q == queued_.end())
+    return {};
+  auto time = q->second;
+  queued_.erase(q);
+  return time;
+}
+
+void ExecutionTracer::record(TraceEvent&& event)
+{
+  if (!enabled())
+    return;
+  std::lock_guard<std::mutex> g(lock_);
+  events_.push_back(std::move(event));
+}
+
+std::vector<TraceEvent> ExecutionTracer::events() const
+{
+  std::lock_guard<std::mutex> g(lock_);
+  return events_;
+}
+
+void ExecutionTracer::clear()
+{
+  std::lock_guard<std::mutex> g(lock_);
+  events_.clear();
+  queued_.clear();
+}
+
+std::string ExecutionTracer::toChromeTraceJson() const
+{
+  auto spans = events();
+  std::ostringstream json;
+  json << std::setprecision(15);
+  json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& e : spans)
+  {
+    if (!first)
+      json << ",";
+    first = false;
+    json << "\n{\"name\":\"" << jsonEscape(e.name) << "\",\"cat\":\"" << jsonEscape(e.category)
+      << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadId
+      << ",\"ts\":" << e.startMicroseconds << ",\"dur\":" << e.durationMicroseconds;
+    if (!e.args.empty())
+    {
+      json << ",\"args\":{";
+      for (size_t i = 0; i < e.args.size(); ++i)
+      {
+        if (i > 0)
+          json << ",";
+        json << "\"" << jsonEscape(e.args[i].first) << "\":" << e.args[i].second;
+      }
+      json << "}";
+    }
+    json << "}";
+  }
+  json << "\n]}\n";
+  return json.str();
+}
+
+bool ExecutionTracer::writeChromeTrace(const std::string& file) const
+{
+  std::ofstream out(file);
+  if (!out)
+    return false;
+  out << toChromeTraceJson();
+  return static_cast<bool>(out);
+}
+
+bool ExecutionTracer::writeChromeTrace() const
+{
+  if (outputFile_.empty())
+    return false;
+  return writeChromeTrace(outputFile_);
+}
+
+ScopedTraceSpan::ScopedTraceSpan(const std::string& name, const std::string& category) :
+  active_(ExecutionTracer::Instance().enabled())
+{
+  if (active_)
+  {
+    event_.name = name;
+    event_.category = category;
+    event_.threadId = ExecutionTracer::currentThreadId();
+    event_.startMicroseconds = ExecutionTracer::Instance().nowMicroseconds();
+  }
+}
+
+ScopedTraceSpan::~ScopedTraceSpan()
+{
+  if (active_)
+  {
+    event_.durationMicroseconds = ExecutionTracer::Instance().nowMicroseconds() - event_.startMicroseconds;
+    ExecutionTracer::Instance().record(std::move(event_));
+  }
+}
+
+void ScopedTraceSpan::addArg(const std::string& key, double value)
+{
+  if (active_)
+    event_.args.emplace_back(key, value);
+}
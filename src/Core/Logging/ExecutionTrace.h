@@ -0,0 +1,120 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef CORE_LOGGING_EXECUTIONTRACE_H
+#define CORE_LOGGING_EXECUTIONTRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Core/Utils/Singleton.h>
+#include <Core/Logging/share.h>
+
+namespace SCIRun
+{
+  namespace Core
+  {
+    namespace Logging
+    {
+      /// One complete span on the execution timeline. Times are microseconds
+      /// since the tracer was created; args are shown in the trace viewer's
+      /// detail pane.
+      struct SCISHARE TraceEvent
+      {
+        std::string name;
+        std::string category;
+        long long startMicroseconds{0};
+        long long durationMicroseconds{0};
+        int threadId{0};
+        std::vector<std::pair<std::string, double>> args;
+      };
+
+      /// Collects module and algorithm spans from all executor threads and
+      /// exports them in the Chrome trace event format (chrome://tracing,
+      /// Perfetto). Disabled by default; when disabled every entry point is a
+      /// single relaxed atomic load.
+      class SCISHARE ExecutionTracer final
+      {
+        CORE_SINGLETON(ExecutionTracer)
+      public:
+        ExecutionTracer();
+        void enable(const std::string& outputFile = "");
+        void disable();
+        bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+        const std::string& outputFile() const { return outputFile_; }
+
+        long long nowMicroseconds() const;
+        static int currentThreadId();
+
+        /// Executors call this when a module becomes ready to run; the module
+        /// takes the timestamp back when it starts to compute its queue wait.
+        void markQueued(const std::string& key);
+        std::optional<long long> takeQueuedTime(const std::string& key);
+
+        void record(TraceEvent&& event);
+        std::vector<TraceEvent> events() const;
+        void clear();
+
+        std::string toChromeTraceJson() const;
+        bool writeChromeTrace(const std::string& file) const;
+        /// Writes to the file given to enable(), if any.
+        bool writeChromeTrace() const;
+      private:
+        std::atomic<bool> enabled_{false};
+        std::string outputFile_;
+        const std::chrono::steady_clock::time_point epoch_;
+        mutable std::mutex lock_;
+        std::vector<TraceEvent> events_;
+        std::map<std::string, long long> queued_;
+      };
+
+      /// Records the enclosing scope as a span when tracing is enabled, e.g.
+      /// for the phases of an algorithm.
+      class SCISHARE ScopedTraceSpan
+      {
+      public:
+        explicit ScopedTraceSpan(const std::string& name, const std::string& category = "algorithm");
+        ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+        ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+        ~ScopedTraceSpan();
+        void addArg(const std::string& key, double value);
+      private:
+        bool active_;
+        TraceEvent event_;
+      };
+    }
+  }
+}
+
+#endif
@@ -48,7 +48,7 @@ double SimpleScopedTimer::elapsedSeconds() const
   return elapsedSeconds.count();
 }
 
-ScopedTimeRemarker::ScopedTimeRemarker(LegacyLoggerInterface* log, const std::string& label) : log_(log), label_(label)
+ScopedTimeRemarker::ScopedTimeRemarker(LegacyLoggerInterface* log, const std::string& label) : log_(log), label_(label), span_(label, "timer")
 {}
 
 ScopedTimeRemarker::~ScopedTimeRemarker()
@@ -58,7 +58,7 @@ ScopedTimeRemarker::~ScopedTimeRemarker()
   log_->status(perf.str());
 }
 
-ScopedTimeLogger::ScopedTimeLogger(const std::string& label, bool shouldLog): label_(label), shouldLog_(shouldLog)
+ScopedTimeLogger::ScopedTimeLogger(const std::string& label, bool shouldLog): label_(label), shouldLog_(shouldLog), span_(label, "timer")
 {
   if (shouldLog_)
     LOG_DEBUG("{} starting.", label_);
@@ -34,6 +34,7 @@
 #include <string>
 #include <chrono>
 #include <Core/Logging/LoggerFwd.h>
+#include <Core/Logging/ExecutionTrace.h>
 #include <Core/Logging/share.h>
 
 namespace SCIRun
@@ -62,6 +63,7 @@ namespace SCIRun
         LegacyLoggerInterface* log_;
         std::string label_;
         SimpleScopedTimer timer_;
+        ScopedTraceSpan span_;
       };
 
       class SCISHARE ScopedTimeLogger
@@ -73,6 +75,7 @@ namespace SCIRun
         std::string label_;
         bool shouldLog_;
         SimpleScopedTimer timer_;
+        ScopedTraceSpan span_;
       };
     }
   }
@@ -0,0 +1,126 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <Core/Logging/ExecutionTrace.h>
+#include <thread>
+
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  class ExecutionTraceTests : public ::testing::Test
+  {
+  protected:
+    void SetUp() override
+    {
+      ExecutionTracer::Instance().clear();
+    }
+    void TearDown() override
+    {
+      ExecutionTracer::Instance().disable();
+      ExecutionTracer::Instance().clear();
+    }
+  };
+}
+
+TEST_F(ExecutionTraceTests, DisabledTracerRecordsNothing)
+{
+  ExecutionTracer::Instance().disable();
+  {
+    ScopedTraceSpan span("idle");
+    span.addArg("bytes", 10);
+  }
+  ExecutionTracer::Instance().markQueued("module:0");
+  EXPECT_TRUE(ExecutionTracer::Instance().events().empty());
+  EXPECT_FALSE(ExecutionTracer::Instance().takeQueuedTime("module:0"));
+}
+
+TEST_F(ExecutionTraceTests, RecordsSpansFromSeveralThreads)
+{
+  ExecutionTracer::Instance().enable();
+  ExecutionTracer::Instance().markQueued("module:0");
+  auto work = []
+  {
+    ScopedTraceSpan span("solve", "algorithm");
+    span.addArg("iterations", 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  };
+  std::thread t1(work), t2(work);
+  t1.join();
+  t2.join();
+
+  auto queued = ExecutionTracer::Instance().takeQueuedTime("module:0");
+  ASSERT_TRUE(!!queued);
+  EXPECT_LE(*queued, ExecutionTracer::Instance().nowMicroseconds());
+  EXPECT_FALSE(ExecutionTracer::Instance().takeQueuedTime("module:0"));
+
+  auto events = ExecutionTracer::Instance().events();
+  ASSERT_EQ(2, events.size());
+  EXPECT_NE(events[0].threadId, events[1].threadId);
+  for (const auto& e : events)
+  {
+    EXPECT_EQ("solve", e.name);
+    EXPECT_EQ("algorithm", e.category);
+    EXPECT_GE(e.durationMicroseconds, 2000);
+    ASSERT_EQ(1, e.args.size());
+    EXPECT_EQ("iterations", e.args[0].first);
+  }
+}
+
+TEST_F(ExecutionTraceTests, ExportsChromeTraceFormat)
+{
+  ExecutionTracer::Instance().enable();
+  TraceEvent e;
+  e.name = "ReadField:0 \"quoted\"";
+  e.category = "module";
+  e.startMicroseconds = 10;
+  e.durationMicroseconds = 25;
+  e.threadId = 4;
+  e.args.emplace_back("bytes_out", 1024);
+  ExecutionTracer::Instance().record(std::move(e));
+
+  const std::string expected =
+    "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+    "{\"name\":\"ReadField:0 \\\"quoted\\\"\",\"cat\":\"module\",\"ph\":\"X\",\"pid\":1,\"tid\":4,"
+    "\"ts\":10,\"dur\":25,\"args\":{\"bytes_out\":1024}}\n"
+    "]}\n";
+  EXPECT_EQ(expected, ExecutionTracer::Instance().toChromeTraceJson());
+}
+
+TEST_F(ExecutionTraceTests, EscapesControlCharactersInNames)
+{
+  ExecutionTracer::Instance().enable();
+  TraceEvent e;
+  e.name = "line\tbreak\n\x01";
+  e.category = "module";
+  ExecutionTracer::Instance().record(std::move(e));
+
+  auto json = ExecutionTracer::Instance().toChromeTraceJson();
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"line\\tbreak\\n\\u0001\""));
+}
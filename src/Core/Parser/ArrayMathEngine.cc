@@ -1819,6 +1819,11 @@ NewArrayMathEngine::run()
 }
 
 
+size_t
+NewArrayMathEngine::num_sequential_codes() const
+{
+  return (mprogram_ ? mprogram_->num_sequential_program_codes() : 0);
+}
 
 void
 NewArrayMathEngine::clear()
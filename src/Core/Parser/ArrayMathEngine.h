@@ -187,6 +187,10 @@ class SCISHARE NewArrayMathEngine : public Parser, public ArrayMathInterpreter
     bool get_field(const std::string& name, FieldHandle& field);
     bool get_matrix(const std::string& name, Core::Datatypes::MatrixHandle& matrix);
 
+    // Number of code segments run for every buffer of values, after
+    // element-wise functions have been combined
+    size_t num_sequential_codes() const;
+
     // Clean up the engine
     void clear();
 
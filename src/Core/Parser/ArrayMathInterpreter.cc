@@ -34,6 +34,9 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Thread/Parallel.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Thread;
@@ -47,6 +50,445 @@ ArrayMathFunction::ArrayMathFunction(
 {
 }
 
+// -------------------------------------------------------------------------
+// Fusion of element-wise scalar functions
+//
+// Expressions are translated into one function call per operator, each
+// writing its result into a sequential buffer. Runs of element-wise scalar
+// functions are instead combined into a single code segment, which evaluates
+// the whole run over small tiles kept on the stack and only writes the
+// results that are needed outside of the run.
+
+namespace {
+
+enum FusedOperation
+{
+  FUSED_ADD_E, FUSED_SUB_E, FUSED_MULT_E, FUSED_DIV_E,
+  FUSED_MIN_E, FUSED_MAX_E, FUSED_POW_E,
+  FUSED_NEG_E, FUSED_INV_E, FUSED_ABS_E, FUSED_SQRT_E,
+  FUSED_EXP_E, FUSED_LOG_E, FUSED_SIN_E, FUSED_COS_E,
+  FUSED_FLOOR_E, FUSED_CEIL_E, FUSED_ROUND_E
+};
+
+// Number of values a fused code segment processes per step. Intermediate
+// results need to stay in the L1 cache, while the loops need to be long
+// enough to amortize the dispatch of each instruction
+const size_type FUSED_TILE_SIZE = 128;
+
+// Maximum number of functions combined into one code segment, each function
+// needs at most three variable slots
+const size_t MAX_FUSED_FUNCTIONS = 32;
+const size_t MAX_FUSED_SLOTS = 3*MAX_FUSED_FUNCTIONS;
+
+// Size of the L1 data cache the sequential buffers are sized for
+const size_type L1_CACHE_SIZE = 32768;
+
+struct FusedOperand
+{
+  // Operands are either a variable slot of the program code, pointing to a
+  // sequential buffer, or a tile register of the fused code segment.
+  // Constants and single values are sequenced into buffers holding the same
+  // value for every element, these are broadcast from their first value
+  bool slot = false;
+  bool broadcast = false;
+  size_t index = 0;
+};
+
+struct FusedInstruction
+{
+  FusedOperation operation;
+  size_t num_inputs;
+  FusedOperand input[2];
+  FusedOperand output;
+};
+
+typedef SharedPointer<std::vector<FusedInstruction> > FusedInstructionsHandle;
+
+struct FusedGroup
+{
+  // Range [first,last) of sequential functions replaced by this group
+  size_t first;
+  size_t last;
+  FusedInstructionsHandle instructions;
+  // For each slot, the function and variable index in the original code
+  // segment the buffer pointer is taken from
+  std::vector<std::pair<size_t,size_t> > slots;
+};
+
+bool
+find_fused_operation(const std::string& function_id,
+                     FusedOperation& operation, size_t& num_inputs)
+{
+  // These need to evaluate exactly as the functions in the catalog do
+  static const struct { const char* id; FusedOperation operation; size_t num_inputs; }
+  operations[] = {
+    { "add$S:S", FUSED_ADD_E, 2 }, { "sub$S:S", FUSED_SUB_E, 2 },
+    { "mult$S:S", FUSED_MULT_E, 2 }, { "div$S:S", FUSED_DIV_E, 2 },
+    { "min$S:S", FUSED_MIN_E, 2 }, { "max$S:S", FUSED_MAX_E, 2 },
+    { "pow$S:S", FUSED_POW_E, 2 },
+    { "neg$S", FUSED_NEG_E, 1 }, { "inv$S", FUSED_INV_E, 1 },
+    { "abs$S", FUSED_ABS_E, 1 }, { "sqrt$S", FUSED_SQRT_E, 1 },
+    { "exp$S", FUSED_EXP_E, 1 }, { "log$S", FUSED_LOG_E, 1 },
+    { "ln$S", FUSED_LOG_E, 1 }, { "sin$S", FUSED_SIN_E, 1 },
+    { "cos$S", FUSED_COS_E, 1 }, { "floor$S", FUSED_FLOOR_E, 1 },
+    { "ceil$S", FUSED_CEIL_E, 1 }, { "round$S", FUSED_ROUND_E, 1 }
+  };
+
+  for (const auto& op : operations)
+  {
+    if (function_id == op.id)
+    {
+      operation = op.operation;
+      num_inputs = op.num_inputs;
+      return (true);
+    }
+  }
+  return (false);
+}
+
+// The loops are kept trivial so the compiler can vectorize them, broadcast
+// operands are loaded once and kept in a register
+template <class OP>
+inline void fused_loop(double* r, const double* a, bool sa, size_type n, OP op)
+{
+  if (sa)
+  {
+    const double x = op(a[0]);
+    for (size_type i=0; i<n; i++) r[i] = x;
+  }
+  else
+  {
+    for (size_type i=0; i<n; i++) r[i] = op(a[i]);
+  }
+}
+
+template <class OP>
+inline void fused_loop(double* r, const double* a, bool sa, const double* b, bool sb, size_type n, OP op)
+{
+  if (sa && sb)
+  {
+    const double x = op(a[0],b[0]);
+    for (size_type i=0; i<n; i++) r[i] = x;
+  }
+  else if (sb)
+  {
+    const double y = b[0];
+    for (size_type i=0; i<n; i++) r[i] = op(a[i],y);
+  }
+  else if (sa)
+  {
+    const double x = a[0];
+    for (size_type i=0; i<n; i++) r[i] = op(x,b[i]);
+  }
+  else
+  {
+    for (size_type i=0; i<n; i++) r[i] = op(a[i],b[i]);
+  }
+}
+
+class ArrayMathFusedFunction
+{
+  public:
+    ArrayMathFusedFunction(FusedInstructionsHandle instructions, size_t num_slots) :
+      instructions_(instructions), num_slots_(num_slots) {}
+
+    bool operator()(ArrayMathProgramCode& pc) const;
+
+  private:
+    FusedInstructionsHandle instructions_;
+    size_t num_slots_;
+};
+
+bool
+ArrayMathFusedFunction::operator()(ArrayMathProgramCode& pc) const
+{
+  double* slots[MAX_FUSED_SLOTS];
+  for (size_t j=0; j<num_slots_; j++)
+  {
+    slots[j] = pc.get_variable(j);
+    if (!slots[j]) return (false);
+  }
+
+  double registers[MAX_FUSED_FUNCTIONS][FUSED_TILE_SIZE];
+  const size_type size = pc.get_size();
+
+  for (size_type offset=0; offset<size; offset+=FUSED_TILE_SIZE)
+  {
+    const size_type n = std::min(FUSED_TILE_SIZE,size-offset);
+    auto tile = [&](const FusedOperand& op) -> double*
+    {
+      if (op.broadcast) return (slots[op.index]);
+      return (op.slot ? slots[op.index]+offset : registers[op.index]);
+    };
+
+    for (const FusedInstruction& instr : *instructions_)
+    {
+      double* r = tile(instr.output);
+      const double* a = tile(instr.input[0]);
+      const bool sa = instr.input[0].broadcast;
+      const double* b = (instr.num_inputs > 1) ? tile(instr.input[1]) : a;
+      const bool sb = (instr.num_inputs > 1) ? instr.input[1].broadcast : sa;
+
+      switch (instr.operation)
+      {
+        case FUSED_ADD_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x+y); }); break;
+        case FUSED_SUB_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x-y); }); break;
+        case FUSED_MULT_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x*y); }); break;
+        case FUSED_DIV_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x/y); }); break;
+        case FUSED_MIN_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x < y ? x : y); }); break;
+        case FUSED_MAX_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (x > y ? x : y); }); break;
+        case FUSED_POW_E:
+          fused_loop(r,a,sa,b,sb,n,[](double x, double y) { return (::pow(x,y)); }); break;
+        case FUSED_NEG_E:
+          fused_loop(r,a,sa,n,[](double x) { return (-x); }); break;
+        case FUSED_INV_E:
+          fused_loop(r,a,sa,n,[](double x) { return (1.0/x); }); break;
+        case FUSED_ABS_E:
+          fused_loop(r,a,sa,n,[](double x) { return (x < 0 ? -x : x); }); break;
+        case FUSED_SQRT_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::sqrt(x)); }); break;
+        case FUSED_EXP_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::exp(x)); }); break;
+        case FUSED_LOG_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::log(x)); }); break;
+        case FUSED_SIN_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::sin(x)); }); break;
+        case FUSED_COS_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::cos(x)); }); break;
+        case FUSED_FLOOR_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::floor(x)); }); break;
+        case FUSED_CEIL_E:
+          fused_loop(r,a,sa,n,[](double x) { return (::ceil(x)); }); break;
+        case FUSED_ROUND_E:
+          fused_loop(r,a,sa,n,[](double x) { return (static_cast<double>(static_cast<int>(x+0.5))); }); break;
+      }
+    }
+  }
+
+  return (true);
+}
+
+// Compile the sequential functions [first,last) into one fused group.
+// Results only go to their sequential buffer when read outside of the group,
+// everything else lives in tile registers that are reused once consumed.
+FusedGroup
+compile_fused_group(ParserProgramHandle& pprogram, size_t first, size_t last,
+                    const std::vector<FusedOperation>& operations,
+                    const std::vector<std::vector<size_t> >& readers,
+                    std::vector<bool>& materialized)
+{
+  FusedGroup group;
+  group.first = first;
+  group.last = last;
+  group.instructions.reset(new std::vector<FusedInstruction>);
+
+  ParserScriptFunctionHandle fhandle;
+  size_t num_functions = last-first;
+
+  // Find the last function in the group reading each result
+  std::vector<size_t> last_use(num_functions,0);
+  std::vector<bool> used(num_functions,false);
+  std::map<int,size_t> writer;
+  for (size_t k=first; k<last; k++)
+  {
+    pprogram->get_sequential_function(k,fhandle);
+    for (size_t i=0; i<fhandle->num_input_vars(); i++)
+    {
+      auto it = writer.find(fhandle->get_input_var(i)->get_var_number());
+      if (it != writer.end())
+      {
+        last_use[it->second-first] = k;
+        used[it->second-first] = true;
+      }
+    }
+    writer[fhandle->get_output_var()->get_var_number()] = k;
+  }
+
+  std::map<int,FusedOperand> defined;
+  std::map<int,size_t> defined_by;
+  std::map<int,size_t> input_slots;
+  std::vector<FusedOperand> results(num_functions);
+  std::vector<size_t> free_registers;
+  size_t num_registers = 0;
+
+  for (size_t k=first; k<last; k++)
+  {
+    pprogram->get_sequential_function(k,fhandle);
+
+    FusedInstruction instr;
+    instr.operation = operations[k];
+    instr.num_inputs = fhandle->num_input_vars();
+
+    // Registers read for the last time are only reused after allocating the
+    // output, as overlapping input and output would defeat vectorization
+    std::vector<size_t> released;
+    for (size_t i=0; i<instr.num_inputs; i++)
+    {
+      int vnum = fhandle->get_input_var(i)->get_var_number();
+      auto it = defined.find(vnum);
+      if (it != defined.end())
+      {
+        instr.input[i] = it->second;
+        size_t w = defined_by[vnum]-first;
+        if (last_use[w] == k && !results[w].slot &&
+            std::find(released.begin(),released.end(),results[w].index) == released.end())
+        {
+          released.push_back(results[w].index);
+        }
+      }
+      else
+      {
+        // Only the first value of a sequenced constant is read, so its
+        // buffer does not take up cache space when running the group
+        bool broadcast = (fhandle->get_input_var(i)->get_flags() & SCRIPT_CONST_VAR_E) != 0;
+        auto sit = input_slots.find(vnum);
+        if (sit == input_slots.end())
+        {
+          sit = input_slots.insert(std::make_pair(vnum,group.slots.size())).first;
+          group.slots.push_back(std::make_pair(k,i+1));
+          if (!broadcast) materialized[vnum] = true;
+        }
+        instr.input[i].slot = true;
+        instr.input[i].broadcast = broadcast;
+        instr.input[i].index = sit->second;
+      }
+    }
+
+    // A result is stored if anything outside the group reads it, or if a
+    // function in the group reads the buffer before this result is written
+    int onum = fhandle->get_output_var()->get_var_number();
+    bool store = false;
+    for (size_t r : readers[onum])
+    {
+      if (r < first || r >= last || r <= k) store = true;
+    }
+
+    if (store)
+    {
+      instr.output.slot = true;
+      instr.output.index = group.slots.size();
+      group.slots.push_back(std::make_pair(k,0));
+      materialized[onum] = true;
+    }
+    else if (used[k-first])
+    {
+      instr.output.slot = false;
+      if (free_registers.empty())
+      {
+        instr.output.index = num_registers++;
+      }
+      else
+      {
+        instr.output.index = free_registers.back();
+        free_registers.pop_back();
+      }
+    }
+
+    free_registers.insert(free_registers.end(),released.begin(),released.end());
+
+    // Results that are never used are not computed
+    if (!store && !used[k-first]) continue;
+
+    results[k-first] = instr.output;
+    defined[onum] = instr.output;
+    defined_by[onum] = k;
+    group.instructions->push_back(instr);
+  }
+
+  return (group);
+}
+
+// Find the runs of element-wise scalar functions in the sequential part of
+// the program. Besides the groups, this marks the sequential variables whose
+// buffers are still read or written when running the program.
+void
+find_fused_groups(ParserProgramHandle& pprogram,
+                  std::vector<FusedGroup>& groups,
+                  std::vector<bool>& materialized)
+{
+  size_t num_functions = pprogram->num_sequential_functions();
+  size_t num_variables = pprogram->num_sequential_variables();
+
+  std::vector<bool> fusable(num_functions,false);
+  std::vector<FusedOperation> operations(num_functions);
+  std::vector<std::vector<size_t> > readers(num_variables);
+  materialized.assign(num_variables,false);
+
+  ParserScriptFunctionHandle fhandle;
+  for (size_t j=0; j<num_functions; j++)
+  {
+    pprogram->get_sequential_function(j,fhandle);
+
+    size_t num_inputs = fhandle->num_input_vars();
+    bool scalar_inputs = true;
+    for (size_t i=0; i<num_inputs; i++)
+    {
+      ParserScriptVariableHandle ihandle = fhandle->get_input_var(i);
+      if (ihandle->get_flags() & SCRIPT_SEQUENTIAL_VAR_E)
+        readers[ihandle->get_var_number()].push_back(j);
+      else
+        scalar_inputs = false;
+      if (ihandle->get_type() != "S") scalar_inputs = false;
+    }
+
+    ParserScriptVariableHandle ohandle = fhandle->get_output_var();
+    int oflags = ohandle->get_flags();
+    size_t num_op_inputs = 0;
+    fusable[j] = scalar_inputs && ohandle->get_type() == "S" &&
+      (oflags & SCRIPT_SEQUENTIAL_VAR_E) && !(oflags & SCRIPT_CONST_VAR_E) &&
+      find_fused_operation(fhandle->get_function()->get_function_id(),operations[j],num_op_inputs) &&
+      num_op_inputs == num_inputs;
+  }
+
+  size_t j = 0;
+  while (j < num_functions)
+  {
+    size_t last = j;
+    while (last < num_functions && fusable[last] && last-j < MAX_FUSED_FUNCTIONS) last++;
+
+    if (last-j > 1)
+    {
+      groups.push_back(compile_fused_group(pprogram,j,last,operations,readers,materialized));
+      j = last;
+      continue;
+    }
+
+    // Function is evaluated on its own and uses all of its buffers
+    if (last == j) last = j+1;
+    for (; j<last; j++)
+    {
+      pprogram->get_sequential_function(j,fhandle);
+      ParserScriptVariableHandle ohandle = fhandle->get_output_var();
+      if (ohandle->get_flags() & SCRIPT_SEQUENTIAL_VAR_E)
+        materialized[ohandle->get_var_number()] = true;
+      for (size_t i=0; i<fhandle->num_input_vars(); i++)
+      {
+        ParserScriptVariableHandle ihandle = fhandle->get_input_var(i);
+        if (ihandle->get_flags() & SCRIPT_SEQUENTIAL_VAR_E)
+          materialized[ihandle->get_var_number()] = true;
+      }
+    }
+  }
+}
+
+// Pick the number of values per sequential buffer such that all buffers
+// touched by one pass over the program fit in half of the L1 cache
+size_type
+tuned_buffer_size(size_type values_per_element)
+{
+  size_type buffer_size = (L1_CACHE_SIZE/2)/(sizeof(double)*std::max<size_type>(values_per_element,1));
+  buffer_size -= buffer_size % FUSED_TILE_SIZE;
+  return (std::min<size_type>(std::max<size_type>(buffer_size,FUSED_TILE_SIZE),1024));
+}
+
+} // end namespace
+
 bool
 ArrayMathInterpreter::create_program(ArrayMathProgramHandle& mprogram, std::string& error)
 {
@@ -88,13 +530,22 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
   size_t num_sequential_variables = pprogram->num_sequential_variables();
   size_t num_sequential_functions = pprogram->num_sequential_functions();
 
+  // Combine runs of element-wise functions in the sequential part
+  std::vector<FusedGroup> fused_groups;
+  std::vector<bool> materialized;
+  find_fused_groups(pprogram,fused_groups,materialized);
+
+  size_t num_sequential_codes = num_sequential_functions;
+  for (size_t j=0; j<fused_groups.size(); j++)
+    num_sequential_codes -= fused_groups[j].last-fused_groups[j].first-1;
+
   // Reserve space for const part of the program
   mprogram->resize_const_variables(num_const_variables);
   mprogram->resize_const_functions(num_const_functions);
   mprogram->resize_single_variables(num_single_variables);
   mprogram->resize_single_functions(num_single_functions);
   mprogram->resize_sequential_variables(num_sequential_variables);
-  mprogram->resize_sequential_functions(num_sequential_functions);
+  mprogram->resize_sequential_functions(num_sequential_codes);
 
   // Variable part
   ParserScriptVariableHandle chandle;
@@ -144,6 +595,23 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
     }
   }
 
+  // Size the sequential buffers so the ones used by the program stay in L1
+  if (mprogram->tune_buffer_size())
+  {
+    size_type values_per_element = 0;
+    for (size_t j=0; j<num_sequential_variables; j++)
+    {
+      if (!materialized[j]) continue;
+      pprogram->get_sequential_variable(j,vhandle);
+      std::string type = vhandle->get_type();
+
+      if (type == "S") { values_per_element += 1; }
+      else if (type == "V") { values_per_element += 3; }
+      else if (type == "T") { values_per_element += 6; }
+    }
+    mprogram->set_buffer_size(tuned_buffer_size(values_per_element));
+  }
+
   // Determine how many space we need to reserve for sequential variables
   auto buffer_size = mprogram->get_buffer_size();
   int num_proc    = mprogram->get_num_proc();
@@ -915,6 +1383,7 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
   }
 
   // Process sequential list
+  std::vector<ArrayMathProgramCodePtr> sequential_codes(num_sequential_functions);
   for (int np=0; np< num_proc; np++)
   {
     for (size_t j=0; j<num_sequential_functions; j++)
@@ -1183,7 +1652,32 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
           return (false);
         }
       }
-      mprogram->set_sequential_program_code(j,np,pcPtr);
+      sequential_codes[j] = pcPtr;
+    }
+
+    // Replace the fused functions with one code segment that takes its
+    // buffers from the code segments generated above
+    size_t g = 0;
+    for (size_t j=0, k=0; j<num_sequential_functions; k++)
+    {
+      mprogram->set_sequential_program_line(k,j);
+      if (g < fused_groups.size() && fused_groups[g].first == j)
+      {
+        const FusedGroup& group = fused_groups[g++];
+        ArrayMathProgramCodePtr pcPtr(new ArrayMathProgramCode(
+          ArrayMathFusedFunction(group.instructions,group.slots.size())));
+        for (size_t s=0; s<group.slots.size(); s++)
+        {
+          pcPtr->set_variable(s,sequential_codes[group.slots[s].first]->get_variable(group.slots[s].second));
+        }
+        mprogram->set_sequential_program_code(k,np,pcPtr);
+        j = group.last;
+      }
+      else
+      {
+        mprogram->set_sequential_program_code(k,np,sequential_codes[j]);
+        j++;
+      }
     }
   }
 
@@ -1520,7 +2014,7 @@ ArrayMathProgram::run_sequential(size_t& error_line)
   {
     if (!success_[j])
     {
-      error_line = error_line_[j];
+      error_line = sequential_lines_[error_line_[j]];
       return (false);
     }
   }
@@ -315,8 +315,11 @@ class SCISHARE ArrayMathProgramSource {
     ArrayMathProgram() : num_proc_(Core::Thread::Parallel::NumCores()), barrier_("ArrayMathProgram", num_proc_)
     {
       // Buffer size describes how many values of a sequential variable are
-      // grouped together for vectorized execution
+      // grouped together for vectorized execution. The default is only a
+      // starting point: the interpreter resizes the buffers when translating
+      // so that the sequential part of the program stays in the L1 cache
       buffer_size_ = 128;
+      tune_buffer_size_ = true;
       array_size_ = 1;
     }
 
@@ -329,6 +332,7 @@ class SCISHARE ArrayMathProgramSource {
       // Buffer size describes how many values of a sequential variable are
       // grouped together for vectorized execution
       buffer_size_ = buffer_size;
+      tune_buffer_size_ = false;
       array_size_ = array_size;
     }
 
@@ -337,6 +341,10 @@ class SCISHARE ArrayMathProgramSource {
     // when allocated
     // Get the number of entries that are processed at once
     size_type get_buffer_size() const { return (buffer_size_); }
+    // Whether the buffer size can be adapted to the translated program.
+    // The interpreter only changes it before the buffers are allocated
+    bool tune_buffer_size() const { return (tune_buffer_size_); }
+    void set_buffer_size(size_type buffer_size) { buffer_size_ = buffer_size; }
     // Get the number of processors
     int get_num_proc() const { return (num_proc_); }
 
@@ -378,6 +386,7 @@ class SCISHARE ArrayMathProgramSource {
         sequential_functions_.resize(num_proc_);
         for (int np=0; np < num_proc_; np++)
           sequential_functions_[np].resize(sz);
+        sequential_lines_.resize(sz);
       }
 
     // Central buffer for all parameters
@@ -408,6 +417,13 @@ class SCISHARE ArrayMathProgramSource {
     void set_sequential_program_code(size_t j, size_t np, ArrayMathProgramCodePtr pc)
       { sequential_functions_[np][j] = pc; }
 
+    // Fused code segments cover several functions of the parser program,
+    // hence the line in the parser program is stored for error reporting
+    void set_sequential_program_line(size_t j, size_t line)
+      { sequential_lines_[j] = line; }
+    size_t num_sequential_program_codes() const
+      { return (sequential_lines_.size()); }
+
     // Code to find the pointers that are given for sources and sinks
     bool find_source(const std::string& name,  ArrayMathProgramSource& ps);
     bool find_sink(const std::string& name,  ArrayMathProgramSource& ps);
@@ -424,6 +440,7 @@ class SCISHARE ArrayMathProgramSource {
     // General parameters that determine how many values are computed at
     // the same time and how many processors to use
     size_type buffer_size_;
+    bool tune_buffer_size_;
     int num_proc_;
 
     // The size of the array we are using
@@ -445,6 +462,7 @@ class SCISHARE ArrayMathProgramSource {
     std::vector<ArrayMathProgramCodePtr> const_functions_;
     std::vector<ArrayMathProgramCodePtr> single_functions_;
     std::vector<std::vector<ArrayMathProgramCodePtr> > sequential_functions_;
+    std::vector<size_t> sequential_lines_;
 
     ParserProgramHandle pprogram_;
 
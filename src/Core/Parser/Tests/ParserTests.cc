@@ -33,6 +33,7 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Parser/ArrayMathEngine.h>
+#include <cmath>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
@@ -1404,6 +1405,72 @@ TEST_F(BasicParserTests, CreateFieldData_find_normal2)
   EXPECT_NEAR(19.4422, max,1e-4);
 }
 
+TEST_F(BasicParserTests, FusedArithmeticMatchesDirectEvaluation)
+{
+  // Size is not a multiple of the buffer size, so the last pass is partial
+  const size_t size = 10007;
+  std::vector<double> x(size), y(size), a(size), result(size);
+  for (size_t j = 0; j < size; j++)
+  {
+    x[j] = std::sin(0.01*j);
+    y[j] = 1.5 + std::cos(0.02*j);
+  }
+
+  NewArrayMathEngine engine;
+  ASSERT_TRUE(engine.add_input_double_array("X",&x));
+  ASSERT_TRUE(engine.add_input_double_array("Y",&y));
+  ASSERT_TRUE(engine.add_output_double_array("A",&a));
+  ASSERT_TRUE(engine.add_output_double_array("RESULT",&result));
+
+  // A is needed both as output and by the expression for RESULT
+  std::string function = "A = X*Y - X/Y; B = sqrt(abs(A)) + exp(-X*X); "
+    "RESULT = min(A,B)*2 + max(X,Y) - floor(Y*3)/ceil(X+2);";
+  ASSERT_TRUE(engine.add_expressions(function));
+  ASSERT_TRUE(engine.run());
+
+  for (size_t j = 0; j < size; j++)
+  {
+    double av = x[j]*y[j] - x[j]/y[j];
+    double bv = std::sqrt(std::abs(av)) + std::exp(-x[j]*x[j]);
+    double rv = std::min(av,bv)*2 + std::max(x[j],y[j]) - std::floor(y[j]*3)/std::ceil(x[j]+2);
+    ASSERT_NEAR(av, a[j], 1e-12) << j;
+    ASSERT_NEAR(rv, result[j], 1e-12) << j;
+  }
+}
+
+TEST_F(BasicParserTests, FusedArithmeticBroadcastsConstants)
+{
+  const size_t size = 1001;
+  std::vector<double> x(size), y(size), result(size);
+  std::vector<double> s(1, 0.25);
+  for (size_t j = 0; j < size; j++)
+  {
+    x[j] = std::sin(0.01*j);
+    y[j] = 1.5 + std::cos(0.02*j);
+  }
+
+  NewArrayMathEngine engine;
+  ASSERT_TRUE(engine.add_input_double_array("X",&x));
+  ASSERT_TRUE(engine.add_input_double_array("Y",&y));
+  ASSERT_TRUE(engine.add_input_double_array("S",&s));
+  ASSERT_TRUE(engine.add_output_double_array("RESULT",&result));
+
+  // Literals and the single value S are operands of the fused functions
+  std::string function = "RESULT = min(X,Y)*2 + max(X,Y) - floor(Y*3)/ceil(X+2) + Y^2 - S/(X+2);";
+  ASSERT_TRUE(engine.add_expressions(function));
+  ASSERT_TRUE(engine.run());
+
+  // Reading X and Y, one fused segment for all arithmetic and writing RESULT
+  EXPECT_EQ(4, engine.num_sequential_codes());
+
+  for (size_t j = 0; j < size; j++)
+  {
+    double rv = std::min(x[j],y[j])*2 + std::max(x[j],y[j]) - std::floor(y[j]*3)/std::ceil(x[j]+2)
+      + std::pow(y[j],2) - 0.25/(x[j]+2);
+    ASSERT_NEAR(rv, result[j], 1e-12) << j;
+  }
+}
+
 
 //Run these tests when the functions below are implemented
 /*
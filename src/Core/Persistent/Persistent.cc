@@ -446,11 +446,25 @@ auto_istream(const std::string& filename, LoggerHandle pr)
     // read it from the header.
     auto machine_endian = Piostream::Endian::Little;
 
-    if (file_endian == machine_endian)
+    if (file_endian == machine_endian && version > 1)
+      return PiostreamPtr(new MappedBinaryPiostream(filename, version, pr));
+    else if (file_endian == machine_endian)
       return PiostreamPtr(new BinaryPiostream(filename, Piostream::Direction::Read, version, pr));
     else
       return PiostreamPtr(new BinarySwapPiostream(filename, Piostream::Direction::Read, version,pr));
   }
+  else if (m1 == 'C' && m2 == 'B' && m3 == 'N')
+  {
+    // Chunked files are only written in native (little endian) byte order.
+    if (file_endian != Piostream::Endian::Little)
+    {
+      if (pr) pr->error("Unsupported endianness in compressed file: " + filename);
+      else std::cerr << "ERROR - Unsupported endianness in compressed file: " << filename << std::endl;
+      return PiostreamPtr();
+    }
+    return PiostreamPtr(new ChunkedBinaryPiostream(filename, Piostream::Direction::Read,
+      ChunkedBinaryPiostream::DEFAULT_CHUNK_SIZE, pr));
+  }
   else if (m1 == 'A' && m2 == 'S' && m3 == 'C')
   {
     return PiostreamPtr(new TextPiostream(filename, Piostream::Direction::Read, pr));
@@ -469,6 +483,7 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   // Based on the type string do the following
   //     Binary:  Return a BinaryPiostream
   //     Fast:    Return FastPiostream
+  //     Compressed: Return ChunkedBinaryPiostream
   //     Text:    Return a TextPiostream
   //     Default: Return BinaryPiostream
   // NOTE: Binary will never return BinarySwap so we always write
@@ -485,6 +500,11 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   {
     return makeShared<FastPiostream>(filename, Piostream::Direction::Write, pr);
   }
+  else if (type == "Compressed")
+  {
+    return makeShared<ChunkedBinaryPiostream>(filename, Piostream::Direction::Write,
+      ChunkedBinaryPiostream::DEFAULT_CHUNK_SIZE, pr);
+  }
   else
   {
     return makeShared<BinaryPiostream>(filename, Piostream::Direction::Write, -1, pr);
@@ -554,6 +574,8 @@ Piostream::readHeader( LoggerHandle pr,
   bool is_binary = false;
   if (hdr[4] == 'B' && hdr[5] == 'I' && hdr[6] == 'N' && hdr[7] == '\n')
     is_binary = true;
+  if (hdr[4] == 'C' && hdr[5] == 'B' && hdr[6] == 'N' && hdr[7] == '\n')
+    is_binary = true;
   if(version > 1 && is_binary)
   {
     // can only be BIG or LIT
@@ -171,6 +171,39 @@ void Pio(Piostream& stream, std::vector<T>& data)
   stream.end_class();
 }
 
+/// Same format as Pio for std::vector<T>, for element types that are stored
+/// as their members back to back (Point, Vector): the elements are
+/// transferred with one block_io call when the stream supports it.
+template <class T>
+void Pio_packed(Piostream& stream, std::vector<T>& data)
+{
+  if (stream.reading() && stream.peek_class() == "Array1")
+  {
+    stream.begin_class("Array1", STLVECTOR_VERSION);
+  }
+  else
+  {
+    stream.begin_class("STLVector", STLVECTOR_VERSION);
+  }
+
+  int size=static_cast<int>(data.size());
+  stream.io(size);
+
+  if(stream.reading()){
+    data.resize(size);
+  }
+
+  if (size && !stream.block_io(&data.front(), sizeof(T), data.size()))
+  {
+    for (int i = 0; i < size; i++)
+    {
+      Pio(stream, data[i]);
+    }
+  }
+
+  stream.end_class();
+}
+
 template <class T>
 void Pio(Piostream& stream, std::vector<T*>& data)
 {
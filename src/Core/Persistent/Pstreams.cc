@@ -43,6 +43,7 @@
 #include <Core/Persistent/Pstreams.h>
 #include <Core/Logging/LoggerInterface.h>
 #include <Core/Utils/Legacy/StringUtil.h>
+#include <Core/Thread/Parallel.h>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
 #include <teem/air.h>
@@ -50,6 +51,8 @@
 #include <zlib.h>
 #endif
 
+#include <zlib.h>
+#include <algorithm>
 #include <string.h>
 #include <stdio.h>
 #include <fstream>
@@ -60,6 +63,8 @@
 
 #ifdef _WIN32
 #  include <io.h>
+#else
+#  include <sys/mman.h>
 #endif
 
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -75,7 +80,10 @@ namespace SCIRun {
   BinaryPiostream::BinaryPiostream(const std::string& filename, Direction dir,
     const int& v, LoggerHandle pr)
     : Piostream(dir, v, filename, pr),
-    fp_(nullptr)
+    fp_(nullptr),
+    map_(nullptr),
+    map_size_(0),
+    map_pos_(0)
   {
     if (v == -1) // no version given so use PERSISTENT_VERSION
       version_ = PERSISTENT_VERSION;
@@ -158,7 +166,10 @@ namespace SCIRun {
 BinaryPiostream::BinaryPiostream(int fd, Direction dir, const int& v,
                                  LoggerHandle pr)
   : Piostream(dir, v, "", pr),
-    fp_(nullptr)
+    fp_(nullptr),
+    map_(nullptr),
+    map_size_(0),
+    map_pos_(0)
 {
   if (v == -1) // No version given so use PERSISTENT_VERSION.
     version_ = PERSISTENT_VERSION;
@@ -250,6 +261,12 @@ BinaryPiostream::reset_post_header()
 {
   if (! reading()) return;
 
+  if (map_)
+  {
+    map_pos_ = version() == 1 ? 12 : 16;
+    return;
+  }
+
   fseek(fp_, 0, SEEK_SET);
 
   if (version() == 1)
@@ -276,6 +293,26 @@ BinaryPiostream::endianness()
 }
 
 
+size_t
+BinaryPiostream::read_bytes(void* data, size_t s, size_t nmemb)
+{
+  if (!map_) return fread(data, s, nmemb, fp_);
+
+  const size_t available = (map_size_ - map_pos_) / s;
+  if (nmemb > available) nmemb = available;
+  memcpy(data, map_ + map_pos_, s * nmemb);
+  map_pos_ += s * nmemb;
+  return nmemb;
+}
+
+
+size_t
+BinaryPiostream::write_bytes(const void* data, size_t s, size_t nmemb)
+{
+  return fwrite(data, s, nmemb, fp_);
+}
+
+
 template <class T>
 inline void
 BinaryPiostream::gen_io(T& data, const char *iotype)
@@ -283,7 +320,7 @@ BinaryPiostream::gen_io(T& data, const char *iotype)
   if (err) return;
   if (dir==Direction::Read)
   {
-    if (!fread(&data, sizeof(data), 1, fp_))
+    if (!read_bytes(&data, sizeof(data), 1))
     {
       err = true;
       reporter_->error(std::string("BinaryPiostream error reading ") +
@@ -292,7 +329,7 @@ BinaryPiostream::gen_io(T& data, const char *iotype)
   }
   else
   {
-    if (!fwrite(&data, sizeof(data), 1, fp_))
+    if (!write_bytes(&data, sizeof(data), 1))
     {
       err = true;
       reporter_->error(std::string("BinaryPiostream error writing ") +
@@ -494,14 +531,14 @@ BinaryPiostream::io(std::string& data)
       // to the 4 byte boundary with zeros.
       chars = data.size();
       io(chars);
-      if (!fwrite(data.c_str(), sizeof(char), chars, fp_)) err = true;
+      if (!write_bytes(data.c_str(), sizeof(char), chars)) err = true;
 
       // Pad data out to 4 bytes.
       int extra = chars % 4;
       if (extra)
       {
         static const char pad[4] = {0, 0, 0, 0};
-        if (!fwrite(pad, sizeof(char), 4 - extra, fp_)) err = true;
+        if (!write_bytes(pad, sizeof(char), 4 - extra)) err = true;
       }
     }
     else
@@ -509,7 +546,7 @@ BinaryPiostream::io(std::string& data)
       const char* p = data.c_str();
       chars = static_cast<int>(strlen(p)) + 1;
       io(chars);
-      if (!fwrite(p, sizeof(char), chars, fp_)) err = true;
+      if (!write_bytes(p, sizeof(char), chars)) err = true;
     }
   }
   if (dir == Direction::Read)
@@ -530,7 +567,7 @@ BinaryPiostream::io(std::string& data)
         char* buf = new char[buf_size];
 
         // Read in data plus padding.
-        if (!fread(buf, sizeof(char), buf_size, fp_))
+        if (!read_bytes(buf, sizeof(char), buf_size))
         {
           err = true;
           delete [] buf;
@@ -546,7 +583,7 @@ BinaryPiostream::io(std::string& data)
     else
     {
       char* buf = new char[chars];
-      fread(buf, sizeof(char), chars, fp_);
+      read_bytes(buf, sizeof(char), chars);
       data = std::string(buf);
       delete[] buf;
     }
@@ -560,7 +597,7 @@ BinaryPiostream::block_io(void *data, size_t s, size_t nmemb)
   if (err || version() == 1) { return false; }
   if (dir == Direction::Read)
   {
-    const size_t did = fread(data, s, nmemb, fp_);
+    const size_t did = read_bytes(data, s, nmemb);
     if (did != nmemb)
     {
       err = true;
@@ -569,7 +606,7 @@ BinaryPiostream::block_io(void *data, size_t s, size_t nmemb)
   }
   else
   {
-    const size_t did = fwrite(data, s, nmemb, fp_);
+    const size_t did = write_bytes(data, s, nmemb);
     if (did != nmemb)
     {
       err = true;
@@ -581,6 +618,599 @@ BinaryPiostream::block_io(void *data, size_t s, size_t nmemb)
 
 
 
+////
+// MappedBinaryPiostream -- native endianness, reading only
+MappedBinaryPiostream::MappedBinaryPiostream(const std::string& filename,
+                                             const int& v, LoggerHandle pr)
+  : BinaryPiostream(filename, Direction::Read, v, pr)
+{
+#ifndef _WIN32
+  if (err || version() == 1) return;
+
+  struct stat st;
+  const int fd = fileno(fp_);
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) return;
+
+  void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) return;
+
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  madvise(map, st.st_size, MADV_WILLNEED);
+  map_ = static_cast<const char*>(map);
+  map_size_ = st.st_size;
+  map_pos_ = ftell(fp_);
+#endif
+}
+
+
+MappedBinaryPiostream::~MappedBinaryPiostream()
+{
+#ifndef _WIN32
+  if (map_) munmap(const_cast<char*>(map_), map_size_);
+#endif
+}
+
+
+////
+// ChunkedBinaryPiostream -- native endianness, zlib compressed chunks
+//
+// The file holds the 16 byte header, the compressed chunks, the index and a
+// 16 byte trailer: the file offset of the index followed by "SCICIDX\n". The
+// index stores the chunk size, the uncompressed size, the offset and
+// compressed size of every chunk, and the block table. All chunks but the
+// last hold exactly chunk_size uncompressed bytes. A chunk whose stored size
+// equals its uncompressed size is stored without compression.
+namespace
+{
+  const char CHUNK_INDEX_MAGIC[8] = { 'S', 'C', 'I', 'C', 'I', 'D', 'X', '\n' };
+  const size_t HEADER_SIZE = 16;
+
+  // fseek and ftell take a long, which is 32 bit on Windows, and chunked
+  // files easily grow past 2 GiB.
+  int seek_file(FILE* fp, long long offset, int whence)
+  {
+#ifdef _WIN32
+    return _fseeki64(fp, offset, whence);
+#else
+    return fseeko(fp, static_cast<off_t>(offset), whence);
+#endif
+  }
+
+  long long tell_file(FILE* fp)
+  {
+#ifdef _WIN32
+    return _ftelli64(fp);
+#else
+    return static_cast<long long>(ftello(fp));
+#endif
+  }
+
+  void put_index_value(std::vector<char>& out, unsigned long long value)
+  {
+    const char* p = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), p, p + sizeof(value));
+  }
+
+  class IndexReader
+  {
+  public:
+    IndexReader(const std::vector<char>& index) : p_(index.data()), end_(index.data() + index.size()), ok_(true) {}
+
+    unsigned long long value()
+    {
+      unsigned long long v = 0;
+      if (end_ - p_ < static_cast<std::ptrdiff_t>(sizeof(v))) { ok_ = false; return 0; }
+      memcpy(&v, p_, sizeof(v));
+      p_ += sizeof(v);
+      return v;
+    }
+
+    std::string text()
+    {
+      const auto length = value();
+      if (!ok_ || static_cast<unsigned long long>(end_ - p_) < length) { ok_ = false; return ""; }
+      std::string s(p_, length);
+      p_ += length;
+      return s;
+    }
+
+    bool ok() const { return ok_; }
+  private:
+    const char* p_;
+    const char* end_;
+    bool ok_;
+  };
+}
+
+const size_t ChunkedBinaryPiostream::DEFAULT_CHUNK_SIZE = 1 << 20;
+
+ChunkedBinaryPiostream::ChunkedBinaryPiostream(const std::string& filename,
+                                               Direction dir,
+                                               size_t chunk_size,
+                                               LoggerHandle pr)
+  : BinaryPiostream(filename, dir, -1, pr),
+    chunk_size_(std::max<size_t>(chunk_size, 1)),
+    position_(0),
+    total_size_(0),
+    finished_(false),
+    num_inflated_(0)
+{
+  if (err) return;
+
+  if (dir == Direction::Read)
+  {
+    char hdr[HEADER_SIZE];
+    if (fseek(fp_, 0, SEEK_SET) != 0 || fread(hdr, 1, HEADER_SIZE, fp_) != HEADER_SIZE ||
+        !readHeader(reporter_, filename, hdr, "CBN", version_, file_endian))
+    {
+      reporter_->error("Header read failed.");
+      err = true;
+      return;
+    }
+    if (!read_index())
+    {
+      reporter_->error("Cannot read the chunk index of " + filename + ".");
+      err = true;
+    }
+  }
+  else
+  {
+    // The base class wrote a BIN header, mark the file as chunked.
+    if (fseek(fp_, 4, SEEK_SET) != 0 || fwrite("CBN", 1, 3, fp_) != 3 ||
+        fseek(fp_, HEADER_SIZE, SEEK_SET) != 0)
+    {
+      reporter_->error("Header write failed.");
+      err = true;
+    }
+  }
+}
+
+
+ChunkedBinaryPiostream::~ChunkedBinaryPiostream()
+{
+  if (writing() && !finished_) finish();
+}
+
+
+void
+ChunkedBinaryPiostream::reset_post_header()
+{
+  position_ = 0;
+}
+
+
+size_t
+ChunkedBinaryPiostream::chunk_length(size_t chunk) const
+{
+  return std::min(chunk_size_, total_size_ - chunk * chunk_size_);
+}
+
+
+bool
+ChunkedBinaryPiostream::read_index()
+{
+  char trailer[16];
+  if (seek_file(fp_, -16, SEEK_END) != 0) return false;
+  const long long trailer_offset = tell_file(fp_);
+  if (trailer_offset < 0 || fread(trailer, 1, 16, fp_) != 16 ||
+      memcmp(trailer + 8, CHUNK_INDEX_MAGIC, 8) != 0) return false;
+
+  unsigned long long index_offset;
+  memcpy(&index_offset, trailer, sizeof(index_offset));
+  if (index_offset < HEADER_SIZE ||
+      index_offset > static_cast<unsigned long long>(trailer_offset)) return false;
+
+  std::vector<char> index(trailer_offset - index_offset);
+  if (seek_file(fp_, static_cast<long long>(index_offset), SEEK_SET) != 0 ||
+      fread(index.data(), 1, index.size(), fp_) != index.size()) return false;
+
+  IndexReader in(index);
+  chunk_size_ = in.value();
+  total_size_ = in.value();
+  const auto num_chunks = in.value();
+  if (!in.ok() || chunk_size_ == 0 ||
+      num_chunks != (total_size_ + chunk_size_ - 1) / chunk_size_) return false;
+
+  chunk_offsets_.resize(num_chunks);
+  chunk_bytes_.resize(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i)
+  {
+    chunk_offsets_[i] = in.value();
+    chunk_bytes_[i] = in.value();
+    if (chunk_offsets_[i] + chunk_bytes_[i] > index_offset) return false;
+  }
+
+  const auto num_blocks = in.value();
+  for (size_t i = 0; i < num_blocks && in.ok(); ++i)
+  {
+    Block block;
+    block.offset = in.value();
+    block.element_size = in.value();
+    block.count = in.value();
+    const auto depth = in.value();
+    for (size_t j = 0; j < depth && in.ok(); ++j)
+      block.classes.push_back(in.text());
+    if (block.offset + block.element_size * block.count > total_size_) return false;
+    blocks_.push_back(block);
+  }
+  return in.ok();
+}
+
+
+size_t
+ChunkedBinaryPiostream::write_bytes(const void* data, size_t s, size_t nmemb)
+{
+  if (finished_) return 0;
+  const char* p = static_cast<const char*>(data);
+  pending_.insert(pending_.end(), p, p + s * nmemb);
+  total_size_ += s * nmemb;
+
+  // Compress a few chunks per core at a time.
+  const size_t batch = 2 * std::max(1u, Core::Thread::Parallel::NumCores());
+  if (pending_.size() >= batch * chunk_size_ && !compress_pending(false))
+    return 0;
+  return nmemb;
+}
+
+
+bool
+ChunkedBinaryPiostream::compress_pending(bool all)
+{
+  const size_t full = pending_.size() / chunk_size_;
+  const size_t count = full + ((all && pending_.size() % chunk_size_) ? 1 : 0);
+  if (count == 0) return true;
+
+  std::vector<std::vector<char>> packed(count);
+  std::vector<int> status(count, Z_OK);
+  Core::Thread::Parallel::For(0, count, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const size_t first = i * chunk_size_;
+      const size_t length = std::min(chunk_size_, pending_.size() - first);
+      uLongf packed_size = compressBound(static_cast<uLong>(length));
+      packed[i].resize(packed_size);
+      status[i] = compress2(reinterpret_cast<Bytef*>(packed[i].data()), &packed_size,
+                            reinterpret_cast<const Bytef*>(pending_.data() + first),
+                            static_cast<uLong>(length), Z_BEST_SPEED);
+      // Chunks that do not shrink are stored as is.
+      if (status[i] == Z_OK && packed_size >= length)
+        packed[i].assign(pending_.data() + first, pending_.data() + first + length);
+      else
+        packed[i].resize(packed_size);
+    }
+  });
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (status[i] != Z_OK ||
+        fwrite(packed[i].data(), 1, packed[i].size(), fp_) != packed[i].size())
+    {
+      err = true;
+      reporter_->error("ChunkedBinaryPiostream error writing compressed chunk.");
+      return false;
+    }
+    const unsigned long long offset = chunk_offsets_.empty() ?
+      HEADER_SIZE : chunk_offsets_.back() + chunk_bytes_.back();
+    chunk_offsets_.push_back(offset);
+    chunk_bytes_.push_back(packed[i].size());
+  }
+  pending_.erase(pending_.begin(),
+                 pending_.begin() + std::min(pending_.size(), count * chunk_size_));
+  return true;
+}
+
+
+bool
+ChunkedBinaryPiostream::finish()
+{
+  if (!writing() || finished_) return !err;
+  finished_ = true;
+  if (err || !compress_pending(true)) return false;
+
+  std::vector<char> index;
+  put_index_value(index, chunk_size_);
+  put_index_value(index, total_size_);
+  put_index_value(index, chunk_offsets_.size());
+  for (size_t i = 0; i < chunk_offsets_.size(); ++i)
+  {
+    put_index_value(index, chunk_offsets_[i]);
+    put_index_value(index, chunk_bytes_[i]);
+  }
+  put_index_value(index, blocks_.size());
+  for (const auto& block : blocks_)
+  {
+    put_index_value(index, block.offset);
+    put_index_value(index, block.element_size);
+    put_index_value(index, block.count);
+    put_index_value(index, block.classes.size());
+    for (const auto& name : block.classes)
+    {
+      put_index_value(index, name.size());
+      index.insert(index.end(), name.begin(), name.end());
+    }
+  }
+  put_index_value(index, chunk_offsets_.empty() ?
+    HEADER_SIZE : chunk_offsets_.back() + chunk_bytes_.back());
+  index.insert(index.end(), CHUNK_INDEX_MAGIC, CHUNK_INDEX_MAGIC + 8);
+
+  if (fwrite(index.data(), 1, index.size(), fp_) != index.size() || fflush(fp_) != 0)
+  {
+    err = true;
+    reporter_->error("ChunkedBinaryPiostream error writing chunk index.");
+    return false;
+  }
+  return true;
+}
+
+
+bool
+ChunkedBinaryPiostream::inflate_chunks(const std::vector<std::pair<size_t, char*>>& jobs)
+{
+  if (jobs.empty()) return true;
+
+  // File reads stay serial, only the inflation runs in parallel.
+  std::vector<std::vector<char>> packed(jobs.size());
+  for (size_t i = 0; i < jobs.size(); ++i)
+  {
+    const size_t chunk = jobs[i].first;
+    packed[i].resize(chunk_bytes_[chunk]);
+    if (seek_file(fp_, static_cast<long long>(chunk_offsets_[chunk]), SEEK_SET) != 0 ||
+        fread(packed[i].data(), 1, packed[i].size(), fp_) != packed[i].size())
+    {
+      err = true;
+      reporter_->error("ChunkedBinaryPiostream error reading chunk " + to_string(chunk) + ".");
+      return false;
+    }
+  }
+
+  std::vector<int> status(jobs.size(), Z_OK);
+  Core::Thread::Parallel::For(0, jobs.size(), 1, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const size_t length = chunk_length(jobs[i].first);
+      if (packed[i].size() == length)
+      {
+        memcpy(jobs[i].second, packed[i].data(), length);
+        continue;
+      }
+      uLongf inflated = static_cast<uLongf>(length);
+      status[i] = uncompress(reinterpret_cast<Bytef*>(jobs[i].second), &inflated,
+                             reinterpret_cast<const Bytef*>(packed[i].data()),
+                             static_cast<uLong>(packed[i].size()));
+      if (status[i] == Z_OK && inflated != length) status[i] = Z_DATA_ERROR;
+    }
+  });
+  num_inflated_ += jobs.size();
+
+  for (size_t i = 0; i < jobs.size(); ++i)
+  {
+    if (status[i] != Z_OK)
+    {
+      err = true;
+      reporter_->error("ChunkedBinaryPiostream error inflating chunk " + to_string(jobs[i].first) + ".");
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool
+ChunkedBinaryPiostream::read_range(size_t offset, size_t size, void* data)
+{
+  if (!reading() || err || offset > total_size_ || size > total_size_ - offset) return false;
+  if (size == 0) return true;
+
+  char* out = static_cast<char*>(data);
+  const size_t first = offset / chunk_size_;
+  const size_t last = (offset + size - 1) / chunk_size_;
+  const size_t read_ahead = std::min(4u, std::max(1u, Core::Thread::Parallel::NumCores()));
+
+  // Forget chunks outside the current window before adding new ones.
+  for (auto it = cache_.begin(); it != cache_.end();)
+  {
+    if (it->first < first || it->first > last + read_ahead) it = cache_.erase(it);
+    else ++it;
+  }
+
+  // Chunks the range covers completely are inflated straight into data.
+  // The partially covered ones go through the cache. Small reads also
+  // fetch a few of the following chunks, so value by value reads inflate in
+  // parallel too.
+  std::vector<std::pair<size_t, char*>> jobs;
+  std::vector<size_t> cached;
+  for (size_t chunk = first; chunk <= last; ++chunk)
+  {
+    const size_t begin = chunk * chunk_size_;
+    if (cache_.count(chunk)) continue;
+    if (begin >= offset && begin + chunk_length(chunk) <= offset + size)
+      jobs.emplace_back(chunk, out + (begin - offset));
+    else
+      cached.push_back(chunk);
+  }
+  if (size < chunk_size_ && !cached.empty() && cached.back() == last)
+  {
+    for (size_t chunk = last + 1; chunk < num_chunks() && chunk < last + read_ahead; ++chunk)
+      if (!cache_.count(chunk)) cached.push_back(chunk);
+  }
+  for (auto chunk : cached)
+  {
+    auto& buffer = cache_[chunk];
+    buffer.resize(chunk_length(chunk));
+    jobs.emplace_back(chunk, buffer.data());
+  }
+  if (!inflate_chunks(jobs))
+  {
+    cache_.clear();
+    return false;
+  }
+
+  for (auto it = cache_.lower_bound(first); it != cache_.end() && it->first <= last; ++it)
+  {
+    const size_t begin = it->first * chunk_size_;
+    const size_t from = std::max(begin, offset);
+    const size_t to = std::min(begin + it->second.size(), offset + size);
+    memcpy(out + (from - offset), it->second.data() + (from - begin), to - from);
+  }
+  return true;
+}
+
+
+size_t
+ChunkedBinaryPiostream::read_bytes(void* data, size_t s, size_t nmemb)
+{
+  if (s == 0 || position_ >= total_size_) return 0;
+  nmemb = std::min(nmemb, (total_size_ - position_) / s);
+  if (!read_range(position_, s * nmemb, data)) return 0;
+  position_ += s * nmemb;
+  return nmemb;
+}
+
+
+int
+ChunkedBinaryPiostream::begin_class(const std::string& name, int current_version)
+{
+  const int version = BinaryPiostream::begin_class(name, current_version);
+  classes_.push_back(name);
+  return version;
+}
+
+
+void
+ChunkedBinaryPiostream::end_class()
+{
+  if (!classes_.empty()) classes_.pop_back();
+  BinaryPiostream::end_class();
+}
+
+
+bool
+ChunkedBinaryPiostream::block_io(void* data, size_t s, size_t nmemb)
+{
+  if (writing() && !err && version() > 1)
+  {
+    Block block;
+    block.classes = classes_;
+    block.offset = total_size_;
+    block.element_size = s;
+    block.count = nmemb;
+    blocks_.push_back(block);
+  }
+  return BinaryPiostream::block_io(data, s, nmemb);
+}
+
+
+const ChunkedBinaryPiostream::Block*
+ChunkedBinaryPiostream::find_field_data() const
+{
+  // The values are the container (STLVector, Array2, Array3) that the field
+  // writes itself. Mesh arrays sit one class deeper, inside the mesh.
+  for (const auto& block : blocks_)
+  {
+    const auto& classes = block.classes;
+    if (classes.size() >= 2 &&
+        classes[classes.size() - 2].compare(0, 13, "GenericField<") == 0)
+      return &block;
+  }
+  return nullptr;
+}
+
+
+const ChunkedBinaryPiostream::Block*
+ChunkedBinaryPiostream::find_dense_matrix_data() const
+{
+  for (const auto& block : blocks_)
+  {
+    if (!block.classes.empty() && block.classes.back() == "DenseMatrix")
+      return &block;
+  }
+  return nullptr;
+}
+
+
+const ChunkedBinaryPiostream::Block*
+ChunkedBinaryPiostream::find_sparse_matrix_data(size_t which) const
+{
+  for (size_t i = 0; i < blocks_.size(); ++i)
+  {
+    if (!blocks_[i].classes.empty() && blocks_[i].classes.back() == "SparseRowMatrix")
+    {
+      if (i + which < blocks_.size() && blocks_[i + which].classes == blocks_[i].classes)
+        return &blocks_[i + which];
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+
+bool
+ChunkedBinaryPiostream::read_block(const Block& block, size_t first, size_t count, void* data)
+{
+  if (first > block.count || count > block.count - first) return false;
+  return read_range(block.offset + first * block.element_size,
+                    count * block.element_size, data);
+}
+
+
+size_t
+ChunkedBinaryPiostream::dense_matrix_columns(const Block& block)
+{
+  // DenseMatrix writes nrows and ncols as long long, then the split flag as
+  // an int, right before its values.
+  long long ncols = 0;
+  const size_t header = sizeof(long long) + sizeof(int);
+  if (block.offset < header || !read_range(block.offset - header, sizeof(ncols), &ncols) ||
+      ncols < 0)
+    return 0;
+  return static_cast<size_t>(ncols);
+}
+
+
+bool
+ChunkedBinaryPiostream::read_dense_matrix_rows(size_t first_row, size_t num_rows,
+                                               std::vector<double>& values,
+                                               size_t& ncols)
+{
+  const Block* block = find_dense_matrix_data();
+  if (!block || block->element_size != sizeof(double)) return false;
+  ncols = dense_matrix_columns(*block);
+  if (ncols == 0 || first_row + num_rows > block->count / ncols) return false;
+  values.resize(num_rows * ncols);
+  return read_block(*block, first_row * ncols, num_rows * ncols, values.data());
+}
+
+
+bool
+ChunkedBinaryPiostream::read_sparse_matrix_rows(size_t first_row, size_t num_rows,
+                                                std::vector<index_type>& row_ptr,
+                                                std::vector<index_type>& columns,
+                                                std::vector<double>& values)
+{
+  const Block* rows = find_sparse_matrix_data(0);
+  const Block* cols = find_sparse_matrix_data(1);
+  const Block* vals = find_sparse_matrix_data(2);
+  if (!rows || !cols || !vals ||
+      rows->element_size != sizeof(index_type) ||
+      cols->element_size != sizeof(index_type) ||
+      vals->element_size != sizeof(double) ||
+      first_row + num_rows + 1 > rows->count)
+    return false;
+
+  row_ptr.resize(num_rows + 1);
+  if (!read_block(*rows, first_row, num_rows + 1, row_ptr.data())) return false;
+  const index_type begin = row_ptr.front();
+  for (auto& r : row_ptr) r -= begin;
+  const size_t nnz = static_cast<size_t>(row_ptr.back());
+  columns.resize(nnz);
+  values.resize(nnz);
+  return read_block(*cols, begin, nnz, columns.data()) &&
+         read_block(*vals, begin, nnz, values.data());
+}
+
+
 ////
 // BinarySwapPiostream -- portable
 // Piostream used when endianness of machine and file don't match
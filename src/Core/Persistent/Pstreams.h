@@ -43,6 +43,8 @@
 #include <Core/Persistent/Persistent.h>
 #include <cstdio>
 #include <iosfwd>
+#include <map>
+#include <vector>
 
 #include <Core/Persistent/share.h>
 
@@ -51,9 +53,15 @@ namespace SCIRun {
 class SCISHARE BinaryPiostream : public Piostream {
 protected:
   FILE* fp_;
+  // Read-only view of the whole file, set by MappedBinaryPiostream.
+  const char* map_;
+  size_t map_size_;
+  size_t map_pos_;
 
   virtual const char *endianness();
   void reset_post_header() override;
+  virtual size_t read_bytes(void*, size_t, size_t);
+  virtual size_t write_bytes(const void*, size_t, size_t);
 private:
   template <class T> void gen_io(T&, const char *);
 
@@ -84,6 +92,112 @@ public:
 };
 
 
+/// Reads native-endian binary files (version > 1) out of a read-only memory
+/// mapping instead of through stdio. Values and block arrays are copied
+/// straight from the page cache into their containers, skipping the stdio
+/// buffer and the per-value fread calls. Falls back to stdio reads when the
+/// file cannot be mapped.
+class SCISHARE MappedBinaryPiostream : public BinaryPiostream {
+public:
+  MappedBinaryPiostream(const std::string& filename, const int& v = -1,
+                        Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  virtual ~MappedBinaryPiostream();
+
+  bool mapped() const { return map_ != nullptr; }
+};
+
+
+/// Native-endian binary stream stored as independently zlib-compressed
+/// chunks (header type "CBN"). The uncompressed byte stream is exactly what
+/// BinaryPiostream writes. Chunks are compressed and inflated in parallel,
+/// and an index at the end of the file lists every chunk and every block_io
+/// array, so part of a large array (field values, matrix rows) can be read
+/// without inflating the rest of the file.
+class SCISHARE ChunkedBinaryPiostream : public BinaryPiostream {
+public:
+  /// An array written with block_io.
+  struct Block
+  {
+    /// Names passed to begin_class around the array, outermost first.
+    std::vector<std::string> classes;
+    /// Offset of the first element in the uncompressed stream.
+    size_t offset;
+    size_t element_size;
+    size_t count;
+  };
+
+  static const size_t DEFAULT_CHUNK_SIZE;
+
+  ChunkedBinaryPiostream(const std::string& filename, Direction dir,
+                         size_t chunk_size = DEFAULT_CHUNK_SIZE,
+                         Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  virtual ~ChunkedBinaryPiostream();
+
+  int begin_class(const std::string& name, int current_version) override;
+  void end_class() override;
+  bool block_io(void*, size_t, size_t) override;
+
+  /// Compresses the remaining data and writes the index. Called by the
+  /// destructor if it has not been called before.
+  bool finish();
+
+  size_t chunk_size() const { return chunk_size_; }
+  size_t num_chunks() const { return chunk_offsets_.size(); }
+  size_t num_inflated_chunks() const { return num_inflated_; }
+  const std::vector<Block>& blocks() const { return blocks_; }
+
+  /// Values of the first field in the file (the array written directly by
+  /// a GenericField), or nullptr.
+  const Block* find_field_data() const;
+  /// Values of the first dense matrix in the file, or nullptr.
+  const Block* find_dense_matrix_data() const;
+  /// Row pointers (which == 0), column indices (1) or values (2) of the
+  /// first sparse row matrix in the file, or nullptr.
+  const Block* find_sparse_matrix_data(size_t which) const;
+
+  /// Reads elements [first, first + count) of block, inflating only the
+  /// chunks that hold them.
+  bool read_block(const Block& block, size_t first, size_t count, void* data);
+  /// Reads uncompressed bytes [offset, offset + size).
+  bool read_range(size_t offset, size_t size, void* data);
+
+  /// Number of columns of the dense matrix whose values are block.
+  size_t dense_matrix_columns(const Block& block);
+  /// Reads rows [first_row, first_row + num_rows) of the first dense matrix.
+  bool read_dense_matrix_rows(size_t first_row, size_t num_rows,
+                              std::vector<double>& values, size_t& ncols);
+  /// Reads rows [first_row, first_row + num_rows) of the first sparse row
+  /// matrix. row_ptr is rebased so that row_ptr[0] == 0.
+  bool read_sparse_matrix_rows(size_t first_row, size_t num_rows,
+                               std::vector<index_type>& row_ptr,
+                               std::vector<index_type>& columns,
+                               std::vector<double>& values);
+
+protected:
+  size_t read_bytes(void*, size_t, size_t) override;
+  size_t write_bytes(const void*, size_t, size_t) override;
+
+private:
+  void reset_post_header() override;
+  bool read_index();
+  bool compress_pending(bool all);
+  bool inflate_chunks(const std::vector<std::pair<size_t, char*>>& jobs);
+  size_t chunk_length(size_t chunk) const;
+
+  size_t chunk_size_;
+  size_t position_;
+  size_t total_size_;
+  bool finished_;
+  size_t num_inflated_;
+  std::vector<char> pending_;
+  std::vector<unsigned long long> chunk_offsets_;
+  std::vector<unsigned long long> chunk_bytes_;
+  std::vector<std::string> classes_;
+  std::vector<Block> blocks_;
+  std::map<size_t, std::vector<char>> cache_;
+};
+
+
 class SCISHARE BinarySwapPiostream : public BinaryPiostream {
 protected:
   const char *endianness() override;
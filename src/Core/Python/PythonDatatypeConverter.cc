@@ -33,9 +33,12 @@
 #pragma warning(disable : 4244)
 #endif
 
+#include <Core/Datatypes/DenseColumnMatrix.h>
 #include <Core/Datatypes/DenseMatrix.h>
 // ReSharper disable once CppUnusedIncludeDirective
 #include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/String.h>
@@ -44,10 +47,13 @@
 #include <Core/Python/PythonDatatypeConverter.h>
 #include <Core/Algorithms/Base/VariableHelper.h>
 #include <boost/variant/apply_visitor.hpp>
+#include <cstring>
+#include <type_traits>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Core::Python;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::MatlabIO;
@@ -221,6 +227,259 @@ py::dict toPythonListSparse(const SparseRowMatrixGeneric<T>& sparse)
   list["values"] = values;
   return list;
 }
+
+template <class T>
+const char* bufferFormat()
+{
+  if (std::is_same<T, double>::value) return "d";
+  if (std::is_same<T, float>::value) return "f";
+  if (std::is_same<T, char>::value || std::is_same<T, signed char>::value) return "b";
+  if (std::is_same<T, unsigned char>::value) return "B";
+  if (std::is_same<T, short>::value) return "h";
+  if (std::is_same<T, unsigned short>::value) return "H";
+  if (std::is_same<T, int>::value) return "i";
+  if (std::is_same<T, unsigned int>::value) return "I";
+  if (std::is_same<T, long>::value) return "l";
+  if (std::is_same<T, unsigned long>::value) return "L";
+  if (std::is_same<T, long long>::value) return "q";
+  if (std::is_same<T, unsigned long long>::value) return "Q";
+  return nullptr;
+}
+
+// Python object exporting a block of memory owned by a SCIRun datatype. It stores
+// nothing but the pointer, layout and a shared reference that keeps the memory alive.
+struct ArrayViewStorage
+{
+  SharedPointer<void> owner;
+  DatatypeHandle datatype;
+  void* data;
+  const char* format;
+  Py_ssize_t itemsize;
+  int ndim;
+  Py_ssize_t shape[3];
+  Py_ssize_t strides[3];
+};
+
+struct ArrayViewObject
+{
+  PyObject_HEAD
+  ArrayViewStorage* storage;
+};
+
+int arrayViewGetBuffer(PyObject* self, Py_buffer* view, int flags)
+{
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+  {
+    PyErr_SetString(PyExc_BufferError,
+      "SCIRun array views share the datatype's memory and are read-only; copy the array to modify it.");
+    view->obj = nullptr;
+    return -1;
+  }
+
+  static char empty = 0;
+  auto storage = reinterpret_cast<ArrayViewObject*>(self)->storage;
+  Py_ssize_t length = storage->itemsize;
+  for (int d = 0; d < storage->ndim; ++d)
+    length *= storage->shape[d];
+
+  view->buf = storage->data ? storage->data : &empty;
+  view->obj = self;
+  Py_INCREF(self);
+  view->len = length;
+  view->readonly = 1;
+  view->itemsize = storage->itemsize;
+  view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char*>(storage->format) : nullptr;
+  view->ndim = storage->ndim;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? storage->shape : nullptr;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? storage->strides : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+void arrayViewDealloc(PyObject* self)
+{
+  delete reinterpret_cast<ArrayViewObject*>(self)->storage;
+  Py_TYPE(self)->tp_free(self);
+}
+
+PyTypeObject* arrayViewType()
+{
+  static PyBufferProcs bufferProcs = { arrayViewGetBuffer, nullptr };
+  static PyTypeObject type = { PyVarObject_HEAD_INIT(nullptr, 0) };
+  static bool ready = false;
+  if (!ready)
+  {
+    type.tp_name = "SCIRun.ArrayView";
+    type.tp_basicsize = sizeof(ArrayViewObject);
+    type.tp_flags = Py_TPFLAGS_DEFAULT;
+    type.tp_doc = "Read-only view of SCIRun datatype memory; use numpy.asarray() or memoryview() to access it.";
+    type.tp_dealloc = arrayViewDealloc;
+    type.tp_as_buffer = &bufferProcs;
+    if (PyType_Ready(&type) < 0)
+      py::throw_error_already_set();
+    ready = true;
+  }
+  return &type;
+}
+
+template <class T>
+py::object makeArrayView(SharedPointer<void> owner, DatatypeHandle datatype, const T* data,
+  std::initializer_list<Py_ssize_t> shape)
+{
+  auto object = arrayViewType()->tp_alloc(arrayViewType(), 0);
+  if (!object)
+    py::throw_error_already_set();
+
+  auto storage = new ArrayViewStorage;
+  storage->owner = owner;
+  storage->datatype = datatype;
+  storage->data = const_cast<T*>(data);
+  storage->format = bufferFormat<T>();
+  storage->itemsize = sizeof(T);
+  storage->ndim = static_cast<int>(shape.size());
+  std::copy(shape.begin(), shape.end(), storage->shape);
+  Py_ssize_t stride = sizeof(T);
+  for (int d = storage->ndim - 1; d >= 0; --d)
+  {
+    storage->strides[d] = stride;
+    stride *= storage->shape[d];
+  }
+  reinterpret_cast<ArrayViewObject*>(object)->storage = storage;
+  return py::object(py::handle<>(object));
+}
+
+const ArrayViewStorage* arrayViewStorage(const py::object& object)
+{
+  if (object.ptr() && Py_TYPE(object.ptr()) == arrayViewType())
+    return reinterpret_cast<ArrayViewObject*>(object.ptr())->storage;
+  return nullptr;
+}
+
+// Reads a one- or two-dimensional numeric buffer (numpy array, memoryview, array.array,
+// SCIRun array view) in C order, converting elements to the requested type.
+class PythonBufferReader
+{
+public:
+  explicit PythonBufferReader(const py::object& object)
+  {
+    auto obj = object.ptr();
+    if (obj && !PyBytes_Check(obj) && !PyByteArray_Check(obj) && PyObject_CheckBuffer(obj))
+    {
+      if (0 == PyObject_GetBuffer(obj, &view_, PyBUF_RECORDS_RO))
+        acquired_ = true;
+      else
+        PyErr_Clear();
+    }
+    if (acquired_)
+    {
+      code_ = typeCode(view_.format);
+      valid_ = (view_.ndim == 1 || view_.ndim == 2) && code_ != 0;
+    }
+  }
+
+  ~PythonBufferReader()
+  {
+    if (acquired_)
+      PyBuffer_Release(&view_);
+  }
+
+  PythonBufferReader(const PythonBufferReader&) = delete;
+  PythonBufferReader& operator=(const PythonBufferReader&) = delete;
+
+  bool valid() const { return valid_; }
+  int ndim() const { return view_.ndim; }
+  Py_ssize_t rows() const { return view_.shape[0]; }
+  Py_ssize_t cols() const { return view_.ndim == 2 ? view_.shape[1] : 1; }
+  Py_ssize_t size() const { return rows() * cols(); }
+
+  template <class T>
+  void copyTo(T* dest) const
+  {
+    if (bufferFormat<T>() && code_ == *bufferFormat<T>() && PyBuffer_IsContiguous(&view_, 'C'))
+    {
+      std::memcpy(dest, view_.buf, size() * sizeof(T));
+      return;
+    }
+    const auto base = static_cast<const char*>(view_.buf);
+    const auto colStride = view_.ndim == 2 ? view_.strides[1] : 0;
+    for (Py_ssize_t i = 0; i < rows(); ++i)
+      for (Py_ssize_t j = 0; j < cols(); ++j)
+        *dest++ = element<T>(base + i * view_.strides[0] + j * colStride);
+  }
+
+  template <class T>
+  std::vector<T> toVector() const
+  {
+    std::vector<T> values(size());
+    if (!values.empty())
+      copyTo(&values[0]);
+    return values;
+  }
+
+private:
+  static char typeCode(const char* format)
+  {
+    if (!format)
+      return 'B';
+    if (*format == '@' || *format == '=')
+      ++format;
+#if PY_LITTLE_ENDIAN
+    else if (*format == '<')
+      ++format;
+#else
+    else if (*format == '>' || *format == '!')
+      ++format;
+#endif
+    if (format[0] == 0 || format[1] != 0)
+      return 0;
+    return std::strchr("dfbBhHiIlLqQ", format[0]) ? format[0] : 0;
+  }
+
+  template <class T, class S>
+  static T read(const char* p)
+  {
+    S s;
+    std::memcpy(&s, p, sizeof(S));
+    return static_cast<T>(s);
+  }
+
+  template <class T>
+  T element(const char* p) const
+  {
+    switch (code_)
+    {
+    case 'd': return read<T, double>(p);
+    case 'f': return read<T, float>(p);
+    case 'b': return read<T, signed char>(p);
+    case 'B': return read<T, unsigned char>(p);
+    case 'h': return read<T, short>(p);
+    case 'H': return read<T, unsigned short>(p);
+    case 'i': return read<T, int>(p);
+    case 'I': return read<T, unsigned int>(p);
+    case 'l': return read<T, long>(p);
+    case 'L': return read<T, unsigned long>(p);
+    case 'q': return read<T, long long>(p);
+    case 'Q': return read<T, unsigned long long>(p);
+    default: return T();
+    }
+  }
+
+  Py_buffer view_;
+  bool acquired_ = false;
+  bool valid_ = false;
+  char code_ = 0;
+};
+
+template <class T>
+bool addFieldValues(py::dict& arrays, FieldHandle field, VField* vfield)
+{
+  if (!vfield->is_type(static_cast<T*>(nullptr)))
+    return false;
+  Py_ssize_t nvalues = vfield->num_values();
+  arrays["field"] = makeArrayView(field, field, static_cast<const T*>(vfield->get_values_pointer()), { nvalues });
+  return true;
+}
 }
 
 py::dict SCIRun::Core::Python::wrapDatatypesInMap(
@@ -307,6 +566,128 @@ py::dict SCIRun::Core::Python::convertMatrixToPython(SparseRowMatrixHandle matri
   return {};
 }
 
+py::object SCIRun::Core::Python::convertMatrixToPythonArray(DenseMatrixHandle matrix)
+{
+  if (!matrix) return {};
+  return makeArrayView(matrix, matrix, matrix->data(), { matrix->nrows(), matrix->ncols() });
+}
+
+py::object SCIRun::Core::Python::convertMatrixToPythonArray(DenseColumnMatrixHandle matrix)
+{
+  if (!matrix) return {};
+  return makeArrayView(matrix, matrix, matrix->data(), { matrix->nrows() });
+}
+
+py::dict SCIRun::Core::Python::convertMatrixToPythonArrays(SparseRowMatrixHandle matrix)
+{
+  py::dict arrays;
+  if (!matrix) return arrays;
+
+  // Uncompressed storage has gaps between rows, so export a compressed copy instead.
+  auto csr = matrix;
+  if (!matrix->isCompressed())
+  {
+    csr = makeShared<SparseRowMatrix>(*matrix);
+    csr->makeCompressed();
+  }
+
+  const Py_ssize_t nnz = csr->nonZeros();
+  arrays["nrows"] = csr->nrows();
+  arrays["ncols"] = csr->ncols();
+  arrays["rows"] = makeArrayView(csr, csr, csr->outerIndexPtr(), { csr->outerSize() + 1 });
+  arrays["columns"] = makeArrayView(csr, csr, csr->innerIndexPtr(), { nnz });
+  arrays["values"] = makeArrayView(csr, csr, csr->valuePtr(), { nnz });
+  return arrays;
+}
+
+py::dict SCIRun::Core::Python::convertFieldToPythonArrays(FieldHandle field)
+{
+  static_assert(sizeof(Point) == 3 * sizeof(double), "Point must be three packed doubles");
+  static_assert(sizeof(Vector) == 3 * sizeof(double), "Vector must be three packed doubles");
+
+  py::dict arrays;
+  if (!field) return arrays;
+
+  auto vmesh = field->vmesh();
+  auto vfield = field->vfield();
+
+  const Py_ssize_t nnodes = vmesh->num_nodes();
+  if (vmesh->is_irregularmesh())
+  {
+    arrays["node"] = makeArrayView(field, field,
+      reinterpret_cast<const double*>(vmesh->get_points_pointer()), { nnodes, 3 });
+  }
+  else
+  {
+    auto nodes = makeShared<std::vector<double>>(3 * nnodes);
+    Point p;
+    for (VMesh::Node::index_type i = 0; i < nnodes; ++i)
+    {
+      vmesh->get_center(p, i);
+      std::copy(&p[0], &p[0] + 3, nodes->begin() + 3 * i);
+    }
+    arrays["node"] = makeArrayView(nodes, nullptr, nodes->data(), { nnodes, 3 });
+  }
+
+  if (vmesh->is_unstructuredmesh())
+  {
+    auto elems = vmesh->get_elems_pointer();
+    if (elems)
+    {
+      const Py_ssize_t nelems = vmesh->num_elems();
+      const Py_ssize_t nodesPerElem = vmesh->num_nodes_per_elem();
+      arrays["elem"] = makeArrayView(field, field, elems, { nelems, nodesPerElem });
+    }
+  }
+
+  const Py_ssize_t nvalues = vfield->num_values();
+  if (!vfield->is_nodata() && nvalues > 0)
+  {
+    if (vfield->is_vector())
+    {
+      arrays["field"] = makeArrayView(field, field,
+        static_cast<const double*>(vfield->get_values_pointer()), { nvalues, 3 });
+    }
+    else if (vfield->is_tensor())
+    {
+      auto values = makeShared<std::vector<double>>(9 * nvalues);
+      Tensor t;
+      for (VMesh::index_type i = 0; i < nvalues; ++i)
+      {
+        vfield->get_value(t, i);
+        for (int r = 0; r < 3; ++r)
+          for (int c = 0; c < 3; ++c)
+            (*values)[9 * i + 3 * r + c] = t.val(r, c);
+      }
+      arrays["field"] = makeArrayView(values, nullptr, values->data(), { nvalues, 3, 3 });
+    }
+    else
+    {
+      addFieldValues<double>(arrays, field, vfield) ||
+        addFieldValues<float>(arrays, field, vfield) ||
+        addFieldValues<int>(arrays, field, vfield) ||
+        addFieldValues<unsigned int>(arrays, field, vfield) ||
+        addFieldValues<char>(arrays, field, vfield) ||
+        addFieldValues<unsigned char>(arrays, field, vfield) ||
+        addFieldValues<short>(arrays, field, vfield) ||
+        addFieldValues<unsigned short>(arrays, field, vfield) ||
+        addFieldValues<long>(arrays, field, vfield) ||
+        addFieldValues<unsigned long>(arrays, field, vfield) ||
+        addFieldValues<long long>(arrays, field, vfield) ||
+        addFieldValues<unsigned long long>(arrays, field, vfield);
+    }
+  }
+
+  arrays["basisorder"] = vfield->basis_order();
+  arrays["fieldtype"] = field->type_name();
+  return arrays;
+}
+
+bool SCIRun::Core::Python::isPythonArray(const py::object& object)
+{
+  return PythonBufferReader(object).valid();
+}
+
 py::object SCIRun::Core::Python::convertStringToPython(StringHandle str)
 {
   if (str)
@@ -319,6 +700,9 @@ py::object SCIRun::Core::Python::convertStringToPython(StringHandle str)
 
 bool DenseMatrixExtractor::check() const
 {
+  if (PythonBufferReader(object_).valid())
+    return true;
+
   py::extract<py::list> e(object_);
   if (!e.check()) return false;
 
@@ -334,6 +718,23 @@ bool DenseMatrixExtractor::check() const
 
 DatatypeHandle DenseMatrixExtractor::operator()() const
 {
+  // A view handed out by convertMatrixToPythonArray comes back as the matrix it views.
+  if (auto view = arrayViewStorage(object_))
+  {
+    auto viewed = std::dynamic_pointer_cast<DenseMatrix>(view->datatype);
+    if (viewed && viewed->data() == view->data)
+      return viewed;
+  }
+  {
+    PythonBufferReader buffer(object_);
+    if (buffer.valid())
+    {
+      auto dense = makeShared<DenseMatrix>(buffer.rows(), buffer.cols());
+      buffer.copyTo(dense->data());
+      return dense;
+    }
+  }
+
   DenseMatrixHandle dense;
   py::extract<py::list> e(object_);
   if (e.check())
@@ -377,6 +778,17 @@ DatatypeHandle DenseMatrixExtractor::operator()() const
   return dense;
 }
 
+namespace {
+template <class T>
+std::vector<T> listOrArrayToVector(const py::object& object)
+{
+  PythonBufferReader buffer(object);
+  if (buffer.valid())
+    return buffer.toVector<T>();
+  return to_std_vector<T>(object);
+}
+}
+
 std::set<std::string> SparseRowMatrixExtractor::validKeys_ = {
     "rows", "columns", "values", "nrows", "ncols"};
 
@@ -401,7 +813,7 @@ bool SparseRowMatrixExtractor::check() const
 
     py::extract<py::list> value_i_list(values[i]);
     py::extract<size_t> value_i_int(values[i]);
-    if (!value_i_int.check() && !value_i_list.check()) return false;
+    if (!value_i_int.check() && !value_i_list.check() && !isPythonArray(values[i])) return false;
   }
 
   return true;
@@ -426,12 +838,11 @@ DatatypeHandle SparseRowMatrixExtractor::operator()() const
   {
     py::extract<std::string> key_i(keys[i]);
 
-    py::extract<py::list> value_i_list(values[i]);
     auto fieldName = key_i();
-    if (fieldName == "rows") { rows = to_std_vector<index_type>(value_i_list()); }
+    if (fieldName == "rows") { rows = listOrArrayToVector<index_type>(values[i]); }
     else if (fieldName == "columns")
     {
-      columns = to_std_vector<index_type>(value_i_list());
+      columns = listOrArrayToVector<index_type>(values[i]);
     }
     else if (fieldName == "nrows")
     {
@@ -445,7 +856,7 @@ DatatypeHandle SparseRowMatrixExtractor::operator()() const
     }
     else if (fieldName == "values")
     {
-      matrixValues = to_std_vector<double>(value_i_list());
+      matrixValues = listOrArrayToVector<double>(values[i]);
     }
   }
 
@@ -478,18 +889,33 @@ bool FieldExtractor::check() const
 
     py::extract<std::string> value_i_string(values[i]);
     py::extract<py::list> value_i_list(values[i]);
-    if (!value_i_string.check() && !value_i_list.check()) return false;
+    if (!value_i_string.check() && !value_i_list.check() && !isPythonArray(values[i])) return false;
   }
 
   return true;
 }
 
 namespace {
-matlabarray getPythonFieldDictionaryValue(
-    const py::extract<std::string>& strExtract, const py::extract<py::list>& listExtract)
+matlabarray getPythonFieldDictionaryValue(const py::object& object)
 {
+  const py::extract<std::string> strExtract(object);
+  const py::extract<py::list> listExtract(object);
+  PythonBufferReader buffer(object);
   matlabarray value;
-  if (strExtract.check())
+  if (buffer.valid())
+  {
+    // Same layout as a list of lists: each row of the array is one matlab column.
+    if (1 == buffer.size())
+      value.createdoublescalar(buffer.toVector<double>()[0]);
+    else if (1 == buffer.ndim())
+      value.createdoublevector(buffer.toVector<double>());
+    else
+    {
+      std::vector<int> dims = {static_cast<int>(buffer.cols()), static_cast<int>(buffer.rows())};
+      value.createdoublematrix(buffer.toVector<double>(), dims);
+    }
+  }
+  else if (strExtract.check())
   {
     value.createstringarray();
     auto strData = strExtract();
@@ -551,11 +977,9 @@ DatatypeHandle FieldExtractor::operator()() const
   {
     py::extract<std::string> key_i(keys[i]);
 
-    py::extract<std::string> value_i_string(values[i]);
-    py::extract<py::list> value_i_list(values[i]);
     auto fieldName = key_i();
     // std::cout << "setting field " << fieldName << std::endl;
-    ma.setfield(0, fieldName, getPythonFieldDictionaryValue(value_i_string, value_i_list));
+    ma.setfield(0, fieldName, getPythonFieldDictionaryValue(values[i]));
   }
 
   FieldHandle field;
@@ -578,6 +1002,12 @@ const std::string SCIRun::Core::Python::getClassName(const py::object& object)
 
 Variable SCIRun::Core::Python::convertPythonObjectToVariable(const py::object& object)
 {
+  // Checked first: numpy arrays also pass the int and double conversion checks.
+  if (isPythonArray(object))
+  {
+    DenseMatrixExtractor e(object);
+    return makeDatatypeVariable(e);
+  }
   {
     py::extract<int> e(object);
     if (e.check())
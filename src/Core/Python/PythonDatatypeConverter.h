@@ -91,6 +91,19 @@ namespace SCIRun
       SCISHARE boost::python::list convertMatrixToPython(Datatypes::DenseMatrixHandle matrix);
       SCISHARE boost::python::dict convertMatrixToPython(Datatypes::SparseRowMatrixHandle matrix);
       SCISHARE boost::python::object convertStringToPython(Datatypes::StringHandle str);
+
+      /// Read-only views of a datatype's own storage, exported through the Python buffer
+      /// protocol: memoryview(view) and numpy.asarray(view) share the memory without copying.
+      /// Each view keeps the datatype alive for as long as Python holds a reference to it.
+      SCISHARE boost::python::object convertMatrixToPythonArray(Datatypes::DenseMatrixHandle matrix);
+      SCISHARE boost::python::object convertMatrixToPythonArray(Datatypes::DenseColumnMatrixHandle matrix);
+      /// CSR arrays under "rows", "columns" and "values", plus "nrows" and "ncols".
+      SCISHARE boost::python::dict convertMatrixToPythonArrays(Datatypes::SparseRowMatrixHandle matrix);
+      /// "node" (nnodes x 3), "elem" (nelems x nodes per element, unstructured meshes only)
+      /// and "field" (nvalues, or nvalues x 3 for vectors), plus "basisorder" and "fieldtype".
+      /// Regular mesh nodes and tensor data have no flat storage and are copied.
+      SCISHARE boost::python::dict convertFieldToPythonArrays(FieldHandle field);
+      SCISHARE bool isPythonArray(const boost::python::object& object);
       SCISHARE boost::python::dict wrapDatatypesInMap(
         const std::vector<Datatypes::MatrixHandle>& matrices,
         const std::vector<FieldHandle>& fields,
@@ -35,6 +35,9 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Matlab/matlabconverter.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
 #include <Testing/Utils/SCIRunFieldSamples.h>
@@ -47,6 +50,7 @@
 using namespace SCIRun;
 using namespace SCIRun::Core;
 using namespace Core::Python;
+using namespace Core::Datatypes;
 using namespace Testing;
 using namespace TestUtils;
 
@@ -430,3 +434,197 @@ TEST_F(FieldConversionTests, RejectsIncompatibleDictionary)
 
   ASSERT_FALSE(converter.check());
 }
+
+namespace
+{
+  struct BufferView
+  {
+    explicit BufferView(const boost::python::object& object, int flags = PyBUF_RECORDS_RO)
+    {
+      acquired = 0 == PyObject_GetBuffer(object.ptr(), &view, flags);
+      if (!acquired)
+        PyErr_Clear();
+    }
+    ~BufferView()
+    {
+      if (acquired)
+        PyBuffer_Release(&view);
+    }
+    Py_buffer view;
+    bool acquired;
+  };
+
+  boost::python::object memoryviewOf(const boost::python::object& object)
+  {
+    return boost::python::object(boost::python::handle<>(PyMemoryView_FromObject(object.ptr())));
+  }
+}
+
+TEST_F(FieldConversionTests, DenseMatrixArrayViewSharesStorage)
+{
+  auto m = makeShared<DenseMatrix>(3, 4);
+  for (int i = 0; i < m->size(); ++i)
+    m->data()[i] = i;
+
+  auto pyArray = convertMatrixToPythonArray(m);
+  ASSERT_TRUE(isPythonArray(pyArray));
+
+  BufferView buffer(pyArray);
+  ASSERT_TRUE(buffer.acquired);
+  EXPECT_EQ(m->data(), buffer.view.buf);
+  EXPECT_EQ(2, buffer.view.ndim);
+  EXPECT_EQ(3, buffer.view.shape[0]);
+  EXPECT_EQ(4, buffer.view.shape[1]);
+  EXPECT_EQ(4 * sizeof(double), buffer.view.strides[0]);
+  EXPECT_STREQ("d", buffer.view.format);
+  EXPECT_TRUE(buffer.view.readonly);
+
+  BufferView writable(pyArray, PyBUF_WRITABLE);
+  EXPECT_FALSE(writable.acquired);
+}
+
+TEST_F(FieldConversionTests, DenseMatrixArrayViewKeepsMatrixAlive)
+{
+  auto m = makeShared<DenseMatrix>(DenseMatrix::Identity(5, 5));
+  std::weak_ptr<DenseMatrix> weak(m);
+
+  auto pyArray = convertMatrixToPythonArray(m);
+  m.reset();
+  EXPECT_FALSE(weak.expired());
+
+  pyArray = boost::python::object();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(FieldConversionTests, DenseMatrixArrayViewRoundTripsWithoutCopy)
+{
+  auto m = makeShared<DenseMatrix>(DenseMatrix::Random(6, 2));
+  auto pyArray = convertMatrixToPythonArray(m);
+
+  DenseMatrixExtractor converter(pyArray);
+  ASSERT_TRUE(converter.check());
+  EXPECT_EQ(m, converter());
+}
+
+TEST_F(FieldConversionTests, DenseMatrixFromForeignBuffer)
+{
+  auto m = makeShared<DenseMatrix>(DenseMatrix::Random(6, 2));
+  auto view = memoryviewOf(convertMatrixToPythonArray(m));
+
+  DenseMatrixExtractor converter(view);
+  ASSERT_TRUE(converter.check());
+  auto actual = std::dynamic_pointer_cast<DenseMatrix>(converter());
+  ASSERT_TRUE(actual != nullptr);
+  EXPECT_NE(m->data(), actual->data());
+  EXPECT_EQ(*m, *actual);
+
+  auto var = convertPythonObjectToVariable(view);
+  auto fromVariable = std::dynamic_pointer_cast<DenseMatrix>(var.getDatatype());
+  ASSERT_TRUE(fromVariable != nullptr);
+  EXPECT_EQ(*m, *fromVariable);
+}
+
+TEST_F(FieldConversionTests, ColumnMatrixArrayView)
+{
+  auto c = makeShared<DenseColumnMatrix>(DenseColumnMatrix::LinSpaced(7, 0, 6));
+  auto pyArray = convertMatrixToPythonArray(c);
+
+  BufferView buffer(pyArray);
+  ASSERT_TRUE(buffer.acquired);
+  EXPECT_EQ(c->data(), buffer.view.buf);
+  EXPECT_EQ(1, buffer.view.ndim);
+  EXPECT_EQ(7, buffer.view.shape[0]);
+}
+
+TEST_F(FieldConversionTests, SparseMatrixArraysRoundTrip)
+{
+  DenseMatrix dense(4, 5);
+  dense << 1, 0, 0, 2, 0,
+           0, 0, 3, 0, 0,
+           0, 0, 0, 0, 0,
+           4, 5, 0, 0, 6;
+  auto sparse = toSparseHandle(dense);
+
+  auto pyArrays = convertMatrixToPythonArrays(sparse);
+  {
+    BufferView values(pyArrays["values"]);
+    ASSERT_TRUE(values.acquired);
+    EXPECT_EQ(sparse->valuePtr(), values.view.buf);
+    EXPECT_EQ(sparse->nonZeros(), values.view.shape[0]);
+    BufferView rows(pyArrays["rows"]);
+    ASSERT_TRUE(rows.acquired);
+    EXPECT_EQ(sparse->nrows() + 1, rows.view.shape[0]);
+  }
+
+  SparseRowMatrixExtractor converter(pyArrays);
+  ASSERT_TRUE(converter.check());
+  auto actual = std::dynamic_pointer_cast<SparseRowMatrix>(converter());
+  ASSERT_TRUE(actual != nullptr);
+  EXPECT_TRUE(compare_with_tolerance_readable(*sparse, *actual, 1e-15));
+}
+
+TEST_F(FieldConversionTests, TriSurfArrayViews)
+{
+  auto field = CubeTriSurfLinearBasis(data_info_type::DOUBLE_E);
+  auto vmesh = field->vmesh();
+  auto vfield = field->vfield();
+  auto pyArrays = convertFieldToPythonArrays(field);
+
+  BufferView node(pyArrays["node"]);
+  ASSERT_TRUE(node.acquired);
+  EXPECT_EQ(vmesh->get_points_pointer(), node.view.buf);
+  EXPECT_EQ(vmesh->num_nodes(), node.view.shape[0]);
+  EXPECT_EQ(3, node.view.shape[1]);
+
+  BufferView elem(pyArrays["elem"]);
+  ASSERT_TRUE(elem.acquired);
+  EXPECT_EQ(vmesh->get_elems_pointer(), elem.view.buf);
+  EXPECT_EQ(vmesh->num_elems(), elem.view.shape[0]);
+  EXPECT_EQ(3, elem.view.shape[1]);
+
+  BufferView data(pyArrays["field"]);
+  ASSERT_TRUE(data.acquired);
+  EXPECT_EQ(vfield->get_values_pointer(), data.view.buf);
+  EXPECT_EQ(vfield->num_values(), data.view.shape[0]);
+  EXPECT_STREQ("d", data.view.format);
+}
+
+TEST_F(FieldConversionTests, LatVolNodesAreCopiedFromRegularMesh)
+{
+  auto field = CreateEmptyLatVol(2, 3, 4);
+  auto pyArrays = convertFieldToPythonArrays(field);
+
+  BufferView node(pyArrays["node"]);
+  ASSERT_TRUE(node.acquired);
+  EXPECT_EQ(24, node.view.shape[0]);
+  auto points = static_cast<const double*>(node.view.buf);
+  Geometry::Point p;
+  field->vmesh()->get_center(p, VMesh::Node::index_type(23));
+  EXPECT_EQ(p.x(), points[69]);
+  EXPECT_EQ(p.y(), points[70]);
+  EXPECT_EQ(p.z(), points[71]);
+  EXPECT_FALSE(pyArrays.has_key("elem"));
+}
+
+TEST_F(FieldConversionTests, RoundTripTriSurfWithArrayNodes)
+{
+  auto expected = CubeTriSurfLinearBasis(data_info_type::DOUBLE_E);
+  auto pyField = convertFieldToPython(expected);
+  pyField["node"] = convertFieldToPythonArrays(expected)["node"];
+
+  FieldExtractor converter(pyField);
+  ASSERT_TRUE(converter.check());
+  auto actual = std::dynamic_pointer_cast<Field>(converter());
+  ASSERT_TRUE(actual != nullptr);
+
+  auto expectedMesh = expected->vmesh();
+  auto actualMesh = actual->vmesh();
+  ASSERT_EQ(expectedMesh->num_nodes(), actualMesh->num_nodes());
+  for (VMesh::Node::index_type i = 0; i < expectedMesh->num_nodes(); ++i)
+  {
+    Geometry::Point e, a;
+    expectedMesh->get_center(e, i);
+    actualMesh->get_center(a, i);
+    EXPECT_EQ(e, a);
+  }
+}
@@ -27,6 +27,7 @@
 
 
 #include <Core/Thread/Parallel.h>
+#include <Core/Thread/ThreadPool.h>
 #include <Core/Logging/Log.h>
 #include <vector>
 #include <iostream>
@@ -36,22 +37,12 @@ using namespace SCIRun::Core::Logging;
 
 void Parallel::RunTasks(IndexedTask task, int numProcs)
 {
-  ThreadGroup threads;
-
-  for (unsigned int i = 0; i < capByUserCoreCount(numProcs); ++i)
-  {
-    threads.create_thread(task, i);
-  }
+  ThreadPool::global().runConcurrently(task, capByUserCoreCount(numProcs));
+}
 
-  //try
-  //{
-    threads.join_all();
-  //}
-  //catch (std::thread_interrupted&)
-  //{
-  //  threads.interrupt_all();
-  //  throw;
-  //}
+void Parallel::For(size_t begin, size_t end, size_t grain, const RangeTask& task)
+{
+  ThreadPool::global().parallel_for(begin, end, grain, task, NumCores());
 }
 
 unsigned int Parallel::NumCores()
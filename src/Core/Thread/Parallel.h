@@ -45,7 +45,13 @@ namespace Thread
   {
   public:
     typedef std::function<void(int)> IndexedTask;
+    typedef std::function<void(size_t, size_t)> RangeTask;
+    /// Runs task(0) ... task(numProcs-1) concurrently on pooled threads, so
+    /// the tasks may synchronize with each other through a Barrier.
     static void RunTasks(IndexedTask task, int numProcs);
+    /// Splits [begin, end) into chunks of grain elements that are processed
+    /// by the work-stealing pool on at most NumCores() threads.
+    static void For(size_t begin, size_t end, size_t grain, const RangeTask& task);
     static unsigned int NumCores();
     static void SetMaximumCores(unsigned int max);
   private:
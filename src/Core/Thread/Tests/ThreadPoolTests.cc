@@ -0,0 +1,121 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+
+#include <Core/Thread/ThreadPool.h>
+#include <Core/Thread/Barrier.h>
+
+using namespace SCIRun::Core::Thread;
+
+TEST(ThreadPoolTests, ParallelForCoversRangeExactlyOnce)
+{
+  ThreadPool pool(4);
+  const size_t size = 100003;
+  std::vector<int> hits(size, 0);
+
+  pool.parallel_for(0, size, 1000, [&](size_t b, size_t e)
+  {
+    for (size_t i = b; i < e; ++i)
+      ++hits[i];
+  });
+
+  EXPECT_EQ(size, std::accumulate(hits.begin(), hits.end(), size_t(0)));
+  EXPECT_EQ(1, *std::min_element(hits.begin(), hits.end()));
+  EXPECT_EQ(1, *std::max_element(hits.begin(), hits.end()));
+  EXPECT_EQ(1u, pool.statistics().parallelForCalls);
+}
+
+TEST(ThreadPoolTests, ParallelForRethrowsTaskException)
+{
+  ThreadPool pool(2);
+  EXPECT_THROW(pool.parallel_for(0, 1000, 10, [](size_t b, size_t)
+  {
+    if (b == 500)
+      throw std::runtime_error("chunk failed");
+  }), std::runtime_error);
+}
+
+TEST(ThreadPoolTests, NestedTaskGroupsComplete)
+{
+  ThreadPool pool(3);
+  std::atomic<int> count {0};
+  {
+    TaskGroup outer(pool);
+    for (int i = 0; i < 16; ++i)
+    {
+      outer.run([&pool, &count]()
+      {
+        TaskGroup inner(pool);
+        for (int j = 0; j < 16; ++j)
+          inner.run([&count]() { ++count; });
+        inner.wait();
+      });
+    }
+    outer.wait();
+  }
+  EXPECT_EQ(256, count);
+  EXPECT_EQ(16u + 256u, pool.statistics().tasksExecuted);
+}
+
+TEST(ThreadPoolTests, ConcurrentTasksCanShareBarrier)
+{
+  ThreadPool pool(1);
+  const int numTasks = 8;
+  Barrier barrier("pool barrier test", numTasks);
+  std::vector<int> values(numTasks, 0);
+
+  for (int pass = 0; pass < 3; ++pass)
+  {
+    pool.runConcurrently([&](int i)
+    {
+      values[i] = i;
+      barrier.wait();
+      EXPECT_EQ(numTasks - 1 - i, values[numTasks - 1 - i]);
+      barrier.wait();
+    }, numTasks);
+  }
+
+  // dedicated threads are cached between calls
+  auto stats = pool.statistics();
+  EXPECT_EQ(3u, stats.concurrentRuns);
+  EXPECT_EQ(1u + numTasks - 1, stats.threadsCreated);
+}
+
+TEST(ThreadPoolTests, RunConcurrentlyRethrowsTaskException)
+{
+  ThreadPool pool(1);
+  EXPECT_THROW(pool.runConcurrently([](int i)
+  {
+    if (i == 2)
+      throw std::runtime_error("task failed");
+  }, 4), std::runtime_error);
+}
@@ -0,0 +1,528 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Thread/ThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace SCIRun::Core::Thread;
+
+namespace SCIRun
+{
+namespace Core
+{
+namespace Thread
+{
+  class TaskGroupState
+  {
+  public:
+    void add() { ++pending_; }
+
+    void finish(std::exception_ptr error)
+    {
+      if (error)
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (!error_)
+          error_ = error;
+      }
+      if (--pending_ == 0)
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        done_.notify_all();
+      }
+    }
+
+    bool finished() const { return pending_ == 0; }
+
+    /// Returns false on timeout so the caller can look for work to help with.
+    bool waitFor(std::chrono::milliseconds timeout)
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      return done_.wait_for(lock, timeout, [this]() { return pending_ == 0; });
+    }
+
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    std::exception_ptr takeError()
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      std::exception_ptr error;
+      std::swap(error, error_);
+      return error;
+    }
+
+  private:
+    std::atomic<size_t> pending_ {0};
+    std::mutex lock_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+  };
+
+  class ThreadPoolImpl
+  {
+  public:
+    struct WorkItem
+    {
+      ThreadPool::Task task;
+      std::shared_ptr<TaskGroupState> group;
+    };
+
+    class WorkQueue
+    {
+    public:
+      void push(WorkItem&& item)
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        items_.push_back(std::move(item));
+      }
+
+      bool popBack(WorkItem& item)
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (items_.empty())
+          return false;
+        item = std::move(items_.back());
+        items_.pop_back();
+        return true;
+      }
+
+      bool popFront(WorkItem& item)
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (items_.empty())
+          return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        return true;
+      }
+
+    private:
+      std::mutex lock_;
+      std::deque<WorkItem> items_;
+    };
+
+    struct DedicatedThread
+    {
+      std::thread thread;
+      std::mutex lock;
+      std::condition_variable wakeup;
+      ThreadPool::Task job;
+      ThreadPool::Task done;
+      bool stop {false};
+    };
+
+    explicit ThreadPoolImpl(unsigned int numWorkers);
+    ~ThreadPoolImpl();
+
+    void submit(WorkItem&& item);
+    bool runOne();
+    void helpUntilFinished(TaskGroupState& group);
+    DedicatedThread* acquireDedicatedThread();
+
+    unsigned int numWorkers() const { return static_cast<unsigned int>(queues_.size()); }
+
+    std::atomic<size_t> threadsCreated_ {0};
+    std::atomic<size_t> tasksExecuted_ {0};
+    std::atomic<size_t> tasksStolen_ {0};
+    std::atomic<size_t> parallelForCalls_ {0};
+    std::atomic<size_t> concurrentRuns_ {0};
+
+  private:
+    void workerLoop(int index);
+    void dedicatedLoop(DedicatedThread& self);
+    bool take(WorkItem& item);
+    void execute(WorkItem& item);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    WorkQueue injected_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<size_t> queued_ {0};
+    std::atomic<size_t> stealSeed_ {0};
+    std::mutex sleepLock_;
+    std::condition_variable wakeup_;
+    bool stop_ {false};
+
+    std::mutex dedicatedLock_;
+    std::vector<std::unique_ptr<DedicatedThread>> dedicated_;
+    std::vector<DedicatedThread*> idleDedicated_;
+  };
+}}}
+
+namespace
+{
+  thread_local ThreadPoolImpl* currentPool = nullptr;
+  thread_local int currentWorker = -1;
+}
+
+ThreadPoolImpl::ThreadPoolImpl(unsigned int numWorkers)
+{
+  for (unsigned int i = 0; i < numWorkers; ++i)
+    queues_.emplace_back(new WorkQueue);
+  for (unsigned int i = 0; i < numWorkers; ++i)
+    workers_.emplace_back([this, i]() { workerLoop(i); });
+  threadsCreated_ = numWorkers;
+}
+
+ThreadPoolImpl::~ThreadPoolImpl()
+{
+  {
+    std::lock_guard<std::mutex> guard(sleepLock_);
+    stop_ = true;
+  }
+  wakeup_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+
+  for (auto& thread : dedicated_)
+  {
+    {
+      std::lock_guard<std::mutex> guard(thread->lock);
+      thread->stop = true;
+    }
+    thread->wakeup.notify_one();
+    thread->thread.join();
+  }
+}
+
+void ThreadPoolImpl::workerLoop(int index)
+{
+  currentPool = this;
+  currentWorker = index;
+  while (true)
+  {
+    if (runOne())
+      continue;
+    std::unique_lock<std::mutex> lock(sleepLock_);
+    wakeup_.wait(lock, [this]() { return stop_ || queued_ > 0; });
+    if (stop_ && queued_ == 0)
+      return;
+  }
+}
+
+void ThreadPoolImpl::submit(WorkItem&& item)
+{
+  // count first so that a concurrent take() can never drive queued_ below zero
+  ++queued_;
+  if (currentPool == this)
+    queues_[currentWorker]->push(std::move(item));
+  else
+    injected_.push(std::move(item));
+  {
+    std::lock_guard<std::mutex> guard(sleepLock_);
+  }
+  wakeup_.notify_one();
+}
+
+bool ThreadPoolImpl::take(WorkItem& item)
+{
+  const int self = (currentPool == this) ? currentWorker : -1;
+  if (self >= 0 && queues_[self]->popBack(item))
+  {
+    --queued_;
+    return true;
+  }
+  if (injected_.popFront(item))
+  {
+    --queued_;
+    return true;
+  }
+  const size_t n = queues_.size();
+  const size_t start = (self >= 0) ? static_cast<size_t>(self) + 1 : stealSeed_++;
+  for (size_t k = 0; k < n; ++k)
+  {
+    const size_t victim = (start + k) % n;
+    if (static_cast<int>(victim) == self)
+      continue;
+    if (queues_[victim]->popFront(item))
+    {
+      --queued_;
+      ++tasksStolen_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPoolImpl::execute(WorkItem& item)
+{
+  std::exception_ptr error;
+  try
+  {
+    item.task();
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+  ++tasksExecuted_;
+  item.group->finish(error);
+}
+
+bool ThreadPoolImpl::runOne()
+{
+  WorkItem item;
+  if (!take(item))
+    return false;
+  execute(item);
+  return true;
+}
+
+void ThreadPoolImpl::helpUntilFinished(TaskGroupState& group)
+{
+  while (!group.finished())
+  {
+    if (runOne())
+      continue;
+    // the remaining tasks are running elsewhere; wake up now and then to
+    // pick up tasks they spawn
+    group.waitFor(std::chrono::milliseconds(1));
+  }
+}
+
+ThreadPoolImpl::DedicatedThread* ThreadPoolImpl::acquireDedicatedThread()
+{
+  std::lock_guard<std::mutex> guard(dedicatedLock_);
+  if (!idleDedicated_.empty())
+  {
+    auto thread = idleDedicated_.back();
+    idleDedicated_.pop_back();
+    return thread;
+  }
+  dedicated_.emplace_back(new DedicatedThread);
+  auto thread = dedicated_.back().get();
+  thread->thread = std::thread([this, thread]() { dedicatedLoop(*thread); });
+  ++threadsCreated_;
+  return thread;
+}
+
+void ThreadPoolImpl::dedicatedLoop(DedicatedThread& self)
+{
+  while (true)
+  {
+    ThreadPool::Task job, done;
+    {
+      std::unique_lock<std::mutex> lock(self.lock);
+      self.wakeup.wait(lock, [&self]() { return self.stop || self.job; });
+      if (!self.job)
+        return;
+      std::swap(job, self.job);
+      std::swap(done, self.done);
+    }
+    job();
+    // back in the cache before signaling, so the next caller can reuse it
+    {
+      std::lock_guard<std::mutex> guard(dedicatedLock_);
+      idleDedicated_.push_back(&self);
+    }
+    done();
+  }
+}
+
+ThreadPool::ThreadPool(unsigned int numWorkers) : impl_(new ThreadPoolImpl(numWorkers))
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+ThreadPool& ThreadPool::global()
+{
+  static ThreadPool pool([]()
+  {
+    const unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+  }());
+  return pool;
+}
+
+unsigned int ThreadPool::numWorkers() const
+{
+  return impl_->numWorkers();
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, const RangeTask& task, unsigned int maxConcurrency)
+{
+  if (end <= begin)
+    return;
+  ++impl_->parallelForCalls_;
+
+  if (grain == 0)
+    grain = 1;
+  const size_t numChunks = (end - begin + grain - 1) / grain;
+  const size_t concurrency = maxConcurrency > 0 ? maxConcurrency : numWorkers() + 1;
+  const size_t numRunners = std::min(numChunks, concurrency);
+  if (numRunners <= 1)
+  {
+    task(begin, end);
+    return;
+  }
+
+  // Chunks are handed out dynamically, so uneven chunk costs even out
+  std::atomic<size_t> nextChunk {0};
+  auto runner = [&]()
+  {
+    size_t chunk;
+    while ((chunk = nextChunk++) < numChunks)
+    {
+      const size_t b = begin + chunk * grain;
+      try
+      {
+        task(b, std::min(end, b + grain));
+      }
+      catch (...)
+      {
+        nextChunk = numChunks;
+        throw;
+      }
+    }
+  };
+
+  TaskGroup group(*this);
+  for (size_t r = 1; r < numRunners; ++r)
+    group.run(runner);
+  try
+  {
+    runner();
+  }
+  catch (...)
+  {
+    group.waitNoThrow();
+    throw;
+  }
+  group.wait();
+}
+
+void ThreadPool::runConcurrently(const IndexedTask& task, int numTasks)
+{
+  if (numTasks <= 0)
+    return;
+  ++impl_->concurrentRuns_;
+
+  auto state = std::make_shared<TaskGroupState>();
+  for (int i = 1; i < numTasks; ++i)
+  {
+    state->add();
+    auto thread = impl_->acquireDedicatedThread();
+    auto error = std::make_shared<std::exception_ptr>();
+    {
+      std::lock_guard<std::mutex> guard(thread->lock);
+      thread->job = [task, i, error]()
+      {
+        try
+        {
+          task(i);
+        }
+        catch (...)
+        {
+          *error = std::current_exception();
+        }
+      };
+      thread->done = [state, error]() { state->finish(*error); };
+    }
+    thread->wakeup.notify_one();
+  }
+
+  std::exception_ptr error;
+  try
+  {
+    task(0);
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+  state->wait();
+
+  if (!error)
+    error = state->takeError();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+ThreadPoolStatistics ThreadPool::statistics() const
+{
+  ThreadPoolStatistics stats;
+  stats.workers = impl_->numWorkers();
+  stats.threadsCreated = impl_->threadsCreated_;
+  stats.tasksExecuted = impl_->tasksExecuted_;
+  stats.tasksStolen = impl_->tasksStolen_;
+  stats.parallelForCalls = impl_->parallelForCalls_;
+  stats.concurrentRuns = impl_->concurrentRuns_;
+  return stats;
+}
+
+void ThreadPool::resetStatistics()
+{
+  impl_->threadsCreated_ = 0;
+  impl_->tasksExecuted_ = 0;
+  impl_->tasksStolen_ = 0;
+  impl_->parallelForCalls_ = 0;
+  impl_->concurrentRuns_ = 0;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool_(pool), state_(std::make_shared<TaskGroupState>())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  waitNoThrow();
+}
+
+void TaskGroup::run(ThreadPool::Task task)
+{
+  state_->add();
+  pool_.impl_->submit({ std::move(task), state_ });
+}
+
+void TaskGroup::waitNoThrow()
+{
+  pool_.impl_->helpUntilFinished(*state_);
+}
+
+void TaskGroup::wait()
+{
+  waitNoThrow();
+  auto error = state_->takeError();
+  if (error)
+    std::rethrow_exception(error);
+}
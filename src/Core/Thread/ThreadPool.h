@@ -0,0 +1,120 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_THREAD_THREADPOOL_H
+#define CORE_THREAD_THREADPOOL_H
+
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <memory>
+#include <Core/Thread/share.h>
+
+namespace SCIRun
+{
+namespace Core
+{
+namespace Thread
+{
+  /// Counters are cumulative since construction or the last resetStatistics().
+  struct SCISHARE ThreadPoolStatistics
+  {
+    size_t workers {0};
+    size_t threadsCreated {0};
+    size_t tasksExecuted {0};
+    size_t tasksStolen {0};
+    size_t parallelForCalls {0};
+    size_t concurrentRuns {0};
+  };
+
+  class ThreadPoolImpl;
+  class TaskGroupState;
+
+  /// Persistent work-stealing pool. Every worker owns a deque: it pushes and
+  /// pops its own tasks at the back while idle workers steal from the front.
+  /// Tasks submitted from outside the pool go through a shared queue. Threads
+  /// waiting on a TaskGroup execute pending tasks instead of blocking.
+  ///
+  /// Tasks that synchronize with each other (Barrier) cannot share workers,
+  /// so runConcurrently() hands them to a cache of dedicated threads that is
+  /// grown on demand and reused across calls.
+  class SCISHARE ThreadPool : boost::noncopyable
+  {
+  public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(size_t, size_t)> RangeTask;
+    typedef std::function<void(int)> IndexedTask;
+
+    explicit ThreadPool(unsigned int numWorkers);
+    ~ThreadPool();
+
+    /// Process-wide pool with one worker less than the hardware concurrency,
+    /// the calling thread being the last participant.
+    static ThreadPool& global();
+
+    /// Calls task(b, e) on consecutive sub-ranges of [begin, end) of at most
+    /// grain elements, using at most maxConcurrency threads including the
+    /// caller (0: all workers). Returns once the whole range is processed;
+    /// the first exception thrown by a task is rethrown here.
+    void parallel_for(size_t begin, size_t end, size_t grain, const RangeTask& task,
+      unsigned int maxConcurrency = 0);
+
+    /// Runs task(0) ... task(numTasks-1) on numTasks threads that are all live
+    /// at the same time; task(0) runs on the calling thread.
+    void runConcurrently(const IndexedTask& task, int numTasks);
+
+    unsigned int numWorkers() const;
+    ThreadPoolStatistics statistics() const;
+    void resetStatistics();
+
+  private:
+    friend class TaskGroup;
+    std::unique_ptr<ThreadPoolImpl> impl_;
+  };
+
+  /// Set of tasks scheduled on a pool that can be waited on together.
+  class SCISHARE TaskGroup : boost::noncopyable
+  {
+  public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::global());
+    /// Waits for outstanding tasks; exceptions are dropped, call wait() to see them.
+    ~TaskGroup();
+
+    void run(ThreadPool::Task task);
+    /// Blocks until all tasks finished, rethrowing the first exception.
+    void wait();
+
+  private:
+    friend class ThreadPool;
+    void waitNoThrow();
+    ThreadPool& pool_;
+    std::shared_ptr<TaskGroupState> state_;
+  };
+
+}}}
+
+#endif
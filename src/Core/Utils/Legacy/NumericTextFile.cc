@@ -0,0 +1,280 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/Utils/Legacy/NumericTextFile.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+using namespace SCIRun::Core::Thread;
+
+namespace SCIRun {
+
+namespace
+{
+  /// Read only view of a whole file: mapped into memory where possible,
+  /// read into a buffer otherwise.
+  class FileView
+  {
+    public:
+      explicit FileView(const std::string& filename) :
+        data_(nullptr), size_(0), mapped_(false), ok_(false)
+      {
+#ifndef _WIN32
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+          size_ = static_cast<size_t>(st.st_size);
+          if (size_ == 0)
+          {
+            ok_ = true;
+          }
+          else
+          {
+            void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+              madvise(map, size_, MADV_SEQUENTIAL);
+              data_ = static_cast<const char*>(map);
+              mapped_ = ok_ = true;
+            }
+          }
+        }
+        close(fd);
+        if (ok_) return;
+#endif
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!file) return;
+        buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (file.bad()) return;
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        ok_ = true;
+      }
+
+      ~FileView()
+      {
+#ifndef _WIN32
+        if (mapped_) munmap(const_cast<char*>(data_), size_);
+#endif
+      }
+
+      FileView(const FileView&) = delete;
+      FileView& operator=(const FileView&) = delete;
+
+      bool ok() const { return (ok_); }
+      const char* data() const { return (data_); }
+      size_t size() const { return (size_); }
+
+    private:
+      const char* data_;
+      size_t size_;
+      bool mapped_;
+      bool ok_;
+      std::vector<char> buffer_;
+  };
+
+  inline bool is_separator(char c)
+  {
+    return (c == ' ' || c == '\t' || c == ',' || c == '"' || c == '\r');
+  }
+
+  /// Parses the number at the start of [begin,end) the way strtod does,
+  /// returns false if the word does not start with a number.
+  bool parse_number(const char* begin, const char* end, double& value)
+  {
+#if defined(__cpp_lib_to_chars)
+    const char* p = begin;
+    if (p < end && *p == '+') ++p;
+    const char* digits = (p < end && *p == '-') ? p + 1 : p;
+    const bool hex = (end - digits > 1 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'));
+    if (!hex)
+    {
+      const std::from_chars_result r = std::from_chars(p, end, value);
+      if (r.ec == std::errc()) return (true);
+      if (r.ec == std::errc::invalid_argument) return (false);
+    }
+#endif
+
+    // Hexadecimal and out of range numbers, or no floating point
+    // from_chars: strtod needs a terminated copy of the word
+    const std::string word(begin, end);
+    char* eptr;
+    value = std::strtod(word.c_str(), &eptr);
+    return (eptr != word.c_str());
+  }
+}
+
+
+NumericTextFile::NumericTextFile() :
+  chunk_first_row_(1, 0),
+  chunk_size_(0)
+{
+}
+
+
+bool
+NumericTextFile::read(const std::string& filename)
+{
+  chunks_.clear();
+  chunk_first_row_.assign(1, 0);
+
+  FileView file(filename);
+  if (!file.ok()) return (false);
+
+  const char* data = file.data();
+  const size_t size = file.size();
+
+  // One chunk per core, of at least a megabyte, unless the chunk size is
+  // set. Chunks start at the beginning of a line, so chunks that a long
+  // line covers completely are empty.
+  const size_t min_chunk = 1 << 20;
+  const int num_chunks = static_cast<int>(std::max<size_t>(1, chunk_size_ > 0 ?
+    (size + chunk_size_ - 1) / chunk_size_ :
+    std::min<size_t>(Parallel::NumCores(), size / min_chunk)));
+
+  std::vector<size_t> start(num_chunks + 1, size);
+  start[0] = 0;
+  for (int c = 1; c < num_chunks; ++c)
+  {
+    size_t pos = std::max(start[c - 1], size * c / num_chunks);
+    while (pos < size && pos > 0 && data[pos - 1] != '\n') ++pos;
+    start[c] = pos;
+  }
+
+  chunks_.resize(num_chunks);
+  auto parse_chunk = [&](size_t c)
+  {
+    Chunk& chunk = chunks_[c];
+    const char* p = data + start[c];
+    const char* chunk_end = data + start[c + 1];
+
+    while (p < chunk_end)
+    {
+      const char* line_end = std::find(p, chunk_end, '\n');
+
+      // block out comments
+      if (*p != '#' && *p != '%')
+      {
+        const size_t row_start = chunk.values.size();
+        while (p < line_end)
+        {
+          while (p < line_end && is_separator(*p)) ++p;
+          if (p == line_end) break;
+          const char* word_end = p;
+          while (word_end < line_end && !is_separator(*word_end)) ++word_end;
+
+          double value;
+          if (parse_number(p, word_end, value)) chunk.values.push_back(value);
+          p = word_end;
+        }
+        if (chunk.values.size() > row_start) chunk.row_end.push_back(chunk.values.size());
+      }
+
+      p = line_end + 1;
+    }
+  };
+  Parallel::For(0, num_chunks, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t c = begin; c < end; ++c) parse_chunk(c);
+  });
+
+  chunk_first_row_.resize(num_chunks + 1);
+  for (int c = 0; c < num_chunks; ++c)
+    chunk_first_row_[c + 1] = chunk_first_row_[c] + chunks_[c].row_end.size();
+
+  return (true);
+}
+
+
+size_t
+NumericTextFile::find_chunk(size_t row) const
+{
+  return (std::upper_bound(chunk_first_row_.begin(), chunk_first_row_.end(), row)
+          - chunk_first_row_.begin() - 1);
+}
+
+
+size_t
+NumericTextFile::row_size(size_t row) const
+{
+  const size_t c = find_chunk(row);
+  const size_t r = row - chunk_first_row_[c];
+  const std::vector<size_t>& row_end = chunks_[c].row_end;
+  return (row_end[r] - (r > 0 ? row_end[r - 1] : 0));
+}
+
+
+const double*
+NumericTextFile::row(size_t row) const
+{
+  const size_t c = find_chunk(row);
+  const size_t r = row - chunk_first_row_[c];
+  return (chunks_[c].values.data() + (r > 0 ? chunks_[c].row_end[r - 1] : 0));
+}
+
+
+bool
+NumericTextFile::same_row_size(size_t first_row, size_t& size) const
+{
+  size = 0;
+  for (size_t row = first_row; row < num_rows(); ++row)
+  {
+    const size_t row_values = row_size(row);
+    if (size == 0) size = row_values;
+    else if (row_values != size) return (false);
+  }
+  return (true);
+}
+
+
+bool
+NumericTextFile::contains(double value) const
+{
+  for (size_t c = 0; c < chunks_.size(); ++c)
+  {
+    const std::vector<double>& values = chunks_[c].values;
+    if (std::find(values.begin(), values.end(), value) != values.end()) return (true);
+  }
+  return (false);
+}
+
+} // End namespace SCIRun
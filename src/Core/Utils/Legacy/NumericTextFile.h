@@ -0,0 +1,92 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+///
+///@file  NumericTextFile.h
+///
+///@brief Parallel parser for text files that hold rows of numbers.
+///
+
+#ifndef CORE_UTIL_NUMERICTEXTFILE_H
+#define CORE_UTIL_NUMERICTEXTFILE_H 1
+
+#include <string>
+#include <vector>
+
+#include <Core/Utils/Legacy/share.h>
+
+namespace SCIRun {
+
+/// Reads all the numbers of a text file at once. The file is mapped into
+/// memory, split at line boundaries into one chunk per core and the chunks
+/// are parsed in parallel. The format is the one multiple_from_string
+/// accepts: lines that start with '#' or '%' are comments, spaces, tabs,
+/// commas and quotes separate the numbers, and words that do not start with
+/// a number are skipped. Every line that holds at least one number is a row.
+class SCISHARE NumericTextFile
+{
+  public:
+    NumericTextFile();
+
+    /// Returns false if the file cannot be opened or read.
+    bool read(const std::string& filename);
+
+    /// Splits files into chunks of about this many bytes instead of one
+    /// chunk per core, 0 restores the default.
+    void set_chunk_size(size_t bytes) { chunk_size_ = bytes; }
+
+    size_t num_rows() const { return (chunk_first_row_.back()); }
+    size_t row_size(size_t row) const;
+    /// The values of a row, row_size(row) of them.
+    const double* row(size_t row) const;
+
+    /// True if all rows from first_row on have the same number of values,
+    /// which is returned in size (0 when there are no such rows).
+    bool same_row_size(size_t first_row, size_t& size) const;
+    /// True if any row holds the value.
+    bool contains(double value) const;
+
+  private:
+    struct Chunk
+    {
+      std::vector<double> values;
+      /// End of every row in values.
+      std::vector<size_t> row_end;
+    };
+
+    size_t find_chunk(size_t row) const;
+
+    std::vector<Chunk> chunks_;
+    /// First row of every chunk, followed by the number of rows.
+    std::vector<size_t> chunk_first_row_;
+    size_t chunk_size_;
+};
+
+} // End namespace SCIRun
+
+#endif
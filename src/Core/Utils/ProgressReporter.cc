@@ -38,6 +38,7 @@
 
 #include <Core/Utils/ProgressReporter.h>
 #include <Core/Utils/StringUtil.h>
+#include <iomanip>
 
 using namespace SCIRun::Core::Utility;
 using namespace SCIRun::Core;
@@ -69,3 +70,24 @@ bool SCIRun::Core::replaceSubstring(std::string& str, const std::string& from, c
   str.replace(start_pos, from.length(), to);
   return true;
 }
+
+std::string SCIRun::Core::jsonEscape(const std::string& str)
+{
+  std::ostringstream out;
+  for (auto c : str)
+  {
+    switch (c)
+    {
+    case '"': out << "\\\""; break;
+    case '\\': out << "\\\\"; break;
+    case '\n': out << "\\n"; break;
+    case '\t': out << "\\t"; break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+      else
+        out << c;
+    }
+  }
+  return out.str();
+}
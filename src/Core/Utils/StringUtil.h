@@ -114,6 +114,9 @@ private:
 
 SCISHARE bool replaceSubstring(std::string& str, const std::string& from, const std::string& to);
 
+/// Escapes quotes, backslashes and control characters for use inside a JSON string literal.
+SCISHARE std::string jsonEscape(const std::string& str);
+
 template <typename... T>
 auto zip(const T&... containers) -> boost::iterator_range<boost::zip_iterator<decltype(boost::make_tuple(std::begin(containers)...))>>
 {
@@ -43,6 +43,8 @@
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Datatypes/String.h>
 #include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Matlab/matlabfile.h>
@@ -84,15 +86,23 @@ namespace
       return str_;
     }
 
+    py::object array() const override
+    {
+      return str_;
+    }
+
   private:
     StringHandle underlying_;
     py::object str_;
   };
 
-  class PyDatatypeDenseMatrix : public PyDatatype
+  // Conversions happen on first access: the list form of a large matrix is expensive
+  // to build and is not needed when the script only asks for the array view.
+  template <class Handle>
+  class PyDatatypeLazy : public PyDatatype
   {
   public:
-    explicit PyDatatypeDenseMatrix(DenseMatrixHandle underlying) : underlying_(underlying), pyMat_(convertMatrixToPython(underlying))
+    explicit PyDatatypeLazy(Handle underlying) : underlying_(underlying)
     {
     }
 
@@ -103,56 +113,61 @@ namespace
 
     py::object value() const override
     {
-      return pyMat_;
+      if (!value_)
+        value_ = convertValue();
+      return *value_;
     }
 
-  private:
-    DenseMatrixHandle underlying_;
-    py::list pyMat_;
-  };
-
-  class PyDatatypeSparseRowMatrix : public PyDatatype
-  {
-  public:
-    explicit PyDatatypeSparseRowMatrix(SparseRowMatrixHandle underlying) : underlying_(underlying), pyMat_(convertMatrixToPython(underlying))
+    py::object array() const override
     {
+      if (!array_)
+        array_ = convertArray();
+      return *array_;
     }
 
-    std::string type() const override
-    {
-      return underlying_->dynamic_type_name();
-    }
-
-    py::object value() const override
-    {
-      return pyMat_;
-    }
+  protected:
+    virtual py::object convertValue() const = 0;
+    virtual py::object convertArray() const = 0;
+    Handle underlying_;
 
   private:
-    SparseRowMatrixHandle underlying_;
-    py::dict pyMat_;
+    mutable std::optional<py::object> value_, array_;
   };
 
-  class PyDatatypeField : public PyDatatype
+  class PyDatatypeDenseMatrix : public PyDatatypeLazy<DenseMatrixHandle>
   {
   public:
-    explicit PyDatatypeField(FieldHandle underlying) : underlying_(underlying), matlabStructure_(convertFieldToPython(underlying))
-    {
-    }
+    explicit PyDatatypeDenseMatrix(DenseMatrixHandle underlying) : PyDatatypeLazy(underlying) {}
+  protected:
+    py::object convertValue() const override { return convertMatrixToPython(underlying_); }
+    py::object convertArray() const override { return convertMatrixToPythonArray(underlying_); }
+  };
 
-    std::string type() const override
-    {
-      return underlying_->dynamic_type_name();
-    }
+  class PyDatatypeDenseColumnMatrix : public PyDatatypeLazy<DenseColumnMatrixHandle>
+  {
+  public:
+    explicit PyDatatypeDenseColumnMatrix(DenseColumnMatrixHandle underlying) : PyDatatypeLazy(underlying) {}
+  protected:
+    py::object convertValue() const override { return convertMatrixToPython(convertMatrix::toDense(underlying_)); }
+    py::object convertArray() const override { return convertMatrixToPythonArray(underlying_); }
+  };
 
-    py::object value() const override
-    {
-      return matlabStructure_;
-    }
+  class PyDatatypeSparseRowMatrix : public PyDatatypeLazy<SparseRowMatrixHandle>
+  {
+  public:
+    explicit PyDatatypeSparseRowMatrix(SparseRowMatrixHandle underlying) : PyDatatypeLazy(underlying) {}
+  protected:
+    py::object convertValue() const override { return convertMatrixToPython(underlying_); }
+    py::object convertArray() const override { return convertMatrixToPythonArrays(underlying_); }
+  };
 
-  private:
-    FieldHandle underlying_;
-    py::dict matlabStructure_;
+  class PyDatatypeField : public PyDatatypeLazy<FieldHandle>
+  {
+  public:
+    explicit PyDatatypeField(FieldHandle underlying) : PyDatatypeLazy(underlying) {}
+  protected:
+    py::object convertValue() const override { return convertFieldToPython(underlying_); }
+    py::object convertArray() const override { return convertFieldToPythonArrays(underlying_); }
   };
 
   class PyDatatypeFactory
@@ -170,6 +185,11 @@ namespace
         if (dense)
           return makeShared<PyDatatypeDenseMatrix>(dense);
       }
+      {
+        auto column = std::dynamic_pointer_cast<DenseColumnMatrix>(data);
+        if (column)
+          return makeShared<PyDatatypeDenseColumnMatrix>(column);
+      }
       {
         auto sparse = std::dynamic_pointer_cast<SparseRowMatrix>(data);
         if (sparse)
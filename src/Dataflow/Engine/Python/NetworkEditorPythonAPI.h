@@ -68,6 +68,9 @@ namespace SCIRun {
     //these work on all platforms
     static boost::python::object scirun_get_module_input_value_index(const std::string& moduleId, int portIndex);
     static boost::python::object scirun_get_module_input_value(const std::string& moduleId, const std::string& portName);
+    // same as above, but matrices and fields arrive as read-only arrays sharing SCIRun's memory
+    static boost::python::object scirun_get_module_input_array_index(const std::string& moduleId, int portIndex);
+    static boost::python::object scirun_get_module_input_array(const std::string& moduleId, const std::string& portName);
 
     static boost::python::dict get_input_data(const std::string& moduleId);
     static boost::python::dict get_output_data(const std::string& moduleId);
@@ -30,10 +30,12 @@
 #include <Dataflow/Network/ModuleInterface.h>
 #include <Dataflow/Network/NetworkInterface.h>
 #include <Core/Thread/Parallel.h>
+#include <Core/Logging/ExecutionTrace.h>
 
 using namespace SCIRun::Dataflow::Engine;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Thread;
+using namespace SCIRun::Core::Logging;
 
 namespace
 {
@@ -58,6 +60,7 @@ namespace
         std::transform(groupIter.first, groupIter.second, std::back_inserter(tasks),
           [&](const ParallelModuleExecutionOrder::ModulesByGroup::value_type& mod) -> boost::function<void()>
         {
+          ExecutionTracer::Instance().markQueued(mod.second.id_);
           return [=]() { lookup_->lookupExecutable(mod.second)->executeWithSignals(); };
         });
 
@@ -32,6 +32,10 @@
 #include <Dataflow/Network/NetworkFwd.h>
 #include <boost/next_prior.hpp>
 #include <boost/lockfree/spsc_queue.hpp>
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <Dataflow/Engine/Scheduler/share.h>
 
 namespace SCIRun {
@@ -42,7 +46,50 @@ namespace Engine {
     template <class Unit>
     using WorkQueue = boost::lockfree::spsc_queue<Unit>;
 
-    typedef WorkQueue<Networks::ModuleHandle> ModuleWorkQueue;
+    /// Multi-producer queue whose consumers sleep until a unit is pushed or
+    /// the queue is closed.
+    template <class Unit>
+    class BlockingWorkQueue : boost::noncopyable
+    {
+    public:
+      void push(const Unit& unit)
+      {
+        {
+          std::lock_guard<std::mutex> guard(lock_);
+          units_.push_back(unit);
+        }
+        available_.notify_one();
+      }
+
+      /// Returns false once the queue is closed and drained.
+      bool waitAndPop(Unit& unit)
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        available_.wait(lock, [this]() { return closed_ || !units_.empty(); });
+        if (units_.empty())
+          return false;
+        unit = units_.front();
+        units_.pop_front();
+        return true;
+      }
+
+      void close()
+      {
+        {
+          std::lock_guard<std::mutex> guard(lock_);
+          closed_ = true;
+        }
+        available_.notify_all();
+      }
+
+    private:
+      std::mutex lock_;
+      std::condition_variable available_;
+      std::deque<Unit> units_;
+      bool closed_ {false};
+    };
+
+    typedef BlockingWorkQueue<Networks::ModuleHandle> ModuleWorkQueue;
     typedef SharedPointer<ModuleWorkQueue> ModuleWorkQueuePtr;
 
   }}
@@ -111,39 +111,20 @@ namespace DynamicExecutor {
 
       //log_->trace_if(shouldLog_, "Consumer started.");
 
-      while (!producer_->isDone() || moreWork())
+      Networks::ModuleHandle unit;
+      while (work_->waitAndPop(unit))
       {
-        if (moreWork())
+        if (unit)
         {
-          //log_->trace_if(shouldLog_, "\tConsumer thinks work queue is not empty.");
-          //log_->trace_if(shouldLog_, "\tConsumer accessing front of work queue.");
+          //log_->trace_if(shouldLog_, "~~~Processing {}", unit->get_id());
 
-          Networks::ModuleHandle unit;
-          work_->pop(unit);
-
-          //log_->trace_if(shouldLog_, "\tConsumer popping front of work queue.");
-
-          if (unit)
-          {
-            //log_->trace_if(shouldLog_, "~~~Processing {}", unit->get_id());
-
-            ModuleExecutor executor(unit, lookup_, producer_);
-            executeThreadGroup_->startExecution(executor);
-          }
-          else
-          {
-            //log_->trace_if(shouldLog_, "\tConsumer received null module");
-          }
+          ModuleExecutor executor(unit, lookup_, producer_);
+          executeThreadGroup_->startExecution(executor);
         }
       }
      // log_->trace_if(shouldLog_, "Consumer done.");
     }
 
-    bool moreWork() const
-    {
-      return !work_->empty();
-    }
-
   private:
     ModuleWorkQueuePtr work_;
     ProducerInterfacePtr producer_;
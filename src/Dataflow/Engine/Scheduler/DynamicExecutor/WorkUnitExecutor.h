@@ -47,7 +47,7 @@ namespace SCIRun {
           void run() const
           {
             auto* exec = lookup_->lookupExecutable(module_->id());
-            boost::signals2::scoped_connection s(exec->connectExecuteEnds([this](double, const Networks::ModuleId&) { producer_->enqueueReadyModules(); }));
+            boost::signals2::scoped_connection s(exec->connectExecuteEnds([this](double, const Networks::ModuleId& id) { producer_->moduleFinished(id); }));
             exec->executeWithSignals();
           }
 
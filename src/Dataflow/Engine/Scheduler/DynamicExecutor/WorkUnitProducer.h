@@ -31,112 +31,115 @@
 
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkQueue.h>
 #include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkUnitProducerInterface.h>
-#include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
+#include <Dataflow/Engine/Scheduler/GraphNetworkAnalyzer.h>
 #include <Dataflow/Network/NetworkInterface.h>
-#include <Core/Thread/Mutex.h>
-#include <boost/foreach.hpp>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Core/Logging/Log.h>
+#include <Core/Logging/ExecutionTrace.h>
+#include <atomic>
+#include <map>
 
 #include <Dataflow/Engine/Scheduler/share.h>
 
-#include <iostream>
-
 namespace SCIRun {
   namespace Dataflow {
     namespace Engine {
       namespace DynamicExecutor {
 
+        /// Incremental ready-queue scheduler: every module to execute keeps a
+        /// count of unfinished upstream connections, and a module is pushed
+        /// onto the work queue by the thread that finishes its last upstream
+        /// module. The queue is closed when all modules have finished.
         class SCISHARE ModuleProducer : public ProducerInterface, boost::noncopyable
         {
         public:
           ModuleProducer(const Networks::ModuleFilter& filter,
-            const Networks::NetworkStateInterface* network, Core::Thread::Mutex* lock, ModuleWorkQueuePtr work, size_t numModules) :
-            scheduler_(filter), network_(network), enqueueLock_(lock),
-            work_(work), doneCount_(0), badGroup_(false),
-            //shouldLog_(SCIRun::Core::Logging::Log::get().verbose()),
-            numModules_(numModules)
+            const Networks::NetworkStateInterface* network, ModuleWorkQueuePtr work) :
+            filter_(filter), network_(network), work_(work), finishedCount_(0), numModules_(0)
           {
-            //log_.setVerbose(shouldLog_);
           }
 
-          void enqueueReadyModules() const override
+          /// Builds the dependency counts over the modules passing the filter
+          /// and queues the ones without upstream modules.
+          void start()
           {
-            Core::Thread::Guard g(enqueueLock_->get());
-            if (!isDone())
+            try
             {
-              auto order = scheduler_.schedule(*network_);
-              //if (shouldLog_)
-              //{
-              //  log_->trace("Producer received this ordering: \n{}\nProducer processing min group {}", order, order.minGroup());
-              //}
-              if (order.minGroup() < 0)
-              {
-                badGroup_ = true;
-              }
-              auto groupIter = order.getGroup(order.minGroup());
-              BOOST_FOREACH(const ParallelModuleExecutionOrder::ModulesByGroup::value_type& mod, groupIter)
+              NetworkGraphAnalyzer graphAnalyzer(*network_, filter_, true);
+              const auto& g = graphAnalyzer.graph();
+
+              numModules_ = graphAnalyzer.moduleCount();
+              modules_.resize(numModules_);
+              downstream_.assign(numModules_, {});
+              remainingUpstream_.reset(new std::atomic<int>[numModules_]);
+
+              for (size_t v = 0; v < numModules_; ++v)
               {
-                auto module = network_->lookupModule(mod.second);
-
-                if (module->executionState().currentState() == Networks::ModuleExecutionState::Value::Waiting)
-                {
-                  //if (shouldLog_)
-                  //  log_->trace("Producer pushing module {}", mod.second);
-
-                  if (doneIds_.find(mod.second) != doneIds_.end())
-                  {
-                    //if (shouldLog_)
-                    //  log_->info("Module producer: wants to enqueue module {} a second time. {}", mod.second, id_);
-                  }
-                  else
-                  {
-                    work_->push(module);
-                    doneIds_.insert(mod.second);
-                    doneCount_.fetch_add(1);
-
-                    //if (shouldLog_)
-                    //  log_->trace("Producer status: {} {} out of {}", id_, doneCount_, numModules_);
-                  }
-                }
+                const auto& id = graphAnalyzer.moduleAt(v);
+                vertexLookup_[id] = v;
+                modules_[v] = network_->lookupModule(id);
+                remainingUpstream_[v] = static_cast<int>(boost::in_degree(v, g));
+
+                NetworkGraph::DirectedGraph::out_edge_iterator e, e_end;
+                for (boost::tie(e, e_end) = boost::out_edges(v, g); e != e_end; ++e)
+                  downstream_[v].push_back(static_cast<int>(boost::target(*e, g)));
               }
             }
-          }
+            catch (NetworkHasCyclesException&)
+            {
+              logCritical("Dynamic executor: network has cycles, nothing will be executed.");
+              numModules_ = 0;
+            }
 
-          void operator()() const
-          {
-            id_ = std::this_thread::get_id();
+            if (numModules_ == 0)
+            {
+              work_->close();
+              return;
+            }
 
-            //log_->trace_if(shouldLog_, "Producer started {}", id_);
+            for (size_t v = 0; v < numModules_; ++v)
+            {
+              if (remainingUpstream_[v] == 0)
+                enqueue(v);
+            }
+          }
 
-            enqueueReadyModules();
+          void moduleFinished(const Networks::ModuleId& id) override
+          {
+            auto vertex = vertexLookup_.find(id);
+            if (vertex == vertexLookup_.end())
+              return;
 
-            while (!badGroup_ && !isDone())
+            for (auto next : downstream_[vertex->second])
             {
-              std::this_thread::sleep_for(std::chrono::milliseconds(100));
-              //std::cout << "producer thread waiting " << id_ << std::endl;
+              if (--remainingUpstream_[next] == 0)
+                enqueue(next);
             }
 
-            if (badGroup_)
-              logCritical("producer is done with bad group, something went wrong. probably a race condition...");
-
-            //log_->trace_if(shouldLog_, "Producer is done. {}", id_);
+            if (++finishedCount_ == numModules_)
+              work_->close();
           }
 
           bool isDone() const override
           {
-            return doneCount_ >= numModules_;
+            return finishedCount_ >= numModules_;
           }
         private:
-          BoostGraphParallelScheduler scheduler_;
+          void enqueue(size_t vertex)
+          {
+            Core::Logging::ExecutionTracer::Instance().markQueued(modules_[vertex]->id().id_);
+            work_->push(modules_[vertex]);
+          }
+
+          Networks::ModuleFilter filter_;
           const Networks::NetworkStateInterface* network_;
-          Core::Thread::Mutex* enqueueLock_;
           ModuleWorkQueuePtr work_;
-          mutable boost::atomic<int> doneCount_;
-          mutable bool badGroup_;
-          mutable std::set<Networks::ModuleId> doneIds_;
-          //static Core::Logging::Logger2 log_;
-          //bool shouldLog_;
+          std::map<Networks::ModuleId, size_t> vertexLookup_;
+          std::vector<Networks::ModuleHandle> modules_;
+          std::vector<std::vector<int>> downstream_;
+          std::unique_ptr<std::atomic<int>[]> remainingUpstream_;
+          std::atomic<size_t> finishedCount_;
           size_t numModules_;
-          mutable std::thread::id id_;
         };
 
         typedef SharedPointer<ModuleProducer> ModuleProducerPtr;
@@ -29,6 +29,7 @@
 #ifndef ENGINE_SCHEDULER_DYNAMICEXECUTOR_WORKUNITPRODUCERINTERFACE_H
 #define ENGINE_SCHEDULER_DYNAMICEXECUTOR_WORKUNITPRODUCERINTERFACE_H
 
+#include <Dataflow/Network/NetworkFwd.h>
 #include <Dataflow/Engine/Scheduler/share.h>
 
 namespace SCIRun {
@@ -41,7 +42,7 @@ namespace SCIRun {
         public:
           virtual ~ProducerInterface() {}
           virtual bool isDone() const = 0;
-          virtual void enqueueReadyModules() const = 0;
+          virtual void moduleFinished(const Networks::ModuleId& id) = 0;
         };
 
         typedef SharedPointer<ProducerInterface> ProducerInterfacePtr;
@@ -53,13 +53,13 @@ namespace SCIRun {
       {
       public:
         DynamicMultithreadedNetworkExecutorImpl(const ExecutionContext& context, const NetworkStateInterface* network,
-          Mutex* lock, size_t numModules, Mutex* executionLock, DynamicExecutor::ExecutionThreadGroupPtr threadGroup) :
+          Mutex* executionLock, DynamicExecutor::ExecutionThreadGroupPtr threadGroup) :
           executeThreads_(threadGroup),
           lookup_(context.lookup()),
           bounds_(&context.bounds()),
-          work_(new DynamicExecutor::ModuleWorkQueue(numModules)),
+          work_(new DynamicExecutor::ModuleWorkQueue),
           producer_(new DynamicExecutor::ModuleProducer(context.addAdditionalFilter(ModuleWaitingFilter::Instance()),
-            network, lock, work_, numModules)),
+            network, work_)),
             consumer_(new DynamicExecutor::ModuleConsumer(work_, lookup_, producer_, executeThreads_)),
           network_(network),
           executionLock_(executionLock)
@@ -75,10 +75,8 @@ namespace SCIRun {
 
           waitForStartupInit(*network_);
 
-          std::thread consume(std::ref(*consumer_));
-          std::thread produce(std::ref(*producer_));
-          consume.join();
-          produce.join();
+          producer_->start();
+          (*consumer_)();
           executeThreads_->joinAll();
 
           return lookup_->errorCode();
@@ -104,11 +102,9 @@ DynamicMultithreadedNetworkExecutor::DynamicMultithreadedNetworkExecutor(const N
 
 std::future<int> DynamicMultithreadedNetworkExecutor::execute(const ExecutionContext& context, ParallelModuleExecutionOrder order, Mutex& executionLock)
 {
-  static Mutex lock("live-scheduler");
-
   threadGroup_->clear();
 
-  auto runner = makeShared<DynamicMultithreadedNetworkExecutorImpl>(context, &network_, &lock, order.size(), &executionLock, threadGroup_);
+  auto runner = makeShared<DynamicMultithreadedNetworkExecutorImpl>(context, &network_, &executionLock, threadGroup_);
   std::packaged_task<int()> task([runner] { return runner->run(); });
   auto value = task.get_future();
   std::thread t(std::move(task));
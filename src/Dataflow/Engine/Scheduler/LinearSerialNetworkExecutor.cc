@@ -30,10 +30,12 @@
 #include <Dataflow/Engine/Scheduler/LinearSerialNetworkExecutor.h>
 #include <Dataflow/Network/ModuleInterface.h>
 #include <Dataflow/Network/NetworkInterface.h>
+#include <Core/Logging/ExecutionTrace.h>
 
 using namespace SCIRun::Dataflow::Engine;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Thread;
+using namespace SCIRun::Core::Logging;
 
 namespace
 {
@@ -53,6 +55,8 @@ namespace
         auto obj = lookup_->lookupExecutable(id);
         if (obj)
         {
+          // Queued when dispatched, so the wait does not include upstream run times
+          ExecutionTracer::Instance().markQueued(id.id_);
           obj->executeWithSignals();
         }
       }
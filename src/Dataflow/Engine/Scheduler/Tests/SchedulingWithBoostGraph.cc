@@ -44,11 +44,14 @@
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
 #include <Dataflow/Engine/Scheduler/BasicMultithreadedNetworkExecutor.h>
 #include <Dataflow/Engine/Scheduler/BasicParallelExecutionStrategy.h>
+#include <Dataflow/Engine/Scheduler/DynamicParallelExecutionStrategy.h>
+#include <Dataflow/Engine/Scheduler/DynamicExecutor/WorkUnitProducer.h>
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Logging/Log.h>
 
 #include <queue>
+#include <algorithm>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
@@ -414,6 +417,132 @@ TEST_F(SchedulingWithBoostGraph, ParallelNetworkOrderExecutedFromAModuleInADisjo
   }
 }
 
+namespace
+{
+  // Pops everything queued so far. An empty handle marks the end, so this
+  // never blocks on a queue that is still open.
+  std::vector<std::string> takeQueued(DynamicExecutor::ModuleWorkQueue& work)
+  {
+    work.push(ModuleHandle());
+    std::vector<std::string> ids;
+    ModuleHandle module;
+    while (work.waitAndPop(module) && module)
+      ids.push_back(module->id().id_);
+    return ids;
+  }
+
+  std::vector<std::string> sorted(std::vector<std::string> ids)
+  {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+}
+
+TEST_F(SchedulingWithBoostGraph, DynamicProducerQueuesSourceModulesInNetworkOrder)
+{
+  setupBasicNetwork();
+
+  auto work = makeShared<DynamicExecutor::ModuleWorkQueue>();
+  DynamicExecutor::ModuleProducer producer(ExecuteAllModules::Instance(), &matrixMathNetwork, work);
+  producer.start();
+
+  std::vector<std::string> expected { "CreateMatrix:0", "CreateMatrix:1" };
+  EXPECT_EQ(expected, takeQueued(*work));
+  EXPECT_FALSE(producer.isDone());
+}
+
+TEST_F(SchedulingWithBoostGraph, DynamicProducerReleasesModuleWhenLastUpstreamModuleFinishes)
+{
+  setupBasicNetwork();
+
+  auto work = makeShared<DynamicExecutor::ModuleWorkQueue>();
+  DynamicExecutor::ModuleProducer producer(ExecuteAllModules::Instance(), &matrixMathNetwork, work);
+  producer.start();
+  takeQueued(*work);
+
+  producer.moduleFinished(ModuleId("CreateMatrix:0"));
+  EXPECT_EQ(std::vector<std::string>({ "EvaluateLinearAlgebraUnary:2", "EvaluateLinearAlgebraUnary:3" }), sorted(takeQueued(*work)));
+  producer.moduleFinished(ModuleId("CreateMatrix:1"));
+  EXPECT_EQ(std::vector<std::string>({ "EvaluateLinearAlgebraUnary:4" }), takeQueued(*work));
+
+  // multiply waits for both negate and scalar
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraUnary:3"));
+  EXPECT_TRUE(takeQueued(*work).empty());
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraUnary:4"));
+  EXPECT_EQ(std::vector<std::string>({ "EvaluateLinearAlgebraBinary:5" }), takeQueued(*work));
+
+  // add waits for transpose and multiply
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraBinary:5"));
+  EXPECT_TRUE(takeQueued(*work).empty());
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraUnary:2"));
+  EXPECT_EQ(std::vector<std::string>({ "EvaluateLinearAlgebraBinary:6" }), takeQueued(*work));
+
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraBinary:6"));
+  EXPECT_EQ(std::vector<std::string>({ "ReportMatrixInfo:7", "ReportMatrixInfo:8" }), sorted(takeQueued(*work)));
+
+  producer.moduleFinished(ModuleId("ReportMatrixInfo:7"));
+  EXPECT_FALSE(producer.isDone());
+  producer.moduleFinished(ModuleId("ReportMatrixInfo:8"));
+  EXPECT_TRUE(producer.isDone());
+
+  // the last module closes the queue
+  ModuleHandle module;
+  EXPECT_FALSE(work->waitAndPop(module));
+}
+
+TEST_F(SchedulingWithBoostGraph, DynamicProducerTreatsFilteredModulesAsFinished)
+{
+  setupBasicNetwork();
+
+  ModuleFilter filter = [](ModuleHandle mh) { return mh->name().find("Unary") == std::string::npos; };
+  auto work = makeShared<DynamicExecutor::ModuleWorkQueue>();
+  DynamicExecutor::ModuleProducer producer(filter, &matrixMathNetwork, work);
+  producer.start();
+
+  std::vector<std::string> expected { "CreateMatrix:0", "CreateMatrix:1", "EvaluateLinearAlgebraBinary:5" };
+  EXPECT_EQ(expected, takeQueued(*work));
+
+  // finishing a module outside the filter releases nothing
+  producer.moduleFinished(ModuleId("EvaluateLinearAlgebraUnary:2"));
+  EXPECT_TRUE(takeQueued(*work).empty());
+}
+
+TEST_F(SchedulingWithBoostGraph, DynamicProducerStopsAtOnceOnCycles)
+{
+  ModuleHandle negate = addModuleToNetwork(matrixMathNetwork, "EvaluateLinearAlgebraUnary");
+  ModuleHandle scalar = addModuleToNetwork(matrixMathNetwork, "EvaluateLinearAlgebraUnary");
+  matrixMathNetwork.connect(ConnectionOutputPort(negate, 0), ConnectionInputPort(scalar, 0));
+  matrixMathNetwork.connect(ConnectionOutputPort(scalar, 0), ConnectionInputPort(negate, 0));
+
+  auto work = makeShared<DynamicExecutor::ModuleWorkQueue>();
+  DynamicExecutor::ModuleProducer producer(ExecuteAllModules::Instance(), &matrixMathNetwork, work);
+  producer.start();
+
+  EXPECT_TRUE(producer.isDone());
+  ModuleHandle module;
+  EXPECT_FALSE(work->waitAndPop(module));
+}
+
+TEST_F(SchedulingWithBoostGraph, DynamicExecutorFinishesDownstreamOfErroredModuleAndReturnsError)
+{
+  setupBasicNetwork();
+
+  // a 2x2 matrix makes the 3x3 multiply fail
+  auto multiply = matrixMathNetwork.lookupModule(ModuleId("EvaluateLinearAlgebraBinary:5"));
+  matrixMathNetwork.lookupModule(ModuleId("CreateMatrix:1"))->get_state()->setValue(Core::Algorithms::Math::Parameters::TextEntry, std::string("1 2\n3 4\n"));
+
+  DynamicParallelExecutionStrategy strategy;
+  ExecutionContext context(matrixMathNetwork, &matrixMathNetwork);
+  Mutex m("exec");
+  auto result = strategy.execute(context, m);
+
+  ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(30)));
+  EXPECT_GT(result.get(), 0);
+  EXPECT_EQ(ModuleExecutionState::Value::Errored, multiply->executionState().expandedState());
+  for (size_t i = 0; i < matrixMathNetwork.nmodules(); ++i)
+    EXPECT_EQ(ModuleExecutionState::Value::Completed, matrixMathNetwork.module(i)->executionState().currentState());
+}
+
 #if 0
 namespace ThreadingPrototype
 {
@@ -48,6 +48,8 @@
 #include <Dataflow/Network/ModuleBuilder.h>
 #include <Core/Logging/ConsoleLogger.h>
 #include <Core/Logging/Log.h>
+#include <Core/Logging/ExecutionTrace.h>
+#include <Core/Algorithms/Describe/DescribeDatatype.h>
 #include <Core/Thread/Mutex.h>
 #include <Core/Thread/Interruptible.h>
 
@@ -203,6 +205,7 @@ namespace SCIRun
         std::string description_;
 
         bool returnCode_{ false };
+        size_t bytesIn_{ 0 }, bytesOut_{ 0 };
 
         NetworkInterface* network_ { nullptr };
       };
@@ -394,6 +397,11 @@ bool Module::executeWithSignals() NOEXCEPT
     std::cout << starting << std::endl;
   }
 #endif
+  auto& tracer = ExecutionTracer::Instance();
+  const bool tracing = tracer.enabled();
+  impl_->bytesIn_ = impl_->bytesOut_ = 0;
+  const auto traceStart = tracing ? tracer.nowMicroseconds() : 0;
+
   impl_->executeBegins_(id());
   auto start = std::chrono::steady_clock::now();
   {
@@ -489,6 +497,23 @@ bool Module::executeWithSignals() NOEXCEPT
     impl_->inputsChanged_ = false;
   }
 
+  if (tracing)
+  {
+    TraceEvent span;
+    span.name = id().id_;
+    span.category = "module";
+    span.threadId = ExecutionTracer::currentThreadId();
+    span.startMicroseconds = traceStart;
+    span.durationMicroseconds = tracer.nowMicroseconds() - traceStart;
+    auto queued = tracer.takeQueuedTime(id().id_);
+    if (queued)
+      span.args.emplace_back("queue_wait_us", static_cast<double>(traceStart - *queued));
+    span.args.emplace_back("bytes_in", static_cast<double>(impl_->bytesIn_));
+    span.args.emplace_back("bytes_out", static_cast<double>(impl_->bytesOut_));
+    span.args.emplace_back("success", impl_->returnCode_ ? 1 : 0);
+    tracer.record(std::move(span));
+  }
+
   impl_->executeEnds_(elapsed_seconds.count(), id());
   return impl_->returnCode_;
 }
@@ -569,6 +594,13 @@ namespace //TODO: flesh out requirements for metadata on input handles.
       return "Null data handle";
     return "Datatype id# " + boost::lexical_cast<std::string>((*data)->id());
   }
+
+  size_t tracedBytes(const DatatypeHandleOption& data)
+  {
+    if (!ExecutionTracer::Instance().enabled() || !data)
+      return 0;
+    return General::DescribeDatatype().estimateBytes(*data);
+  }
 }
 
 DatatypeHandleOption Module::get_input_handle(const PortId& id)
@@ -594,6 +626,7 @@ DatatypeHandleOption Module::get_input_handle(const PortId& id)
 
   auto data = port->getData();
   impl_->metadata_.setMetadata("Input " + id.toString(), metaInfo(data));
+  impl_->bytesIn_ += tracedBytes(data);
   return data;
 }
 
@@ -617,6 +650,8 @@ std::vector<DatatypeHandleOption> Module::get_dynamic_input_handles(const PortId
   std::vector<DatatypeHandleOption> options;
   auto getData = [](InputPortHandle input) { return input->getData(); };
   std::transform(portsWithName.begin(), portsWithName.end(), std::back_inserter(options), getData);
+  for (const auto& option : options)
+    impl_->bytesIn_ += tracedBytes(option);
 
   impl_->metadata_.setMetadata("Input " + pid.toString(), metaInfo(options.empty() ? DatatypeHandleOption() : options[0]));
 
@@ -631,6 +666,7 @@ void Module::send_output_handle(const PortId& id, DatatypeHandle data)
     THROW_OUT_OF_RANGE("Output port does not exist: " + id.toString());
   }
 
+  impl_->bytesOut_ += tracedBytes(data);
   impl_->oports_[id]->sendData(data);
 }
 
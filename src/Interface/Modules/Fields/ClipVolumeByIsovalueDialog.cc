@@ -45,4 +45,5 @@ ClipVolumeByIsovalueDialog::ClipVolumeByIsovalueDialog(const std::string& name,
   fixSize();
   addDoubleSpinBoxManager(IsoValueSpinBox_, Parameters::ScalarIsoValue);
   addRadioButtonGroupManager({ lessthanRadioButton_,  greaterthanRadioButton_}, Parameters::LessThanIsoValue);
+  addCheckBoxManager(multithreadedCheckBox_, Parameters::MultithreadedClip);
 }
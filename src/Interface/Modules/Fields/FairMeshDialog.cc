@@ -44,6 +44,7 @@ FairMeshDialog::FairMeshDialog(const std::string& name, ModuleStateHandle state,
 
   connect(fastWeightingButton_, &QPushButton::clicked, this, &FairMeshDialog::push);
   connect(desbrunWeightingButton_, &QPushButton::clicked, this, &FairMeshDialog::push);
+  connect(chebyshevWeightingButton_, &QPushButton::clicked, this, &FairMeshDialog::push);
 
   using namespace Parameters;
   addSpinBoxManager(iterationsSpinBox_, NumIterations);
@@ -56,7 +57,12 @@ void FairMeshDialog::push()
   if (!pulling_)
   {
     using namespace Parameters;
-    state_->setValue(FairMeshMethod, fastWeightingButton_->isChecked() ? std::string("fast") : std::string("desbrun"));
+    std::string method("fast");
+    if (desbrunWeightingButton_->isChecked())
+      method = "desbrun";
+    else if (chebyshevWeightingButton_->isChecked())
+      method = "chebyshev";
+    state_->setValue(FairMeshMethod, method);
   }
 }
 
@@ -66,4 +72,5 @@ void FairMeshDialog::pullSpecial() //TODO: change to checkbox manager //TODO ref
   auto method = state_->getValue(FairMeshMethod).toString();
   fastWeightingButton_->setChecked("fast" == method);
   desbrunWeightingButton_->setChecked("desbrun" == method);
+  chebyshevWeightingButton_->setChecked("chebyshev" == method);
 }
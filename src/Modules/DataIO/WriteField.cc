@@ -123,7 +123,12 @@ bool WriteField::useCustomExporter(const std::string& filename) const
   LOG_DEBUG("WriteField with filetype {}", ft);
   auto ret = boost::filesystem::extension(filename) != ".fld";
 
-  filetype_ = ft.find("SCIRun Field ASCII") != std::string::npos ? "ASCII" : "Binary";
+  if (ft.find("SCIRun Field ASCII") != std::string::npos)
+    filetype_ = "ASCII";
+  else if (ft.find("SCIRun Field Compressed") != std::string::npos)
+    filetype_ = "Compressed";
+  else
+    filetype_ = "Binary";
 
   return ret;
 }
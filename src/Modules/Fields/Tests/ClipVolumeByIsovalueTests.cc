@@ -34,6 +34,9 @@
 #include <Testing/ModuleTestBase/ModuleTestBase.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Algorithms/Legacy/Fields/ClipMesh/ClipMeshByIsovalue.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Testing;
@@ -41,6 +44,8 @@ using namespace SCIRun::Modules;
 using namespace SCIRun::Modules::Fields;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Geometry;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::TestUtils;
 using ::testing::_;
@@ -113,3 +118,35 @@ TEST_F(ClipVolumeByIsovalueModuleTests, ThrowForNullPointerExeption)
   stubPortNWithThisData(test, 1, nullfield);
   EXPECT_THROW(test->execute(), NullHandleOnPortException);
 }
+
+TEST_F(ClipVolumeByIsovalueModuleTests, MultithreadedClipIsOnByDefaultAndGivesTheSameField)
+{
+  UseRealAlgorithmFactory f;
+  UseRealModuleStateFactory s;
+
+  auto block = CreateCubeBlock(mesh_info_type::TETVOLMESH_E, 6, databasis_info_type::LINEARDATA_E, ShearedGridPoint);
+  for (VMesh::Node::index_type i = 0; i < block->vmesh()->num_nodes(); i++)
+  {
+    Point p;
+    block->vmesh()->get_center(p, i);
+    block->vfield()->set_value(p.x() + 0.5*p.y() - 0.3*p.z(), i);
+  }
+
+  FieldHandle outputs[2];
+  for (bool multithreaded : { true, false })
+  {
+    auto clip = makeModule("ClipVolumeByIsovalue");
+    EXPECT_TRUE(clip->get_state()->getValue(Parameters::MultithreadedClip).toBool());
+    clip->get_state()->setValue(Parameters::MultithreadedClip, multithreaded);
+    clip->get_state()->setValue(Parameters::ScalarIsoValue, 3.0);
+    stubPortNWithThisData(clip, 0, block);
+    clip->execute();
+    outputs[multithreaded ? 0 : 1] = std::dynamic_pointer_cast<Field>(getDataOnThisOutputPort(clip, 0));
+  }
+
+  ASSERT_TRUE(outputs[0] != nullptr);
+  ASSERT_TRUE(outputs[1] != nullptr);
+  ASSERT_GT(outputs[1]->vmesh()->num_elems(), 0);
+  EXPECT_EQ(outputs[1]->vmesh()->num_nodes(), outputs[0]->vmesh()->num_nodes());
+  EXPECT_EQ(outputs[1]->vmesh()->num_elems(), outputs[0]->vmesh()->num_elems());
+}
@@ -0,0 +1,178 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <Modules/Legacy/FiniteElements/BuildFEMatrix.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Logging/ExecutionTrace.h>
+#include <Testing/ModuleTestBase/ModuleTestBase.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Testing;
+using namespace SCIRun::TestUtils;
+using namespace SCIRun::Modules::FiniteElements;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::FiniteElements;
+using namespace SCIRun::Core::Logging;
+using namespace SCIRun::Dataflow::Networks;
+
+class BuildFEMatrixModuleTests : public ModuleTest
+{
+protected:
+  void TearDown() override
+  {
+    ExecutionTracer::Instance().disable();
+    ExecutionTracer::Instance().clear();
+  }
+};
+
+namespace
+{
+  // New element conductivities on the mesh of the given field, as
+  // SetConductivitiesToMesh outputs them
+  FieldHandle withConductivities(FieldHandle field, double scale)
+  {
+    FieldInformation fi(field);
+    auto output = CreateField(fi, field->mesh());
+    output->vfield()->resize_values();
+    for (VMesh::Elem::index_type e = 0; e < field->vmesh()->num_elems(); e++)
+      output->vfield()->set_value(scale * (1.0 + e % 3), e);
+    return output;
+  }
+
+  size_t numSpans(const std::string& name)
+  {
+    auto events = ExecutionTracer::Instance().events();
+    return std::count_if(events.begin(), events.end(),
+      [&name](const TraceEvent& event) { return event.name == name; });
+  }
+}
+
+TEST_F(BuildFEMatrixModuleTests, ThrowsForNullInput)
+{
+  auto build = makeModule("BuildFEMatrix");
+  FieldHandle nullField;
+  stubPortNWithThisData(build, 0, nullField);
+
+  EXPECT_THROW(build->execute(), NullHandleOnPortException);
+}
+
+TEST_F(BuildFEMatrixModuleTests, ReusesAssemblyPlanForNewConductivities)
+{
+  UseRealAlgorithmFactory f;
+  UseRealModuleStateFactory s;
+
+  auto build = makeModule("BuildFEMatrix");
+  EXPECT_TRUE(build->get_state()->getValue(BuildFEMatrixAlgo::GenerateBasis).toBool());
+
+  auto block = CreateCubeBlock(mesh_info_type::TETVOLMESH_E, 3,
+    databasis_info_type::CONSTANTDATA_E, ShearedGridPoint);
+
+  ExecutionTracer::Instance().clear();
+  ExecutionTracer::Instance().enable();
+
+  stubPortNWithThisData(build, 0, withConductivities(block, 1.0));
+  build->execute();
+  auto first = std::dynamic_pointer_cast<SparseRowMatrix>(getDataOnThisOutputPort(build, 0));
+
+  stubPortNWithThisData(build, 0, withConductivities(block, 3.0));
+  build->execute();
+  auto second = std::dynamic_pointer_cast<SparseRowMatrix>(getDataOnThisOutputPort(build, 0));
+
+  ASSERT_TRUE(first != nullptr);
+  ASSERT_TRUE(second != nullptr);
+  EXPECT_TRUE(second->isApprox(3.0 * *first, 1e-12));
+
+  // Only the first run builds the plan, both runs assemble with it
+  EXPECT_EQ(1u, numSpans("BuildFEMatrix::build_plan"));
+  EXPECT_EQ(2u, numSpans("BuildFEMatrix::assemble"));
+}
+
+TEST_F(BuildFEMatrixModuleTests, ElementColoringFromStateGivesTheSameMatrix)
+{
+  UseRealAlgorithmFactory f;
+  UseRealModuleStateFactory s;
+
+  auto block = CreateCubeBlock(mesh_info_type::TETVOLMESH_E, 3,
+    databasis_info_type::CONSTANTDATA_E, ShearedGridPoint);
+  auto input = withConductivities(block, 1.0);
+
+  auto plain = makeModule("BuildFEMatrix");
+  EXPECT_FALSE(plain->get_state()->getValue(BuildFEMatrixAlgo::ElementColoring).toBool());
+  stubPortNWithThisData(plain, 0, input);
+  plain->execute();
+  auto expected = std::dynamic_pointer_cast<SparseRowMatrix>(getDataOnThisOutputPort(plain, 0));
+
+  ExecutionTracer::Instance().clear();
+  ExecutionTracer::Instance().enable();
+  auto colored = makeModule("BuildFEMatrix");
+  colored->get_state()->setValue(BuildFEMatrixAlgo::ElementColoring, true);
+  stubPortNWithThisData(colored, 0, input);
+  colored->execute();
+  auto actual = std::dynamic_pointer_cast<SparseRowMatrix>(getDataOnThisOutputPort(colored, 0));
+
+  ASSERT_TRUE(expected != nullptr);
+  ASSERT_TRUE(actual != nullptr);
+  EXPECT_TRUE(expected->isApprox(*actual, 1e-12));
+
+  auto events = ExecutionTracer::Instance().events();
+  auto assemble = std::find_if(events.begin(), events.end(),
+    [](const TraceEvent& event) { return event.name == "BuildFEMatrix::assemble"; });
+  ASSERT_TRUE(assemble != events.end());
+  ASSERT_EQ(1u, assemble->args.size());
+  EXPECT_EQ("colored", assemble->args[0].first);
+  EXPECT_EQ(1.0, assemble->args[0].second);
+}
+
+TEST_F(BuildFEMatrixModuleTests, RebuildsEverythingWithoutGenerateBasis)
+{
+  UseRealAlgorithmFactory f;
+  UseRealModuleStateFactory s;
+
+  auto build = makeModule("BuildFEMatrix");
+  build->get_state()->setValue(BuildFEMatrixAlgo::GenerateBasis, false);
+
+  auto block = CreateCubeBlock(mesh_info_type::TETVOLMESH_E, 2,
+    databasis_info_type::CONSTANTDATA_E, ShearedGridPoint);
+
+  ExecutionTracer::Instance().clear();
+  ExecutionTracer::Instance().enable();
+  for (double scale : { 1.0, 2.0 })
+  {
+    stubPortNWithThisData(build, 0, withConductivities(block, scale));
+    build->execute();
+    EXPECT_TRUE(getDataOnThisOutputPort(build, 0) != nullptr);
+  }
+  EXPECT_EQ(0u, numSpans("BuildFEMatrix::build_plan"));
+}
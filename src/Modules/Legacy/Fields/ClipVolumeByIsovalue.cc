@@ -67,6 +67,7 @@ void ClipVolumeByIsovalue::setStateDefaults()
   auto state = get_state();
   setStateDoubleFromAlgo(Parameters::ScalarIsoValue);
   setStateIntFromAlgo(Parameters::LessThanIsoValue);
+  setStateBoolFromAlgo(Parameters::MultithreadedClip);
 }
 
 
@@ -95,6 +96,7 @@ void ClipVolumeByIsovalue::execute()
        gui_LessThanIsoValue=0;
 
     algo().set(Parameters::LessThanIsoValue, gui_LessThanIsoValue);
+    setAlgoBoolFromState(Parameters::MultithreadedClip);
 
     auto output = algo().run(withInputData((InputField, input)));
 
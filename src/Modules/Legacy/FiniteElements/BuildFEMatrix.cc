@@ -30,20 +30,18 @@
 
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
 #include <Modules/Legacy/FiniteElements/BuildFEMatrix.h>
 
 using namespace SCIRun::Modules::FiniteElements;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::FiniteElements;
 using namespace SCIRun;
 
 BuildFEMatrix::BuildFEMatrix()
-  : Module(ModuleLookupInfo("BuildFEMatrix", "FiniteElements", "SCIRun"), false)
-#ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-    gui_use_basis_(get_ctx()->subVar("use-basis"), 0),
-    gui_force_symmetry_(get_ctx()->subVar("force-symmetry"), 0),
-#endif
+  : Module(ModuleLookupInfo("BuildFEMatrix", "FiniteElements", "SCIRun"))
 {
   INITIALIZE_PORT(InputField);
   INITIALIZE_PORT(Conductivity_Table);
@@ -51,6 +49,16 @@ BuildFEMatrix::BuildFEMatrix()
   INITIALIZE_PORT(Stiffness_Matrix_Complex);
 }
 
+void BuildFEMatrix::setStateDefaults()
+{
+  auto state = get_state();
+  // Keep the assembly plan between runs, so new conductivities on the same
+  // mesh only assemble the element matrices again
+  state->setValue(BuildFEMatrixAlgo::GenerateBasis, true);
+  setStateBoolFromAlgo(BuildFEMatrixAlgo::ForceSymmetry);
+  setStateBoolFromAlgo(BuildFEMatrixAlgo::ElementColoring);
+}
+
 void BuildFEMatrix::execute()
 {
   auto field = getRequiredInput(InputField);
@@ -58,13 +66,9 @@ void BuildFEMatrix::execute()
 
   if (needToExecute())
   {
-#ifdef SCIRUN4_ESSENTIAL_CODE_TO_BE_PORTED
-    algo().set("generate_basis", gui_use_basis_.get());
-    algo().set("force_symmetry", gui_force_symmetry_.get());
-//#else
-//    algo().set(GenerateBasis, true);
-//    algo().set(ForceSymmetry, true);
-#endif
+    setAlgoBoolFromState(BuildFEMatrixAlgo::GenerateBasis);
+    setAlgoBoolFromState(BuildFEMatrixAlgo::ForceSymmetry);
+    setAlgoBoolFromState(BuildFEMatrixAlgo::ElementColoring);
 
     auto output = algo().run(withInputData((InputField, field)(Conductivity_Table, optionalAlgoInput(conductivity))));
 
@@ -45,8 +45,7 @@ namespace SCIRun {
       public:
         BuildFEMatrix();
 
-        void setStateDefaults() override
-        {}
+        void setStateDefaults() override;
 
         void execute() override;
 
@@ -54,7 +53,7 @@ namespace SCIRun {
         INPUT_PORT(1, Conductivity_Table, Matrix);
         OUTPUT_PORT(0, Stiffness_Matrix, Matrix);
         OUTPUT_PORT(1, Stiffness_Matrix_Complex, ComplexSparseRowMatrix);
-        MODULE_TRAITS_AND_INFO(ModuleFlags::ModuleHasAlgorithm)
+        MODULE_TRAITS_AND_INFO(ModuleFlags::ModuleHasUIAndAlgorithm)
       };
 
     }
@@ -67,14 +67,27 @@ void SolveLinearSystem::execute()
   if (needToExecute())
   {
     /// @todo: why aren't these checks in the algo class?
-    if (rhs->ncols() != 1)
-      THROW_ALGORITHM_INPUT_ERROR("Right-hand side matrix must contain only one column.");
+    if (rhs->ncols() < 1)
+      THROW_ALGORITHM_INPUT_ERROR("Right-hand side matrix must contain at least one column.");
     if (!matrixIs::sparse(A))
       THROW_ALGORITHM_INPUT_ERROR("Left-hand side matrix to solve must be sparse.");
 
-    auto rhsCol = castMatrix::toColumn(rhs);
-    if (!rhsCol)
-      rhsCol = convertMatrix::toColumn(rhs);
+    // Several right hand side columns are solved together
+    DatatypeHandle rhsInput;
+    if (rhs->ncols() == 1)
+    {
+      auto rhsCol = castMatrix::toColumn(rhs);
+      if (!rhsCol)
+        rhsCol = convertMatrix::toColumn(rhs);
+      rhsInput = rhsCol;
+    }
+    else
+    {
+      auto rhsDense = castMatrix::toDense(rhs);
+      if (!rhsDense)
+        rhsDense = convertMatrix::toDense(rhs);
+      rhsInput = rhsDense;
+    }
 
     auto tolerance = get_state()->getValue(Variables::TargetError).toDouble();
     auto maxIterations = get_state()->getValue(Variables::MaxIterations).toInt();
@@ -100,7 +113,7 @@ void SolveLinearSystem::execute()
       ScopedTimeRemarker perf(this, "Linear solver");
       remark("Using preconditioner: " + precond);
 
-      auto output = algo().run(withInputData((LHS, A)(RHS, rhsCol)));
+      auto output = algo().run(withInputData((LHS, A)(RHS, rhsInput)));
 
       sendOutputFromAlgorithm(Solution, output);
     }
@@ -0,0 +1,202 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Core/Algorithms/Base/AlgorithmLogger.h>
+#include <Core/Logging/ConsoleLogger.h>
+#include <Core/Thread/Parallel.h>
+#include <Core/Utils/StringUtil.h>
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+using namespace SCIRun::Benchmarks;
+
+BenchmarkTimer::BenchmarkTimer() : start_(std::chrono::steady_clock::now()), accumulated_(0), running_(true)
+{
+}
+
+void BenchmarkTimer::pause()
+{
+  if (running_)
+  {
+    accumulated_ += std::chrono::steady_clock::now() - start_;
+    running_ = false;
+  }
+}
+
+void BenchmarkTimer::resume()
+{
+  if (!running_)
+  {
+    start_ = std::chrono::steady_clock::now();
+    running_ = true;
+  }
+}
+
+double BenchmarkTimer::elapsedSeconds() const
+{
+  auto total = accumulated_;
+  if (running_)
+    total += std::chrono::steady_clock::now() - start_;
+  return std::chrono::duration<double>(total).count();
+}
+
+double BenchmarkResult::minimum() const
+{
+  return seconds.empty() ? 0 : *std::min_element(seconds.begin(), seconds.end());
+}
+
+double BenchmarkResult::median() const
+{
+  if (seconds.empty())
+    return 0;
+  auto sorted = seconds;
+  std::sort(sorted.begin(), sorted.end());
+  const auto mid = sorted.size() / 2;
+  return sorted.size() % 2 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+}
+
+double BenchmarkResult::mean() const
+{
+  return seconds.empty() ? 0 : std::accumulate(seconds.begin(), seconds.end(), 0.0) / seconds.size();
+}
+
+void BenchmarkRegistry::add(const std::string& name, const std::vector<int>& sizes, BenchmarkSetup setup)
+{
+  cases_.push_back({ name, sizes, setup });
+}
+
+std::vector<BenchmarkResult> BenchmarkRegistry::run(const BenchmarkOptions& options, std::ostream& log) const
+{
+  std::vector<BenchmarkResult> results;
+  for (const auto& c : cases_)
+  {
+    if (!options.filter.empty() && c.name.find(options.filter) == std::string::npos)
+      continue;
+
+    for (size_t s = 0; s < c.sizes.size(); ++s)
+    {
+      if (options.smallestSizeOnly && s > 0)
+        break;
+
+      BenchmarkResult result;
+      result.name = c.name;
+      result.size = c.sizes[s];
+      log << std::left << std::setw(48) << (c.name + "/" + std::to_string(result.size)) << std::flush;
+      try
+      {
+        auto body = c.setup(result.size, result.counters);
+        if (options.warmup)
+        {
+          BenchmarkTimer timer;
+          body(timer);
+        }
+        for (int r = 0; r < options.repetitions; ++r)
+        {
+          BenchmarkTimer timer;
+          body(timer);
+          result.seconds.push_back(timer.elapsedSeconds());
+        }
+        log << std::right << std::setw(12) << std::fixed << std::setprecision(6) << result.median() << " s (median of " << result.seconds.size() << ")\n";
+      }
+      catch (std::exception& e)
+      {
+        result.error = e.what();
+        log << " FAILED: " << result.error << "\n";
+      }
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+void SCIRun::Benchmarks::quiet(Core::Algorithms::AlgorithmLogger& algo)
+{
+  algo.setLogger(makeShared<Core::Logging::NullLogger>());
+}
+
+namespace
+{
+  std::string quoted(const std::string& str)
+  {
+    return '"' + SCIRun::Core::jsonEscape(str) + '"';
+  }
+}
+
+std::string SCIRun::Benchmarks::toJson(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options)
+{
+  std::ostringstream json;
+  json << std::setprecision(9);
+
+  auto now = std::time(nullptr);
+  char date[32];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  json << "{\n  \"context\": {\n"
+    << "    \"date\": " << quoted(date) << ",\n"
+    << "    \"num_cores\": " << Core::Thread::Parallel::NumCores() << ",\n"
+    << "    \"repetitions\": " << options.repetitions << ",\n"
+#ifdef NDEBUG
+    << "    \"build_type\": \"release\"\n"
+#else
+    << "    \"build_type\": \"debug\"\n"
+#endif
+    << "  },\n  \"benchmarks\": [";
+
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& r = results[i];
+    json << (i > 0 ? "," : "") << "\n    {\n"
+      << "      \"name\": " << quoted(r.name + "/" + std::to_string(r.size)) << ",\n"
+      << "      \"benchmark\": " << quoted(r.name) << ",\n"
+      << "      \"size\": " << r.size << ",\n";
+    if (!r.error.empty())
+      json << "      \"error\": " << quoted(r.error) << ",\n";
+    json << "      \"seconds\": [";
+    for (size_t k = 0; k < r.seconds.size(); ++k)
+      json << (k > 0 ? ", " : "") << r.seconds[k];
+    json << "],\n"
+      << "      \"min_seconds\": " << r.minimum() << ",\n"
+      << "      \"median_seconds\": " << r.median() << ",\n"
+      << "      \"mean_seconds\": " << r.mean() << ",\n"
+      << "      \"counters\": {";
+    bool first = true;
+    for (const auto& counter : r.counters)
+    {
+      json << (first ? "" : ", ") << quoted(counter.first) << ": " << counter.second;
+      first = false;
+    }
+    json << "}\n    }";
+  }
+  json << "\n  ]\n}\n";
+  return json.str();
+}
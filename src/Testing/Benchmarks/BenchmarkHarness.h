@@ -0,0 +1,116 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef TESTING_BENCHMARKS_BENCHMARKHARNESS_H
+#define TESTING_BENCHMARKS_BENCHMARKHARNESS_H
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace SCIRun {
+namespace Core { namespace Algorithms { class AlgorithmLogger; }}
+namespace Benchmarks {
+
+  /// Measures the timed part of one benchmark iteration. Work that has to be
+  /// redone per iteration but should not be measured (e.g. rebuilding a mesh
+  /// that the benchmark modifies) goes between pause() and resume().
+  class BenchmarkTimer
+  {
+  public:
+    BenchmarkTimer();
+    void pause();
+    void resume();
+    double elapsedSeconds() const;
+  private:
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::duration accumulated_;
+    bool running_;
+  };
+
+  /// Problem-size figures reported next to the timings (nodes, nonzeros, ...).
+  using BenchmarkCounters = std::map<std::string, double>;
+  using BenchmarkBody = std::function<void(BenchmarkTimer&)>;
+  /// Builds the inputs for one problem size outside of the timed region and
+  /// returns the body to time.
+  using BenchmarkSetup = std::function<BenchmarkBody(int size, BenchmarkCounters& counters)>;
+
+  struct BenchmarkCase
+  {
+    std::string name;
+    std::vector<int> sizes;
+    BenchmarkSetup setup;
+  };
+
+  struct BenchmarkResult
+  {
+    std::string name;
+    int size{0};
+    std::vector<double> seconds;
+    BenchmarkCounters counters;
+    std::string error;
+
+    double minimum() const;
+    double median() const;
+    double mean() const;
+  };
+
+  struct BenchmarkOptions
+  {
+    std::string filter;
+    int repetitions{5};
+    bool warmup{true};
+    bool smallestSizeOnly{false};
+  };
+
+  class BenchmarkRegistry
+  {
+  public:
+    void add(const std::string& name, const std::vector<int>& sizes, BenchmarkSetup setup);
+    const std::vector<BenchmarkCase>& cases() const { return cases_; }
+    std::vector<BenchmarkResult> run(const BenchmarkOptions& options, std::ostream& log) const;
+  private:
+    std::vector<BenchmarkCase> cases_;
+  };
+
+  /// Drops the remarks algorithms print on every run; failures are reported
+  /// by the benchmark bodies throwing.
+  void quiet(Core::Algorithms::AlgorithmLogger& algo);
+
+  std::string toJson(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options);
+
+  void registerMatrixBenchmarks(BenchmarkRegistry& registry);
+  void registerFieldBenchmarks(BenchmarkRegistry& registry);
+  void registerPersistentBenchmarks(BenchmarkRegistry& registry);
+
+}}
+
+#endif
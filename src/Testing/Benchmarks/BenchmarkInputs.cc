@@ -0,0 +1,149 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkInputs.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+
+SparseRowMatrixHandle SCIRun::Benchmarks::gridLaplacian(int n)
+{
+  const int rows = n * n * n;
+  auto index = [n](int i, int j, int k) { return i + n * (j + n * k); };
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(7 * rows);
+  for (int k = 0; k < n; ++k)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i)
+      {
+        const int row = index(i, j, k);
+        entries.emplace_back(row, row, 6.01);
+        if (i > 0) entries.emplace_back(row, index(i - 1, j, k), -1.0);
+        if (i < n - 1) entries.emplace_back(row, index(i + 1, j, k), -1.0);
+        if (j > 0) entries.emplace_back(row, index(i, j - 1, k), -1.0);
+        if (j < n - 1) entries.emplace_back(row, index(i, j + 1, k), -1.0);
+        if (k > 0) entries.emplace_back(row, index(i, j, k - 1), -1.0);
+        if (k < n - 1) entries.emplace_back(row, index(i, j, k + 1), -1.0);
+      }
+  auto matrix = makeShared<SparseRowMatrix>(rows, rows);
+  matrix->setFromTriplets(entries.begin(), entries.end());
+  matrix->makeCompressed();
+  return matrix;
+}
+
+FieldHandle SCIRun::Benchmarks::tetCube(int n, bool linearData)
+{
+  const double h = 1.0 / n;
+  auto field = TestUtils::CreateCubeBlock(mesh_info_type::TETVOLMESH_E, n,
+    linearData ? databasis_info_type::LINEARDATA_E : databasis_info_type::CONSTANTDATA_E,
+    [h](int i, int j, int k) { return h * TestUtils::ShearedGridPoint(i, j, k); });
+  auto vmesh = field->vmesh();
+  auto vfield = field->vfield();
+  if (linearData)
+  {
+    for (VMesh::Node::index_type idx = 0; idx < vmesh->num_nodes(); ++idx)
+    {
+      auto p = vmesh->get_point(idx);
+      vfield->set_value(p.x() + 2.0 * p.y() - p.z(), idx);
+    }
+  }
+  else
+  {
+    for (VMesh::Elem::index_type idx = 0; idx < vmesh->num_elems(); ++idx)
+      vfield->set_value(1.0 + (idx % 7) * 0.5, idx);
+  }
+  return field;
+}
+
+FieldHandle SCIRun::Benchmarks::sphereLatVol(int n)
+{
+  auto field = TestUtils::CreateEmptyLatVol(n, n, n);
+  auto vmesh = field->vmesh();
+  auto vfield = field->vfield();
+  Point p;
+  for (VMesh::Node::index_type idx = 0; idx < vmesh->num_nodes(); ++idx)
+  {
+    vmesh->get_center(p, idx);
+    vfield->set_value((p - Point(0, 0, 0)).length(), idx);
+  }
+  return field;
+}
+
+FieldHandle SCIRun::Benchmarks::latLongSphere(int n)
+{
+  FieldInformation fi(mesh_info_type::TRISURFMESH_E, databasis_info_type::LINEARDATA_E,
+    data_info_type::DOUBLE_E);
+  auto field = CreateField(fi);
+  auto vmesh = field->vmesh();
+  const int m = 2 * n;
+  vmesh->add_point(Point(0, 0, 1));
+  for (int i = 1; i < n; i++)
+    for (int j = 0; j < m; j++)
+    {
+      const double theta = M_PI * i / n, phi = 2.0 * M_PI * j / m;
+      vmesh->add_point(Point(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta)));
+    }
+  const int south = 1 + (n - 1) * m;
+  vmesh->add_point(Point(0, 0, -1));
+
+  auto node = [m](int i, int j) { return 1 + (i - 1) * m + j % m; };
+  VMesh::Node::array_type nodes(3);
+  auto addTri = [&](int a, int b, int c)
+  {
+    nodes[0] = a; nodes[1] = b; nodes[2] = c;
+    vmesh->add_elem(nodes);
+  };
+  for (int j = 0; j < m; j++)
+  {
+    addTri(0, node(1, j), node(1, j + 1));
+    addTri(south, node(n - 1, j + 1), node(n - 1, j));
+  }
+  for (int i = 1; i < n - 1; i++)
+    for (int j = 0; j < m; j++)
+    {
+      addTri(node(i, j), node(i + 1, j), node(i + 1, j + 1));
+      addTri(node(i, j), node(i + 1, j + 1), node(i, j + 1));
+    }
+
+  auto vfield = field->vfield();
+  vfield->resize_values();
+  for (VMesh::Node::index_type idx = 0; idx < vmesh->num_nodes(); ++idx)
+  {
+    auto p = vmesh->get_point(idx);
+    vfield->set_value(p.x() + 2.0 * p.y(), idx);
+  }
+  return field;
+}
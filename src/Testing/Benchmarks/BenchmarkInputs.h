@@ -0,0 +1,59 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#ifndef TESTING_BENCHMARKS_BENCHMARKINPUTS_H
+#define TESTING_BENCHMARKS_BENCHMARKINPUTS_H
+
+#include <Core/Datatypes/Legacy/Field/FieldFwd.h>
+#include <Core/Datatypes/MatrixFwd.h>
+
+namespace SCIRun {
+namespace Benchmarks {
+
+  /// Deterministic inputs generated in-process, so runs on different machines
+  /// and releases measure the same problems.
+
+  /// 7-point Laplacian on an n^3 grid plus a small diagonal shift (SPD).
+  Core::Datatypes::SparseRowMatrixHandle gridLaplacian(int n);
+
+  /// Cube of n^3 hexahedra split into six positively oriented tetrahedra
+  /// each, with a smooth scalar at the nodes (linear) or elements (constant).
+  FieldHandle tetCube(int n, bool linearData);
+
+  /// n^3 LatVol on [-1,1]^3 holding the distance to the origin at the nodes.
+  FieldHandle sphereLatVol(int n);
+
+  /// Unit sphere TriSurf with n latitude bands and 2n meridians, with a
+  /// linear scalar at the nodes. The triangles shrink towards the poles, so
+  /// their sizes are far from uniform.
+  FieldHandle latLongSphere(int n);
+
+}}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+using namespace SCIRun::Benchmarks;
+
+namespace
+{
+  void usage()
+  {
+    std::cout << "scirun_benchmarks [options]\n"
+      "  --filter=<text>      only run benchmarks whose name contains text\n"
+      "  --repetitions=<n>    timed repetitions per problem size (default 5)\n"
+      "  --json=<file>        write the results as JSON\n"
+      "  --quick              only run the smallest problem size\n"
+      "  --no-warmup          skip the untimed warmup run\n"
+      "  --list               list the benchmarks and their problem sizes\n";
+  }
+
+  bool startsWith(const std::string& arg, const std::string& prefix, std::string& value)
+  {
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+      return false;
+    value = arg.substr(prefix.size());
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  BenchmarkOptions options;
+  std::string jsonFile;
+  bool list = false;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg(argv[i]);
+    std::string value;
+    if (startsWith(arg, "--filter=", value))
+      options.filter = value;
+    else if (startsWith(arg, "--repetitions=", value))
+      options.repetitions = std::max(1, std::stoi(value));
+    else if (startsWith(arg, "--json=", value))
+      jsonFile = value;
+    else if (arg == "--quick")
+      options.smallestSizeOnly = true;
+    else if (arg == "--no-warmup")
+      options.warmup = false;
+    else if (arg == "--list")
+      list = true;
+    else
+    {
+      usage();
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+
+  BenchmarkRegistry registry;
+  registerMatrixBenchmarks(registry);
+  registerFieldBenchmarks(registry);
+  registerPersistentBenchmarks(registry);
+
+  if (list)
+  {
+    for (const auto& c : registry.cases())
+    {
+      std::cout << c.name << ":";
+      for (auto size : c.sizes)
+        std::cout << " " << size;
+      std::cout << "\n";
+    }
+    return 0;
+  }
+
+  auto results = registry.run(options, std::cout);
+
+  if (!jsonFile.empty())
+  {
+    std::ofstream out(jsonFile);
+    out << toJson(results, options);
+    if (!out)
+    {
+      std::cerr << "Could not write " << jsonFile << std::endl;
+      return 1;
+    }
+  }
+
+  for (const auto& r : results)
+    if (!r.error.empty())
+      return 1;
+  return 0;
+}
@@ -0,0 +1,157 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Testing/Benchmarks/BenchmarkInputs.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
+#include <Core/Algorithms/Legacy/Fields/DistanceField/CalculateSignedDistanceField.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/MarchingCubes.h>
+#include <Core/Algorithms/Legacy/Fields/Mapping/MapFieldDataFromSourceToDestination.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Parser/ArrayMathEngine.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
+#include <stdexcept>
+
+using namespace SCIRun;
+using namespace SCIRun::Benchmarks;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Fields;
+using namespace SCIRun::Core::Algorithms::FiniteElements;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  void countMesh(const FieldHandle& field, BenchmarkCounters& counters)
+  {
+    counters["nodes"] = field->vmesh()->num_nodes();
+    counters["elems"] = field->vmesh()->num_elems();
+  }
+}
+
+void SCIRun::Benchmarks::registerFieldBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("BuildFEMatrixAlgo", { 10, 20, 30 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = tetCube(n, false);
+    countMesh(field, counters);
+    auto algo = makeShared<BuildFEMatrixAlgo>();
+    quiet(*algo);
+    return [field, algo](BenchmarkTimer&)
+    {
+      auto output = algo->run(withInputData((Variables::InputField, field)));
+      if (!output.get<SparseRowMatrix>(BuildFEMatrixAlgo::Stiffness_Matrix))
+        throw std::runtime_error("BuildFEMatrixAlgo failed");
+    };
+  });
+
+  registry.add("MarchingCubesAlgo", { 32, 64, 96 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = sphereLatVol(n);
+    countMesh(field, counters);
+    auto algo = makeShared<MarchingCubesAlgo>();
+    quiet(*algo);
+    algo->set(Parameters::build_field, true);
+    algo->set(Parameters::build_geometry, false);
+    return [field, algo](BenchmarkTimer&)
+    {
+      FieldHandle output;
+      MatrixHandle nodeInterp, elemInterp;
+      if (!algo->run(field, { 0.5, 0.8 }, output, nodeInterp, elemInterp))
+        throw std::runtime_error("MarchingCubesAlgo failed");
+    };
+  });
+
+  registry.add("MapFieldDataFromSourceToDestination", { 8, 16, 24 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto source = tetCube(n, true);
+    auto destination = TestUtils::CreateEmptyLatVol(2 * n, 2 * n, 2 * n, data_info_type::DOUBLE_E,
+      Point(0.2, 0.2, 0.2), Point(0.8, 0.8, 0.8));
+    countMesh(source, counters);
+    counters["destination_nodes"] = destination->vmesh()->num_nodes();
+    auto algo = makeShared<MapFieldDataFromSourceToDestinationAlgo>();
+    quiet(*algo);
+    algo->setOption(Parameters::MappingMethod, "interpolateddata");
+    return [source, destination, algo](BenchmarkTimer&)
+    {
+      FieldHandle output;
+      if (!algo->runImpl(source, destination, output))
+        throw std::runtime_error("MapFieldDataFromSourceToDestinationAlgo failed");
+    };
+  });
+
+  registry.add("CalculateSignedDistanceField", { 32, 64, 128 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto object = latLongSphere(n);
+    auto field = sphereLatVol(48);
+    countMesh(object, counters);
+    counters["queries"] = field->vmesh()->num_nodes();
+    auto algo = makeShared<CalculateSignedDistanceFieldAlgo>();
+    quiet(*algo);
+    return [field, object, algo](BenchmarkTimer&)
+    {
+      FieldHandle output, value;
+      if (!algo->run(field, object, output, value))
+        throw std::runtime_error("CalculateSignedDistanceFieldAlgo failed");
+    };
+  });
+
+  registry.add("NewArrayMathEngine/expression", { 32, 64, 96 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = sphereLatVol(n);
+    countMesh(field, counters);
+    return [field](BenchmarkTimer&)
+    {
+      NewArrayMathEngine engine;
+      engine.add_input_fielddata("DATA", field);
+      engine.add_input_fielddata_coordinates("X", "Y", "Z", field);
+      engine.add_output_fielddata("RESULT", field);
+      engine.add_expressions("RESULT = (X*X + Y*Y - Z)/(1 + DATA*DATA) + sqrt(abs(X*Y*Z)) - 2*DATA;");
+      if (!engine.run())
+        throw std::runtime_error("NewArrayMathEngine failed");
+    };
+  });
+
+  registry.add("TetVolMesh/synchronize", { 10, 20, 30 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = tetCube(n, false);
+    countMesh(field, counters);
+    return [field](BenchmarkTimer& timer)
+    {
+      timer.pause();
+      field->vmesh()->clear_synchronization();
+      timer.resume();
+      field->vmesh()->synchronize(Mesh::EDGES_E | Mesh::FACES_E | Mesh::NODE_NEIGHBORS_E | Mesh::ELEM_NEIGHBORS_E);
+    };
+  });
+}
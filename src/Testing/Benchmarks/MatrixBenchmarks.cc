@@ -0,0 +1,86 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Testing/Benchmarks/BenchmarkInputs.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <stdexcept>
+
+using namespace SCIRun::Benchmarks;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+
+void SCIRun::Benchmarks::registerMatrixBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("SparseRowMatrix/SpMV", { 32, 64, 96 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto A = gridLaplacian(n);
+    auto x = makeShared<DenseColumnMatrix>(DenseColumnMatrix::Ones(A->ncols()));
+    auto y = makeShared<DenseColumnMatrix>(A->nrows());
+    counters["rows"] = A->nrows();
+    counters["nonzeros"] = A->nonZeros();
+    counters["products_per_iteration"] = 10;
+    return [A, x, y](BenchmarkTimer&)
+    {
+      for (int i = 0; i < 10; ++i)
+        *y = *A * *x;
+    };
+  });
+
+  for (const std::string method : { "cg", "bicg", "jacobi", "minres" })
+  {
+    registry.add("SolveLinearSystemAlgo/" + method, { 16, 32, 48 }, [method](int n, BenchmarkCounters& counters)
+    {
+      auto A = gridLaplacian(n);
+      auto b = makeShared<DenseColumnMatrix>(DenseColumnMatrix::Ones(A->nrows()));
+      counters["rows"] = A->nrows();
+      counters["nonzeros"] = A->nonZeros();
+
+      auto algo = makeShared<SolveLinearSystemAlgo>();
+
+      quiet(*algo);
+      algo->setOption(Variables::Method, method);
+      algo->setOption(Variables::Preconditioner, "Jacobi");
+      algo->set(Variables::MaxIterations, 300);
+      algo->set(Variables::TargetError, 1e-8);
+      algo->set(Variables::BuildConvergence, false);
+      algo->setUpdaterFunc([](double) {});
+      return [A, b, algo](BenchmarkTimer&)
+      {
+        DenseColumnMatrixHandle x;
+        if (!algo->run(A, b, nullptr, x))
+          throw std::runtime_error("SolveLinearSystemAlgo failed");
+      };
+    });
+  }
+}
@@ -0,0 +1,153 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2020 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+
+#include <Testing/Benchmarks/BenchmarkHarness.h>
+#include <Testing/Benchmarks/BenchmarkInputs.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Persistent/Pstreams.h>
+#include <boost/filesystem.hpp>
+#include <stdexcept>
+
+using namespace SCIRun;
+using namespace SCIRun::Benchmarks;
+
+namespace
+{
+  // Scratch file in the temp directory that is removed once the last
+  // benchmark body holding it goes away.
+  class ScratchFile
+  {
+  public:
+    ScratchFile(const std::string& name, int n) :
+      path_((boost::filesystem::temp_directory_path() / ("scirun_benchmark_" + name + "_" + std::to_string(n) + ".fld")).string())
+    {
+    }
+    ~ScratchFile()
+    {
+      boost::system::error_code ec;
+      boost::filesystem::remove(path_, ec);
+    }
+    const std::string& path() const { return path_; }
+  private:
+    std::string path_;
+  };
+
+  using ScratchFileHandle = std::shared_ptr<ScratchFile>;
+
+  void writeField(const std::string& file, FieldHandle field, const std::string& type = "Binary")
+  {
+    auto stream = auto_ostream(file, type);
+    Pio(*stream, field);
+    if (stream->error())
+      throw std::runtime_error(type + " Piostream could not write " + file);
+  }
+
+  void readField(Piostream& stream, const std::string& file, const std::string& type)
+  {
+    FieldHandle field;
+    Pio(stream, field);
+    if (!field || stream.error())
+      throw std::runtime_error(type + " could not read " + file);
+  }
+
+  // Writes the input once and records its size, so the body only times the read.
+  ScratchFileHandle readInput(const std::string& name, int n, const std::string& type, BenchmarkCounters& counters)
+  {
+    auto field = tetCube(n, true);
+    auto file = std::make_shared<ScratchFile>(name, n);
+    writeField(file->path(), field, type);
+    counters["nodes"] = field->vmesh()->num_nodes();
+    counters["elems"] = field->vmesh()->num_elems();
+    counters["file_bytes"] = static_cast<double>(boost::filesystem::file_size(file->path()));
+    return file;
+  }
+}
+
+void SCIRun::Benchmarks::registerPersistentBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("BinaryPiostream/write", { 10, 30, 50 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = tetCube(n, true);
+    auto file = std::make_shared<ScratchFile>("write", n);
+    counters["nodes"] = field->vmesh()->num_nodes();
+    counters["elems"] = field->vmesh()->num_elems();
+    return [field, file](BenchmarkTimer&)
+    {
+      writeField(file->path(), field);
+    };
+  });
+
+  registry.add("BinaryPiostream/read", { 10, 30, 50 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto file = readInput("read", n, "Binary", counters);
+    return [file](BenchmarkTimer&)
+    {
+      BinaryPiostream stream(file->path(), Piostream::Direction::Read);
+      readField(stream, file->path(), "BinaryPiostream");
+    };
+  });
+
+  registry.add("MappedBinaryPiostream/read", { 10, 30, 50 }, [](int n, BenchmarkCounters& counters)
+  {
+    // auto_istream opens native binary files through the memory-mapped reader
+    auto file = readInput("mapped_read", n, "Binary", counters);
+    return [file](BenchmarkTimer&)
+    {
+      auto stream = auto_istream(file->path());
+      if (!stream)
+        throw std::runtime_error("Could not open " + file->path());
+      readField(*stream, file->path(), "MappedBinaryPiostream");
+    };
+  });
+
+  registry.add("ChunkedBinaryPiostream/write", { 10, 30, 50 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto field = tetCube(n, true);
+    auto file = std::make_shared<ScratchFile>("chunked_write", n);
+    counters["nodes"] = field->vmesh()->num_nodes();
+    counters["elems"] = field->vmesh()->num_elems();
+    return [field, file](BenchmarkTimer&)
+    {
+      writeField(file->path(), field, "Compressed");
+    };
+  });
+
+  registry.add("ChunkedBinaryPiostream/read", { 10, 30, 50 }, [](int n, BenchmarkCounters& counters)
+  {
+    auto file = readInput("chunked_read", n, "Compressed", counters);
+    return [file](BenchmarkTimer&)
+    {
+      auto stream = auto_istream(file->path());
+      if (!stream)
+        throw std::runtime_error("Could not open " + file->path());
+      readField(*stream, file->path(), "ChunkedBinaryPiostream");
+    };
+  });
+}
@@ -29,6 +29,7 @@
 #include <Testing/Utils/SCIRunFieldSamples.h>
 
 #include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/Vector.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
@@ -291,6 +292,66 @@ FieldHandle CubeTriSurfLinearBasis(data_info_type type)
 
 }}
 
+FieldHandle SCIRun::TestUtils::CreateCubeBlock(mesh_info_type mesh, int n, databasis_info_type basis,
+  const std::function<Point(int, int, int)>& position, const std::function<bool(int, int, int)>& skipCell)
+{
+  FieldInformation fi(mesh, basis, data_info_type::DOUBLE_E);
+  FieldHandle field = CreateField(fi);
+  auto vmesh = field->vmesh();
+
+  vmesh->node_reserve((n+1)*(n+1)*(n+1));
+  for (int k = 0; k <= n; k++)
+    for (int j = 0; j <= n; j++)
+      for (int i = 0; i <= n; i++)
+        vmesh->add_point(position ? position(i, j, k) : Point(i, j, k));
+
+  // Cube corners are numbered by their offsets, x + 2y + 4z
+  static const int tets[6][4] = { {0,1,3,7}, {0,1,5,7}, {0,2,3,7}, {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+  static const int prisms[2][6] = { {0,1,3,4,5,7}, {0,3,2,4,7,6} };
+  static const int hex[1][8] = { {0,1,3,2,4,5,7,6} };
+
+  const int* cells;
+  int num_cells, num_corners;
+  switch (mesh)
+  {
+  case mesh_info_type::TETVOLMESH_E: cells = tets[0]; num_cells = 6; num_corners = 4; break;
+  case mesh_info_type::PRISMVOLMESH_E: cells = prisms[0]; num_cells = 2; num_corners = 6; break;
+  default: cells = hex[0]; num_cells = 1; num_corners = 8; break;
+  }
+
+  auto node = [n](int i, int j, int k) { return static_cast<VMesh::index_type>(i + (n+1)*(j + (n+1)*k)); };
+  VMesh::Node::array_type nodes(num_corners);
+  for (int k = 0; k < n; k++)
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < n; i++)
+      {
+        if (skipCell && skipCell(i, j, k))
+          continue;
+        for (int c = 0; c < num_cells; c++)
+        {
+          const int* corners = cells + c*num_corners;
+          for (int q = 0; q < num_corners; q++)
+            nodes[q] = node(i + (corners[q] & 1), j + ((corners[q] >> 1) & 1), k + ((corners[q] >> 2) & 1));
+          if (num_corners == 4)
+          {
+            // Orient the tetrahedra so that the jacobian is positive
+            auto p0 = vmesh->get_point(nodes[0]);
+            if (Dot(Cross(vmesh->get_point(nodes[1]) - p0, vmesh->get_point(nodes[2]) - p0), vmesh->get_point(nodes[3]) - p0) < 0)
+              std::swap(nodes[2], nodes[3]);
+          }
+          vmesh->add_elem(nodes);
+        }
+      }
+
+  field->vfield()->resize_values();
+  return field;
+}
+
+Point SCIRun::TestUtils::ShearedGridPoint(int i, int j, int k)
+{
+  return Point(i + 0.1*j, j, k + 0.05*i);
+}
+
 FieldHandle SCIRun::TestUtils::CreateEmptyLatVol()
 {
   size_type sizex = 3, sizey = 4, sizez = 5;
@@ -32,6 +32,8 @@
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/GeometryPrimitives/Point.h>
 
+#include <functional>
+
 #include <Testing/Utils/share.h>
 
 /// Utility file containing empty and very small fields (no data set, only types).
@@ -90,6 +92,21 @@ SCISHARE FieldHandle CubeTriSurfLinearBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfConstantBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfLinearBasis(data_info_type type);
 
+/// Block of n^3 unit cubes over the grid nodes (i,j,k), 0 <= i,j,k <= n, numbered with i
+/// running fastest. A TetVolMesh splits every cube into six positively oriented tetrahedra
+/// around its main diagonal, a PrismVolMesh into two prisms standing on the xy diagonal, and a
+/// HexVolMesh keeps the cubes. Nodes are placed by position(i,j,k), the integer grid if it is
+/// empty, and the cubes with lower corner (i,j,k) for which skipCell returns true are left out.
+/// The field values are allocated but not set.
+SCISHARE FieldHandle CreateCubeBlock(mesh_info_type mesh, int n,
+  databasis_info_type basis = databasis_info_type::LINEARDATA_E,
+  const std::function<Core::Geometry::Point(int, int, int)>& position = {},
+  const std::function<bool(int, int, int)>& skipCell = {});
+
+/// Sheared grid position for CreateCubeBlock, so that no element has edges parallel to
+/// the axes.
+SCISHARE Core::Geometry::Point ShearedGridPoint(int i, int j, int k);
+
 SCISHARE FieldHandle CreateEmptyLatVol();
 SCISHARE FieldHandle CreateEmptyLatVol(size_type sizex, size_type sizey, size_type sizez,
   data_info_type type = data_info_type::DOUBLE_E,